@@ -0,0 +1,394 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2024, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+
+#include "classad/common.h"
+#include "classad/attrName.h"
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace classad {
+
+struct AttrNameEntry {
+	std::string name;
+	uint32_t hash;	// of the name folded to lower case
+	uint32_t key;	// id of the first spelling of the name
+};
+
+// An open addressed hash index over all spellings.  A slot holds the
+// hash of the name in the high word and id+1 in the low word, 0 is empty.
+// All spellings of a name have the same hash, so they are in the same
+// probe sequence.
+struct AttrNameIndex {
+	size_t mask;
+	std::atomic<uint64_t> *slots;
+};
+
+// Readers don't take the lock.  Entries never move once added (that's
+// why they are in a deque), the ids of the entries are published by
+// storing them in a slot of the index, and the arrays that get replaced
+// as the table grows are kept, since a reader may still be using one.
+// Any thread that holds an id learned it after the entry and the arrays
+// holding it were stored.
+struct AttrNameTable {
+	std::mutex lock;
+	std::deque<AttrNameEntry> entries;
+	std::atomic<const AttrNameEntry **> byId{nullptr};
+	size_t byIdSize{0};
+	std::atomic<AttrNameIndex *> index{nullptr};
+	std::vector<void *> retired;
+	size_t keys{0};
+	size_t nameBytes{0};
+	size_t limit{262144};
+	std::atomic<bool> full{false};
+	std::atomic<size_t> notInterned{0};
+};
+
+// A name kept outside of the table because the table was full, shared
+// by the AttrNames that refer to it.
+struct NotInternedName {
+	std::atomic<int> refs;
+	uint32_t hash;	// of the name folded to lower case
+	std::string name;
+};
+
+static uint32_t
+foldChar( unsigned char ch )
+{
+	return (ch >= 'A' && ch <= 'Z') ? ch + ('a' - 'A') : ch;
+}
+
+uint32_t AttrName::
+HashName( const char *name, size_t len )
+{
+	// FNV-1a
+	uint32_t hash = 2166136261u;
+	for (size_t ix = 0; ix < len; ++ix) {
+		hash ^= foldChar( (unsigned char)name[ix] );
+		hash *= 16777619u;
+	}
+	return hash;
+}
+
+static bool
+sameIgnoringCase( const std::string &name, const char *other, size_t len )
+{
+	if (name.size() != len) {
+		return false;
+	}
+	const char *str = name.data();
+	for (size_t ix = 0; ix < len; ++ix) {
+		if (foldChar( (unsigned char)str[ix] ) != foldChar( (unsigned char)other[ix] )) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// Look for a spelling of the name in the index, returning its id.
+// Ignoring case, this finds the first spelling added.
+static bool
+probe( const AttrNameTable &table, const char *name, size_t len, uint32_t hash, bool exact, uint32_t &id )
+{
+	const AttrNameIndex *ix = table.index.load( std::memory_order_acquire );
+	for (size_t pos = hash & ix->mask; ; pos = (pos + 1) & ix->mask) {
+		uint64_t slot = ix->slots[pos].load( std::memory_order_acquire );
+		if ( ! slot) {
+			return false;
+		}
+		if ((uint32_t)(slot >> 32) != hash) {
+			continue;
+		}
+		// load the array after the slot, the id may be newer than the
+		// array we would have loaded before
+		uint32_t candidate = (uint32_t)slot - 1;
+		const std::string &str = table.byId.load( std::memory_order_acquire )[candidate]->name;
+		if (exact ? (str.size() == len && memcmp( str.data(), name, len ) == 0)
+				  : sameIgnoringCase( str, name, len )) {
+			id = candidate;
+			return true;
+		}
+	}
+}
+
+static void
+insertSlot( AttrNameIndex *ix, uint32_t hash, uint32_t id )
+{
+	size_t pos = hash & ix->mask;
+	while (ix->slots[pos].load( std::memory_order_relaxed )) {
+		pos = (pos + 1) & ix->mask;
+	}
+	ix->slots[pos].store( ((uint64_t)hash << 32) | (id + 1), std::memory_order_release );
+}
+
+// Add a spelling; the caller holds the lock.
+static uint32_t
+addEntry( AttrNameTable &table, const char *name, size_t len, uint32_t hash, uint32_t key, bool new_key )
+{
+	uint32_t id = (uint32_t)table.entries.size();
+	table.entries.push_back( AttrNameEntry{ std::string( name, len ), hash, new_key ? id : key } );
+	const std::string &added = table.entries.back().name;
+	table.nameBytes += sizeof(AttrNameEntry);
+	if (added.data() < (const char *)&added || added.data() >= (const char *)(&added + 1)) {
+		// not stored in the string itself
+		table.nameBytes += added.capacity() + 1;
+	}
+	if (new_key) {
+		table.keys++;
+	}
+
+	const AttrNameEntry **byId = table.byId.load( std::memory_order_relaxed );
+	if (id >= table.byIdSize) {
+		size_t size = table.byIdSize ? table.byIdSize * 2 : 1024;
+		const AttrNameEntry **bigger = new const AttrNameEntry *[size];
+		for (size_t ix = 0; ix < id; ++ix) {
+			bigger[ix] = byId[ix];
+		}
+		if (byId) {
+			table.retired.push_back( byId );
+		}
+		byId = bigger;
+		table.byIdSize = size;
+	}
+	byId[id] = &table.entries.back();
+	table.byId.store( byId, std::memory_order_release );
+
+	// keep the index at most half full
+	AttrNameIndex *ix = table.index.load( std::memory_order_relaxed );
+	if ( ! ix || (id + 1) * 2 > ix->mask + 1) {
+		AttrNameIndex *bigger = new AttrNameIndex;
+		size_t size = ix ? (ix->mask + 1) * 2 : 2048;
+		bigger->mask = size - 1;
+		bigger->slots = new std::atomic<uint64_t>[size];
+		for (size_t pos = 0; pos < size; ++pos) {
+			bigger->slots[pos].store( 0, std::memory_order_relaxed );
+		}
+		// in order of id, so the first spelling of a name stays first
+		for (uint32_t old = 0; old < id; ++old) {
+			insertSlot( bigger, byId[old]->hash, old );
+		}
+		if (ix) {
+			table.retired.push_back( ix->slots );
+			table.retired.push_back( ix );
+		}
+		ix = bigger;
+	}
+	insertSlot( ix, hash, id );
+	table.index.store( ix, std::memory_order_release );
+	return id;
+}
+
+static AttrNameTable &
+theTable()
+{
+	// never destroyed, ads may be destroyed during static destruction
+	static AttrNameTable *table = []() {
+		AttrNameTable *t = new AttrNameTable;
+		// id 0 is the empty name
+		addEntry( *t, "", 0, AttrName::HashName( "", 0 ), 0, true );
+		return t;
+	}();
+	return *table;
+}
+
+static const AttrNameEntry &
+entryFor( uint32_t id )
+{
+	return *theTable().byId.load( std::memory_order_acquire )[id];
+}
+
+static uint64_t
+internedBits( uint32_t id )
+{
+	return ((uint64_t)entryFor( id ).key << 32) | ((uint64_t)id << 1) | 1;
+}
+
+static NotInternedName *
+notInterned( uint64_t bits )
+{
+	return reinterpret_cast<NotInternedName *>( (uintptr_t)bits );
+}
+
+static uint64_t
+newNotInterned( AttrNameTable &table, const char *name, size_t len, uint32_t hash )
+{
+	NotInternedName *entry = new NotInternedName;
+	entry->refs.store( 1, std::memory_order_relaxed );
+	entry->hash = hash;
+	entry->name.assign( name, len );
+	table.notInterned.fetch_add( 1, std::memory_order_relaxed );
+	return (uint64_t)(uintptr_t)entry;
+}
+
+const std::string &AttrName::
+str() const
+{
+	return Interned() ? entryFor( Id() ).name : notInterned( bits )->name;
+}
+
+uint32_t AttrName::
+Hash() const
+{
+	return Interned() ? entryFor( Id() ).hash : notInterned( bits )->hash;
+}
+
+void AttrName::
+Retain() const
+{
+	notInterned( bits )->refs.fetch_add( 1, std::memory_order_relaxed );
+}
+
+void AttrName::
+Release()
+{
+	NotInternedName *entry = notInterned( bits );
+	if (entry->refs.fetch_sub( 1, std::memory_order_acq_rel ) == 1) {
+		theTable().notInterned.fetch_sub( 1, std::memory_order_relaxed );
+		delete entry;
+	}
+	bits = 1;
+}
+
+bool AttrName::
+SameNotInterned( const AttrName &other ) const
+{
+	const NotInternedName *theirs = notInterned( other.bits );
+	return notInterned( bits ) == theirs ||
+		CompareNotInterned( theirs->name.data(), theirs->name.size(), theirs->hash ) == 0;
+}
+
+bool AttrName::
+NotInternedBefore( const AttrName &other ) const
+{
+	const NotInternedName *theirs = notInterned( other.bits );
+	return CompareNotInterned( theirs->name.data(), theirs->name.size(), theirs->hash ) < 0;
+}
+
+int AttrName::
+CompareNotInterned( const char *name, size_t len, uint32_t hash ) const
+{
+	const NotInternedName *mine = notInterned( bits );
+	if (mine->hash != hash) {
+		return mine->hash < hash ? -1 : 1;
+	}
+	const std::string &a = mine->name;
+	for (size_t ix = 0; ix < a.size() && ix < len; ++ix) {
+		uint32_t ca = foldChar( (unsigned char)a[ix] );
+		uint32_t cb = foldChar( (unsigned char)name[ix] );
+		if (ca != cb) {
+			return ca < cb ? -1 : 1;
+		}
+	}
+	if (a.size() != len) {
+		return a.size() < len ? -1 : 1;
+	}
+	return 0;
+}
+
+bool AttrName::
+TableFull()
+{
+	return theTable().full.load( std::memory_order_acquire );
+}
+
+bool AttrName::
+Find( const char *name, size_t len, AttrName &found )
+{
+	AttrNameTable &table = theTable();
+	uint32_t id;
+	if ( ! probe( table, name, len, HashName( name, len ), false, id )) {
+		return false;
+	}
+	found = AttrName();
+	found.bits = internedBits( id );
+	return true;
+}
+
+void AttrName::
+Intern( const char *name, size_t len )
+{
+	AttrNameTable &table = theTable();
+	uint32_t hash = HashName( name, len );
+	uint32_t id;
+
+	if (probe( table, name, len, hash, true, id )) {
+		bits = internedBits( id );
+		return;
+	}
+
+	std::lock_guard<std::mutex> guard( table.lock );
+	if (probe( table, name, len, hash, true, id )) {
+		bits = internedBits( id );
+		return;
+	}
+	uint32_t first;
+	bool known = probe( table, name, len, hash, false, first );
+	if (table.entries.size() >= table.limit) {
+		table.full.store( true, std::memory_order_release );
+		bits = known ? internedBits( first ) : newNotInterned( table, name, len, hash );
+		return;
+	}
+	if (known) {
+		id = addEntry( table, name, len, hash, entryFor( first ).key, false );
+	} else {
+		id = addEntry( table, name, len, hash, 0, true );
+	}
+	bits = internedBits( id );
+}
+
+void
+ClassAdGetAttrNameStats( AttrNameStats &stats )
+{
+	AttrNameTable &table = theTable();
+	std::lock_guard<std::mutex> guard( table.lock );
+	const AttrNameIndex *ix = table.index.load( std::memory_order_relaxed );
+	stats.names = table.entries.size();
+	stats.keys = table.keys;
+	stats.bytes = table.nameBytes
+		+ table.byIdSize * sizeof(AttrNameEntry *)
+		+ (ix->mask + 1) * sizeof(uint64_t);
+	stats.limit = table.limit;
+	stats.not_interned = table.notInterned.load( std::memory_order_relaxed );
+}
+
+void
+ClassAdInternAttrNames( const char * const *names, size_t count )
+{
+	for (size_t ix = 0; ix < count; ++ix) {
+		AttrName name( names[ix] );
+	}
+}
+
+void
+ClassAdSetAttrNameLimit( size_t max_names )
+{
+	AttrNameTable &table = theTable();
+	std::lock_guard<std::mutex> guard( table.lock );
+	if (table.full.load( std::memory_order_relaxed ) && max_names > table.limit) {
+		return;
+	}
+	// ids must fit in 31 bits, and the empty name is always there
+	table.limit = std::max( std::min( max_names, (size_t)0x7FFFFFFF ), (size_t)1 );
+}
+
+} // classad
@@ -536,7 +536,7 @@ FindExpr(EvalState &state, ExprTree *&tree, ExprTree *&sig, bool wantSig) const
 AttributeReference *AttributeReference::
 MakeAttributeReference(ExprTree *tree, const std::string &attrStr, bool absolut)
 {
-	return( new AttributeReference( tree, attrStr, absolut ) );
+	return( CLASSAD_NEW_EXPR( AttributeReference, tree, attrStr, absolut ) );
 }
 
 } // classad
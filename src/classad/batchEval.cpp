@@ -0,0 +1,640 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2024, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+
+#include "classad/common.h"
+#include "classad/classad.h"
+#include "classad/literals.h"
+#include "classad/attrrefs.h"
+#include "classad/batchEval.h"
+
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+#include <math.h>
+
+namespace classad {
+
+size_t BatchColumn::
+size( ) const
+{
+	switch (kind) {
+	case INTEGER: return ints.size();
+	case REAL: return reals.size();
+	case BOOLEAN: return bools.size();
+	default: return values.size();
+	}
+}
+
+void BatchColumn::
+GetValue( size_t ix, Value &val ) const
+{
+	if (scalar) { ix = 0; }
+	switch (kind) {
+	case INTEGER: val.SetIntegerValue(ints[ix]); break;
+	case REAL: val.SetRealValue(reals[ix]); break;
+	case BOOLEAN: val.SetBooleanValue(bools[ix] != 0); break;
+	default: val.CopyFrom(values[ix]); break;
+	}
+}
+
+void BatchColumn::
+Classify( )
+{
+	kind = VALUES;
+	if (values.empty()) {
+		return;
+	}
+
+	Value::ValueType type = values[0].GetType();
+	for (const Value &val : values) {
+		if (val.GetType() != type) {
+			return;
+		}
+	}
+
+	size_t n = values.size();
+	switch (type) {
+	case Value::INTEGER_VALUE:
+		ints.resize(n);
+		for (size_t ix = 0; ix < n; ++ix) { values[ix].IsIntegerValue(ints[ix]); }
+		values.clear();
+		kind = INTEGER;
+		break;
+	case Value::REAL_VALUE:
+		reals.resize(n);
+		for (size_t ix = 0; ix < n; ++ix) { values[ix].IsRealValue(reals[ix]); }
+		values.clear();
+		kind = REAL;
+		break;
+	case Value::BOOLEAN_VALUE: {
+		bools.resize(n);
+		bool b = false;
+		for (size_t ix = 0; ix < n; ++ix) { values[ix].IsBooleanValue(b); bools[ix] = b; }
+		values.clear();
+		kind = BOOLEAN;
+		break;
+	}
+	case Value::STRING_VALUE:
+		strs.resize(n);
+		for (size_t ix = 0; ix < n; ++ix) { values[ix].IsStringValue(strs[ix]); }
+		kind = STRING;
+		break;
+	default:
+		break;
+	}
+}
+
+
+BatchColumnPtr AdBatch::
+GetColumn( const std::string &attr )
+{
+	auto it = columns.find(attr);
+	if (it != columns.end()) {
+		return it->second;
+	}
+
+	std::shared_ptr<BatchColumn> col(new BatchColumn());
+	col->values.resize(ads.size());
+	for (size_t ix = 0; ix < ads.size(); ++ix) {
+		Value &val = col->values[ix];
+		// most attributes are literals, which we can take as they are
+		const ExprTree *tree = ads[ix]->Lookup(attr);
+		if (tree) { tree = tree->self(); }
+		if (tree && tree->GetKind() >= ExprTree::ERROR_LITERAL && tree->GetKind() <= ExprTree::STRING_LITERAL) {
+			static_cast<const Literal*>(tree)->GetValue(val);
+		} else if ( ! ads[ix]->EvaluateAttr(attr, val)) {
+			val.SetErrorValue();
+		}
+	}
+	col->Classify();
+
+	columns[attr] = col;
+	return col;
+}
+
+
+BatchExpr::
+BatchExpr( const ExprTree *tree )
+	: fallbacks(0)
+{
+	if (tree) {
+		root.reset(Build(tree->self()));
+	}
+}
+
+BatchExpr::
+~BatchExpr( )
+{
+}
+
+BatchExpr::Node *BatchExpr::
+Build( const ExprTree *expr )
+{
+	Node *node = new Node();
+	node->type = Node::FALLBACK;
+	node->op = Operation::__NO_OP__;
+	node->expr = expr;
+
+	switch (expr->GetKind()) {
+	case ExprTree::ERROR_LITERAL:
+	case ExprTree::UNDEFINED_LITERAL:
+	case ExprTree::BOOLEAN_LITERAL:
+	case ExprTree::INTEGER_LITERAL:
+	case ExprTree::REAL_LITERAL:
+	case ExprTree::RELTIME_LITERAL:
+	case ExprTree::ABSTIME_LITERAL:
+	case ExprTree::STRING_LITERAL: {
+		std::shared_ptr<BatchColumn> col(new BatchColumn());
+		col->scalar = true;
+		col->values.resize(1);
+		static_cast<const Literal*>(expr)->GetValue(col->values[0]);
+		col->Classify();
+		node->type = Node::CONSTANT;
+		node->constant = col;
+		return node;
+	}
+
+	case ExprTree::ATTRREF_NODE: {
+		// attr, or MY.attr when MY is the ad itself, looked up in the ad
+		ExprTree *scope = nullptr;
+		std::string attr;
+		bool absolute = false;
+		static_cast<const AttributeReference*>(expr)->GetComponents(scope, attr, absolute);
+		if (_useOldClassAdSemantics && ! absolute && scope && scope->GetKind() == ExprTree::ATTRREF_NODE) {
+			ExprTree *scope_scope = nullptr;
+			std::string scope_attr;
+			bool scope_absolute = false;
+			static_cast<const AttributeReference*>(scope)->GetComponents(scope_scope, scope_attr, scope_absolute);
+			if ( ! scope_scope && ! scope_absolute && strcasecmp(scope_attr.c_str(), "MY") == 0) {
+				scope = nullptr;
+			}
+		}
+		if ( ! absolute && ! scope) {
+			node->type = Node::ATTRIBUTE;
+			node->attr = attr;
+			return node;
+		}
+		break;
+	}
+
+	case ExprTree::OP_NODE: {
+		Operation::OpKind op = Operation::__NO_OP__;
+		ExprTree *c1 = nullptr, *c2 = nullptr, *c3 = nullptr;
+		static_cast<const Operation*>(expr)->GetComponents(op, c1, c2, c3);
+		if ( ! c1 || op == Operation::SUBSCRIPT_OP) {
+			break;
+		}
+		node->type = Node::OPERATION;
+		node->op = op;
+		node->child[0].reset(Build(c1->self()));
+		if (c2) { node->child[1].reset(Build(c2->self())); }
+		if (c3) { node->child[2].reset(Build(c3->self())); }
+		return node;
+	}
+
+	default:
+		break;
+	}
+
+	++fallbacks;
+	return node;
+}
+
+
+void BatchExpr::
+Evaluate( AdBatch &batch, std::vector<Value> &results ) const
+{
+	results.resize(batch.size());
+	if ( ! root) {
+		for (Value &val : results) { val.SetErrorValue(); }
+		return;
+	}
+	BatchColumnPtr col = Eval(*root, batch);
+	for (size_t ix = 0; ix < results.size(); ++ix) {
+		col->GetValue(ix, results[ix]);
+	}
+}
+
+size_t BatchExpr::
+EvaluateBool( AdBatch &batch, std::vector<unsigned char> &matches ) const
+{
+	size_t n = batch.size();
+	matches.assign(n, 0);
+	if ( ! root || ! n) {
+		return 0;
+	}
+
+	BatchColumnPtr col = Eval(*root, batch);
+	size_t stride = col->scalar ? 0 : 1;
+	switch (col->kind) {
+	case BatchColumn::BOOLEAN:
+		for (size_t ix = 0; ix < n; ++ix) { matches[ix] = col->bools[ix * stride]; }
+		break;
+	case BatchColumn::INTEGER:
+		for (size_t ix = 0; ix < n; ++ix) { matches[ix] = col->ints[ix * stride] != 0; }
+		break;
+	case BatchColumn::REAL:
+		for (size_t ix = 0; ix < n; ++ix) { matches[ix] = col->reals[ix * stride] != 0; }
+		break;
+	default: {
+		bool b = false;
+		for (size_t ix = 0; ix < n; ++ix) {
+			matches[ix] = col->values[ix * stride].IsBooleanValueEquiv(b) && b;
+		}
+		break;
+	}
+	}
+
+	size_t count = 0;
+	for (unsigned char m : matches) { count += m; }
+	return count;
+}
+
+BatchColumnPtr BatchExpr::
+Eval( const Node &node, AdBatch &batch ) const
+{
+	switch (node.type) {
+	case Node::CONSTANT:
+		return node.constant;
+
+	case Node::ATTRIBUTE:
+		return batch.GetColumn(node.attr);
+
+	case Node::OPERATION:
+		return EvalOperation(node, batch);
+
+	case Node::FALLBACK:
+	default: {
+		std::shared_ptr<BatchColumn> col(new BatchColumn());
+		col->values.resize(batch.size());
+		for (size_t ix = 0; ix < batch.size(); ++ix) {
+			if ( ! ClassAd::EvaluateExpr(batch.GetAd(ix), node.expr, col->values[ix])) {
+				col->values[ix].SetErrorValue();
+			}
+		}
+		col->Classify();
+		return col;
+	}
+	}
+}
+
+
+// The loops below all come in four flavors, for whether each operand is
+// a scalar, so that the common case of comparing a column to a literal
+// is a loop over one array.
+template <class R, class A, class B, class F>
+static void
+apply2( size_t n, const A *a, bool sa, const B *b, bool sb, std::vector<R> &out, F f )
+{
+	if (sa && sb) {
+		out.resize(1);
+		out[0] = f(a[0], b[0]);
+	} else if (sa) {
+		out.resize(n);
+		const A x = a[0];
+		for (size_t ix = 0; ix < n; ++ix) { out[ix] = f(x, b[ix]); }
+	} else if (sb) {
+		out.resize(n);
+		const B y = b[0];
+		for (size_t ix = 0; ix < n; ++ix) { out[ix] = f(a[ix], y); }
+	} else {
+		out.resize(n);
+		for (size_t ix = 0; ix < n; ++ix) { out[ix] = f(a[ix], b[ix]); }
+	}
+}
+
+// A numeric column as integers or reals, converting booleans (and, for
+// reals, integers) the way Operation::coerceToNumber() does.
+template <class T>
+class NumView
+{
+public:
+	NumView( const BatchColumn &col, const std::vector<long long> &ints,
+			 const std::vector<double> &reals, const std::vector<unsigned char> &bools )
+	{
+		if (col.GetKind() == BatchColumn::INTEGER) { convert(ints); }
+		else if (col.GetKind() == BatchColumn::REAL) { convert(reals); }
+		else { convert(bools); }
+	}
+	const T *data( ) const { return ptr; }
+
+private:
+	template <class S> void convert( const std::vector<S> &src ) {
+		if constexpr (std::is_same<S, T>::value) {
+			ptr = src.data();
+		} else {
+			tmp.assign(src.begin(), src.end());
+			ptr = tmp.data();
+		}
+	}
+	std::vector<T> tmp;
+	const T *ptr;
+};
+
+static bool
+isNumeric( BatchColumn::Kind kind )
+{
+	return kind == BatchColumn::INTEGER || kind == BatchColumn::REAL || kind == BatchColumn::BOOLEAN;
+}
+
+template <class T, class R>
+static void
+compareNumbers( Operation::OpKind op, size_t n, const T *a, bool sa, const T *b, bool sb, std::vector<R> &out )
+{
+	switch (op) {
+	case Operation::LESS_THAN_OP:
+		apply2(n, a, sa, b, sb, out, [](T x, T y) -> R { return x < y; }); break;
+	case Operation::LESS_OR_EQUAL_OP:
+		apply2(n, a, sa, b, sb, out, [](T x, T y) -> R { return x <= y; }); break;
+	case Operation::GREATER_THAN_OP:
+		apply2(n, a, sa, b, sb, out, [](T x, T y) -> R { return x > y; }); break;
+	case Operation::GREATER_OR_EQUAL_OP:
+		apply2(n, a, sa, b, sb, out, [](T x, T y) -> R { return x >= y; }); break;
+	case Operation::EQUAL_OP:
+	case Operation::META_EQUAL_OP:
+		apply2(n, a, sa, b, sb, out, [](T x, T y) -> R { return x == y; }); break;
+	default:
+		apply2(n, a, sa, b, sb, out, [](T x, T y) -> R { return x != y; }); break;
+	}
+}
+
+// Evaluate one operator on typed operands with array loops.  Returns
+// false if the operands aren't ones we have a loop for, or if the loop
+// came upon a value it can't represent (such as division by zero), in
+// which case the operator is applied to each ad's Values instead.
+bool BatchExpr::
+EvalTyped( Operation::OpKind op, size_t n, const BatchColumn *a, const BatchColumn *b,
+				const BatchColumn *c, BatchColumn &out )
+{
+	BatchColumn::Kind ka = a->GetKind();
+	BatchColumn::Kind kb = b ? b->GetKind() : BatchColumn::VALUES;
+	bool sa = a->IsScalar();
+	bool sb = b ? b->IsScalar() : true;
+
+	switch (op) {
+	case Operation::UNARY_MINUS_OP:
+		out.scalar = sa;
+		if (ka == BatchColumn::INTEGER) {
+			out.kind = BatchColumn::INTEGER;
+			out.ints.resize(a->ints.size());
+			for (size_t ix = 0; ix < a->ints.size(); ++ix) {
+				out.ints[ix] = (long long)(0ULL - (unsigned long long)a->ints[ix]);
+			}
+			return true;
+		} else if (ka == BatchColumn::REAL) {
+			out.kind = BatchColumn::REAL;
+			out.reals.resize(a->reals.size());
+			for (size_t ix = 0; ix < a->reals.size(); ++ix) { out.reals[ix] = -a->reals[ix]; }
+			return true;
+		}
+		return false;
+
+	case Operation::LOGICAL_NOT_OP:
+		if (ka != BatchColumn::BOOLEAN) { return false; }
+		out.kind = BatchColumn::BOOLEAN;
+		out.scalar = sa;
+		out.bools.resize(a->bools.size());
+		for (size_t ix = 0; ix < a->bools.size(); ++ix) { out.bools[ix] = ! a->bools[ix]; }
+		return true;
+
+	case Operation::LOGICAL_AND_OP:
+	case Operation::LOGICAL_OR_OP:
+		if (ka != BatchColumn::BOOLEAN || kb != BatchColumn::BOOLEAN) { return false; }
+		out.kind = BatchColumn::BOOLEAN;
+		out.scalar = sa && sb;
+		if (op == Operation::LOGICAL_AND_OP) {
+			apply2(n, a->bools.data(), sa, b->bools.data(), sb, out.bools,
+				[](unsigned char x, unsigned char y) -> unsigned char { return x & y; });
+		} else {
+			apply2(n, a->bools.data(), sa, b->bools.data(), sb, out.bools,
+				[](unsigned char x, unsigned char y) -> unsigned char { return x | y; });
+		}
+		return true;
+
+	case Operation::ADDITION_OP:
+	case Operation::SUBTRACTION_OP:
+	case Operation::MULTIPLICATION_OP:
+	case Operation::DIVISION_OP:
+	case Operation::MODULUS_OP:
+		if ( ! isNumeric(ka) || ! isNumeric(kb)) { return false; }
+		out.scalar = sa && sb;
+		if (ka != BatchColumn::REAL && kb != BatchColumn::REAL) {
+			NumView<long long> x(*a, a->ints, a->reals, a->bools);
+			NumView<long long> y(*b, b->ints, b->reals, b->bools);
+			out.kind = BatchColumn::INTEGER;
+			typedef unsigned long long U;
+			switch (op) {
+			case Operation::ADDITION_OP:
+				apply2(n, x.data(), sa, y.data(), sb, out.ints,
+					[](long long p, long long q) -> long long { return (long long)((U)p + (U)q); });
+				return true;
+			case Operation::SUBTRACTION_OP:
+				apply2(n, x.data(), sa, y.data(), sb, out.ints,
+					[](long long p, long long q) -> long long { return (long long)((U)p - (U)q); });
+				return true;
+			case Operation::MULTIPLICATION_OP:
+				apply2(n, x.data(), sa, y.data(), sb, out.ints,
+					[](long long p, long long q) -> long long { return (long long)((U)p * (U)q); });
+				return true;
+			default: {
+				// division by zero is an error, which an integer can't hold
+				size_t count = sb ? 1 : n;
+				for (size_t ix = 0; ix < count; ++ix) {
+					if (y.data()[ix] == 0) { return false; }
+				}
+				const long long lmin = std::numeric_limits<long long>::min();
+				const long long lmax = std::numeric_limits<long long>::max();
+				if (op == Operation::DIVISION_OP) {
+					apply2(n, x.data(), sa, y.data(), sb, out.ints,
+						[=](long long p, long long q) -> long long { return (p == lmin && q == -1) ? lmax : p / q; });
+				} else {
+					apply2(n, x.data(), sa, y.data(), sb, out.ints,
+						[=](long long p, long long q) -> long long { return (p == lmin && q == -1) ? 0 : p % q; });
+				}
+				return true;
+			}
+			}
+		} else {
+			if (op == Operation::MODULUS_OP) { return false; }
+			NumView<double> x(*a, a->ints, a->reals, a->bools);
+			NumView<double> y(*b, b->ints, b->reals, b->bools);
+			out.kind = BatchColumn::REAL;
+			switch (op) {
+			case Operation::ADDITION_OP:
+				apply2(n, x.data(), sa, y.data(), sb, out.reals, [](double p, double q) { return p + q; });
+				break;
+			case Operation::SUBTRACTION_OP:
+				apply2(n, x.data(), sa, y.data(), sb, out.reals, [](double p, double q) { return p - q; });
+				break;
+			case Operation::MULTIPLICATION_OP:
+				apply2(n, x.data(), sa, y.data(), sb, out.reals, [](double p, double q) { return p * q; });
+				break;
+			default:
+				apply2(n, x.data(), sa, y.data(), sb, out.reals, [](double p, double q) { return p / q; });
+				break;
+			}
+			// Operation::doRealArithmetic() makes overflow an error
+			for (double r : out.reals) {
+				if (r == HUGE_VAL) { return false; }
+			}
+			return true;
+		}
+
+	case Operation::LESS_THAN_OP:
+	case Operation::LESS_OR_EQUAL_OP:
+	case Operation::GREATER_THAN_OP:
+	case Operation::GREATER_OR_EQUAL_OP:
+	case Operation::EQUAL_OP:
+	case Operation::NOT_EQUAL_OP:
+	case Operation::META_EQUAL_OP:
+	case Operation::META_NOT_EQUAL_OP: {
+		bool meta = (op == Operation::META_EQUAL_OP || op == Operation::META_NOT_EQUAL_OP);
+		if (ka == BatchColumn::VALUES || kb == BatchColumn::VALUES) { return false; }
+		out.kind = BatchColumn::BOOLEAN;
+		out.scalar = sa && sb;
+		if (meta && ka != kb) {
+			// =?= is false for values of different types
+			out.scalar = true;
+			out.bools.assign(1, op == Operation::META_NOT_EQUAL_OP);
+			return true;
+		}
+		if (ka == BatchColumn::STRING || kb == BatchColumn::STRING) {
+			if (ka != kb) { return false; }
+			// only =?= and =!= are case sensitive
+			auto cmp = meta ? strcmp : strcasecmp;
+			std::vector<int> diff;
+			apply2(n, a->strs.data(), sa, b->strs.data(), sb, diff,
+				[=](const char *x, const char *y) { return cmp(x, y); });
+			out.bools.resize(diff.size());
+			int zero = 0;
+			const int *z = &zero;
+			compareNumbers(op, diff.size(), diff.data(), false, z, true, out.bools);
+			return true;
+		}
+		if (ka != BatchColumn::REAL && kb != BatchColumn::REAL) {
+			NumView<long long> x(*a, a->ints, a->reals, a->bools);
+			NumView<long long> y(*b, b->ints, b->reals, b->bools);
+			compareNumbers(op, n, x.data(), sa, y.data(), sb, out.bools);
+		} else {
+			NumView<double> x(*a, a->ints, a->reals, a->bools);
+			NumView<double> y(*b, b->ints, b->reals, b->bools);
+			compareNumbers(op, n, x.data(), sa, y.data(), sb, out.bools);
+		}
+		return true;
+	}
+
+	case Operation::TERNARY_OP: {
+		if ( ! c || ka != BatchColumn::BOOLEAN || kb != c->GetKind()) { return false; }
+		if (kb != BatchColumn::INTEGER && kb != BatchColumn::REAL && kb != BatchColumn::BOOLEAN) { return false; }
+		bool sc = c->IsScalar();
+		out.kind = kb;
+		out.scalar = sa && sb && sc;
+		size_t count = out.scalar ? 1 : n;
+		size_t st_a = sa ? 0 : 1, st_b = sb ? 0 : 1, st_c = sc ? 0 : 1;
+		auto select = [&](auto &dst, const auto &x, const auto &y) {
+			dst.resize(count);
+			for (size_t ix = 0; ix < count; ++ix) {
+				dst[ix] = a->bools[ix * st_a] ? x[ix * st_b] : y[ix * st_c];
+			}
+		};
+		if (kb == BatchColumn::INTEGER) { select(out.ints, b->ints, c->ints); }
+		else if (kb == BatchColumn::REAL) { select(out.reals, b->reals, c->reals); }
+		else { select(out.bools, b->bools, c->bools); }
+		return true;
+	}
+
+	default:
+		return false;
+	}
+}
+
+BatchColumnPtr BatchExpr::
+EvalOperation( const Node &node, AdBatch &batch ) const
+{
+	if (node.op == Operation::PARENTHESES_OP) {
+		return Eval(*node.child[0], batch);
+	}
+
+	BatchColumnPtr cols[3];
+	bool all_scalar = true;
+	for (int ix = 0; ix < 3; ++ix) {
+		if (node.child[ix]) {
+			cols[ix] = Eval(*node.child[ix], batch);
+			all_scalar = all_scalar && cols[ix]->IsScalar();
+		}
+	}
+
+	// +x of a number, and x ?: y where x has a single type and so is
+	// never undefined, are just x.
+	BatchColumn::Kind k1 = cols[0]->GetKind();
+	if ((node.op == Operation::UNARY_PLUS_OP && (k1 == BatchColumn::INTEGER || k1 == BatchColumn::REAL)) ||
+		(node.op == Operation::ELVIS_OP && k1 != BatchColumn::VALUES)) {
+		return cols[0];
+	}
+
+	size_t n = batch.size();
+	std::shared_ptr<BatchColumn> out(new BatchColumn());
+	if (EvalTyped(node.op, n, cols[0].get(), cols[1].get(), cols[2].get(), *out)) {
+		return out;
+	}
+
+	// Apply the operator to each ad's values, as CompiledExpr::Evaluate()
+	// and the Operation nodes do.
+	*out = BatchColumn();
+	out->scalar = all_scalar;
+	size_t count = all_scalar ? 1 : n;
+	out->values.resize(count);
+	Value v1, v2, v3, tmp;
+	for (size_t ix = 0; ix < count; ++ix) {
+		Value &result = out->values[ix];
+		cols[0]->GetValue(ix, v1);
+		if ( ! cols[1]) {
+			Operation::_doOperation(node.op, v1, v2, v3, true, false, false, result);
+			continue;
+		}
+		if (node.op == Operation::LOGICAL_AND_OP || node.op == Operation::LOGICAL_OR_OP ||
+			node.op == Operation::ELVIS_OP) {
+			if (Operation::shortCircuit(node.op, v1, tmp) == Operation::SIG_CHLD1) {
+				result.CopyFrom(node.op == Operation::ELVIS_OP ? v1 : tmp);
+				continue;
+			}
+		}
+		cols[1]->GetValue(ix, v2);
+		if ( ! cols[2]) {
+			Operation::_doOperation(node.op, v1, v2, v3, true, true, false, result);
+			continue;
+		}
+		int sig = Operation::shortCircuit(node.op, v1, tmp);
+		if (sig == Operation::SIG_CHLD1) {
+			result.CopyFrom(tmp);
+		} else if (sig == Operation::SIG_CHLD2) {
+			result.CopyFrom(v2);
+		} else if (sig == Operation::SIG_CHLD3) {
+			cols[2]->GetValue(ix, result);
+		} else {
+			cols[2]->GetValue(ix, v3);
+			Operation::_doOperation(node.op, v1, v2, v3, true, true, true, result);
+		}
+	}
+	out->Classify();
+	return out;
+}
+
+} // classad
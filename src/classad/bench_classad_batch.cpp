@@ -0,0 +1,151 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2024, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+// Compares the rate of evaluating a constraint against each ad of a
+// corpus of slot ads in turn with the tree walker with that of evaluating
+// it against the whole corpus at once with a BatchExpr, and checks that
+// both give the same value for every ad.  The batch times include
+// building the attribute columns, which a new AdBatch does for each pass.
+//
+// usage: _bench_classad_batch [-iterations N] [-slots N]
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <chrono>
+#include <vector>
+#include <string>
+
+#include "classad/classad_distribution.h"
+
+using namespace classad;
+
+static const char * constraints[] = {
+	"Memory >= 4096 && Cpus > 2",
+	"Arch == \"X86_64\" && OpSys == \"LINUX\" && OpSysMajorVer >= 9",
+	"MY.Memory * 1.5 > Disk / 1000 || GPUs > 0",
+	"KFlops / Cpus > 10000 ? Mips > 900 : HasSingularity =?= true",
+	"(Cpus - 1) % 3 == 0 && Memory / Cpus >= 1024",
+	"ifThenElse(HasSingularity =?= true, Cpus, 0) > 2 && Memory > 2048",
+};
+
+static ClassAd * make_slot(int ix)
+{
+	ClassAd * slot = new ClassAd();
+	slot->InsertAttr("Arch", (ix % 7) ? "X86_64" : "aarch64");
+	slot->InsertAttr("OpSys", "LINUX");
+	slot->InsertAttr("OpSysMajorVer", 8 + (ix % 3));
+	slot->InsertAttr("Memory", 1024 * (1 + ix % 16));
+	slot->InsertAttr("Disk", 1000000 + 1000 * ix);
+	slot->InsertAttr("Cpus", 1 + ix % 8);
+	slot->InsertAttr("KFlops", 50000 + 1000 * (ix % 100));
+	slot->InsertAttr("Mips", 500 + 10 * (ix % 100));
+	if (ix % 2) { slot->InsertAttr("HasSingularity", true); }
+	if (ix % 5 == 0) { slot->InsertAttr("GPUs", ix % 4); }
+	return slot;
+}
+
+int main(int argc, char ** argv)
+{
+	int iterations = 20;
+	int num_slots = 5000;
+
+	for (int ii = 1; ii < argc; ++ii) {
+		if (!strcmp(argv[ii], "-iterations") && ii+1 < argc) {
+			iterations = atoi(argv[++ii]);
+		} else if (!strcmp(argv[ii], "-slots") && ii+1 < argc) {
+			num_slots = atoi(argv[++ii]);
+		} else {
+			fprintf(stderr, "usage: %s [-iterations N] [-slots N]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	// as the daemons do, so MY refers to the ad
+	SetOldClassAdSemantics(true);
+
+	std::vector<ClassAd*> slots;
+	for (int ix = 0; ix < num_slots; ++ix) {
+		slots.push_back(make_slot(ix));
+	}
+
+	int failures = 0;
+	ClassAdParser parser;
+	int num_constraints = (int)(sizeof(constraints)/sizeof(constraints[0]));
+	for (int cx = 0; cx < num_constraints; ++cx) {
+		ExprTree * tree = parser.ParseExpression(constraints[cx]);
+		if ( ! tree) {
+			printf("constraint %d: parse error\n", cx);
+			++failures;
+			continue;
+		}
+		BatchExpr batch_expr(tree);
+
+		std::vector<Value> tree_values(slots.size());
+		long tree_matches = 0;
+		auto begin = std::chrono::steady_clock::now();
+		for (int it = 0; it < iterations; ++it) {
+			for (size_t ix = 0; ix < slots.size(); ++ix) {
+				ClassAd::EvaluateExpr(slots[ix], tree, tree_values[ix]);
+				bool b = false;
+				if (tree_values[ix].IsBooleanValueEquiv(b) && b) { ++tree_matches; }
+			}
+		}
+		auto end = std::chrono::steady_clock::now();
+		double tree_secs = std::chrono::duration<double>(end - begin).count();
+
+		std::vector<unsigned char> matches;
+		long batch_matches = 0;
+		begin = std::chrono::steady_clock::now();
+		for (int it = 0; it < iterations; ++it) {
+			AdBatch batch(slots.begin(), slots.end());
+			batch_matches += (long)batch_expr.EvaluateBool(batch, matches);
+		}
+		end = std::chrono::steady_clock::now();
+		double batch_secs = std::chrono::duration<double>(end - begin).count();
+
+		double evals = (double)iterations * slots.size();
+		printf("constraint %d: %ld matches, %d subexpressions per ad\n  tree:  %10.0f evals/sec\n  batch: %10.0f evals/sec (%.2fx)\n",
+			cx, tree_matches, batch_expr.NumFallbacks(), evals / tree_secs, evals / batch_secs, tree_secs / batch_secs);
+		if (tree_matches != batch_matches) {
+			printf("  MISMATCH: batch evaluator found %ld matches\n", batch_matches);
+			++failures;
+		}
+
+		AdBatch batch(slots.begin(), slots.end());
+		std::vector<Value> batch_values;
+		batch_expr.Evaluate(batch, batch_values);
+		for (size_t ix = 0; ix < slots.size(); ++ix) {
+			if ( ! batch_values[ix].SameAs(tree_values[ix])) {
+				std::string want, got;
+				ClassAdUnParser unparser;
+				unparser.Unparse(want, tree_values[ix]);
+				unparser.Unparse(got, batch_values[ix]);
+				printf("  MISMATCH: slot %d is %s, batch evaluator gave %s\n", (int)ix, want.c_str(), got.c_str());
+				++failures;
+				break;
+			}
+		}
+
+		delete tree;
+	}
+
+	for (ClassAd * slot : slots) { delete slot; }
+	return failures ? 1 : 0;
+}
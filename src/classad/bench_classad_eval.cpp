@@ -0,0 +1,161 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2024, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+// Compares the evaluation rate of the tree walker with that of the
+// compiled (CompiledExpr) evaluator for typical matchmaking expressions.
+//
+// usage: _bench_classad_eval [-iterations N] [-slots N]
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <chrono>
+#include <vector>
+#include <string>
+
+#include "classad/classad_distribution.h"
+
+using namespace classad;
+
+static const char * job_requirements[] = {
+	"(TARGET.Arch == \"X86_64\") && (TARGET.OpSys == \"LINUX\") && (TARGET.Disk >= RequestDisk) && (TARGET.Memory >= RequestMemory) && (TARGET.Cpus >= RequestCpus) && (TARGET.HasFileTransfer)",
+	"(TARGET.Memory >= RequestMemory) && ((TARGET.OpSysMajorVer == 8) || (TARGET.OpSysMajorVer == 9)) && (TARGET.Cpus >= RequestCpus) && TARGET.HasSingularity =?= true",
+	"ifThenElse(isUndefined(TARGET.GPUs), false, TARGET.GPUs >= RequestGPUs) && TARGET.Memory >= RequestMemory * 1024 / 1024",
+	"TARGET.Memory > 2048 ? (TARGET.Cpus * 2 > RequestCpus) : (TARGET.KFlops > 100000 && TARGET.Mips > 1000)",
+};
+
+static const char * slot_requirements =
+	"(START) && (WithinResourceLimits) && (TARGET.RequestMemory ?: 0) <= MY.Memory";
+
+static ClassAd * make_slot(int ix)
+{
+	ClassAd * slot = new ClassAd();
+	ClassAdParser parser;
+	slot->InsertAttr("Arch", (ix % 7) ? "X86_64" : "aarch64");
+	slot->InsertAttr("OpSys", "LINUX");
+	slot->InsertAttr("OpSysMajorVer", 8 + (ix % 3));
+	slot->InsertAttr("Memory", 1024 * (1 + ix % 16));
+	slot->InsertAttr("Disk", 1000000 + 1000 * ix);
+	slot->InsertAttr("Cpus", 1 + ix % 8);
+	slot->InsertAttr("KFlops", 50000 + 1000 * (ix % 100));
+	slot->InsertAttr("Mips", 500 + 10 * (ix % 100));
+	slot->InsertAttr("HasFileTransfer", true);
+	if (ix % 2) { slot->InsertAttr("HasSingularity", true); }
+	if (ix % 5 == 0) { slot->InsertAttr("GPUs", ix % 4); }
+	slot->Insert("START", parser.ParseExpression("TARGET.RequestCpus <= MY.Cpus || TARGET.Owner == \"alice\""));
+	slot->Insert("WithinResourceLimits", parser.ParseExpression("MY.Cpus > 0 && MY.Memory > 0"));
+	return slot;
+}
+
+static ClassAd * make_job(int ix)
+{
+	ClassAd * job = new ClassAd();
+	job->InsertAttr("Owner", (ix % 2) ? "alice" : "bob");
+	job->InsertAttr("RequestCpus", 1 + ix % 4);
+	job->InsertAttr("RequestMemory", 1024 * (1 + ix % 8));
+	job->InsertAttr("RequestDisk", 1000000);
+	job->InsertAttr("RequestGPUs", 1);
+	return job;
+}
+
+// Time symmetricMatch() against every slot, once with the tree walker and
+// once with compiled programs.  The slot is swapped into the match ad only
+// once per pair of runs so that the measurement is dominated by evaluation.
+static void eval_all(MatchClassAd & mad, std::vector<ClassAd*> & slots, int iterations,
+	double & tree_secs, long & tree_matches, double & compiled_secs, long & compiled_matches)
+{
+	tree_secs = compiled_secs = 0;
+	tree_matches = compiled_matches = 0;
+	for (ClassAd * slot : slots) {
+		mad.ReplaceRightAd(slot);
+
+		ClassAdSetCompiledEvaluation(false);
+		auto begin = std::chrono::steady_clock::now();
+		for (int it = 0; it < iterations; ++it) {
+			if (mad.symmetricMatch()) { ++tree_matches; }
+		}
+		auto end = std::chrono::steady_clock::now();
+		tree_secs += std::chrono::duration<double>(end - begin).count();
+
+		ClassAdSetCompiledEvaluation(true);
+		begin = std::chrono::steady_clock::now();
+		for (int it = 0; it < iterations; ++it) {
+			if (mad.symmetricMatch()) { ++compiled_matches; }
+		}
+		end = std::chrono::steady_clock::now();
+		compiled_secs += std::chrono::duration<double>(end - begin).count();
+
+		mad.RemoveRightAd();
+	}
+}
+
+int main(int argc, char ** argv)
+{
+	int iterations = 20;
+	int num_slots = 5000;
+
+	for (int ii = 1; ii < argc; ++ii) {
+		if (!strcmp(argv[ii], "-iterations") && ii+1 < argc) {
+			iterations = atoi(argv[++ii]);
+		} else if (!strcmp(argv[ii], "-slots") && ii+1 < argc) {
+			num_slots = atoi(argv[++ii]);
+		} else {
+			fprintf(stderr, "usage: %s [-iterations N] [-slots N]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	// expressions must be in the cache to be compiled transparently
+	ClassAdSetExpressionCaching(true);
+
+	std::vector<ClassAd*> slots;
+	for (int ix = 0; ix < num_slots; ++ix) {
+		ClassAd * slot = make_slot(ix);
+		slot->InsertViaCache(ATTR_REQUIREMENTS, slot_requirements);
+		slots.push_back(slot);
+	}
+
+	int failures = 0;
+	int num_jobs = (int)(sizeof(job_requirements)/sizeof(job_requirements[0]));
+	for (int jx = 0; jx < num_jobs; ++jx) {
+		ClassAd * job = make_job(jx);
+		job->InsertViaCache(ATTR_REQUIREMENTS, job_requirements[jx]);
+
+		MatchClassAd mad;
+		mad.ReplaceLeftAd(job);
+
+		long tree_matches = 0, compiled_matches = 0;
+		double tree_secs = 0, compiled_secs = 0;
+		eval_all(mad, slots, iterations, tree_secs, tree_matches, compiled_secs, compiled_matches);
+
+		double evals = (double)iterations * slots.size();
+		printf("job %d: %ld matches\n  tree:     %10.0f evals/sec\n  compiled: %10.0f evals/sec (%.2fx)\n",
+			jx, tree_matches, evals / tree_secs, evals / compiled_secs, tree_secs / compiled_secs);
+		if (tree_matches != compiled_matches) {
+			printf("  MISMATCH: compiled evaluator found %ld matches\n", compiled_matches);
+			++failures;
+		}
+
+		mad.RemoveLeftAd();
+		delete job;
+	}
+
+	for (ClassAd * slot : slots) { delete slot; }
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,264 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2024, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+// Measures the memory used by a synthetic job queue: cluster ads holding
+// the attributes common to their jobs, and job ads chained to them, the
+// way the schedd keeps them.  Reports the heap used per job, the part of
+// it that is attribute names, and what the names would have taken had
+// each ad stored them as std::strings.  Then times attribute lookups.
+// With -arena the ads are built in an ExprArena, and the time to delete
+// them is reported too.
+//
+// usage: _bench_classad_memory [-jobs N] [-procs N] [-lookups N] [-arena]
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <chrono>
+#include <vector>
+#include <string>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+#include "classad/classad_distribution.h"
+
+using namespace classad;
+
+static size_t heap_in_use()
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+	struct mallinfo2 mi = mallinfo2();
+	return mi.uordblks + mi.hblkhd;
+#else
+	return 0;
+#endif
+}
+
+static ClassAd * make_cluster(int cluster)
+{
+	ClassAd * ad = new ClassAd();
+	ClassAdParser parser;
+	char owner[32];
+	snprintf(owner, sizeof(owner), "user%03d", cluster % 300);
+	std::string iwd = std::string("/home/") + owner + "/run" + std::to_string(cluster);
+
+	ad->InsertAttr("ClusterId", cluster);
+	ad->InsertAttr("Owner", owner);
+	ad->InsertAttr("User", std::string(owner) + "@submit.example.org");
+	ad->InsertAttr("AccountingGroup", std::string("group_physics.") + owner);
+	ad->InsertAttr("Cmd", iwd + "/analyze.sh");
+	ad->InsertAttr("Iwd", iwd);
+	ad->InsertAttr("In", "/dev/null");
+	ad->InsertAttr("Out", "_condor_stdout");
+	ad->InsertAttr("Err", "_condor_stderr");
+	ad->InsertAttr("UserLog", iwd + "/job.log");
+	ad->InsertAttr("Universe", 5);
+	ad->InsertAttr("JobPrio", 0);
+	ad->InsertAttr("NiceUser", false);
+	ad->InsertAttr("RequestCpus", 1);
+	ad->InsertAttr("RequestDisk", 1048576);
+	ad->InsertAttr("RequestMemory", 2048);
+	ad->InsertAttr("ImageSize", 100000);
+	ad->InsertAttr("DiskUsage", 10000);
+	ad->InsertAttr("MaxHosts", 1);
+	ad->InsertAttr("MinHosts", 1);
+	ad->InsertAttr("CoreSize", 0);
+	ad->InsertAttr("CumulativeSlotTime", 0);
+	ad->InsertAttr("CommittedTime", 0);
+	ad->InsertAttr("CommittedSlotTime", 0);
+	ad->InsertAttr("CommittedSuspensionTime", 0);
+	ad->InsertAttr("CumulativeSuspensionTime", 0);
+	ad->InsertAttr("ExitBySignal", false);
+	ad->InsertAttr("TransferIn", false);
+	ad->InsertAttr("TransferInputSizeMB", 0);
+	ad->InsertAttr("ShouldTransferFiles", "YES");
+	ad->InsertAttr("WhenToTransferOutput", "ON_EXIT");
+	ad->InsertAttr("StreamOut", false);
+	ad->InsertAttr("StreamErr", false);
+	ad->InsertAttr("BufferSize", 524288);
+	ad->InsertAttr("BufferBlockSize", 32768);
+	ad->InsertAttr("JobNotification", 0);
+	ad->InsertAttr("JobLeaseDuration", 2400);
+	ad->InsertAttr("RootDir", "/");
+	ad->InsertAttr("TargetType", "Machine");
+	ad->InsertAttr("MyType", "Job");
+	ad->InsertAttr("Environment", "PATH=/usr/bin:/bin HOME=" + iwd);
+	ad->InsertAttr("WantRemoteSyscalls", false);
+	ad->InsertAttr("WantCheckpoint", false);
+	ad->InsertAttr("EncryptExecuteDirectory", false);
+	ad->InsertAttr("LeaveJobInQueue", false);
+	ad->InsertAttr("OnExitRemove", true);
+	ad->InsertAttr("OnExitHold", false);
+	ad->InsertAttr("PeriodicHold", false);
+	ad->InsertAttr("PeriodicRelease", false);
+	ad->InsertAttr("PeriodicRemove", false);
+	ad->InsertAttr("NumCkpts", 0);
+	ad->InsertAttr("NumRestarts", 0);
+	ad->InsertAttr("NumSystemHolds", 0);
+	ad->InsertAttr("RequestedChroot", "");
+	ad->InsertAttr("MyProject", "LHC_Analysis_Run3");
+	ad->Insert("Requirements", parser.ParseExpression(
+		"(TARGET.Arch == \"X86_64\") && (TARGET.OpSys == \"LINUX\") && (TARGET.Disk >= RequestDisk) "
+		"&& (TARGET.Memory >= RequestMemory) && (TARGET.HasFileTransfer)"));
+	ad->Insert("Rank", parser.ParseExpression("TARGET.Mips * TARGET.Cpus"));
+	return ad;
+}
+
+static ClassAd * make_proc(int cluster, int proc, ClassAd * cluster_ad)
+{
+	ClassAd * ad = new ClassAd();
+	ad->InsertAttr("ProcId", proc);
+	ad->InsertAttr("JobStatus", 1);
+	ad->InsertAttr("EnteredCurrentStatus", 1700000000 + cluster);
+	ad->InsertAttr("QDate", 1700000000 + cluster);
+	ad->InsertAttr("GlobalJobId", "submit.example.org#" + std::to_string(cluster) + "." + std::to_string(proc) + "#1700000000");
+	ad->InsertAttr("Args", "--input data_" + std::to_string(proc) + ".root --events 10000");
+	ad->InsertAttr("LastJobStatus", 0);
+	ad->InsertAttr("JobRunCount", 0);
+	ad->InsertAttr("NumJobStarts", 0);
+	ad->InsertAttr("NumShadowStarts", 0);
+	ad->InsertAttr("RemoteUserCpu", 0.0);
+	ad->InsertAttr("RemoteSysCpu", 0.0);
+	ad->InsertAttr("RemoteWallClockTime", 0.0);
+	ad->InsertAttr("AutoClusterId", cluster % 50);
+	ad->InsertAttr("AutoClusterAttrs", "RequestCpus,RequestDisk,RequestMemory,Requirements,Rank");
+	ad->ChainToAd(cluster_ad);
+	return ad;
+}
+
+int main(int argc, char ** argv)
+{
+	int num_jobs = 1000000;
+	int procs_per_cluster = 100;
+	long num_lookups = 20000000;
+	bool use_arena = false;
+
+	for (int ii = 1; ii < argc; ++ii) {
+		if (!strcmp(argv[ii], "-jobs") && ii+1 < argc) {
+			num_jobs = atoi(argv[++ii]);
+		} else if (!strcmp(argv[ii], "-procs") && ii+1 < argc) {
+			procs_per_cluster = atoi(argv[++ii]);
+		} else if (!strcmp(argv[ii], "-lookups") && ii+1 < argc) {
+			num_lookups = atol(argv[++ii]);
+		} else if (!strcmp(argv[ii], "-arena")) {
+			use_arena = true;
+		} else {
+			fprintf(stderr, "usage: %s [-jobs N] [-procs N] [-lookups N] [-arena]\n", argv[0]);
+			return 1;
+		}
+	}
+	if (num_jobs < 1 || procs_per_cluster < 1) {
+		fprintf(stderr, "jobs and procs must be positive\n");
+		return 1;
+	}
+
+	size_t heap_start = heap_in_use();
+	auto begin = std::chrono::steady_clock::now();
+
+	std::vector<ClassAd*> ads;
+	std::vector<ClassAd*> clusters;
+	std::vector<ClassAd*> jobs;
+	ads.reserve(num_jobs + num_jobs / procs_per_cluster + 1);
+	jobs.reserve(num_jobs);
+	ClassAd * cluster_ad = nullptr;
+	ExprArena * arena = use_arena ? new ExprArena : nullptr;
+	ExprArenaScope * arena_scope = new ExprArenaScope(arena);
+	for (int ix = 0; ix < num_jobs; ++ix) {
+		int cluster = 1 + ix / procs_per_cluster;
+		int proc = ix % procs_per_cluster;
+		if (proc == 0) {
+			cluster_ad = make_cluster(cluster);
+			ads.push_back(cluster_ad);
+			clusters.push_back(cluster_ad);
+		}
+		ClassAd * job = make_proc(cluster, proc, cluster_ad);
+		ads.push_back(job);
+		jobs.push_back(job);
+	}
+	delete arena_scope;
+	delete arena;
+
+	auto end = std::chrono::steady_clock::now();
+	size_t heap_queue = heap_in_use() - heap_start;
+
+	size_t entries = 0;
+	for (ClassAd * ad : ads) { entries += ad->size(); }
+
+	AttrNameStats names;
+	ClassAdGetAttrNameStats(names);
+
+	// What the same attribute lists take with a std::string per name.
+	std::vector<std::vector<std::pair<std::string, ExprTree*>>> string_lists(ads.size());
+	size_t heap_before_strings = heap_in_use();
+	for (size_t ix = 0; ix < ads.size(); ++ix) {
+		string_lists[ix].reserve(ads[ix]->size());
+		for (auto & [name, tree] : *ads[ix]) {
+			string_lists[ix].emplace_back(name, tree);
+		}
+	}
+	size_t heap_strings = heap_in_use() - heap_before_strings;
+	string_lists.clear();
+	string_lists.shrink_to_fit();
+
+	printf("%d jobs in %zu cluster and job ads, %zu attributes, built in %.2f sec%s\n",
+		num_jobs, ads.size(), entries, std::chrono::duration<double>(end - begin).count(),
+		use_arena ? " in an arena" : "");
+	printf("  heap used:             %12zu bytes (%.0f per job)\n",
+		heap_queue, (double)heap_queue / num_jobs);
+	printf("  attribute lists:       %12zu bytes (%zu per attribute)\n",
+		entries * sizeof(ClassAd::iterator::value_type), sizeof(ClassAd::iterator::value_type));
+	printf("  interned names:        %12zu bytes (%zu names)\n", names.bytes, names.names);
+	printf("  as std::string lists:  %12zu bytes (%.0f per job more)\n",
+		heap_strings, ((double)heap_strings - entries * sizeof(ClassAd::iterator::value_type) - names.bytes) / num_jobs);
+
+	// Look up attributes of the job ads, some of them in the cluster ad
+	static const char * lookup_names[] = {
+		"ProcId", "JobStatus", "RequestMemory", "Owner", "QDate",
+		"Requirements", "EnteredCurrentStatus", "NoSuchAttribute",
+	};
+	const size_t num_names = sizeof(lookup_names) / sizeof(lookup_names[0]);
+	std::vector<std::string> names_str(lookup_names, lookup_names + num_names);
+	long found = 0;
+	begin = std::chrono::steady_clock::now();
+	for (long ix = 0; ix < num_lookups; ++ix) {
+		if (jobs[ix % jobs.size()]->Lookup(names_str[ix % num_names])) { ++found; }
+	}
+	end = std::chrono::steady_clock::now();
+	double secs = std::chrono::duration<double>(end - begin).count();
+	printf("  lookups by string:     %12.0f per sec (%ld found)\n", num_lookups / secs, found);
+
+	std::vector<AttrName> names_interned;
+	for (const auto & name : names_str) { names_interned.emplace_back(name); }
+	found = 0;
+	begin = std::chrono::steady_clock::now();
+	for (long ix = 0; ix < num_lookups; ++ix) {
+		if (jobs[ix % jobs.size()]->Lookup(names_interned[ix % num_names])) { ++found; }
+	}
+	end = std::chrono::steady_clock::now();
+	secs = std::chrono::duration<double>(end - begin).count();
+	printf("  lookups by AttrName:   %12.0f per sec (%ld found)\n", num_lookups / secs, found);
+
+	begin = std::chrono::steady_clock::now();
+	for (ClassAd * job : jobs) { delete job; }
+	for (ClassAd * ad : clusters) { delete ad; }
+	end = std::chrono::steady_clock::now();
+	printf("  deleted in:            %12.3f sec\n", std::chrono::duration<double>(end - begin).count());
+	return 0;
+}
@@ -0,0 +1,226 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2024, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+// Compares the two ways putClassAd() can put ads on the wire, by encoding
+// and decoding a batch of synthetic slot ads the way a collector query
+// reply carries them, all in one message.  The text encoding is an
+// "attr = expr" string per attribute, which the receiver splits and
+// parses; the binary encoding is ClassAdBinaryUnParser's, with attribute
+// names sent once per message.  Reports bytes per ad and ads per second
+// for each.  The sockets themselves aren't involved; both encodings go
+// through the same CEDAR buffers.
+//
+// usage: _bench_classad_wire [-ads N] [-per-message N] [-rounds N]
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <chrono>
+#include <vector>
+#include <string>
+
+#include "classad/classad_distribution.h"
+
+using namespace classad;
+
+static ClassAd * make_slot(int ix)
+{
+	ClassAd * ad = new ClassAd();
+	ClassAdParser parser;
+	std::string machine = "exec" + std::to_string(ix / 16) + ".example.org";
+	std::string name = "slot" + std::to_string(ix % 16 + 1) + "@" + machine;
+
+	ad->InsertAttr("MyType", "Machine");
+	ad->InsertAttr("Name", name);
+	ad->InsertAttr("Machine", machine);
+	ad->InsertAttr("MyAddress", "<10.0." + std::to_string(ix / 4096 % 256) + "." + std::to_string(ix / 16 % 256) + ":9618?addrs=10.0.0.1-9618&alias=" + machine + ">");
+	ad->InsertAttr("Arch", "X86_64");
+	ad->InsertAttr("OpSys", "LINUX");
+	ad->InsertAttr("OpSysAndVer", "AlmaLinux9");
+	ad->InsertAttr("CondorVersion", "$CondorVersion: 25.14.0 2026-09-17 BuildID: 123456 $");
+	ad->InsertAttr("State", ix % 3 ? "Claimed" : "Unclaimed");
+	ad->InsertAttr("Activity", ix % 3 ? "Busy" : "Idle");
+	ad->InsertAttr("Cpus", 1 + ix % 4);
+	ad->InsertAttr("Memory", 2048 * (1 + ix % 4));
+	ad->InsertAttr("Disk", 20000000 + ix);
+	ad->InsertAttr("Mips", 30000 + ix % 1000);
+	ad->InsertAttr("KFlops", 1500000 + ix % 10000);
+	ad->InsertAttr("LoadAvg", 0.25 * (ix % 5));
+	ad->InsertAttr("CondorLoadAvg", 0.2 * (ix % 5));
+	ad->InsertAttr("TotalCpus", 64.0);
+	ad->InsertAttr("TotalMemory", 262144);
+	ad->InsertAttr("TotalSlots", 16);
+	ad->InsertAttr("SlotID", ix % 16 + 1);
+	ad->InsertAttr("SlotWeight", 1 + ix % 4);
+	ad->InsertAttr("HasFileTransfer", true);
+	ad->InsertAttr("HasJobDeferral", true);
+	ad->InsertAttr("HasVM", false);
+	ad->InsertAttr("HasDocker", ix % 2 == 0);
+	ad->InsertAttr("IsWakeAble", false);
+	ad->InsertAttr("EnteredCurrentState", 1790000000 + ix);
+	ad->InsertAttr("EnteredCurrentActivity", 1790000000 + ix);
+	ad->InsertAttr("LastHeardFrom", 1790001000 + ix);
+	ad->InsertAttr("MyCurrentTime", 1790001000 + ix);
+	ad->InsertAttr("UpdateSequenceNumber", ix % 1000);
+	ad->InsertAttr("UpdatesTotal", 100 + ix % 1000);
+	ad->InsertAttr("UpdatesLost", 0);
+	ad->InsertAttr("DaemonStartTime", 1780000000);
+	ad->InsertAttr("FileSystemDomain", "example.org");
+	ad->InsertAttr("UidDomain", "example.org");
+	ad->InsertAttr("StarterAbilityList", "HasFileTransfer,HasJobDeferral,HasTDP,HasSelfCheckpointTransfers");
+	ad->InsertAttr("Rank", 0.0);
+	ad->InsertAttr("CurrentRank", 0.0);
+	ad->InsertAttr("RemoteUser", "user" + std::to_string(ix % 300) + "@example.org");
+	ad->InsertAttr("JobId", std::to_string(1000 + ix) + ".0");
+	ad->Insert("Start", parser.ParseExpression("(KeyboardIdle > 15 * 60) && (LoadAvg - CondorLoadAvg) <= 0.3"));
+	ad->Insert("Requirements", parser.ParseExpression(
+		"START && (WithinResourceLimits) && (TARGET.RequestCpus <= Cpus) && (TARGET.RequestMemory <= Memory)"));
+	ad->Insert("WithinResourceLimits", parser.ParseExpression(
+		"ifThenElse(TARGET._condor_RequestCpus =!= undefined, MY.Cpus > 0 && TARGET._condor_RequestCpus <= MY.Cpus, "
+		"ifThenElse(TARGET.RequestCpus =!= undefined, MY.Cpus > 0 && TARGET.RequestCpus <= MY.Cpus, 1 <= MY.Cpus))"));
+	ad->Insert("IsOwner", parser.ParseExpression("(START =?= false)"));
+	ad->Insert("ChildCpus", parser.ParseExpression("{ 1, 1, 2, 4 }"));
+	return ad;
+}
+
+// The text encoding: what _putClassAd() puts, one string per attribute.
+static void put_text(const ClassAd & ad, std::string & msg)
+{
+	ClassAdUnParser unp;
+	unp.SetOldClassAd(true, true);
+	std::string buf;
+	msg += std::to_string(ad.size());
+	msg += '\0';
+	for (auto & [name, tree] : ad) {
+		buf = name;
+		buf += " = ";
+		unp.Unparse(buf, tree);
+		msg.append(buf.c_str(), buf.size() + 1);
+	}
+}
+
+// What getClassAdEx() does with them, less its shortcuts for literals.
+static bool get_text(const char *& pos, const char * end, ClassAd & ad)
+{
+	ClassAdParser parser;
+	parser.SetOldClassAd(true);
+	int count = atoi(pos);
+	pos += strlen(pos) + 1;
+	for (int ix = 0; ix < count; ++ix) {
+		if (pos >= end) { return false; }
+		const char * eq = strstr(pos, " = ");
+		if ( ! eq) { return false; }
+		std::string attr(pos, eq - pos);
+		ExprTree * tree = parser.ParseExpression(eq + 3);
+		if ( ! tree || ! ad.Insert(attr, tree)) { return false; }
+		pos += strlen(pos) + 1;
+	}
+	return true;
+}
+
+int main(int argc, char ** argv)
+{
+	int num_ads = 10000;
+	int per_message = 1000;
+	int rounds = 5;
+
+	for (int ii = 1; ii < argc; ++ii) {
+		if (!strcmp(argv[ii], "-ads") && ii+1 < argc) {
+			num_ads = atoi(argv[++ii]);
+		} else if (!strcmp(argv[ii], "-per-message") && ii+1 < argc) {
+			per_message = atoi(argv[++ii]);
+		} else if (!strcmp(argv[ii], "-rounds") && ii+1 < argc) {
+			rounds = atoi(argv[++ii]);
+		} else {
+			fprintf(stderr, "usage: %s [-ads N] [-per-message N] [-rounds N]\n", argv[0]);
+			return 1;
+		}
+	}
+	if (num_ads < 1 || per_message < 1 || rounds < 1) {
+		fprintf(stderr, "ads, per-message and rounds must be positive\n");
+		return 1;
+	}
+
+	std::vector<ClassAd *> ads;
+	size_t attrs = 0;
+	for (int ix = 0; ix < num_ads; ++ix) {
+		ads.push_back(make_slot(ix));
+		attrs += ads.back()->size();
+	}
+	printf("%d slot ads, %zu attributes, %d ads per message, best of %d rounds\n",
+		num_ads, attrs, per_message, rounds);
+
+	for (int binary = 0; binary < 2; ++binary) {
+		double best_put = 1e9, best_get = 1e9;
+		size_t bytes = 0;
+		bool ok = true;
+		for (int round = 0; round < rounds; ++round) {
+			std::vector<std::string> msgs((num_ads + per_message - 1) / per_message);
+
+			auto begin = std::chrono::steady_clock::now();
+			for (size_t m = 0; m < msgs.size(); ++m) {
+				ClassAdBinaryNames names;
+				ClassAdBinaryUnParser unp(&names);
+				for (size_t ix = m * per_message; ix < ads.size() && ix < (m + 1) * per_message; ++ix) {
+					if (binary) {
+						unp.Unparse(msgs[m], *ads[ix]);
+					} else {
+						put_text(*ads[ix], msgs[m]);
+					}
+				}
+			}
+			auto end = std::chrono::steady_clock::now();
+			best_put = std::min(best_put, std::chrono::duration<double>(end - begin).count());
+
+			bytes = 0;
+			std::vector<ClassAd *> received;
+			received.reserve(ads.size());
+			begin = std::chrono::steady_clock::now();
+			for (const std::string & msg : msgs) {
+				ClassAdBinaryNames names;
+				ClassAdBinaryParser parser(&names);
+				const char * pos = msg.data();
+				const char * msg_end = pos + msg.size();
+				bytes += msg.size();
+				while (pos < msg_end) {
+					ClassAd * ad = new ClassAd();
+					ok = ok && (binary ? parser.ParseClassAd(pos, msg_end, *ad) : get_text(pos, msg_end, *ad));
+					received.push_back(ad);
+					if ( ! ok) { break; }
+				}
+			}
+			end = std::chrono::steady_clock::now();
+			best_get = std::min(best_get, std::chrono::duration<double>(end - begin).count());
+
+			for (size_t ix = 0; ok && ix < received.size(); ++ix) {
+				ok = received.size() == ads.size() && received[ix]->SameAs(ads[ix]);
+			}
+			for (ClassAd * ad : received) { delete ad; }
+		}
+		if ( ! ok) {
+			printf("  %s: ads did not round trip\n", binary ? "binary" : "text");
+			return 1;
+		}
+		printf("  %-6s %8.0f bytes per ad, encoded %9.0f ads/sec, decoded %9.0f ads/sec\n",
+			binary ? "binary" : "text", (double)bytes / num_ads, num_ads / best_put, num_ads / best_get);
+	}
+
+	for (ClassAd * ad : ads) { delete ad; }
+	return 0;
+}
@@ -0,0 +1,584 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2024, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+
+#include "classad/common.h"
+#include "classad/binaryCodec.h"
+#include "classad/classad.h"
+#include "classad/classadCache.h"
+
+#include <string.h>
+
+using std::string;
+using std::vector;
+
+namespace classad {
+
+enum BinaryTag {
+	TAG_UNDEFINED,
+	TAG_ERROR,
+	TAG_FALSE,
+	TAG_TRUE,
+	TAG_INTEGER,
+	TAG_REAL,
+	TAG_STRING,
+	TAG_ABSTIME,
+	TAG_RELTIME,
+	TAG_ATTRREF,
+	TAG_OP,
+	TAG_FNCALL,
+	TAG_LIST,
+	TAG_CLASSAD,
+	TAG_NULL,
+};
+
+static const unsigned ATTRREF_ABSOLUTE = 1;
+static const unsigned ATTRREF_SCOPED = 2;
+
+// the same limit as the text parser puts on nesting
+static const int MAX_BINARY_DEPTH = 500;
+
+static void
+putVarint( string &buffer, uint64_t val )
+{
+	while (val >= 0x80) {
+		buffer += (char)(val | 0x80);
+		val >>= 7;
+	}
+	buffer += (char)val;
+}
+
+static void
+putSigned( string &buffer, int64_t val )
+{
+	putVarint( buffer, ((uint64_t)val << 1) ^ (uint64_t)(val >> 63) );
+}
+
+static void
+putReal( string &buffer, double val )
+{
+	uint64_t bits;
+	memcpy( &bits, &val, sizeof(bits) );
+	for (int i = 0; i < 8; i++) {
+		buffer += (char)(bits >> (8 * i));
+	}
+}
+
+static void
+putBytes( string &buffer, const char *data, size_t len )
+{
+	putVarint( buffer, len );
+	buffer.append( data, len );
+}
+
+static bool
+getVarint( const char *&pos, const char *end, uint64_t &val )
+{
+	val = 0;
+	for (int shift = 0; shift < 64; shift += 7) {
+		if (pos >= end) {
+			return false;
+		}
+		unsigned char c = *pos++;
+		val |= (uint64_t)(c & 0x7f) << shift;
+		if ( ! (c & 0x80)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+static bool
+getSigned( const char *&pos, const char *end, int64_t &val )
+{
+	uint64_t zz;
+	if ( ! getVarint( pos, end, zz )) {
+		return false;
+	}
+	val = (int64_t)(zz >> 1) ^ -(int64_t)(zz & 1);
+	return true;
+}
+
+static bool
+getReal( const char *&pos, const char *end, double &val )
+{
+	if (end - pos < 8) {
+		return false;
+	}
+	uint64_t bits = 0;
+	for (int i = 0; i < 8; i++) {
+		bits |= (uint64_t)(unsigned char)pos[i] << (8 * i);
+	}
+	pos += 8;
+	memcpy( &val, &bits, sizeof(val) );
+	return true;
+}
+
+static bool
+getBytes( const char *&pos, const char *end, const char *&data, size_t &len )
+{
+	uint64_t val;
+	if ( ! getVarint( pos, end, val ) || val > (uint64_t)(end - pos)) {
+		return false;
+	}
+	data = pos;
+	len = (size_t)val;
+	pos += len;
+	return true;
+}
+
+static int
+operandCount( Operation::OpKind op )
+{
+	switch (op) {
+		case Operation::PARENTHESES_OP:
+		case Operation::UNARY_PLUS_OP:
+		case Operation::UNARY_MINUS_OP:
+		case Operation::LOGICAL_NOT_OP:
+		case Operation::BITWISE_NOT_OP:
+			return 1;
+		case Operation::TERNARY_OP:
+			return 3;
+		default:
+			return 2;
+	}
+}
+
+// --- unparser
+
+ClassAdBinaryUnParser::
+ClassAdBinaryUnParser( ClassAdBinaryNames *names_in )
+	: names( names_in ? names_in : &ownNames )
+{
+}
+
+void ClassAdBinaryUnParser::
+UnparseCount( string &buffer, size_t count )
+{
+	putVarint( buffer, count );
+}
+
+void ClassAdBinaryUnParser::
+UnparseName( string &buffer, const string &name )
+{
+	auto [itr, inserted] = names->sent.emplace( name, (uint32_t)names->sent.size() + 1 );
+	if (inserted) {
+		buffer += (char)0;
+		putBytes( buffer, name.data(), name.size() );
+	} else {
+		putVarint( buffer, itr->second );
+	}
+}
+
+void ClassAdBinaryUnParser::
+UnparseAttr( string &buffer, const string &name, const ExprTree *tree )
+{
+	UnparseName( buffer, name );
+	Unparse( buffer, tree );
+}
+
+void ClassAdBinaryUnParser::
+Unparse( string &buffer, const ClassAd &ad )
+{
+	UnparseCount( buffer, ad.size() );
+	for (auto itr = ad.begin(); itr != ad.end(); itr++) {
+		UnparseAttr( buffer, itr->first, itr->second );
+	}
+}
+
+void ClassAdBinaryUnParser::
+Unparse( string &buffer, const ExprTree *tree )
+{
+	if ( ! tree) {
+		buffer += (char)TAG_NULL;
+		return;
+	}
+
+	switch (tree->GetKind()) {
+		case ExprTree::ERROR_LITERAL:
+			buffer += (char)TAG_ERROR;
+			return;
+
+		case ExprTree::UNDEFINED_LITERAL:
+			buffer += (char)TAG_UNDEFINED;
+			return;
+
+		case ExprTree::BOOLEAN_LITERAL:
+			buffer += (char)(static_cast<const BooleanLiteral *>(tree)->getBool() ? TAG_TRUE : TAG_FALSE);
+			return;
+
+		case ExprTree::INTEGER_LITERAL:
+			buffer += (char)TAG_INTEGER;
+			putSigned( buffer, static_cast<const IntegerLiteral *>(tree)->getInteger() );
+			return;
+
+		case ExprTree::REAL_LITERAL:
+			buffer += (char)TAG_REAL;
+			putReal( buffer, static_cast<const RealLiteral *>(tree)->getReal() );
+			return;
+
+		case ExprTree::RELTIME_LITERAL:
+			buffer += (char)TAG_RELTIME;
+			putReal( buffer, static_cast<const ReltimeLiteral *>(tree)->getReltime() );
+			return;
+
+		case ExprTree::ABSTIME_LITERAL: {
+			abstime_t abst = static_cast<const AbstimeLiteral *>(tree)->getAbstime();
+			buffer += (char)TAG_ABSTIME;
+			putSigned( buffer, abst.secs );
+			putSigned( buffer, abst.offset );
+			return;
+		}
+
+		case ExprTree::STRING_LITERAL: {
+			const string &s = static_cast<const StringLiteral *>(tree)->getString();
+			buffer += (char)TAG_STRING;
+			putBytes( buffer, s.data(), s.size() );
+			return;
+		}
+
+		case ExprTree::ATTRREF_NODE: {
+			ExprTree *expr;
+			string ref;
+			bool absolute;
+			static_cast<const AttributeReference *>(tree)->GetComponents( expr, ref, absolute );
+			buffer += (char)TAG_ATTRREF;
+			putVarint( buffer, (absolute ? ATTRREF_ABSOLUTE : 0) | (expr ? ATTRREF_SCOPED : 0) );
+			UnparseName( buffer, ref );
+			if (expr) {
+				Unparse( buffer, expr );
+			}
+			return;
+		}
+
+		case ExprTree::OP_NODE: {
+			Operation::OpKind op;
+			ExprTree *t1, *t2, *t3;
+			static_cast<const Operation *>(tree)->GetComponents( op, t1, t2, t3 );
+			buffer += (char)TAG_OP;
+			putVarint( buffer, op );
+			int count = operandCount( op );
+			Unparse( buffer, t1 );
+			if (count > 1) Unparse( buffer, t2 );
+			if (count > 2) Unparse( buffer, t3 );
+			return;
+		}
+
+		case ExprTree::FN_CALL_NODE: {
+			string name;
+			vector<ExprTree *> args;
+			static_cast<const FunctionCall *>(tree)->GetComponents( name, args );
+			buffer += (char)TAG_FNCALL;
+			putBytes( buffer, name.data(), name.size() );
+			putVarint( buffer, args.size() );
+			for (const ExprTree *arg : args) {
+				Unparse( buffer, arg );
+			}
+			return;
+		}
+
+		case ExprTree::EXPR_LIST_NODE: {
+			const ExprList *list = static_cast<const ExprList *>(tree);
+			buffer += (char)TAG_LIST;
+			putVarint( buffer, list->size() );
+			for (const ExprTree *expr : *list) {
+				Unparse( buffer, expr );
+			}
+			return;
+		}
+
+		case ExprTree::CLASSAD_NODE:
+			buffer += (char)TAG_CLASSAD;
+			Unparse( buffer, *static_cast<const ClassAd *>(tree) );
+			return;
+
+		case ExprTree::EXPR_ENVELOPE:
+			Unparse( buffer, static_cast<const CachedExprEnvelope *>(tree)->get() );
+			return;
+
+		default:
+			buffer += (char)TAG_ERROR;
+			return;
+	}
+}
+
+// --- parser
+
+ClassAdBinaryParser::
+ClassAdBinaryParser( ClassAdBinaryNames *names_in )
+	: names( names_in ? names_in : &ownNames )
+	, cacheKey( NULL )
+	, cacheKeyFrom( NULL )
+{
+}
+
+bool ClassAdBinaryParser::
+ParseCount( const char *&pos, const char *end, size_t &count )
+{
+	uint64_t val;
+	// every item takes at least a byte, which bounds honest counts
+	if ( ! getVarint( pos, end, val ) || val > (uint64_t)(end - pos)) {
+		return false;
+	}
+	count = (size_t)val;
+	return true;
+}
+
+bool ClassAdBinaryParser::
+ParseName( const char *&pos, const char *end, AttrName &name )
+{
+	if (cacheKey) {
+		cacheKey->append( cacheKeyFrom, pos - cacheKeyFrom );
+	}
+	uint64_t ref;
+	if ( ! getVarint( pos, end, ref )) {
+		return false;
+	}
+	if (ref) {
+		if (ref > names->received.size()) {
+			return false;
+		}
+		name = names->received[ref - 1];
+	} else {
+		const char *data;
+		size_t len;
+		if ( ! getBytes( pos, end, data, len ) || len == 0) {
+			return false;
+		}
+		name = AttrName( data, len );
+		names->received.push_back( name );
+	}
+	// a name's position in the dictionary depends on the message, so the
+	// cache key spells it out, the way it is sent the first time
+	if (cacheKey) {
+		*cacheKey += (char)0;
+		putBytes( *cacheKey, name.data(), name.size() );
+		cacheKeyFrom = pos;
+	}
+	return true;
+}
+
+ExprTree *ClassAdBinaryParser::
+ParseExpression( const char *&pos, const char *end )
+{
+	return ParseExpression( pos, end, 0 );
+}
+
+bool ClassAdBinaryParser::
+ParseAttr( const char *&pos, const char *end, AttrName &name, ExprTree *&tree )
+{
+	tree = NULL;
+	if ( ! ParseName( pos, end, name )) {
+		return false;
+	}
+	tree = ParseExpression( pos, end, 0 );
+	return tree != NULL;
+}
+
+bool ClassAdBinaryParser::
+ParseClassAd( const char *&pos, const char *end, ClassAd &ad, bool use_cache )
+{
+	return ParseAttrs( pos, end, ad, 0, use_cache && ClassAdGetExpressionCaching() );
+}
+
+bool ClassAdBinaryParser::
+ParseAttrs( const char *&pos, const char *end, ClassAd &ad, int depth, bool use_cache )
+{
+	size_t count;
+	if ( ! ParseCount( pos, end, count )) {
+		return false;
+	}
+	for (size_t i = 0; i < count; i++) {
+		AttrName name;
+		if ( ! ParseName( pos, end, name )) {
+			return false;
+		}
+		bool cache_it = use_cache && name[0] != '\'';
+		string key;
+		if (cache_it) {
+			// keyed on the bytes that encode the expression, so that
+			// caching it doesn't cost unparsing it.  Parsed text never
+			// starts with this byte, so these keys don't collide with
+			// the keys of expressions parsed from text.
+			key = (char)1;
+			cacheKey = &key;
+			cacheKeyFrom = pos;
+		}
+		ExprTree *tree = ParseExpression( pos, end, depth );
+		if (cache_it) {
+			cacheKey = NULL;
+		}
+		if ( ! tree) {
+			return false;
+		}
+		if (cache_it) {
+			key.append( cacheKeyFrom, pos - cacheKeyFrom );
+			tree = CachedExprEnvelope::cache( name, tree, key );
+		}
+		if ( ! ad.Insert( name, tree )) {
+			delete tree;
+			return false;
+		}
+	}
+	return true;
+}
+
+ExprTree *ClassAdBinaryParser::
+ParseExpression( const char *&pos, const char *end, int depth )
+{
+	if (pos >= end || depth > MAX_BINARY_DEPTH) {
+		return NULL;
+	}
+
+	switch (*pos++) {
+		case TAG_UNDEFINED:
+			return Literal::MakeUndefined();
+
+		case TAG_ERROR:
+			return Literal::MakeError();
+
+		case TAG_FALSE:
+			return Literal::MakeBool( false );
+
+		case TAG_TRUE:
+			return Literal::MakeBool( true );
+
+		case TAG_INTEGER: {
+			int64_t val;
+			if ( ! getSigned( pos, end, val )) return NULL;
+			return Literal::MakeInteger( val );
+		}
+
+		case TAG_REAL: {
+			double val;
+			if ( ! getReal( pos, end, val )) return NULL;
+			return Literal::MakeReal( val );
+		}
+
+		case TAG_RELTIME: {
+			double secs;
+			if ( ! getReal( pos, end, secs )) return NULL;
+			Value val;
+			val.SetRelativeTimeValue( secs );
+			return Literal::MakeLiteral( val );
+		}
+
+		case TAG_ABSTIME: {
+			int64_t secs, offset;
+			if ( ! getSigned( pos, end, secs ) || ! getSigned( pos, end, offset )) return NULL;
+			abstime_t abst;
+			abst.secs = (time_t)secs;
+			abst.offset = (int)offset;
+			return Literal::MakeAbsTime( &abst );
+		}
+
+		case TAG_STRING: {
+			const char *data;
+			size_t len;
+			if ( ! getBytes( pos, end, data, len )) return NULL;
+			return Literal::MakeString( data, len );
+		}
+
+		case TAG_ATTRREF: {
+			uint64_t flags;
+			AttrName name;
+			if ( ! getVarint( pos, end, flags ) || ! ParseName( pos, end, name )) return NULL;
+			ExprTree *expr = NULL;
+			if (flags & ATTRREF_SCOPED) {
+				if ( ! (expr = ParseExpression( pos, end, depth + 1 ))) return NULL;
+			}
+			return AttributeReference::MakeAttributeReference( expr, name.str(), (flags & ATTRREF_ABSOLUTE) != 0 );
+		}
+
+		case TAG_OP: {
+			uint64_t op;
+			if ( ! getVarint( pos, end, op ) || op < Operation::__FIRST_OP__ || op > Operation::__LAST_OP__) {
+				return NULL;
+			}
+			Operation::OpKind kind = (Operation::OpKind)op;
+			int count = operandCount( kind );
+			ExprTree *t[3] = { NULL, NULL, NULL };
+			for (int i = 0; i < count; i++) {
+				bool is_null = pos < end && *pos == TAG_NULL;
+				if (is_null) {
+					pos++;
+				} else if ( ! (t[i] = ParseExpression( pos, end, depth + 1 ))) {
+					delete t[0];
+					delete t[1];
+					return NULL;
+				}
+			}
+			// only the middle of a ternary (making it an elvis) may be missing
+			if ( ! t[0] || (count > 1 && ! t[count - 1])) {
+				delete t[0];
+				delete t[1];
+				delete t[2];
+				return NULL;
+			}
+			return Operation::MakeOperation( kind, t[0], t[1], t[2] );
+		}
+
+		case TAG_FNCALL: {
+			const char *data;
+			size_t len, count;
+			if ( ! getBytes( pos, end, data, len ) || ! ParseCount( pos, end, count )) return NULL;
+			vector<ExprTree *> args;
+			args.reserve( count );
+			for (size_t i = 0; i < count; i++) {
+				ExprTree *arg = ParseExpression( pos, end, depth + 1 );
+				if ( ! arg) {
+					for (ExprTree *a : args) delete a;
+					return NULL;
+				}
+				args.push_back( arg );
+			}
+			return FunctionCall::MakeFunctionCall( string( data, len ), args );
+		}
+
+		case TAG_LIST: {
+			size_t count;
+			if ( ! ParseCount( pos, end, count )) return NULL;
+			vector<ExprTree *> exprs;
+			exprs.reserve( count );
+			for (size_t i = 0; i < count; i++) {
+				ExprTree *expr = ParseExpression( pos, end, depth + 1 );
+				if ( ! expr) {
+					for (ExprTree *e : exprs) delete e;
+					return NULL;
+				}
+				exprs.push_back( expr );
+			}
+			return ExprList::MakeExprList( exprs );
+		}
+
+		case TAG_CLASSAD: {
+			ClassAd *ad = new ClassAd;
+			if ( ! ParseAttrs( pos, end, *ad, depth + 1, false )) {
+				delete ad;
+				return NULL;
+			}
+			return ad;
+		}
+
+		default:
+			return NULL;
+	}
+}
+
+} // classad
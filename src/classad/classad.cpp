@@ -261,6 +261,12 @@ GetComponents( std::vector<std::pair<std::string, ExprTree* > > &attrs ) const
 	for( const auto& [attr_name, tree] : attrList ) {
 		attrs.emplace_back(attr_name, tree);
 	}
+	// the attribute list is in order of interned name, which differs
+	// from process to process; give callers (the unparser) a stable order
+	std::sort( attrs.begin(), attrs.end(),
+		[]( const std::pair<std::string, ExprTree*> &a, const std::pair<std::string, ExprTree*> &b ) {
+			return ClassAdFlatMapOrder{}( a.first, b.first );
+		} );
 }
 
 void ClassAd::
@@ -380,11 +386,23 @@ DeepInsertAttr( ExprTree *scopeExpr, const std::string &name, bool value )
 
 
 // --- begin std::string attribute insertion
+
+// Long strings inserted by code are shared through the cache, the same
+// as long strings that were parsed.
+static ExprTree *
+CacheStringLiteral( const std::string &name, ExprTree *plit )
+{
+	if ( ! doExpressionCaching || name.empty() || name[0] == '\'' ) {
+		return plit;
+	}
+	return CachedExprEnvelope::cache( name, plit );
+}
+
 bool ClassAd::
 InsertAttr( const std::string &name, const char *value )
 {
 	ExprTree* plit  = Literal::MakeString( value );
-	return( Insert( name, plit ) );
+	return( Insert( name, CacheStringLiteral( name, plit ) ) );
 }
 
 bool ClassAd::
@@ -414,7 +432,7 @@ bool ClassAd::
 InsertAttr( const std::string &name, const std::string &value )
 {
 	ExprTree* plit  = Literal::MakeString( value );
-	return( Insert( name, plit ) );
+	return( Insert( name, CacheStringLiteral( name, plit ) ) );
 }
 
 
@@ -476,6 +494,26 @@ bool ClassAd::InsertViaCache(const std::string& name, const std::string & rhs, b
 	return Insert(name, tree);
 }
 
+// Insert an attribute value that was already parsed from rhs via cache if the cache is enabled
+//
+bool ClassAd::InsertViaCache(const std::string& name, const std::string & rhs, ExprTree * tree)
+{
+	if (name.empty() || ! tree) {
+		delete tree;
+		return false;
+	}
+
+	if (doExpressionCaching && name[0] != '\'' && CachedExprEnvelope::cacheable(rhs)) {
+		CachedExprEnvelope * penv = CachedExprEnvelope::check_hit(name, rhs);
+		if (penv) {
+			delete tree;
+			return Insert(name, penv);
+		}
+		tree = CachedExprEnvelope::cache(name, tree, rhs);
+	}
+	return Insert(name, tree);
+}
+
 bool
 ClassAd::Insert(const std::string &str)
 {
@@ -538,6 +576,17 @@ AssignExpr(const std::string &name, const char *value)
 }
 
 bool ClassAd::Insert( const std::string& attrName, ExprTree * tree )
+{
+		// sanity checks
+	if( attrName.empty() ) {
+		CondorErrno = ERR_MISSING_ATTRNAME;
+		CondorErrMsg= "no attribute name when inserting expression in classad";
+		return false;
+	}
+	return Insert( AttrName(attrName), tree );
+}
+
+bool ClassAd::Insert( const AttrName& attrName, ExprTree * tree )
 {
 		// sanity checks
 	if( attrName.empty() ) {
@@ -604,6 +653,11 @@ bool ClassAd::Swap(const std::string& attrName, ExprTree* tree, ExprTree* & old_
 // for large std::string literals.
 //
 bool ClassAd::InsertLiteral(const std::string & name, Literal* lit)
+{
+	return InsertLiteral(AttrName(name), lit);
+}
+
+bool ClassAd::InsertLiteral(const AttrName & name, Literal* lit)
 {
 	auto [itr, inserted] = attrList.emplace(name, lit);
 
@@ -684,13 +738,23 @@ LookupInScope(const std::string &name, ExprTree*& expr, EvalState &state) const
 
 	expr = NULL;
 
+	// look the name up once for all the scopes; if it has never been
+	// interned, no ad has an attribute of that name, unless the table of
+	// names is full, in which case look it up as a string.
+	AttrName key;
+	bool known = AttrName::Find( name, key );
+	bool not_interned = ! known && AttrName::TableFull();
+
 	while( !expr && current ) {
 
 		// lookups/eval's being done in the 'current' ad
 		state.curAd = current;
 
 		// lookup in current scope
-		if( ( expr = current->Lookup( name ) ) ) {
+		if( known && ( expr = current->Lookup( key ) ) ) {
+			return( EVAL_OK );
+		}
+		if( not_interned && ( expr = current->Lookup( name ) ) ) {
 			return( EVAL_OK );
 		}
 
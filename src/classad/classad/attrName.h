@@ -0,0 +1,212 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2024, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+
+#ifndef __CLASSAD_ATTR_NAME_H__
+#define __CLASSAD_ATTR_NAME_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <utility>
+
+namespace classad {
+
+/** An attribute name, interned in a process wide table.
+ *
+ *  A ClassAd stores the names of its attributes as AttrNames rather than
+ *  as strings, so that each distinct name is kept in memory once no
+ *  matter how many ads have an attribute of that name.  An AttrName is
+ *  two integers: the id of its spelling, and a key that is the same for
+ *  all spellings of the name that differ only in case.  Comparing keys
+ *  is how ClassAds compare attribute names.
+ *
+ *  Names are never removed from the table.  The table can be read by
+ *  several threads at once, and names can be added by any thread.  So
+ *  that names sent by clients can't grow it without bound, the table
+ *  holds at most ClassAdSetAttrNameLimit() spellings.  Once it is full,
+ *  a new name is kept outside of the table, in memory shared by the
+ *  AttrNames that refer to it and freed with the last of them, and a
+ *  new spelling of a name already in the table gets the first spelling.
+ *
+ *  An AttrName converts to a const std::string & and has the read-only
+ *  parts of the std::string interface that code iterating over a ClassAd
+ *  usually uses.  Comparisons with strings, like those of std::string,
+ *  are case sensitive.
+ */
+class AttrName
+{
+	public:
+		/// The empty name.
+		AttrName() : bits(1) {}
+		AttrName( const AttrName &other ) : bits(other.bits) { if ( ! Interned()) { Retain(); } }
+		AttrName( AttrName &&other ) noexcept : bits(other.bits) { other.bits = 1; }
+		~AttrName() { if ( ! Interned()) { Release(); } }
+		AttrName &operator=( const AttrName &other ) {
+			if (bits != other.bits) {
+				AttrName copy( other );
+				std::swap( bits, copy.bits );
+			}
+			return *this;
+		}
+		AttrName &operator=( AttrName &&other ) noexcept {
+			std::swap( bits, other.bits );
+			return *this;
+		}
+
+		/// Intern a name, adding it to the table if it is new.
+		explicit AttrName( const std::string &name ) { Intern( name.data(), name.size() ); }
+		explicit AttrName( const char *name ) { Intern( name, strlen(name) ); }
+		AttrName( const char *name, size_t len ) { Intern( name, len ); }
+
+		/** Look up a name without adding it to the table.
+		 *  @param name The name to look for; case is ignored
+		 *  @param found Set to the name with the same key as name
+		 *  @return false if no name with the same key has been interned,
+		 *      in which case no ClassAd has an attribute of that name,
+		 *      unless the table is full.  Names kept outside of the table
+		 *      are never found, see CompareNotInterned().
+		 */
+		static bool Find( const char *name, size_t len, AttrName &found );
+		static bool Find( const std::string &name, AttrName &found )
+			{ return Find( name.data(), name.size(), found ); }
+		static bool Find( const char *name, AttrName &found )
+			{ return Find( name, strlen(name), found ); }
+
+		/// The name, spelled the way it was when it was interned.
+		const std::string &str() const;
+		operator const std::string &() const { return str(); }
+
+		const char *c_str() const { return str().c_str(); }
+		const char *data() const { return str().data(); }
+		size_t size() const { return str().size(); }
+		size_t length() const { return str().size(); }
+		bool empty() const { return bits == 1; }
+		char operator[]( size_t ix ) const { return str()[ix]; }
+		std::string substr( size_t pos, size_t len = std::string::npos ) const
+			{ return str().substr( pos, len ); }
+		int compare( const std::string &other ) const { return str().compare( other ); }
+		template <typename T> size_t find( const T &s, size_t pos = 0 ) const
+			{ return str().find( s, pos ); }
+		template <typename T> size_t rfind( const T &s, size_t pos = std::string::npos ) const
+			{ return str().rfind( s, pos ); }
+		template <typename T> bool starts_with( const T &s ) const { return str().starts_with( s ); }
+		template <typename T> bool ends_with( const T &s ) const { return str().ends_with( s ); }
+
+		/// Same for all spellings of this name that differ only in case.
+		/// All names kept outside of the table have the key NotInterned,
+		/// which is larger than the key of any name in it.
+		uint32_t Key() const { return Interned() ? (uint32_t)(bits >> 32) : NotInterned; }
+		/// Distinct for each spelling in the table.
+		uint32_t Id() const { return Interned() ? (uint32_t)bits >> 1 : NotInterned; }
+		/// Hash of the name folded to lower case.
+		uint32_t Hash() const;
+		/// False if the name is kept outside of the table.
+		bool Interned() const { return (bits & 1) != 0; }
+
+		static const uint32_t NotInterned = 0xFFFFFFFF;
+
+		/// True if the names are the same ignoring case.
+		bool SameKey( const AttrName &other ) const {
+			return Key() == other.Key() && (Interned() || SameNotInterned( other ));
+		}
+		/// The order of ClassAd attributes: by key, then names kept outside
+		/// the table by hash and name, ignoring case.
+		bool KeyBefore( const AttrName &other ) const {
+			if (Key() != other.Key()) {
+				return Key() < other.Key();
+			}
+			return ! Interned() && NotInternedBefore( other );
+		}
+
+		/// Hash of a name folded to lower case, as Hash() returns.
+		static uint32_t HashName( const char *name, size_t len );
+
+		/// True once the table has been full, after which ads may have
+		/// names that Find() doesn't find.
+		static bool TableFull();
+
+		/** Compare this name, which must be kept outside of the table, with
+		 *  a string in the order of KeyBefore().  This is how a name that
+		 *  isn't in the table is looked up without allocating one.
+		 *  @param hash HashName() of the string
+		 *  @return less than, equal to or greater than 0 as this name is
+		 *      before, the same as or after the string, ignoring case
+		 */
+		int CompareNotInterned( const char *name, size_t len, uint32_t hash ) const;
+
+	private:
+		void Intern( const char *name, size_t len );
+		void Retain() const;
+		void Release();
+		bool SameNotInterned( const AttrName &other ) const;
+		bool NotInternedBefore( const AttrName &other ) const;
+
+		// For a name in the table, the key in the high word, and the id
+		// times two plus one in the low word.  Otherwise a pointer to the
+		// name, which is even.
+		uint64_t bits;
+};
+
+inline bool operator==( const AttrName &a, const AttrName &b ) {
+	return a.Id() == b.Id() && (a.Interned() || a.str() == b.str());
+}
+inline bool operator!=( const AttrName &a, const AttrName &b ) { return !(a == b); }
+inline bool operator==( const AttrName &a, const std::string &b ) { return a.str() == b; }
+inline bool operator==( const std::string &a, const AttrName &b ) { return a == b.str(); }
+inline bool operator!=( const AttrName &a, const std::string &b ) { return a.str() != b; }
+inline bool operator!=( const std::string &a, const AttrName &b ) { return a != b.str(); }
+inline bool operator<( const AttrName &a, const std::string &b ) { return a.str() < b; }
+inline bool operator<( const std::string &a, const AttrName &b ) { return a < b.str(); }
+inline std::string operator+( const AttrName &a, const std::string &b ) { return a.str() + b; }
+inline std::string operator+( const std::string &a, const AttrName &b ) { return a + b.str(); }
+inline std::string operator+( const AttrName &a, const char *b ) { return a.str() + b; }
+inline std::string operator+( const char *a, const AttrName &b ) { return a + b.str(); }
+inline std::string operator+( const AttrName &a, char b ) { return a.str() + b; }
+inline std::string &operator+=( std::string &a, const AttrName &b ) { return a += b.str(); }
+
+struct AttrNameStats {
+	size_t names;		// distinct spellings interned
+	size_t keys;		// distinct names ignoring case
+	size_t bytes;		// memory used by the table
+	size_t limit;		// most spellings the table will hold
+	size_t not_interned;	// names kept outside of the table now
+};
+
+// Counts since the process started.
+void ClassAdGetAttrNameStats( AttrNameStats &stats );
+
+/** Intern a list of names up front, so that the names have the same
+ *  spelling and ids in every process that does so before it sees any
+ *  other names.  Processes that send ads to each other then send the
+ *  attributes in an order the receiver can insert without moving any.
+ */
+void ClassAdInternAttrNames( const char * const *names, size_t count );
+
+/** Set the most spellings the table will hold, by default 262144.
+ *  The limit can't be raised once the table has been full, since
+ *  names kept outside of it would then no longer match the same
+ *  names added to it.
+ */
+void ClassAdSetAttrNameLimit( size_t max_names );
+
+} // classad
+
+#endif//__CLASSAD_ATTR_NAME_H__
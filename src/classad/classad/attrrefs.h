@@ -99,10 +99,10 @@ class AttributeReference : public ExprTree
 	protected:
 		/// Constructor
 		AttributeReference(): parentScope(nullptr), expr(nullptr), absolute(false)  {}
+		// ctor for internal use
+		AttributeReference( ExprTree*, const std::string &, bool );
 
   	private:
-		// private ctor for internal use
-		AttributeReference( ExprTree*, const std::string &, bool );
 		virtual void _SetParentScope( const ClassAd* p );
     	virtual bool _Evaluate( EvalState & , Value & ) const;
     	virtual bool _Evaluate( EvalState & , Value &, ExprTree*& ) const;
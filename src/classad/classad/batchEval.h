@@ -0,0 +1,169 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2024, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+
+#ifndef __CLASSAD_BATCH_EVAL_H__
+#define __CLASSAD_BATCH_EVAL_H__
+
+#include <vector>
+#include <string>
+#include <map>
+#include <memory>
+#include "classad/exprTree.h"
+#include "classad/operators.h"
+
+namespace classad {
+
+/** The values of one attribute or subexpression across a batch of ads.
+ *
+ *  When every ad has a value of the same integer, real, boolean or
+ *  string type, the values are kept in a contiguous array of that type.
+ *  Otherwise (a mix of types, or undefined or error in some ads) they
+ *  are kept as Values.  A scalar column holds a single value that
+ *  stands for every ad, such as a literal.
+ */
+class BatchColumn
+{
+	public:
+		enum Kind { INTEGER, REAL, BOOLEAN, STRING, VALUES };
+
+		BatchColumn( ) : kind(VALUES), scalar(false) {}
+
+		Kind GetKind( ) const { return kind; }
+		bool IsScalar( ) const { return scalar; }
+		size_t size( ) const;
+
+		/// The value for the ad at index ix of the batch.
+		void GetValue( size_t ix, Value &val ) const;
+
+	private:
+		friend class AdBatch;
+		friend class BatchExpr;
+
+		// Set kind to the type all of the values share, if they do, and
+		// move them into the array of that type.
+		void Classify( );
+
+		Kind kind;
+		bool scalar;
+		std::vector<long long>		ints;
+		std::vector<double>			reals;
+		std::vector<unsigned char>	bools;
+		std::vector<const char *>	strs;	// point into values
+		std::vector<Value>			values;	// VALUES and STRING
+};
+
+typedef std::shared_ptr<const BatchColumn> BatchColumnPtr;
+
+/** A batch of ads to evaluate expressions against, with the values of
+ *  their attributes kept by column.  The column for an attribute is
+ *  built the first time an expression refers to it, by evaluating the
+ *  attribute in each ad, and is shared by every expression evaluated
+ *  against the batch after that.  The ads must not be changed or
+ *  deleted while the batch is in use.
+ */
+class AdBatch
+{
+	public:
+		AdBatch( ) {}
+		template <class Iter> AdBatch( Iter begin, Iter end ) {
+			for ( ; begin != end; ++begin) { ads.push_back(*begin); }
+		}
+
+		void Add( const ClassAd *ad ) { ads.push_back(ad); columns.clear(); }
+		void Clear( ) { ads.clear(); columns.clear(); }
+
+		size_t size( ) const { return ads.size(); }
+		const ClassAd *GetAd( size_t ix ) const { return ads[ix]; }
+
+		/// The values of an attribute in each ad.
+		BatchColumnPtr GetColumn( const std::string &attr );
+
+	private:
+		std::vector<const ClassAd *> ads;
+		std::map<std::string, BatchColumnPtr, CaseIgnLTStr> columns;
+};
+
+/** An expression prepared for evaluation against a batch of ads.
+ *
+ *  Evaluating it against a batch gives, for each ad, what evaluating
+ *  the expression with ClassAd::EvaluateExpr(ad, tree, val) would.
+ *  Literals, attribute references (attr, and MY.attr with old ClassAd
+ *  semantics), and the arithmetic, comparison, logical and conditional
+ *  operators are evaluated one operator at a time over the whole batch.  Where the operands have a
+ *  single numeric, boolean or string type across the batch, that is a
+ *  loop over plain arrays the compiler can vectorize; otherwise the
+ *  operator is applied to each ad's Values.  Anything else - function
+ *  calls, TARGET and other scoped references, lists, nested ads - is
+ *  evaluated by the tree walker in each ad, and its values feed the
+ *  operators above it.
+ *
+ *  The right operand of &&, || and ?: is evaluated for every ad, and
+ *  the per-ad result is then chosen exactly as the tree walker would, so
+ *  the results only differ from per-ad evaluation in that the step and
+ *  recursion limits apply to each subexpression handed to the tree
+ *  walker rather than to the whole expression.
+ *
+ *  A BatchExpr borrows the nodes of its tree; the tree must outlive it.
+ */
+class BatchExpr
+{
+	public:
+		BatchExpr( const ExprTree *tree );
+		~BatchExpr( );
+
+		/// Number of subexpressions that are evaluated ad by ad by the tree walker.
+		int NumFallbacks( ) const { return fallbacks; }
+
+		/// Evaluate against every ad in the batch.  results[ix] is the value for ad ix.
+		void Evaluate( AdBatch &batch, std::vector<Value> &results ) const;
+
+		/** Evaluate against every ad in the batch as a boolean.  matches[ix]
+		 *  is set if the value for ad ix is true or a non-zero number.
+		 *  @return The number of ads for which it is.
+		 */
+		size_t EvaluateBool( AdBatch &batch, std::vector<unsigned char> &matches ) const;
+
+	private:
+		struct Node {
+			enum Type { CONSTANT, ATTRIBUTE, OPERATION, FALLBACK };
+			Type type;
+			Operation::OpKind op;
+			std::string attr;
+			BatchColumnPtr constant;
+			const ExprTree *expr;
+			std::unique_ptr<Node> child[3];
+		};
+
+		BatchExpr( const BatchExpr & );
+		BatchExpr &operator=( const BatchExpr & );
+
+		Node *Build( const ExprTree *expr );
+		BatchColumnPtr Eval( const Node &node, AdBatch &batch ) const;
+		BatchColumnPtr EvalOperation( const Node &node, AdBatch &batch ) const;
+		static bool EvalTyped( Operation::OpKind op, size_t n, const BatchColumn *a,
+							   const BatchColumn *b, const BatchColumn *c, BatchColumn &out );
+
+		std::unique_ptr<Node> root;
+		int fallbacks;
+};
+
+} // classad
+
+#endif//__CLASSAD_BATCH_EVAL_H__
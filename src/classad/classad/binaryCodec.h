@@ -0,0 +1,158 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2024, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+
+#ifndef __CLASSAD_BINARY_CODEC_H__
+#define __CLASSAD_BINARY_CODEC_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "classad/attrName.h"
+
+namespace classad {
+
+class ExprTree;
+class ClassAd;
+
+/** A binary encoding of expressions, for sending ads between processes
+ *  without unparsing them to text and parsing them again.
+ *
+ *  An expression is sent as its tree, a tag byte for each node followed
+ *  by what the node holds.  Literals are sent as their values, integers
+ *  and lengths as variable length integers (7 bits a byte, low bits
+ *  first; signed values zigzag encoded), and reals as the 8 bytes of the
+ *  IEEE double, low byte first:
+ *
+ *      UNDEFINED, ERROR, FALSE, TRUE
+ *      INTEGER  value
+ *      REAL     value
+ *      STRING   length, bytes
+ *      ABSTIME  seconds, offset
+ *      RELTIME  seconds as a real
+ *      ATTRREF  flags (1: absolute, 2: scoped), name, [scope expression]
+ *      OP       operator, its one, two or three operands
+ *      FNCALL   length, name bytes, argument count, arguments
+ *      LIST     count, expressions
+ *      CLASSAD  count, (name, expression) pairs
+ *      NULL     (a missing operand)
+ *
+ *  The operator is the value of its Operation::OpKind, which therefore
+ *  must only ever be added to at the end.
+ *
+ *  A name (of an attribute or an attribute reference) is sent once per
+ *  dictionary: the first time as a 0 followed by its length and bytes,
+ *  after that as its position in the dictionary plus one.  The sender and
+ *  the receiver must use dictionaries that start out empty at the same
+ *  point in the data, such as the start of a message.
+ */
+class ClassAdBinaryNames
+{
+	public:
+		/// Forget all names, at the start of a new message.
+		void Clear() { sent.clear(); received.clear(); }
+
+	private:
+		friend class ClassAdBinaryUnParser;
+		friend class ClassAdBinaryParser;
+
+		std::unordered_map<std::string, uint32_t> sent;
+		std::vector<AttrName> received;
+};
+
+/// Encodes expressions.  Each call appends to the buffer.
+class ClassAdBinaryUnParser
+{
+	public:
+		/** @param names The dictionary to use; if NULL, the unparser
+		 *      uses one of its own.
+		 */
+		explicit ClassAdBinaryUnParser( ClassAdBinaryNames *names = NULL );
+
+		/// Encode an expression; an envelope is encoded as what it holds.
+		void Unparse( std::string &buffer, const ExprTree *tree );
+
+		/// Encode an attribute, its name followed by its expression.
+		void UnparseAttr( std::string &buffer, const std::string &name, const ExprTree *tree );
+
+		/// Encode the attributes of an ad (but not of its chained parent).
+		void Unparse( std::string &buffer, const ClassAd &ad );
+
+		/// Encode a count, like the number of attributes to follow.
+		static void UnparseCount( std::string &buffer, size_t count );
+
+	private:
+		void UnparseName( std::string &buffer, const std::string &name );
+
+		ClassAdBinaryNames ownNames;
+		ClassAdBinaryNames *names;
+};
+
+/** Decodes what a ClassAdBinaryUnParser encoded.  Each call reads from
+ *  pos, which must not get past end, and advances pos past what was read.
+ *  Malformed or truncated data is an error, never read past.  Nodes are
+ *  made with the ExprTree factories, so they come from the current
+ *  ExprArena if there is one.
+ */
+class ClassAdBinaryParser
+{
+	public:
+		/** @param names The dictionary to use; if NULL, the parser
+		 *      uses one of its own.
+		 */
+		explicit ClassAdBinaryParser( ClassAdBinaryNames *names = NULL );
+
+		/// @return the expression, or NULL on error
+		ExprTree *ParseExpression( const char *&pos, const char *end );
+
+		/// @return false on error, in which case tree is NULL
+		bool ParseAttr( const char *&pos, const char *end, AttrName &name, ExprTree *&tree );
+
+		/** Decode the attributes of an ad and insert them into ad.
+		 *  @param use_cache Share the ad's expressions through the
+		 *      expression cache, as the text parser would, if caching
+		 *      is enabled.  They are keyed on the bytes that encode
+		 *      them, so decoded ads share expressions with each other,
+		 *      but not with ads parsed from text.
+		 *  @return false on error, in which case ad may have some of them.
+		 */
+		bool ParseClassAd( const char *&pos, const char *end, ClassAd &ad, bool use_cache = false );
+
+		/// @return false on error
+		static bool ParseCount( const char *&pos, const char *end, size_t &count );
+
+	private:
+		ExprTree *ParseExpression( const char *&pos, const char *end, int depth );
+		bool ParseName( const char *&pos, const char *end, AttrName &name );
+		bool ParseAttrs( const char *&pos, const char *end, ClassAd &ad, int depth, bool use_cache );
+
+		ClassAdBinaryNames ownNames;
+		ClassAdBinaryNames *names;
+
+		// while decoding an expression to cache, its key so far, and
+		// where the bytes not yet added to it start
+		std::string *cacheKey;
+		const char *cacheKeyFrom;
+};
+
+} // classad
+
+#endif//__CLASSAD_BINARY_CODEC_H__
@@ -103,6 +103,9 @@ class ClassAd : public ExprTree
 		*/
 		bool Insert( const std::string& attrName, ExprTree* expr);   // (ignores cache)
 		bool InsertLiteral(const std::string& attrName, Literal* lit); // (ignores cache)
+		// the same, for a name that is already interned
+		bool Insert( const AttrName& attrName, ExprTree* expr);
+		bool InsertLiteral(const AttrName& attrName, Literal* lit);
 		/*
 			Swap() is just like Insert() except it returns the old exprtree rather than
 			deleting it.  If there was no old exprtree, the old_expr is set to nullptr
@@ -113,6 +116,9 @@ class ClassAd : public ExprTree
 		// insert through cache if cache is enabled, otherwise just parse and insert
 		// parsing of the rhs expression is done use old ClassAds syntax
 		bool InsertViaCache(const std::string& attrName, const std::string & rhs, bool lazy=false);
+		// insert tree, which was already parsed from rhs, through the cache if the
+		// cache is enabled.  the ad (or the cache) takes ownership of the tree.
+		bool InsertViaCache(const std::string& attrName, const std::string & rhs, ExprTree * tree);
 
 		/** Insert an attribute/value into the ClassAd
 		 *  @param str A string of the form "Attribute = Value"
@@ -844,6 +850,7 @@ class ClassAd : public ExprTree
 		friend 	class AttributeReference;
 		friend 	class ExprTree;
 		friend 	class EvalState;
+		friend 	class CompiledExpr;
 
 
 		bool _GetExternalReferences( const ExprTree *, const ClassAd *, 
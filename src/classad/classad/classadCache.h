@@ -21,24 +21,47 @@
 
 #include "classad/exprTree.h"
 #include <string>
+#include <atomic>
+#include <stdint.h>
 
 namespace classad {
 
+class CompiledExpr;
+
 class CacheEntry
 {
 public: 
-	CacheEntry() : pData(NULL) {}
-	CacheEntry(const std::string & szNameIn, const std::string & szValueIn, ExprTree * pDataIn)
-		: szName(szNameIn)
-		, szValue(szValueIn)
-		, pData(pDataIn)
-	{}
+	CacheEntry(const std::string & szNameIn, const std::string & szValueIn, ExprTree * pDataIn);
 
 	virtual ~CacheEntry();
 
+	// returns the compiled form of pData, compiling it on first use.
+	// returns NULL if pData is not worth compiling.
+	const CompiledExpr * program();
+
+	// sets pData, once a lazy entry has been parsed.  returns the tree
+	// to use, which is another thread's if that one set it first.
+	ExprTree * setData(ExprTree * pDataIn);
+
 	std::string szName;    // string space the names.
 	std::string szValue;   // reference back for cleanup
-	ExprTree * pData;
+	// a lazy entry is parsed the first time it is used, which may be
+	// on a query thread, hence atomic.
+	std::atomic<ExprTree *> pData;
+
+private:
+	friend class CachedExprEnvelope;
+
+	// envelopes that hold this entry, and what each of them would
+	// cost if it had its own copy of the tree (the size of the text
+	// until a lazy entry is parsed).  used for the savings counters.
+	std::atomic<long> nRefs;
+	std::atomic<size_t> nBytes;
+
+	// shared by every ad that uses this entry, which may be evaluated
+	// from several matchmaking threads at once, hence atomic.
+	std::atomic<CompiledExpr *> pProgram;
+	std::atomic<bool> bProgramTried;
 };
 
 typedef classad_weak_ptr< CacheEntry > pCacheEntry;
@@ -53,7 +76,7 @@ typedef classad_shared_ptr< CacheEntry > pCacheData;
 class CachedExprEnvelope : public ExprTree
 {
 public:
-	virtual ~CachedExprEnvelope() {} // nothing to do counted pointer and cache entry do all of the work.
+	virtual ~CachedExprEnvelope();
 
 	/// node type
 	virtual NodeKind GetKind (void) const { return EXPR_ENVELOPE; }
@@ -64,6 +87,15 @@ public:
 	 */
 	static ExprTree * cache (const std::string & pName, ExprTree * pTree, const std::string & szValue );
 	static ExprTree * cache_lazy (const std::string & pName, const std::string & szValue );
+
+	/**
+	 * cache () - for a tree that was not parsed from text, such as one
+	 * built by InsertAttr().  The tree is unparsed, and shared with every
+	 * other tree with the same name and text, however those were made.
+	 * (Trees received in binary form are cached by the binary parser,
+	 * keyed on their encoding instead.)
+	 */
+	static ExprTree * cache (const std::string & pName, ExprTree * pTree );
 	static bool cacheable(ExprTree * tree) {
 		if ( ! tree) return false;
 		NodeKind nk = tree->GetKind();
@@ -97,6 +129,9 @@ protected:
 	
 	virtual void _SetParentScope( const ClassAd* parent) { parentScope = parent; }
 	CachedExprEnvelope() : parentScope(NULL) {};
+
+	// holds the letter, and counts the envelope in the savings counters.
+	void attach(pCacheData && letter);
 	
 	/**
 	 * SameAs() - determines if two elements are the same.
@@ -118,6 +153,17 @@ protected:
 	
 };
 
+struct ExprCacheStats {
+	size_t entries;			// distinct expressions in the cache now
+	size_t references;		// ad attributes that use them
+	size_t bytes;			// held by the expressions in the cache
+	size_t bytes_saved;		// that ads would hold without the cache
+	uint64_t unparsed;		// trees that were unparsed to be cached
+};
+
+// The counts for the whole process.  unparsed is since the process started.
+void ClassAdGetExprCacheStats( ExprCacheStats &stats );
+
 } // namespace classad
 
 #endif 
@@ -29,7 +29,11 @@
 #include "classad/xmlSink.h"
 #include "classad/jsonSource.h"
 #include "classad/jsonSink.h"
+#include "classad/binaryCodec.h"
 #include "classad/matchClassad.h"
+#include "classad/compiledExpr.h"
+#include "classad/batchEval.h"
+#include "classad/regexCache.h"
 #include "classad/collection.h"
 #include "classad/collectionBase.h"
 #include "classad/query.h"
@@ -19,9 +19,11 @@
 
 
 #include "classad/exprTree.h"
+#include "classad/attrName.h"
 #include <vector>
 #include <algorithm>
 #include <string>
+#include <string_view>
 #include <string.h>
 
 namespace classad {
@@ -30,7 +32,7 @@ class ExprTree;
 
 // ClassAdFlatMap
 //
-// This is the data structure that holds the map from std::string's to 
+// This is the data structure that holds the map from attribute names to 
 // ExprTree*'s.  
 //
 // Requirements:  We need to support hundreds of thousands of instances of
@@ -42,35 +44,46 @@ class ExprTree;
 // much it is likely to grow, so we can perform a single allocation for the
 // entire map.
 //
-// Therefore, we store the map as a std::vector of pairs of std::string and
-// ExprTree *.  To speed lookup, we sort the strings, first by size (as that's
-// fast to lookup), and then lexigraphically, insensitive to case.  If the
-// sender and receiver have the same ordering function, the pairs will arrive
-// in order, so the reciever will not need to shuffle them around in memory,
-// further accelerating the process of injestion.
+// Therefore, we store the map as a std::vector of pairs of AttrName and
+// ExprTree *.  The names are interned (see attrName.h), so an entry is 16
+// bytes no matter how long the name is, and the few hundred distinct names
+// that a schedd's hundreds of thousands of job ads share are stored once.
+// The pairs are sorted by the key of the name, which is the same for all
+// spellings of a name that differ only in case, so finding a name is a
+// binary search comparing integers.  A string that has never been interned
+// can't be the name of any attribute, so looking it up stops at the hash
+// of the string.  (Names that came after the table of names filled up are
+// kept outside of it; they sort after all the others, and are found by
+// comparing them with the string, without making an AttrName of it.)
+// Names in the list from condor_attributes.h are interned when a daemon
+// starts, so if the sender and receiver of an ad both did
+// that, the pairs will arrive in order, so the reciever will not need to
+// shuffle them around in memory, further accelerating the process of
+// injestion.
+//
+// Iterating goes in order of the keys, which is not the order the names
+// would sort in, and is not the same in every process.  Code that
+// prints the attributes of an ad should sort them (see ClassAdFlatMapOrder).
 //
 // Downsides: erasing or emplacing invaliate iterators, so it is UB (i.e.
 // a crash) to insert or erase while iterating.
 
 
-// The ordering function
+// The ordering function.  Pairs and AttrNames are ordered by key, strings
+// first by size (as that's fast to lookup), and then lexigraphically,
+// insensitive to case.
 struct ClassAdFlatMapOrder {
 	ClassAdFlatMapOrder()  = default;
 
-	bool operator()(const std::pair<std::string, ExprTree *> &lhs, const std::string &rhs) noexcept {
-		if (lhs.first.size() < rhs.size()) return true;
-		if (lhs.first.size() > rhs.size()) return false;
-		return strcasecmp(lhs.first.c_str(), rhs.c_str()) < 0;	
+	bool operator()(const std::pair<AttrName, ExprTree *> &lhs, const AttrName &rhs) const noexcept {
+		return lhs.first.KeyBefore(rhs);
 	}
 
-	bool operator()(const std::pair<std::string, ExprTree *> &lhs, const char *rhs) noexcept {
-		size_t len = strlen(rhs);
-		if (lhs.first.size() < len) return true;
-		if (lhs.first.size() > len) return false;
-		return strcasecmp(lhs.first.c_str(), rhs) < 0;	
+	bool operator()(const std::pair<AttrName, ExprTree *> &lhs, const std::pair<AttrName, ExprTree *> &rhs) const noexcept {
+		return lhs.first.KeyBefore(rhs.first);
 	}
 
-	bool operator()(const std::string &lhs, const std::string &rhs) noexcept {
+	bool operator()(const std::string &lhs, const std::string &rhs) const noexcept {
 		if (lhs.size() < rhs.size()) return true;
 		if (lhs.size() > rhs.size()) return false;
 		return strcasecmp(lhs.c_str(), rhs.c_str()) < 0;	
@@ -78,16 +91,8 @@ struct ClassAdFlatMapOrder {
 };
 
 // note this needs to be inline for ODR reasons
-inline bool ClassAdFlatMapEqual(const std::pair<std::string, ExprTree *>&lhs, const std::string &rhs) {
-	// Length is stored inline in std::string, so check it first: it lets us
-	// reject a mismatch (e.g. when lower_bound overshot to a longer name)
-	// without the strcasecmp reading both character buffers, which for names
-	// longer than the SSO limit means chasing a heap pointer.
-	return lhs.first.size() == rhs.size() && 0 == strcasecmp(lhs.first.c_str(), rhs.c_str());
-}
-
-inline bool ClassAdFlatMapEqual(const std::pair<std::string, ExprTree *>&lhs, const char *rhs) {
-	return 0 == strcasecmp(lhs.first.c_str(), rhs);
+inline bool ClassAdFlatMapEqual(const std::pair<AttrName, ExprTree *>&lhs, const AttrName &rhs) {
+	return lhs.first.SameKey(rhs);
 }
 
 
@@ -95,7 +100,7 @@ class ClassAdFlatMap {
 	public:
 		// Rule of zero for ctors/dtors/assignment/move
 	
-		using keyValue = std::pair<std::string, ExprTree *>;
+		using keyValue = std::pair<AttrName, ExprTree *>;
 		using container = std::vector<keyValue>;
 		using iterator = container::iterator;
 		using const_iterator = container::const_iterator;
@@ -119,9 +124,8 @@ class ClassAdFlatMap {
 			_theVector.clear();
 		}
 
-		template <typename StringLike>
-		iterator find(const StringLike &key) {
-			iterator lb = std::lower_bound(begin(), end(), key, ClassAdFlatMapOrder{});
+		iterator find(const AttrName &key) {
+			iterator lb = lower_bound(key);
 			if (lb != end() && ClassAdFlatMapEqual(*lb, key)) {
 				return lb;
 			} else  {
@@ -129,9 +133,8 @@ class ClassAdFlatMap {
 			}
 		}
 
-		template <typename StringLike>
-		const_iterator find(const StringLike &key) const {
-			const_iterator lb = std::lower_bound(begin(), end(), key, ClassAdFlatMapOrder{});
+		const_iterator find(const AttrName &key) const {
+			const_iterator lb = lower_bound(key);
 			if (lb != end() && ClassAdFlatMapEqual(*lb, key)) {
 				return lb;
 			} else  {
@@ -139,14 +142,36 @@ class ClassAdFlatMap {
 			}
 		}
 
+		template <typename StringLike>
+		iterator find(const StringLike &key) {
+			return begin() + (static_cast<const ClassAdFlatMap *>(this)->find(key) - _theVector.cbegin());
+		}
+
+		template <typename StringLike>
+		const_iterator find(const StringLike &key) const {
+			std::string_view str(key);
+			AttrName name;
+			if (AttrName::Find(str.data(), str.size(), name)) {
+				return find(name);
+			}
+			if ( ! AttrName::TableFull()) {
+				return end();
+			}
+			return findNotInterned(str.data(), str.size());
+		}
+
 		// This is the hack for compat with clients who expect the hash interface
 		// Ideally should deprecate this in the future
 		ExprTree *&  operator[](const std::string &key) {
-			iterator lb = std::lower_bound(begin(), end(), key, ClassAdFlatMapOrder{});
-			if (lb != end() && ClassAdFlatMapEqual(*lb, key)) {
+			return (*this)[AttrName(key)];
+		}
+
+		ExprTree *&  operator[](const AttrName &name) {
+			iterator lb = lower_bound(name);
+			if (lb != end() && ClassAdFlatMapEqual(*lb, name)) {
 				return lb->second;
 			} else {
-				return _theVector.insert(lb, std::make_pair(key, nullptr))->second;
+				return _theVector.insert(lb, std::make_pair(name, nullptr))->second;
 			}
 		}
 
@@ -168,17 +193,43 @@ class ClassAdFlatMap {
 
 		template <typename StringLike> 
 		std::pair<iterator, bool> emplace(const StringLike &key, ExprTree *value) {
-			iterator lb = std::lower_bound(begin(), end(), key, ClassAdFlatMapOrder{});
+			AttrName name(key);
+			iterator lb = lower_bound(name);
 
-			if (lb != end() && ClassAdFlatMapEqual(*lb, key)) {
+			if (lb != end() && ClassAdFlatMapEqual(*lb, name)) {
 				return std::make_pair(lb, false);
 			} else {
-				iterator newit = _theVector.insert(lb, std::make_pair(key, value));
+				iterator newit = _theVector.insert(lb, std::make_pair(name, value));
 				return std::make_pair(newit, true);
 			}
 		}
 
 	private:
+		iterator lower_bound(const AttrName &key) {
+			// ads usually arrive in order, check the end first
+			if (_theVector.empty() || _theVector.back().first.Key() < key.Key()) {
+				return end();
+			}
+			return std::lower_bound(begin(), end(), key, ClassAdFlatMapOrder{});
+		}
+
+		const_iterator lower_bound(const AttrName &key) const {
+			return std::lower_bound(begin(), end(), key, ClassAdFlatMapOrder{});
+		}
+
+		// Names kept outside of the table of names sort last.  Compare them
+		// with the string, so that looking up a name no ad has allocates nothing.
+		const_iterator findNotInterned(const char *key, size_t len) const {
+			uint32_t hash = AttrName::HashName(key, len);
+			const_iterator it = std::partition_point(begin(), end(), [&](const keyValue &kv) {
+				return kv.first.Interned() || kv.first.CompareNotInterned(key, len, hash) < 0;
+			});
+			if (it != end() && it->first.CompareNotInterned(key, len, hash) == 0) {
+				return it;
+			}
+			return end();
+		}
+
 		container _theVector;
 };
 }
@@ -0,0 +1,148 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2024, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+
+#ifndef __CLASSAD_COMPILED_EXPR_H__
+#define __CLASSAD_COMPILED_EXPR_H__
+
+#include <vector>
+#include <string>
+#include "classad/exprTree.h"
+
+namespace classad {
+
+// Should expressions that are shared through the expression cache (the
+// letters of CachedExprEnvelopes) be lowered to a CompiledExpr the first
+// time they are evaluated and run by the flat interpreter after that.
+// The default is true.
+void ClassAdSetCompiledEvaluation(bool do_compile);
+bool ClassAdGetCompiledEvaluation();
+
+/** A flat, stack-based program lowered from an ExprTree.
+ *
+ *  The operator skeleton of the tree (literals, unary, binary and
+ *  ternary operators, parentheses) is compiled into a linear sequence
+ *  of instructions, with the short-circuit operators (&&, ||, ?: and
+ *  the ternary) turned into forward jumps. Everything else - attribute
+ *  references, function calls, lists and nested ads - is kept as a
+ *  pointer to the original node and evaluated by the tree walker, so
+ *  scoping (MY., TARGET., alternateScope), circular reference detection
+ *  and undefined/error propagation are exactly those of
+ *  ExprTree::Evaluate.  The evaluation step budget and the recursion
+ *  depth limit are accounted for per node just as the tree walker does.
+ *
+ *  References of the form scope.attr (TARGET.Memory, MY.Cpus) are the
+ *  exception: the program resolves each distinct scope at most once per
+ *  evaluation and looks the attribute up directly in the resolved ad.
+ *  Since evaluation cannot modify an ad, this gives the same result as
+ *  resolving the scope every time; only the step budget is charged less.
+ *
+ *  A CompiledExpr borrows the nodes of the tree it was compiled from;
+ *  the tree must outlive the program and must not be modified.
+ */
+class CompiledExpr
+{
+	public:
+		/** Compile an expression.
+		 *  @param tree The expression to compile
+		 *  @return A new program, or NULL if the expression has no
+		 *      operator skeleton worth compiling (a bare literal,
+		 *      attribute reference or function call, for instance).
+		 */
+		static CompiledExpr *Compile( const ExprTree *tree );
+
+		~CompiledExpr( ) {}
+
+		/** Evaluate the program.  Same contract as ExprTree::Evaluate()
+		 *  on the tree the program was compiled from.
+		 *  @param state The current state
+		 *  @param val   The result of the evaluation
+		 *  @return true on success, false on failure
+		 */
+		bool Evaluate( EvalState &state, Value &val ) const;
+
+		/// The expression this program was compiled from.
+		const ExprTree *GetTree( ) const { return tree; }
+
+		/// Number of instructions in the program.
+		size_t size( ) const { return code.size(); }
+
+	private:
+		enum OpCode {
+			PUSH_CONST,		// push consts[arg]
+			EVAL_NODE,		// push result of node->Evaluate()
+			UNARY_OP,		// replace top of stack with op(top)
+			BINARY_OP,		// pop two, push op(a,b)
+			TERNARY_OP,		// pop three, push op(a,b,c)
+			SHORT_CIRCUIT,	// if op can be decided from top, replace top and goto arg
+			TERNARY_SELECT,	// pick a ternary arm from top: goto arg (else), arg2 (both)
+			JUMP,			// goto arg
+			SCOPED_ATTR		// push value of refs[arg2], scope cached in slot arg
+		};
+
+		// A scope.attr reference. scope is the simple reference (TARGET,
+		// MY, .RIGHT...) that yields the ad in which to look up attr.
+		struct ScopedRef {
+			const ExprTree *node;
+			const ExprTree *scope;
+			std::string attr;
+		};
+
+		// resolved scopes, valid for a single evaluation
+		struct ScopeSlot {
+			const ClassAd *curAd;
+			const ClassAd *ad;
+		};
+		static const int MAX_SCOPE_SLOTS = 8;
+
+		struct Instr {
+			OpCode code;
+			Operation::OpKind op;
+			int arg;
+			int arg2;
+			// number of Operation nodes enclosing this one in the tree,
+			// i.e. how much the tree walker would have taken off of
+			// EvalState::depth_remaining when it got here.
+			int depth;
+			// number of tree nodes whose Evaluate() begins here.
+			int steps;
+			const ExprTree *node;
+		};
+
+		friend class CompiledExprBuilder;
+
+		CompiledExpr( const ExprTree *t )
+			: tree(t), max_stack(0), max_depth(0), num_scopes(0) {}
+		CompiledExpr( const CompiledExpr & );
+		CompiledExpr &operator=( const CompiledExpr & );
+
+		bool EvaluateScopedAttr( EvalState &, const ScopedRef &, ScopeSlot &, Value & ) const;
+
+		const ExprTree		*tree;
+		std::vector<Instr>	code;
+		std::vector<Value>	consts;
+		std::vector<ScopedRef>	refs;
+		int					max_stack;
+		int					max_depth;
+		int					num_scopes;
+};
+
+} // classad
+
+#endif//__CLASSAD_COMPILED_EXPR_H__
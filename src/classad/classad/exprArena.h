@@ -0,0 +1,138 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2024, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+
+#ifndef __CLASSAD_EXPR_ARENA_H__
+#define __CLASSAD_EXPR_ARENA_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <utility>
+
+namespace classad {
+
+struct ExprArenaBlock;
+
+/** A bump allocator for expression nodes.
+ *
+ *  While an ExprArenaScope naming an arena is active in a thread, the
+ *  ExprTree factories (Literal::Make*, Operation::MakeOperation,
+ *  AttributeReference::MakeAttributeReference, FunctionCall::MakeFunctionCall
+ *  and ExprList::MakeExprList) carve the nodes they make out of the
+ *  arena's current block rather than calling new for each one.  The
+ *  parser makes all of its nodes with those factories, so an ad or a whole
+ *  batch of ads parsed inside the scope ends up packed into a few blocks.
+ *
+ *  Ownership doesn't change: an arena node is deleted like any other
+ *  node, by whatever owns the tree.  Each block counts the nodes still
+ *  living in it, and goes back to the heap when the last one is deleted,
+ *  so the ads of a batch are freed a block at a time as they are deleted,
+ *  and a node that outlives the rest of its batch keeps only its own
+ *  block.  The arena object itself can go away as soon as the parsing
+ *  is done.
+ *
+ *  An arena is for use by one thread at a time.  Nodes made from it can
+ *  be deleted by any thread.
+ */
+class ExprArena
+{
+	public:
+		ExprArena() : block(nullptr), next(nullptr), end(nullptr), blockNodes(0) {}
+		~ExprArena();
+
+		ExprArena( const ExprArena & ) = delete;
+		ExprArena &operator=( const ExprArena & ) = delete;
+
+		/// Memory for a node of the given size, taken from the current block.
+		void *Allocate( size_t size );
+
+		/// Give back a node's memory; frees its block if it was the last node.
+		static void Release( void *node );
+
+		/// The arena of the innermost active ExprArenaScope in this thread, if any.
+		static ExprArena *Current();
+
+		/// Blocks are this size, and aligned to it.  Much bigger and the
+		/// aligned allocation is mapped, at twice the size, rather than
+		/// carved out of the heap.
+		static const size_t ARENA_BLOCK_SIZE = 16 * 1024;
+
+	private:
+		void NewBlock();
+		void LeaveBlock();
+
+		ExprArenaBlock *block;
+		char *next;
+		char *end;
+		size_t blockNodes;	// allocated from the current block
+};
+
+/** Makes the factories in this thread allocate from an arena until the
+ *  scope ends.  Scopes nest; passing NULL makes them use the heap again,
+ *  which is how code that keeps what it parses for a long time (like the
+ *  expression cache) keeps it out of the caller's arena.
+ */
+class ExprArenaScope
+{
+	public:
+		explicit ExprArenaScope( ExprArena *arena );
+		~ExprArenaScope();
+
+		ExprArenaScope( const ExprArenaScope & ) = delete;
+		ExprArenaScope &operator=( const ExprArenaScope & ) = delete;
+
+	private:
+		ExprArena *previous;
+};
+
+/** A node of type T that lives in an arena.  It is a T in every way
+ *  except that deleting it gives its memory back to its block.
+ */
+template <class T>
+class ArenaNode final : public T
+{
+	public:
+		template <typename... Args>
+		explicit ArenaNode( Args&&... args ) : T( std::forward<Args>(args)... ) {}
+
+		static void *operator new( size_t size, ExprArena &arena ) { return arena.Allocate( size ); }
+		static void operator delete( void *node, ExprArena & ) { ExprArena::Release( node ); }
+		static void operator delete( void *node ) { ExprArena::Release( node ); }
+};
+
+struct ExprArenaStats {
+	uint64_t nodes;			// nodes allocated from arenas
+	uint64_t blocks;		// blocks allocated
+	size_t blocks_in_use;	// blocks not yet freed
+};
+
+// Counts since the process started.
+void ClassAdGetExprArenaStats( ExprArenaStats &stats );
+
+} // classad
+
+/** Make a new expression node of type T, from the current arena if there
+ *  is one.  For use by the factories, where T's constructor is accessible.
+ */
+#define CLASSAD_NEW_EXPR( T, ... ) \
+	( classad::ExprArena::Current() \
+		? static_cast<T *>( new ( *classad::ExprArena::Current() ) classad::ArenaNode<T>( __VA_ARGS__ ) ) \
+		: new T( __VA_ARGS__ ) )
+
+#endif//__CLASSAD_EXPR_ARENA_H__
@@ -250,6 +250,7 @@ class ExprTree
 		friend class ClassAd;
 		friend class CachedExprEnvelope;
 		friend class Literal;
+		friend class CompiledExpr;
 
 		/// Copy constructor
         ExprTree(const ExprTree &tree);
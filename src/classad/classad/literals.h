@@ -25,6 +25,7 @@
 #include <limits>
 #include "exprTree.h"
 #include "classad/lexer.h"
+#include "classad/exprArena.h"
 
 namespace classad {
 
@@ -422,86 +423,86 @@ SLIST_VALUE	= 1<<10,
 
 inline BooleanLiteral* 
 Literal::MakeBool(bool val) {
-	return new BooleanLiteral(val);
+	return CLASSAD_NEW_EXPR(BooleanLiteral, val);
 }
 
 inline IntegerLiteral* 
 Literal::MakeInteger(int64_t val) {
-	return new IntegerLiteral(val);
+	return CLASSAD_NEW_EXPR(IntegerLiteral, val);
 }
 
 inline RealLiteral* 
 Literal::MakeReal(double real) {
-	return new RealLiteral(real);
+	return CLASSAD_NEW_EXPR(RealLiteral, real);
 }
 inline StringLiteral* 
 Literal::MakeString(const std::string & str) {
-	return new StringLiteral(str);
+	return CLASSAD_NEW_EXPR(StringLiteral, str);
 }
 inline StringLiteral* 
 Literal::MakeString(const char* str) {
-	return new StringLiteral(str ? str : "");
+	return CLASSAD_NEW_EXPR(StringLiteral, str ? str : "");
 }
 
 inline StringLiteral* 
 Literal::MakeString(const char* str, size_t cch) {
 	if (str == nullptr) {
-		return new StringLiteral("");
+		return CLASSAD_NEW_EXPR(StringLiteral, "");
 	}
-	return new StringLiteral(std::string(str, cch));
+	return CLASSAD_NEW_EXPR(StringLiteral, std::string(str, cch));
 }
 inline ErrorLiteral* 
 Literal::MakeError() {
-	return new ErrorLiteral();
+	return CLASSAD_NEW_EXPR(ErrorLiteral);
 }
 inline UndefinedLiteral *
 Literal::MakeUndefined() {
-	return new UndefinedLiteral();
+	return CLASSAD_NEW_EXPR(UndefinedLiteral);
 }
 
 inline Literal*
 Literal::MakeLiteral(const Value &v) {
 	switch (v.valueType) {
 		case Value::UNDEFINED_VALUE:
-			return new UndefinedLiteral;
+			return CLASSAD_NEW_EXPR(UndefinedLiteral);
 			break;
 		case Value::ERROR_VALUE:
-			return new ErrorLiteral;
+			return CLASSAD_NEW_EXPR(ErrorLiteral);
 			break;
 		case Value::STRING_VALUE: {
 			std::string s;
 			std::ignore = v.IsStringValue(s);
-			return new StringLiteral(s);
+			return CLASSAD_NEW_EXPR(StringLiteral, s);
 			break;
 		}
 		case Value::REAL_VALUE: {
 			double d = 0;
 			std::ignore = v.IsRealValue(d);
-			return new RealLiteral(d);
+			return CLASSAD_NEW_EXPR(RealLiteral, d);
 			break;
 		}
 		case Value::INTEGER_VALUE: {
 			int64_t i = 0;
 			std::ignore = v.IsIntegerValue(i);
-			return new IntegerLiteral(i);
+			return CLASSAD_NEW_EXPR(IntegerLiteral, i);
 			break;
 		}
 		case Value::BOOLEAN_VALUE: {
 			bool b = true;
 			std::ignore = v.IsBooleanValue(b);
-			return new BooleanLiteral(b);
+			return CLASSAD_NEW_EXPR(BooleanLiteral, b);
 			break;
 		}
 		case Value::ABSOLUTE_TIME_VALUE: {
 			classad::abstime_t atime {};
 			std::ignore = v.IsAbsoluteTimeValue(atime);
-			return new AbstimeLiteral(atime);
+			return CLASSAD_NEW_EXPR(AbstimeLiteral, atime);
 			break;
 		}
 		case Value::RELATIVE_TIME_VALUE: {
-			time_t seconds = 0;
+			double seconds = 0;
 			std::ignore = v.IsRelativeTimeValue(seconds);
-			return new ReltimeLiteral(double(seconds));
+			return CLASSAD_NEW_EXPR(ReltimeLiteral, seconds);
 			break;
 		}
 		default:
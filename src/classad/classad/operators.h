@@ -228,6 +228,8 @@ class Operation : public ExprTree
 		friend class OperationParens;
 		friend class Operation2;
 		friend class Operation3;
+		friend class CompiledExpr;
+		friend class BatchExpr;
 };
 
 
@@ -0,0 +1,61 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2024, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+
+#ifndef __CLASSAD_REGEX_CACHE_H__
+#define __CLASSAD_REGEX_CACHE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <memory>
+
+// pcre2_code for a code unit width of 8, without pulling in pcre2.h
+struct pcre2_real_code_8;
+
+namespace classad {
+
+// The regexp() family of ClassAd functions keeps the patterns it compiles
+// in a cache of the most recently used max_patterns patterns, so that an
+// expression evaluated over and over doesn't compile its pattern every
+// time.  A size of 0 turns the cache off.  The default is 256.
+void ClassAdSetRegexCacheSize(size_t max_patterns);
+size_t ClassAdGetRegexCacheSize();
+
+struct RegexCacheStats {
+	uint64_t hits;		// lookups that found a compiled pattern
+	uint64_t misses;	// lookups that had to compile the pattern
+	size_t entries;		// patterns in the cache now
+};
+
+// Counts since the process started.
+void ClassAdGetRegexCacheStats(RegexCacheStats &stats);
+
+/** Compile a pattern, or get it from the cache.  Cached patterns are also
+ *  JIT compiled when the PCRE2 library supports it.  The result can be
+ *  shared between threads, and stays valid after it is evicted from the
+ *  cache.
+ *  @param pattern The regular expression
+ *  @param options PCRE2 compile options
+ *  @return The compiled pattern, or NULL if the pattern is not valid
+ */
+std::shared_ptr<pcre2_real_code_8> CompileRegex(const char *pattern, uint32_t options);
+
+} // classad
+
+#endif//__CLASSAD_REGEX_CACHE_H__
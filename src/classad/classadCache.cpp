@@ -18,14 +18,86 @@
 
 #include "classad/common.h"
 #include "classad/classadCache.h"
+#include "classad/compiledExpr.h"
 #include "classad/sink.h"
 #include "classad/source.h"
 #include <assert.h>
 #include <stdio.h>
 #include <list>
+#include <algorithm>
 
 using namespace classad;
 
+// Gauges for the savings counters, kept as entries come and go and
+// envelopes are made and deleted, which can happen in several threads.
+static std::atomic<long> exprCacheEntries(0);
+static std::atomic<long> exprCacheRefs(0);
+static std::atomic<long> exprCacheBytes(0);
+static std::atomic<long> exprCacheBytesSaved(0);
+
+// what a string holds on the heap, assuming short ones fit in the string.
+static size_t StringBytes(size_t len)
+{
+	return (len < sizeof(std::string)) ? 0 : len + 1;
+}
+
+// Roughly the memory a tree takes up: its nodes and what they point to,
+// less the malloc overhead.
+static size_t ExprTreeBytes(const ExprTree * tree)
+{
+	if ( ! tree) return 0;
+
+	switch (tree->GetKind()) {
+	case ExprTree::ATTRREF_NODE: {
+		ExprTree * expr = NULL;
+		std::string attr;
+		bool absolute = false;
+		((const AttributeReference *)tree)->GetComponents(expr, attr, absolute);
+		return sizeof(AttributeReference) + StringBytes(attr.size()) + ExprTreeBytes(expr);
+	}
+	case ExprTree::OP_NODE: {
+		Operation::OpKind op;
+		ExprTree *t1 = NULL, *t2 = NULL, *t3 = NULL;
+		((const Operation *)tree)->GetComponents(op, t1, t2, t3);
+		size_t bytes = t3 ? sizeof(Operation3) : (t2 ? sizeof(Operation2) : sizeof(Operation1));
+		return bytes + ExprTreeBytes(t1) + ExprTreeBytes(t2) + ExprTreeBytes(t3);
+	}
+	case ExprTree::FN_CALL_NODE: {
+		std::string name;
+		std::vector<ExprTree*> args;
+		((const FunctionCall *)tree)->GetComponents(name, args);
+		size_t bytes = sizeof(FunctionCall) + StringBytes(name.size()) + args.size() * sizeof(ExprTree*);
+		for (const ExprTree * arg : args) { bytes += ExprTreeBytes(arg); }
+		return bytes;
+	}
+	case ExprTree::EXPR_LIST_NODE: {
+		std::vector<ExprTree*> items;
+		((const ExprList *)tree)->GetComponents(items);
+		size_t bytes = sizeof(ExprList) + items.size() * sizeof(ExprTree*);
+		for (const ExprTree * item : items) { bytes += ExprTreeBytes(item); }
+		return bytes;
+	}
+	case ExprTree::CLASSAD_NODE: {
+		size_t bytes = sizeof(ClassAd);
+		for (const auto & [name, expr] : *(const ClassAd *)tree) {
+			bytes += sizeof(name) + sizeof(expr) + StringBytes(name.size()) + ExprTreeBytes(expr);
+		}
+		return bytes;
+	}
+	case ExprTree::EXPR_ENVELOPE:		return sizeof(CachedExprEnvelope);
+	case ExprTree::ERROR_LITERAL:		return sizeof(ErrorLiteral);
+	case ExprTree::UNDEFINED_LITERAL:	return sizeof(UndefinedLiteral);
+	case ExprTree::BOOLEAN_LITERAL:		return sizeof(BooleanLiteral);
+	case ExprTree::INTEGER_LITERAL:		return sizeof(IntegerLiteral);
+	case ExprTree::REAL_LITERAL:		return sizeof(RealLiteral);
+	case ExprTree::RELTIME_LITERAL:		return sizeof(ReltimeLiteral);
+	case ExprTree::ABSTIME_LITERAL:		return sizeof(AbstimeLiteral);
+	case ExprTree::STRING_LITERAL:
+		return sizeof(StringLiteral) + StringBytes(((const StringLiteral *)tree)->getString().size());
+	}
+	return 0;
+}
+
 
 /**
  * ClassAdCache - is meant to be the storage container which is used to cache classads,
@@ -67,6 +139,8 @@ public:
 	
 	virtual ~ClassAdCache(){ m_destroyed = true; };
 
+	void count_unparse() { m_UnparseCount++; }
+
 	///< cache's a local attribute->ExpTree
 	pCacheData cache(const std::string & szName, const std::string & szValue , ExprTree * pVal)
 	{
@@ -316,36 +390,151 @@ static ClassAdCache * _cache = nullptr;
 //////////////////////////////////////////////////////////////////////////////
 //////////////////////////////////////////////////////////////////////////////
 
+CacheEntry::CacheEntry(const std::string & szNameIn, const std::string & szValueIn, ExprTree * pDataIn)
+	: szName(szNameIn)
+	, szValue(szValueIn)
+	, pData(pDataIn)
+	, nRefs(0)
+	, nBytes(pDataIn ? ExprTreeBytes(pDataIn) : szValueIn.size())
+	, pProgram(NULL)
+	, bProgramTried(false)
+{
+	exprCacheEntries++;
+	exprCacheBytes += nBytes;
+}
+
 CacheEntry::~CacheEntry()
 {
 	if (_cache) {
 		_cache->flush(szName, szValue);
 	}
-	delete pData;
+	exprCacheEntries--;
+	exprCacheBytes -= nBytes;
+	delete pProgram.load();
+	delete pData.load();
 	pData = NULL;
 }
 
+ExprTree * CacheEntry::setData(ExprTree * pDataIn)
+{
+	ExprTree * expected = NULL;
+	if ( ! pData.compare_exchange_strong(expected, pDataIn, std::memory_order_acq_rel)) {
+		// another thread parsed it first, use theirs.
+		delete pDataIn;
+		return expected;
+	}
+
+	// the text was standing in for the size of the tree until now
+	size_t bytes = ExprTreeBytes(pDataIn);
+	long delta = (long)bytes - (long)nBytes.exchange(bytes);
+	exprCacheBytes += delta;
+	long others = nRefs.load() - 1;
+	if (others > 0) { exprCacheBytesSaved += others * delta; }
+	return pDataIn;
+}
+
+const CompiledExpr * CacheEntry::program()
+{
+	if (bProgramTried.load(std::memory_order_acquire)) {
+		return pProgram.load(std::memory_order_acquire);
+	}
+	ExprTree * tree = pData.load(std::memory_order_acquire);
+	if ( ! tree) {
+		return NULL;
+	}
+
+	CompiledExpr * prog = CompiledExpr::Compile(tree);
+	CompiledExpr * expected = NULL;
+	if (prog && ! pProgram.compare_exchange_strong(expected, prog)) {
+		// another thread got there first, use theirs.
+		delete prog;
+		prog = expected;
+	}
+	bProgramTried.store(true, std::memory_order_release);
+	return prog;
+}
+
 
 ExprTree * CachedExprEnvelope::cache (const std::string & pName, ExprTree * pTree, const std::string & szValue)
 {
 	ExprTree * pRet = pTree;
 	if (cacheable(pTree)) {
+		if (ExprArena::Current()) {
+			// the tree may be in the caller's arena, and the cache keeps it
+			// for as long as any ad uses it, so keep a copy on the heap.
+			pTree = pTree->Copy();
+			delete pRet;
+		}
 		if ( ! _cache) { _cache = new ClassAdCache(); }
 		CachedExprEnvelope * pNewEnv = new CachedExprEnvelope();
-		pNewEnv->m_pLetter = _cache->cache(pName, szValue, pTree);
+		pNewEnv->attach(_cache->cache(pName, szValue, pTree));
 		pRet = pNewEnv;
 	}
 	return pRet;
 }
 
+ExprTree * CachedExprEnvelope::cache (const std::string & pName, ExprTree * pTree)
+{
+	if ( ! cacheable(pTree)) {
+		return pTree;
+	}
+
+	// the same text the parse-time callers key on, so that a tree built
+	// in code finds one that was parsed, and the other way around.
+	std::string szValue;
+	ClassAdUnParser unparser;
+	unparser.SetOldClassAd(true, true);
+	unparser.Unparse(szValue, pTree);
+	if ( ! cacheable(szValue)) {
+		return pTree;
+	}
+
+	if ( ! _cache) { _cache = new ClassAdCache(); }
+	_cache->count_unparse();
+	return cache(pName, pTree, szValue);
+}
+
 ExprTree * CachedExprEnvelope::cache_lazy (const std::string & pName, const std::string & szValue)
 {
 	if ( ! _cache) { _cache = new ClassAdCache(); }
 	CachedExprEnvelope *pEnv = new CachedExprEnvelope();
-	pEnv->m_pLetter = _cache->insert_lazy(pName, szValue);
+	pEnv->attach(_cache->insert_lazy(pName, szValue));
 	return pEnv;
 }
 
+CachedExprEnvelope::~CachedExprEnvelope()
+{
+	if (m_pLetter) {
+		exprCacheRefs--;
+		if (m_pLetter->nRefs.fetch_sub(1) > 1) {
+			exprCacheBytesSaved -= m_pLetter->nBytes;
+		}
+	}
+}
+
+void CachedExprEnvelope::attach(pCacheData && letter)
+{
+	m_pLetter = std::move(letter);
+	if (m_pLetter) {
+		exprCacheRefs++;
+		// every envelope after the first is a tree some ad didn't need
+		if (m_pLetter->nRefs.fetch_add(1) > 0) {
+			exprCacheBytesSaved += m_pLetter->nBytes;
+		}
+	}
+}
+
+void classad::ClassAdGetExprCacheStats( ExprCacheStats &stats )
+{
+	stats.entries = (size_t)std::max(0L, exprCacheEntries.load());
+	stats.references = (size_t)std::max(0L, exprCacheRefs.load());
+	stats.bytes = (size_t)std::max(0L, exprCacheBytes.load());
+	stats.bytes_saved = (size_t)std::max(0L, exprCacheBytesSaved.load());
+	unsigned long hits = 0, misses = 0, querys = 0, hitdels = 0, removals = 0, unparse = 0;
+	CachedExprEnvelope::_debug_get_counts(hits, misses, querys, hitdels, removals, unparse);
+	stats.unparsed = unparse;
+}
+
 bool CachedExprEnvelope::_debug_dump_keys(const std::string & szFile)
 {
   if ( ! _cache) return false;
@@ -378,7 +567,7 @@ CachedExprEnvelope * CachedExprEnvelope::check_hit(const std::string & szName, c
    if (cache_check)
    {
      pRet = new CachedExprEnvelope();
-     pRet->m_pLetter = cache_check;
+     pRet->attach(std::move(cache_check));
    }
 
    return pRet;
@@ -391,12 +580,16 @@ ExprTree * CachedExprEnvelope::get() const
 	
 	if (m_pLetter) {
 		CacheEntry * ptr = m_pLetter.get();
-		expr = ptr->pData;
+		expr = ptr->pData.load(std::memory_order_acquire);
 		if ( ! expr) {
+			// shared by many ads, keep it out of the caller's arena
+			ExprArenaScope arena_scope(nullptr);
 			ClassAdParser parser;
 			parser.SetOldClassAd(true);
 			expr = parser.ParseExpression(ptr->szValue);
-			ptr->pData = expr;
+			if (expr) {
+				expr = ptr->setData(expr);
+			}
 		}
 	}
 	
@@ -419,7 +612,7 @@ ExprTree * CachedExprEnvelope::Copy( ) const
 	CachedExprEnvelope * pRet = new CachedExprEnvelope();
 	
 	// duplicate as little data as possible.
-	pRet->m_pLetter = this->m_pLetter;
+	pRet->attach(pCacheData(this->m_pLetter));
 	
 	return ( pRet );
 }
@@ -434,8 +627,9 @@ bool CachedExprEnvelope::SameAs(const ExprTree* tree) const
 	}
 
 	if (tree->GetKind() != EXPR_ENVELOPE) {
-		if (m_pLetter && m_pLetter->pData) {
-			return m_pLetter->pData->SameAs(tree);
+		ExprTree * expr = m_pLetter ? m_pLetter->pData.load(std::memory_order_acquire) : NULL;
+		if (expr) {
+			return expr->SameAs(tree);
 		}
 		return false;
 	}
@@ -444,15 +638,22 @@ bool CachedExprEnvelope::SameAs(const ExprTree* tree) const
 	if ( ! m_pLetter || ! that->m_pLetter) return false;
 	if (m_pLetter == that->m_pLetter) return true;
 
-	return get()->SameAs(tree);
+	// entries keyed differently, as parsed and decoded trees are, can hold the same tree
+	ExprTree * expr = get();
+	ExprTree * other = that->get();
+	return expr && other && expr->SameAs(other);
 }
 
 
 bool CachedExprEnvelope::_Evaluate( EvalState& st, Value& v ) const
 {
 	ExprTree * tree = get();
-	if (tree) { return tree->Evaluate(st,v); }
-	return false;
+	if ( ! tree) { return false; }
+	if (ClassAdGetCompiledEvaluation()) {
+		const CompiledExpr * prog = m_pLetter->program();
+		if (prog) { return prog->Evaluate(st,v); }
+	}
+	return tree->Evaluate(st,v);
 }
 
 bool CachedExprEnvelope::_Evaluate( EvalState& st, Value& v, ExprTree*& t) const
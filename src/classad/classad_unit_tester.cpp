@@ -35,6 +35,7 @@
 #include "classad/classad_distribution.h"
 #include "classad/lexerSource.h"
 #include "classad/xmlSink.h"
+#include "classad/classadCache.h"
 #include <fstream>
 #include <iostream>
 #include <ctype.h>
@@ -99,6 +100,7 @@ static void test_parsing(const Parameters &parameters, Results &results);
 static void test_classad(const Parameters &parameters, Results &results);
 static void test_exprlist(const Parameters &parameters, Results &results);
 static void test_value(const Parameters &parameters, Results &results);
+static void test_operator(const Parameters &parameters, Results &results);
 static void test_collection(const Parameters &parameters, Results &results);
 static void test_utils(const Parameters &parameters, Results &results);
 static bool check_in_view(ClassAdCollection *collection, string view_name, string classad_name);
@@ -295,6 +297,7 @@ int main(
     if (parameters.check_all || parameters.check_match) {
     }
     if (parameters.check_all || parameters.check_operator) {
+        test_operator(parameters, results);
     }
     if (parameters.check_all || parameters.check_collection) {
         test_collection(parameters, results);
@@ -568,6 +571,318 @@ static void test_classad(const Parameters &, Results &results)
     TEST("Move to classad can lookup int", (i == 4));
 	move_to_classad.LookupInteger("a", i);
     TEST("Move to classad can lookup parent int", (i == 1));
+
+    /* ----- Test interned attribute names ----- */
+    AttrName name1("UnitTestInternedName");
+    AttrName name2(std::string("UnitTestInternedName"));
+    AttrName name3("unittestinternedname");
+    AttrName found;
+    TEST("Same spelling interns to the same id", name1.Id() == name2.Id());
+    TEST("Other case interns to another id", name1.Id() != name3.Id());
+    TEST("Other case has the same key", name1.Key() == name3.Key());
+    TEST("Interned spelling is kept", name3 == "unittestinternedname");
+    TEST("Hash ignores case", name1.Hash() == name3.Hash());
+    TEST("Find ignores case", AttrName::Find("UNITTESTINTERNEDNAME", found) && found.Key() == name1.Key());
+    TEST("Find does not intern", ! AttrName::Find("UnitTestNeverInternedName", found));
+    TEST("Default name is empty", AttrName().empty() && AttrName("").Id() == 0);
+
+    ClassAd names_ad;
+    names_ad.InsertAttr("UnitTestInternedName", 1);
+    names_ad.InsertAttr("unitTestOtherName", 2);
+    names_ad.InsertAttr("UNITTESTINTERNEDNAME", 3);
+    TEST("Insert of other case replaces", names_ad.size() == 2);
+    TEST("Lookup ignores case", names_ad.LookupInteger("unittestinternedname", i) && i == 3);
+    TEST("Lookup by AttrName", names_ad.Lookup(name3) != NULL);
+    TEST("Lookup of name never interned", names_ad.Lookup("UnitTestNeverInternedName") == NULL);
+    TEST("Lookup of name not in ad", names_ad.Lookup("UnitTestInternedName2") == NULL);
+    bool spelling_kept = false;
+    for (auto & [attr_name, attr_tree] : names_ad) {
+        if (attr_name.Key() == name1.Key()) {
+            spelling_kept = (attr_name == std::string("UnitTestInternedName"));
+        }
+    }
+    TEST("Ad keeps the spelling of the first insert", spelling_kept);
+
+    std::vector<std::pair<std::string, ExprTree *>> components;
+    names_ad.InsertAttr("b", 4);
+    names_ad.InsertAttr("A", 5);
+    names_ad.GetComponents(components);
+    TEST("GetComponents is sorted by length and name",
+        components.size() == 4 && components[0].first == "A" && components[1].first == "b" &&
+        components[2].first == "unitTestOtherName" && components[3].first == "UnitTestInternedName");
+
+    // Fill the table of names; the rest of the tests run with it full.
+    AttrNameStats name_stats;
+    ClassAdGetAttrNameStats(name_stats);
+    ClassAdSetAttrNameLimit(name_stats.names + 1);
+    AttrName last_in("UnitTestLastInternedName");
+    AttrName over1("UnitTestOverflowName");
+    AttrName over2("unittestoverflowname");
+    AttrName over3("UnitTestOtherOverflowName");
+    AttrName later_case("UNITTESTLASTINTERNEDNAME");
+    TEST("Name that fits is interned", last_in.Interned());
+    TEST("Name past the limit is not interned", ! over1.Interned() && ! over3.Interned());
+    TEST("Names past the limit keep their spelling", over1 == "UnitTestOverflowName" && over2 == "unittestoverflowname");
+    TEST("Names past the limit compare ignoring case", over1.SameKey(over2) && ! over1.SameKey(over3) && over1 != over2);
+    TEST("New spelling of a full table name gets the first", later_case.Interned() && later_case == last_in);
+    TEST("Find of a name past the limit", ! AttrName::Find("UnitTestNeverInternedName2", found) && AttrName::TableFull());
+    ClassAdSetAttrNameLimit(name_stats.names + 1000);
+    ClassAdGetAttrNameStats(name_stats);
+    TEST("Limit can't be raised once full", name_stats.limit == name_stats.names);
+    TEST("Names past the limit are counted", name_stats.not_interned >= 3);
+
+    ClassAd over_ad;
+    over_ad.InsertAttr("UnitTestOverflowName", 1);
+    over_ad.InsertAttr("UnitTestInternedName", 2);
+    over_ad.InsertAttr("UnitTestOtherOverflowName", 3);
+    over_ad.InsertAttr("UNITTESTOVERFLOWNAME", 4);
+    over_ad.InsertAttr("UnitTestThirdOverflowName", 5);
+    TEST("Insert of other case past the limit replaces", over_ad.size() == 4);
+    TEST("Lookup past the limit ignores case", over_ad.LookupInteger("unittestoverflowname", i) && i == 4);
+    TEST("Lookup of other name past the limit", over_ad.LookupInteger("UnitTestThirdOverflowName", i) && i == 5);
+    TEST("Lookup of missing name past the limit", over_ad.Lookup("UnitTestMissingOverflowName") == NULL);
+    TEST("Evaluate name past the limit", over_ad.EvaluateAttrInt("UnitTestOtherOverflowName", i) && i == 3);
+    TEST("Evaluate missing name past the limit", ! over_ad.EvaluateAttrInt("UnitTestMissingOverflowName", i));
+    ClassAd over_copy(over_ad);
+    over_ad.Delete("UnitTestOtherOverflowName");
+    TEST("Copy keeps names past the limit", over_copy.size() == 4 && over_copy.LookupInteger("unittestotheroverflowname", i) && i == 3);
+    TEST("Delete of name past the limit", over_ad.size() == 3 && over_ad.Lookup("UnitTestOtherOverflowName") == NULL);
+
+    /* ----- Test parsing into an arena ----- */
+    ExprArenaStats arena_before, arena_during, arena_after;
+    ClassAdGetExprArenaStats(arena_before);
+    ClassAd *arena_ad = new ClassAd;
+    ExprTree *arena_copy = nullptr;
+    {
+        ExprArena arena;
+        ExprArenaScope arena_scope(&arena);
+        parser.ParseClassAd("[ a = 1; b = a + 2.5; c = \"str\"; d = strcat(c, \"ing\"); e = { a, b }; f = b > 3 ? true : false ]", *arena_ad);
+        arena_copy = arena_ad->Lookup("b")->Copy();
+    }
+    ClassAdGetExprArenaStats(arena_during);
+    TEST("Parse into arena allocates nodes", arena_during.nodes > arena_before.nodes);
+    TEST("Parse into arena allocates a block", arena_during.blocks_in_use == arena_before.blocks_in_use + 1);
+    TEST("Arena ad evaluates", arena_ad->EvaluateAttrString("d", s) && s == "string");
+    TEST("Arena ad evaluates ops", arena_ad->EvaluateAttrBool("f", b) && b);
+    arena_ad->InsertAttr("a", 5);
+    arena_ad->Delete("c");
+    TEST("Arena ad can be changed", arena_ad->EvaluateAttrReal("b", r) && r == 7.5);
+    delete arena_ad;
+    ClassAdGetExprArenaStats(arena_after);
+    TEST("Deleting the arena ad frees its block", arena_after.blocks_in_use == arena_before.blocks_in_use);
+    TEST("Copy of an arena node is on the heap", arena_copy && arena_after.nodes == arena_during.nodes);
+    delete arena_copy;
+
+    /* ----- Test the binary encoding ----- */
+    ClassAd bin_in, bin_out;
+    parser.ParseClassAd("[ a = 1; b = a + 2.5 * -3; c = \"str\\\"ing\"; d = strcat(c, \"ing\"); e = { a, b, undefined, error };"
+        " f = b > 3 ? true : false; g = a ?: b; h = [ x = -7; y = .x ]; i = h.x; j = (a << 2) =?= 4;"
+        " k = absTime(\"2024-01-02T03:04:05-06:00\"); l = relTime(\"1+02:03:04.5\"); m = 1e300; n = b[0] ]", bin_in);
+    ClassAdBinaryNames send_names, recv_names;
+    ClassAdBinaryUnParser bin_unparser(&send_names);
+    ClassAdBinaryParser bin_parser(&recv_names);
+    std::string bin_buffer;
+    bin_unparser.Unparse(bin_buffer, bin_in);
+    size_t first_size = bin_buffer.size();
+    bin_unparser.Unparse(bin_buffer, bin_in);
+    TEST("Binary names are sent once per dictionary", bin_buffer.size() - first_size < first_size);
+    const char *bin_pos = bin_buffer.data();
+    const char *bin_end = bin_pos + bin_buffer.size();
+    TEST("Binary ad decodes", bin_parser.ParseClassAd(bin_pos, bin_end, bin_out));
+    TEST("Binary ad is the same", bin_in.SameAs(&bin_out));
+    bin_out.Clear();
+    TEST("Second binary ad decodes", bin_parser.ParseClassAd(bin_pos, bin_end, bin_out) && bin_pos == bin_end);
+    TEST("Second binary ad is the same", bin_in.SameAs(&bin_out));
+    TEST("Binary ad evaluates", bin_out.EvaluateAttrString("d", s) && s == "str\"inging");
+    TEST("Binary ad evaluates nested ads", bin_out.EvaluateAttrInt("i", i) && i == -7);
+
+    bool truncated_fails = true;
+    for (size_t len = 0; len < first_size; len++) {
+        ClassAd partial;
+        ClassAdBinaryParser partial_parser;
+        bin_pos = bin_buffer.data();
+        if (partial_parser.ParseClassAd(bin_pos, bin_pos + len, partial)) {
+            truncated_fails = false;
+        }
+    }
+    TEST("Truncated binary ads fail to decode", truncated_fails);
+    std::string bad_name("\x01\x05", 2);
+    ClassAdBinaryParser bad_parser;
+    bin_pos = bad_name.data();
+    TEST("Binary name not in the dictionary fails", ! bad_parser.ParseClassAd(bin_pos, bin_pos + bad_name.size(), bin_out));
+
+    /* ----- Test sharing built and decoded trees through the cache ----- */
+    int old_min_string = 0;
+    bool old_caching = ClassAdGetExpressionCaching(old_min_string);
+    ClassAdSetExpressionCaching(true, 16);
+    ExprCacheStats cache_before, cache_during, cache_after;
+    ClassAdGetExprCacheStats(cache_before);
+    {
+        std::string long_string = "a string long enough to be worth sharing";
+        ClassAd parsed_ad, built_ad, recv_ad;
+        parsed_ad.InsertViaCache("UnitTestShared", "\"" + long_string + "\"");
+        parsed_ad.InsertViaCache("UnitTestSharedExpr", "UnitTestShared =!= undefined && size(UnitTestShared) > 10");
+        built_ad.InsertAttr("UnitTestShared", long_string);
+        std::string cache_buffer, cache_buffer2;
+        ClassAdBinaryUnParser cache_unparser;
+        cache_unparser.Unparse(cache_buffer, parsed_ad);
+        // the names are in the dictionary now, so they are sent as references
+        cache_unparser.Unparse(cache_buffer2, parsed_ad);
+        ClassAdBinaryParser cache_parser;
+        ClassAd recv_ad2;
+        bin_pos = cache_buffer.data();
+        TEST("Binary ad decodes into the cache", cache_parser.ParseClassAd(bin_pos, bin_pos + cache_buffer.size(), recv_ad, true));
+        bin_pos = cache_buffer2.data();
+        TEST("Binary ad with names sent before decodes into the cache",
+            cache_parser.ParseClassAd(bin_pos, bin_pos + cache_buffer2.size(), recv_ad2, true));
+        ClassAdGetExprCacheStats(cache_during);
+        TEST("Built string is shared", built_ad.Lookup("UnitTestShared")->GetKind() == ExprTree::EXPR_ENVELOPE);
+        TEST("Parsed and built trees share entries, decoded trees share theirs", cache_during.entries - cache_before.entries == 4);
+        TEST("Every attribute references an entry", cache_during.references - cache_before.references == 7);
+        TEST("Only the built tree was unparsed", cache_during.unparsed - cache_before.unparsed == 1);
+        TEST("Sharing saves memory", cache_during.bytes_saved > cache_before.bytes_saved);
+        TEST("Shared string evaluates", recv_ad.EvaluateAttrString("UnitTestShared", s) && s == long_string);
+        TEST("Shared expression evaluates", recv_ad.EvaluateAttrBool("UnitTestSharedExpr", b) && b);
+        TEST("Expressions decoded twice are the same", recv_ad.SameAs(&recv_ad2) && recv_ad.SameAs(&parsed_ad));
+    }
+    ClassAdGetExprCacheStats(cache_after);
+    TEST("Deleting the ads empties the cache", cache_after.entries == cache_before.entries &&
+        cache_after.references == cache_before.references && cache_after.bytes == cache_before.bytes &&
+        cache_after.bytes_saved == cache_before.bytes_saved);
+    ClassAdSetExpressionCaching(old_caching, old_min_string);
+}
+
+/*********************************************************************
+ *
+ * Function: test_operator
+ * Purpose:  Test that operators evaluate the same whether the
+ *           expression is walked as a tree, run as a CompiledExpr,
+ *           or evaluated against a batch of ads by a BatchExpr.
+ *
+ *********************************************************************/
+static void test_operator(const Parameters &, Results &results)
+{
+    cout << "Testing operators and compiled and batch evaluation...\n";
+
+    const char *classad_string = "[ a = 3; b = 4.5; s = \"babyzilla\"; t = true; "
+        "l = { 1, 2, 3 }; n = [ x = 7 ]; self_ref = self_ref + 1; e = error ]";
+    const char *exprs[] = {
+        "a + b * 2", "a - -b", "!t || a", "t && (a > 2)", "a < 2 && undefined",
+        "undefined && false", "undefined || true", "error || true", "s == \"BABYZILLA\"",
+        "s =?= \"BABYZILLA\"", "s =!= undefined", "a ?: 5", "z ?: 5", "z ?: e",
+        "a > 2 ? s : b", "z ? 1 : 2", "s ? 1 : 2", "e ? 1 : 2", "t ? (a ? 1 : 2) : 3",
+        "l[1] + a", "n.x * 2", "n[\"x\"]", "a % 2 == 1 && (b / 0) is error",
+        "(a << 2) | 1 ^ 3 & 7", "-(a) + +b", "~a", "self_ref * 2 + 1",
+        "strcat(s, \"!\") == \"babyzilla!\" && size(l) == 3", "(((a)))",
+    };
+
+    ClassAdParser   parser;
+    ClassAdUnParser unparser;
+    ClassAd *classad = parser.ParseClassAd(classad_string, true);
+    TEST("Made classad for operator tests", (classad != NULL));
+    if (classad == NULL) {
+        return;
+    }
+
+    for (const char *str : exprs) {
+        ExprTree *tree = parser.ParseExpression(str);
+        TEST("Parsed operator expression", (tree != NULL));
+        if (tree == NULL) {
+            continue;
+        }
+        tree->SetParentScope(classad);
+
+        Value    tree_val, compiled_val;
+        string   tree_str, compiled_str;
+        EvalState state;
+        state.SetScopes(classad);
+        bool tree_ok = tree->Evaluate(state, tree_val);
+
+        CompiledExpr *prog = CompiledExpr::Compile(tree);
+        bool compiled_ok = tree_ok;
+        if (prog) {
+            EvalState cstate;
+            cstate.SetScopes(classad);
+            compiled_ok = prog->Evaluate(cstate, compiled_val);
+        } else {
+            compiled_val.CopyFrom(tree_val);
+        }
+        unparser.Unparse(tree_str, tree_val);
+        unparser.Unparse(compiled_str, compiled_val);
+        if (tree_str != compiled_str) {
+            cout << "  " << str << ": tree " << tree_str << " compiled " << compiled_str << endl;
+        }
+        TEST("Compiled evaluation succeeds like the tree", (tree_ok == compiled_ok));
+        TEST("Compiled evaluation has the same type", (tree_val.GetType() == compiled_val.GetType()));
+        TEST("Compiled evaluation has the same value", (tree_str == compiled_str));
+
+        delete prog;
+        delete tree;
+    }
+
+    ExprTree *literal = Literal::MakeInteger(1);
+    TEST("Literal isn't worth compiling", (CompiledExpr::Compile(literal) == NULL));
+    delete literal;
+
+    // Batch evaluation must give each ad what the tree gives it, both
+    // when the attributes have one type across the batch and when not.
+    const char *batch_strings[] = {
+        "[ a = 5; b = 0.5; s = \"Godzilla\"; t = false; l = { 4 }; n = [ x = 1 ] ]",
+        "[ a = 4.0; b = 2; s = 17; t = 1; e = 2 ]",
+        "[ a = -9223372036854775807 - 1; b = 0; s = \"babyzilla\"; t = undefined ]",
+        "[ b = 4.5; s = undefined; t = error ]",
+    };
+    vector<ClassAd *> batch_ads;
+    batch_ads.push_back(classad);
+    for (const char *str : batch_strings) {
+        ClassAd *ad = parser.ParseClassAd(str, true);
+        TEST("Made classad for batch tests", (ad != NULL));
+        if (ad) {
+            batch_ads.push_back(ad);
+        }
+    }
+    const char *batch_exprs[] = {
+        "a * 2 - 1", "a / -1", "a % 2 == 1", "b / a", "a > b", "a == b", "s < \"C\"",
+        "s =?= \"BABYZILLA\"", "t ? a : b", "t && a > 0", "t || b", "MY.a ?: b",
+        "a =!= undefined", "-b >= -4", "!t", "n.x + a", "size(l) + a",
+    };
+    bool old_semantics = _useOldClassAdSemantics;
+    SetOldClassAdSemantics(true);
+    for (int single = 0; single < 2; ++single) {
+        AdBatch batch;
+        for (size_t ix = 0; ix < (single ? 1 : batch_ads.size()); ++ix) {
+            batch.Add(batch_ads[ix]);
+        }
+        for (const char *str : batch_exprs) {
+            ExprTree *tree = parser.ParseExpression(str);
+            TEST("Parsed batch expression", (tree != NULL));
+            if (tree == NULL) {
+                continue;
+            }
+            BatchExpr batch_expr(tree);
+            vector<Value> batch_vals;
+            batch_expr.Evaluate(batch, batch_vals);
+            TEST("Batch evaluation has a value for each ad", (batch_vals.size() == batch.size()));
+            for (size_t ix = 0; ix < batch_vals.size(); ++ix) {
+                Value  tree_val;
+                string tree_str, batch_str;
+                ClassAd::EvaluateExpr(batch.GetAd(ix), tree, tree_val);
+                unparser.Unparse(tree_str, tree_val);
+                unparser.Unparse(batch_str, batch_vals[ix]);
+                if (tree_str != batch_str) {
+                    cout << "  " << str << " in ad " << ix << ": tree " << tree_str << " batch " << batch_str << endl;
+                }
+                TEST("Batch evaluation has the same type", (tree_val.GetType() == batch_vals[ix].GetType()));
+                TEST("Batch evaluation has the same value", (tree_str == batch_str));
+            }
+            delete tree;
+        }
+    }
+    SetOldClassAdSemantics(old_semantics);
+
+    for (ClassAd *ad : batch_ads) {
+        delete ad;
+    }
 }
 
 /*********************************************************************
@@ -1047,6 +1362,53 @@ static void test_utils(const Parameters &, Results &results)
     TEST("Dec 31, 2005->6, 364", weekday==6 && yearday==364);
     day_numbers(2004, 12, 31, weekday, yearday);
     TEST("Dec 31, 2005->5, 365", weekday==5 && yearday==365);
+
+    /* ----- Test the compiled regex cache ----- */
+    ClassAdParser parser;
+    ClassAd ad;
+    Value val;
+    bool b = false;
+    string str;
+    RegexCacheStats before, after;
+    size_t old_size = ClassAdGetRegexCacheSize();
+
+    ClassAdSetRegexCacheSize(2);
+    ClassAdGetRegexCacheStats(before);
+    TEST("Regex cache trimmed", before.entries <= 2);
+    ad.EvaluateExpr("regexp(\"^ba+[by]\", \"baabyzilla\")", val);
+    TEST("regexp matches", val.IsBooleanValue(b) && b);
+    ad.EvaluateExpr("regexp(\"^ba+[by]\", \"baabyzilla\")", val);
+    TEST("cached regexp matches", val.IsBooleanValue(b) && b);
+    ad.EvaluateExpr("regexp(\"^ba+[by]\", \"BAABYZILLA\")", val);
+    TEST("cached regexp doesn't match other case", val.IsBooleanValue(b) && !b);
+    ad.EvaluateExpr("regexp(\"^ba+[by]\", \"BAABYZILLA\", \"i\")", val);
+    TEST("regexp with other options matches", val.IsBooleanValue(b) && b);
+    ClassAdGetRegexCacheStats(after);
+    TEST("Regex cache hit once", after.hits - before.hits == 2);
+    TEST("Regex cache missed for each pattern and options", after.misses - before.misses == 2);
+    TEST("Regex cache holds both", after.entries == 2);
+
+    ad.EvaluateExpr("replace(\"a+\", \"baabyzilla\", \"A\")", val);
+    TEST("replace() works", val.IsStringValue(str) && str == "bAbyzilla");
+    ad.EvaluateExpr("regexp(\"^ba+[by]\", \"baabyzilla\")", val);
+    ClassAdGetRegexCacheStats(after);
+    TEST("Least recently used pattern was evicted", after.misses - before.misses == 4);
+    TEST("Regex cache stays at its size", after.entries == 2);
+
+    ad.EvaluateExpr("regexp(\"(\", \"baabyzilla\")", val);
+    TEST("Bad pattern is an error", val.IsErrorValue());
+    ad.EvaluateExpr("regexp(\"(\", \"baabyzilla\")", val);
+    TEST("Cached bad pattern is an error", val.IsErrorValue());
+
+    ClassAdSetRegexCacheSize(0);
+    ClassAdGetRegexCacheStats(before);
+    ad.EvaluateExpr("regexp(\"zilla$\", \"baabyzilla\")", val);
+    ad.EvaluateExpr("regexp(\"zilla$\", \"baabyzilla\")", val);
+    TEST("uncached regexp matches", val.IsBooleanValue(b) && b);
+    ClassAdGetRegexCacheStats(after);
+    TEST("Disabled regex cache is empty", after.entries == 0);
+    TEST("Disabled regex cache always misses", after.misses - before.misses == 2 && after.hits == before.hits);
+    ClassAdSetRegexCacheSize(old_size);
     return;
 }
 
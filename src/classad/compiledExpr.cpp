@@ -0,0 +1,530 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2024, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+
+#include "classad/common.h"
+#include "classad/exprTree.h"
+#include "classad/compiledExpr.h"
+
+namespace classad {
+
+static bool doCompiledEvaluation = true;
+
+void ClassAdSetCompiledEvaluation(bool do_compile) {
+	doCompiledEvaluation = do_compile;
+}
+
+bool ClassAdGetCompiledEvaluation() {
+	return doCompiledEvaluation;
+}
+
+// Operator nesting deeper than this is left to the tree walker. It keeps
+// the recursive builder's own stack use bounded, and it is far deeper
+// than anything real Requirements or Rank expressions contain.
+static const int MAX_COMPILE_DEPTH = 200;
+
+// Programs whose value stack fits in this many slots evaluate without
+// touching the heap.
+static const int INLINE_STACK_SIZE = 16;
+
+// Resolving a scope like TARGET takes a few levels of attribute reference.
+// Reusing a resolved scope is only safe if it was resolved well clear of
+// the recursion limit, so programs with scoped references require this
+// much headroom over their own nesting depth, or fall back to the tree.
+static const int SCOPE_DEPTH_MARGIN = 32;
+
+class CompiledExprBuilder
+{
+public:
+	CompiledExprBuilder( CompiledExpr &p )
+		: prog(p), pending_steps(0), cur_stack(0), num_ops(0) {}
+
+	void emit( const ExprTree *expr, int depth );
+
+	int num_operations() const { return num_ops; }
+
+private:
+	int push( CompiledExpr::OpCode code, Operation::OpKind op = Operation::__NO_OP__,
+			  const ExprTree *node = nullptr, int depth = 0 )
+	{
+		CompiledExpr::Instr in;
+		in.code = code;
+		in.op = op;
+		in.arg = 0;
+		in.arg2 = 0;
+		in.depth = depth;
+		in.steps = pending_steps;
+		in.node = node;
+		pending_steps = 0;
+		prog.code.push_back(in);
+		return (int)prog.code.size() - 1;
+	}
+
+	void adjust_stack( int delta ) {
+		cur_stack += delta;
+		if (cur_stack > prog.max_stack) { prog.max_stack = cur_stack; }
+	}
+
+	void emit_node( const ExprTree *expr, int depth ) {
+		// the node's own Evaluate() accounts for its step
+		push(CompiledExpr::EVAL_NODE, Operation::__NO_OP__, expr, depth);
+		adjust_stack(1);
+	}
+
+	void emit_attr( const AttributeReference *ref, int depth );
+
+	CompiledExpr &prog;
+	// scope name (lower case, '.' prefixed if absolute) -> scope slot
+	std::vector<std::string> scope_names;
+	int pending_steps;
+	int cur_stack;
+	int num_ops;
+};
+
+// Lower expr, whose evaluation leaves exactly one value on the stack.
+// depth is the number of Operation nodes enclosing expr.
+void CompiledExprBuilder::
+emit( const ExprTree *expr, int depth )
+{
+	ExprTree::NodeKind kind = expr->GetKind();
+
+	switch (kind) {
+	case ExprTree::ERROR_LITERAL:
+	case ExprTree::UNDEFINED_LITERAL:
+	case ExprTree::BOOLEAN_LITERAL:
+	case ExprTree::INTEGER_LITERAL:
+	case ExprTree::REAL_LITERAL:
+	case ExprTree::RELTIME_LITERAL:
+	case ExprTree::ABSTIME_LITERAL:
+	case ExprTree::STRING_LITERAL: {
+		Value val;
+		static_cast<const Literal*>(expr)->GetValue(val);
+		prog.consts.push_back(val);
+		++pending_steps;
+		int ix = push(CompiledExpr::PUSH_CONST);
+		prog.code[ix].arg = (int)prog.consts.size() - 1;
+		adjust_stack(1);
+		return;
+	}
+
+	case ExprTree::OP_NODE: {
+		if (depth >= MAX_COMPILE_DEPTH) {
+			emit_node(expr, depth);
+			return;
+		}
+
+		Operation::OpKind op = Operation::__NO_OP__;
+		ExprTree *c1 = nullptr, *c2 = nullptr, *c3 = nullptr;
+		static_cast<const Operation*>(expr)->GetComponents(op, c1, c2, c3);
+		if ( ! c1) {
+			emit_node(expr, depth);
+			return;
+		}
+
+		// this node's Evaluate() step is charged to the first instruction
+		// of its first operand, which always runs when this node does.
+		++pending_steps;
+		++num_ops;
+		int child_depth = depth + 1;
+		if (child_depth > prog.max_depth) { prog.max_depth = child_depth; }
+
+		if (op == Operation::PARENTHESES_OP) {
+			emit(c1, child_depth);
+		} else if (op == Operation::TERNARY_OP && c2 && c3) {
+			emit(c1, child_depth);
+			int sel = push(CompiledExpr::TERNARY_SELECT, op);
+			adjust_stack(-1);
+
+			emit(c2, child_depth);
+			int then_jump = push(CompiledExpr::JUMP);
+			adjust_stack(-1);
+
+			prog.code[sel].arg = (int)prog.code.size();
+			emit(c3, child_depth);
+			int else_jump = push(CompiledExpr::JUMP);
+			adjust_stack(-1);
+
+			// Selector was neither boolean nor exceptional.  The tree walker
+			// evaluates both arms before reporting the error, so we do too.
+			prog.code[sel].arg2 = (int)prog.code.size();
+			adjust_stack(1);
+			emit_node(c2, child_depth);
+			emit_node(c3, child_depth);
+			push(CompiledExpr::TERNARY_OP, op);
+			adjust_stack(-2);
+
+			int end = (int)prog.code.size();
+			prog.code[then_jump].arg = end;
+			prog.code[else_jump].arg = end;
+			prog.code[sel].node = expr;
+		} else if ( ! c2) {
+			emit(c1, child_depth);
+			push(CompiledExpr::UNARY_OP, op);
+		} else if (op == Operation::LOGICAL_AND_OP ||
+				   op == Operation::LOGICAL_OR_OP ||
+				   op == Operation::ELVIS_OP) {
+			emit(c1, child_depth);
+			int sc = push(CompiledExpr::SHORT_CIRCUIT, op);
+			emit(c2, child_depth);
+			push(CompiledExpr::BINARY_OP, op);
+			adjust_stack(-1);
+			prog.code[sc].arg = (int)prog.code.size();
+		} else if ( ! c3) {
+			emit(c1, child_depth);
+			emit(c2, child_depth);
+			push(CompiledExpr::BINARY_OP, op);
+			adjust_stack(-1);
+		} else {
+			// not an operator shape we know; let the tree walker have it.
+			--pending_steps;
+			--num_ops;
+			emit_node(expr, depth);
+		}
+		return;
+	}
+
+	case ExprTree::ATTRREF_NODE:
+		emit_attr(static_cast<const AttributeReference*>(expr), depth);
+		return;
+
+	default:
+		emit_node(expr, depth);
+		return;
+	}
+}
+
+// A reference of the form scope.attr, where scope is itself a simple
+// reference, gets a SCOPED_ATTR so that the scope is resolved only once
+// per evaluation.  Anything else is left to the tree walker.
+void CompiledExprBuilder::
+emit_attr( const AttributeReference *ref, int depth )
+{
+	ExprTree *scope = nullptr;
+	std::string attr;
+	bool absolute = false;
+	ref->GetComponents(scope, attr, absolute);
+
+	ExprTree *scope_scope = nullptr;
+	std::string scope_attr;
+	bool scope_absolute = false;
+	if ( ! scope || scope->GetKind() != ExprTree::ATTRREF_NODE) {
+		emit_node(ref, depth);
+		return;
+	}
+	static_cast<const AttributeReference*>(scope)->GetComponents(scope_scope, scope_attr, scope_absolute);
+	if (scope_scope) {
+		emit_node(ref, depth);
+		return;
+	}
+
+	std::string key = scope_absolute ? "." : "";
+	for (char ch : scope_attr) { key += (char)tolower((unsigned char)ch); }
+	int slot = -1;
+	for (size_t ix = 0; ix < scope_names.size(); ++ix) {
+		if (scope_names[ix] == key) { slot = (int)ix; break; }
+	}
+	if (slot < 0) {
+		if ((int)scope_names.size() >= CompiledExpr::MAX_SCOPE_SLOTS) {
+			emit_node(ref, depth);
+			return;
+		}
+		scope_names.push_back(key);
+		slot = (int)scope_names.size() - 1;
+		prog.num_scopes = (int)scope_names.size();
+	}
+
+	CompiledExpr::ScopedRef sref;
+	sref.node = ref;
+	sref.scope = scope;
+	sref.attr = attr;
+	prog.refs.push_back(sref);
+
+	int ix = push(CompiledExpr::SCOPED_ATTR, Operation::__NO_OP__, ref, depth);
+	prog.code[ix].arg = slot;
+	prog.code[ix].arg2 = (int)prog.refs.size() - 1;
+	adjust_stack(1);
+}
+
+
+CompiledExpr *CompiledExpr::
+Compile( const ExprTree *expr )
+{
+	if ( ! expr) {
+		return nullptr;
+	}
+	expr = expr->self();
+	if (expr->GetKind() != ExprTree::OP_NODE) {
+		return nullptr;
+	}
+
+	CompiledExpr *prog = new CompiledExpr(expr);
+	CompiledExprBuilder builder(*prog);
+	builder.emit(expr, 0);
+	if (builder.num_operations() == 0) {
+		delete prog;
+		return nullptr;
+	}
+	return prog;
+}
+
+
+bool CompiledExpr::
+Evaluate( EvalState &state, Value &result ) const
+{
+	// The tree walker prints a trace of every node when debugging, and it
+	// is the one that reports running out of recursion depth.  Hand both
+	// cases back to it so the behavior is identical.
+	int min_depth = max_depth + (num_scopes ? SCOPE_DEPTH_MARGIN : 0);
+	if (state.debug || state.depth_remaining < min_depth) {
+		return tree->Evaluate(state, result);
+	}
+
+	ScopeSlot scopes[MAX_SCOPE_SLOTS];
+	for (int ix = 0; ix < num_scopes; ++ix) {
+		scopes[ix].curAd = nullptr;
+		scopes[ix].ad = nullptr;
+	}
+
+	Value inline_stack[INLINE_STACK_SIZE];
+	std::vector<Value> heap_stack;
+	Value *stack = inline_stack;
+	if (max_stack > INLINE_STACK_SIZE) {
+		heap_stack.resize(max_stack);
+		stack = heap_stack.data();
+	}
+
+	Value dummy;
+	Value tmp;
+	int sp = 0;
+	int pc = 0;
+	const int end = (int)code.size();
+
+	while (pc < end) {
+		const Instr &in = code[pc];
+
+		if (in.steps) {
+			state.eval_steps_remaining -= in.steps;
+			if (state.eval_steps_remaining < 0) {
+				result.SetErrorValue();
+				return false;
+			}
+		}
+
+		switch (in.code) {
+		case PUSH_CONST:
+			stack[sp++].CopyFrom(consts[in.arg]);
+			break;
+
+		case EVAL_NODE: {
+			Value &val = stack[sp++];
+			val.Clear();
+			state.depth_remaining -= in.depth;
+			bool ok = in.node->Evaluate(state, val);
+			state.depth_remaining += in.depth;
+			if ( ! ok) {
+				result.SetErrorValue();
+				return false;
+			}
+			break;
+		}
+
+		case UNARY_OP:
+			if (Operation::_doOperation(in.op, stack[sp-1], dummy, dummy,
+					true, false, false, tmp, &state) == Operation::SIG_NONE) {
+				result.CopyFrom(tmp);
+				return false;
+			}
+			stack[sp-1].CopyFrom(tmp);
+			break;
+
+		case BINARY_OP:
+			--sp;
+			if (Operation::_doOperation(in.op, stack[sp-1], stack[sp], dummy,
+					true, true, false, tmp, &state) == Operation::SIG_NONE) {
+				result.CopyFrom(tmp);
+				return false;
+			}
+			stack[sp-1].CopyFrom(tmp);
+			break;
+
+		case TERNARY_OP:
+			sp -= 2;
+			if (Operation::_doOperation(in.op, stack[sp-1], stack[sp], stack[sp+1],
+					true, true, true, tmp, &state) == Operation::SIG_NONE) {
+				result.CopyFrom(tmp);
+				return false;
+			}
+			stack[sp-1].CopyFrom(tmp);
+			break;
+
+		case SHORT_CIRCUIT:
+			if (Operation::shortCircuit(in.op, stack[sp-1], tmp) == Operation::SIG_CHLD1) {
+				if (in.op != Operation::ELVIS_OP) {
+					// ?: leaves the (defined) left operand as the result
+					stack[sp-1].CopyFrom(tmp);
+				}
+				pc = in.arg;
+				continue;
+			}
+			break;
+
+		case TERNARY_SELECT: {
+			int sig = Operation::shortCircuit(in.op, stack[sp-1], tmp);
+			if (sig == Operation::SIG_CHLD1) {
+				stack[sp-1].CopyFrom(tmp);
+				// skip past both arms and the fallback; the instruction
+				// before the else arm is the jump to the end.
+				pc = code[in.arg - 1].arg;
+				continue;
+			} else if (sig == Operation::SIG_CHLD2) {
+				--sp;
+			} else if (sig == Operation::SIG_CHLD3) {
+				--sp;
+				pc = in.arg;
+				continue;
+			} else {
+				pc = in.arg2;
+				continue;
+			}
+			break;
+		}
+
+		case JUMP:
+			pc = in.arg;
+			continue;
+
+		case SCOPED_ATTR: {
+			Value &val = stack[sp++];
+			val.Clear();
+			state.depth_remaining -= in.depth;
+			bool ok = EvaluateScopedAttr(state, refs[in.arg2], scopes[in.arg], val);
+			state.depth_remaining += in.depth;
+			if ( ! ok) {
+				result.SetErrorValue();
+				return false;
+			}
+			break;
+		}
+		}
+		++pc;
+	}
+
+	result.CopyFrom(stack[0]);
+	return true;
+}
+
+// Evaluate scope.attr the way ExprTree::Evaluate() on the reference
+// would, except that the ad that scope resolves to is taken from slot
+// when scope has already been resolved from the same ad in this
+// evaluation.
+bool CompiledExpr::
+EvaluateScopedAttr( EvalState &state, const ScopedRef &ref, ScopeSlot &slot, Value &val ) const
+{
+	if (--state.eval_steps_remaining < 0) {
+		val.SetErrorValue();
+		return false;
+	}
+
+	const ClassAd *curAd = state.curAd;
+	const ClassAd *scope = nullptr;
+	int rc = ExprTree::EVAL_OK;
+
+	// AttributeReference::FindExpr() for "expr.attr"
+	if (state.depth_remaining <= 0) {
+		rc = ExprTree::EVAL_ERROR;
+	} else if (slot.ad && slot.curAd == curAd) {
+		scope = slot.ad;
+	} else {
+		Value scope_val;
+		state.depth_remaining--;
+		bool ok = ref.scope->Evaluate(state, scope_val);
+		state.depth_remaining++;
+		if ( ! ok) {
+			return false;
+		}
+
+		ClassAd *ad = nullptr;
+		if (scope_val.IsUndefinedValue()) {
+			rc = ExprTree::EVAL_UNDEF;
+		} else if (scope_val.IsErrorValue()) {
+			rc = ExprTree::EVAL_ERROR;
+		} else if (scope_val.GetType() == Value::CLASSAD_VALUE && scope_val.IsClassAdValue(ad)) {
+			scope = ad;
+			slot.curAd = curAd;
+			slot.ad = scope;
+		} else if (scope_val.IsClassAdValue() || scope_val.IsListValue()) {
+			// a list projection, or an ad that belongs to the value.
+			// leave those to the tree walker.
+			return ref.node->Evaluate(state, val);
+		} else {
+			rc = ExprTree::EVAL_ERROR;
+		}
+	}
+
+	ExprTree *tree = nullptr;
+	if (rc == ExprTree::EVAL_OK) {
+		rc = scope->LookupInScope(ref.attr, tree, state);
+	}
+
+	// AttributeReference::_Evaluate()
+	switch (rc) {
+	case ExprTree::EVAL_FAIL:
+		return false;
+
+	case ExprTree::EVAL_ERROR:
+		val.SetErrorValue();
+		state.curAd = curAd;
+		return true;
+
+	case ExprTree::EVAL_UNDEF:
+		val.SetUndefinedValue();
+		state.curAd = curAd;
+		return true;
+
+	default:
+		break;
+	}
+
+	if (state.depth_remaining <= 0) {
+		val.SetErrorValue();
+		state.curAd = curAd;
+		return false;
+	}
+
+	for (const ExprTree *active : state.eval_stack) {
+		if (active == tree) {
+			val.SetUndefinedValue();
+			state.curAd = curAd;
+			return true;
+		}
+	}
+
+	state.eval_stack.push_back(tree);
+	state.depth_remaining--;
+
+	bool rval = tree->Evaluate(state, val);
+
+	state.depth_remaining++;
+	state.eval_stack.pop_back();
+
+	state.curAd = curAd;
+	return rval;
+}
+
+} // classad
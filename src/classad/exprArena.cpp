@@ -0,0 +1,166 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2024, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+
+#include "classad/common.h"
+#include "classad/exprArena.h"
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <stdlib.h>
+#ifdef WIN32
+#include <malloc.h>
+#endif
+
+namespace classad {
+
+// The header of a block.  A node finds its block by rounding its address
+// down to a multiple of the block size.  refs counts the nodes living in
+// the block.  So that allocating doesn't have to touch it, the arena that
+// is allocating from a block holds ARENA_REFS references for the nodes it
+// hasn't allocated yet, and gives back the ones it didn't use when it
+// moves on.  There can't be that many nodes in a block, so the count
+// can't reach zero until then, however many nodes are deleted meanwhile.
+struct ExprArenaBlock {
+	std::atomic<size_t> refs;
+};
+
+static const size_t ARENA_REFS = ExprArena::ARENA_BLOCK_SIZE;
+
+static const size_t NODE_ALIGN = alignof(std::max_align_t);
+static const size_t HEADER_SIZE = (sizeof(ExprArenaBlock) + NODE_ALIGN - 1) & ~(NODE_ALIGN - 1);
+
+static thread_local ExprArena *currentArena = nullptr;
+
+static std::atomic<uint64_t> nodesAllocated{0};
+static std::atomic<uint64_t> blocksAllocated{0};
+static std::atomic<size_t> blocksInUse{0};
+
+static ExprArenaBlock *
+allocBlock()
+{
+	void *mem;
+#ifdef WIN32
+	mem = _aligned_malloc( ExprArena::ARENA_BLOCK_SIZE, ExprArena::ARENA_BLOCK_SIZE );
+#else
+	if (posix_memalign( &mem, ExprArena::ARENA_BLOCK_SIZE, ExprArena::ARENA_BLOCK_SIZE ) != 0) {
+		mem = nullptr;
+	}
+#endif
+	if ( ! mem) {
+		throw std::bad_alloc();
+	}
+	blocksAllocated.fetch_add( 1, std::memory_order_relaxed );
+	blocksInUse.fetch_add( 1, std::memory_order_relaxed );
+	return new (mem) ExprArenaBlock{ {ARENA_REFS} };
+}
+
+static void
+unrefBlock( ExprArenaBlock *block, size_t refs )
+{
+	if (block->refs.fetch_sub( refs, std::memory_order_acq_rel ) != refs) {
+		return;
+	}
+	block->~ExprArenaBlock();
+	blocksInUse.fetch_sub( 1, std::memory_order_relaxed );
+#ifdef WIN32
+	_aligned_free( block );
+#else
+	free( block );
+#endif
+}
+
+ExprArena::
+~ExprArena()
+{
+	LeaveBlock();
+}
+
+void ExprArena::
+LeaveBlock()
+{
+	if ( ! block) {
+		return;
+	}
+	nodesAllocated.fetch_add( blockNodes, std::memory_order_relaxed );
+	unrefBlock( block, ARENA_REFS - blockNodes );
+	block = nullptr;
+	blockNodes = 0;
+}
+
+void ExprArena::
+NewBlock()
+{
+	LeaveBlock();
+	block = allocBlock();
+	next = (char *)block + HEADER_SIZE;
+	end = (char *)block + ARENA_BLOCK_SIZE;
+}
+
+void *ExprArena::
+Allocate( size_t size )
+{
+	size = (size + NODE_ALIGN - 1) & ~(NODE_ALIGN - 1);
+	if ( ! block || size > (size_t)(end - next)) {
+		// nodes are a few dozen bytes, so this can't happen twice
+		NewBlock();
+	}
+	void *node = next;
+	next += size;
+	blockNodes++;
+	return node;
+}
+
+void ExprArena::
+Release( void *node )
+{
+	if ( ! node) {
+		return;
+	}
+	unrefBlock( (ExprArenaBlock *)((uintptr_t)node & ~(uintptr_t)(ARENA_BLOCK_SIZE - 1)), 1 );
+}
+
+ExprArena *ExprArena::
+Current()
+{
+	return currentArena;
+}
+
+ExprArenaScope::
+ExprArenaScope( ExprArena *arena ) : previous( currentArena )
+{
+	currentArena = arena;
+}
+
+ExprArenaScope::
+~ExprArenaScope()
+{
+	currentArena = previous;
+}
+
+void
+ClassAdGetExprArenaStats( ExprArenaStats &stats )
+{
+	stats.nodes = nodesAllocated.load( std::memory_order_relaxed );
+	stats.blocks = blocksAllocated.load( std::memory_order_relaxed );
+	stats.blocks_in_use = blocksInUse.load( std::memory_order_relaxed );
+}
+
+} // classad
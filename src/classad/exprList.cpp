@@ -156,7 +156,7 @@ _SetParentScope( const ClassAd *parent )
 ExprList *ExprList::
 MakeExprList(const std::vector<ExprTree*> &exprs )
 {
-	ExprList *el = new ExprList;
+	ExprList *el = CLASSAD_NEW_EXPR(ExprList);
 	if( !el ) {
 		CondorErrno = ERR_MEM_ALLOC_FAILED;
 		CondorErrMsg = "";
@@ -28,6 +28,7 @@
 #include "classad/sink.h"
 #include "classad/util.h"
 #include "classad/natural_cmp.h"
+#include "classad/regexCache.h"
 
 #ifdef WIN32
  #if _MSC_VER < 1900
@@ -412,7 +413,7 @@ _SetParentScope( const ClassAd* parent )
 FunctionCall *FunctionCall::
 MakeFunctionCall( const string &str, vector<ExprTree*> &args )
 {
-	FunctionCall *fc = new FunctionCall;
+	FunctionCall *fc = CLASSAD_NEW_EXPR(FunctionCall);
 	if( !fc ) {
 		vector<ExprTree*>::iterator i = args.begin( );
 		while(i != args.end()) {
@@ -1763,7 +1764,7 @@ bool FunctionCall::hasRefs(const char*, const ArgumentList& argList, EvalState&
 
 	// for the 2 arg form, the second argument is a regex pattern to be compared against
 	// each of the unresolved references
-	pcre2_code * re = nullptr;
+	std::shared_ptr<pcre2_code> re;
 	if (argList.size() == 2) {
 		const char* pattern = nullptr;
 		if ( !argList[1]->Evaluate(state, arg) || ! arg.IsStringValue(pattern)) {
@@ -1771,10 +1772,7 @@ bool FunctionCall::hasRefs(const char*, const ArgumentList& argList, EvalState&
 			return false;
 		}
 
-		int error_number;
-		PCRE2_SIZE error_offset;
-		PCRE2_SPTR pattern_pcre2str = reinterpret_cast<const unsigned char *>(pattern);
-		re = pcre2_compile(pattern_pcre2str, PCRE2_ZERO_TERMINATED, PCRE2_CASELESS, &error_number, &error_offset, NULL);
+		re = CompileRegex(pattern, PCRE2_CASELESS);
 		if ( ! re) {
 			// error in pattern
 			result.SetErrorValue();
@@ -1794,9 +1792,9 @@ bool FunctionCall::hasRefs(const char*, const ArgumentList& argList, EvalState&
 					len -= 7;
 				}
 				if (re) {
-					pcre2_match_data * match_data = pcre2_match_data_create_from_pattern(re, NULL);
+					pcre2_match_data * match_data = pcre2_match_data_create_from_pattern(re.get(), NULL);
 					PCRE2_SPTR attr_pcre2str = reinterpret_cast<const unsigned char *>(attr);
-					if (pcre2_match(re, attr_pcre2str, len, 0, PCRE2_NOTEMPTY, match_data, NULL) > 0) {
+					if (pcre2_match(re.get(), attr_pcre2str, len, 0, PCRE2_NOTEMPTY, match_data, NULL) > 0) {
 						result.SetBooleanValue(true); // found a match
 						pcre2_match_data_free(match_data);
 						break;
@@ -1813,8 +1811,6 @@ bool FunctionCall::hasRefs(const char*, const ArgumentList& argList, EvalState&
 
 	if ( ! re) {
 		result.SetStringValue(val);
-	} else {
-		pcre2_code_free(re);
 	}
 	return true;
 }
@@ -2737,10 +2733,7 @@ static bool regexp_helper(
 	bool		full_target = false;
 	bool		find_all = false;
 
-	PCRE2_SIZE error_offset;
-	int error_code;
-	pcre2_code * re = NULL;
-	PCRE2_SPTR pattern_pcre2 = reinterpret_cast<const unsigned char *>(pattern);
+	std::shared_ptr<pcre2_code> re;
 	PCRE2_SIZE *ovector = NULL;
 	bool empty_match = false;
 	uint32_t addl_opts = 0;
@@ -2781,8 +2774,8 @@ static bool regexp_helper(
 		}
     }
 
-    re = pcre2_compile(pattern_pcre2, PCRE2_ZERO_TERMINATED, options, &error_code, &error_offset, NULL);
-    if ( re == NULL ){
+    re = CompileRegex(pattern, options);
+    if ( ! re ){
 			// error in pattern
 		result.SetErrorValue( );
 		goto cleanup;
@@ -2802,8 +2795,8 @@ static bool regexp_helper(
 			addl_opts = 0;
 		}
 
-		pcre2_match_data * match_data = pcre2_match_data_create_from_pattern(re, NULL);
-		status = pcre2_match(re, target_pcre2str, target_len, target_idx, addl_opts, match_data, NULL);
+		pcre2_match_data * match_data = pcre2_match_data_create_from_pattern(re.get(), NULL);
+		status = pcre2_match(re.get(), target_pcre2str, target_len, target_idx, addl_opts, match_data, NULL);
 		ovector = pcre2_get_ovector_pointer(match_data);
 		if (empty_match && status == PCRE2_ERROR_NOMATCH) {
 			output += target[target_idx];
@@ -2872,9 +2865,6 @@ static bool regexp_helper(
 		result.SetStringValue(output);
 	}
  cleanup:
-	if ( re ) {
-		pcre2_code_free(re);
-	}
     return true;
 }
 
@@ -53,7 +53,7 @@ Literal::MakeAbsTime( abstime_t *tim )
     else { //make a literal out of the passed value
         abst = *tim;
     }
-    return new AbstimeLiteral(abst);
+    return CLASSAD_NEW_EXPR(AbstimeLiteral, abst);
 }
 
 /* Creates an absolute time literal, from the string timestr, 
@@ -164,7 +164,7 @@ Literal::MakeAbsTime(string timeStr )
 		return nullptr;
 	}
 	else {
-		return new AbstimeLiteral(abst);
+		return CLASSAD_NEW_EXPR(AbstimeLiteral, abst);
 	}
 }
 
@@ -173,7 +173,7 @@ Literal::MakeRelTime( time_t t1, time_t t2 )
 {
 	if( t1<0 ) time( &t1 );
 	if( t2<0 ) time( &t2 );
-	return new ReltimeLiteral(t1 - t2);
+	return CLASSAD_NEW_EXPR(ReltimeLiteral, t1 - t2);
 }
 
 
@@ -185,9 +185,9 @@ Literal::MakeRelTime( time_t secs )
 	if( secs<0 ) {
 		time(&secs );
 		getLocalTime( &secs, &lt );
-		return new ReltimeLiteral((time_t) (lt.tm_hour*3600 + lt.tm_min*60 + lt.tm_sec));
+		return CLASSAD_NEW_EXPR(ReltimeLiteral, (time_t) (lt.tm_hour*3600 + lt.tm_min*60 + lt.tm_sec));
 	} else {
-		return new ReltimeLiteral((time_t) secs);
+		return CLASSAD_NEW_EXPR(ReltimeLiteral, (time_t) secs);
 	}
 }
 
@@ -279,7 +279,7 @@ Literal::MakeRelTime(const string &timeStr)
 	
 	rsecs = ( negative ? -1 : +1 ) * ( days*86400 + hrs*3600 + mins*60 + secs );
 	
-	return new ReltimeLiteral(rsecs);
+	return CLASSAD_NEW_EXPR(ReltimeLiteral, rsecs);
 }
 
 /* Function which iterates through the string Str from the location 'index', 
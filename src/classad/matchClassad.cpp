@@ -20,7 +20,10 @@
 
 #include "classad/common.h"
 #include "classad/source.h"
+#include "classad/sink.h"
 #include "classad/matchClassad.h"
+#include "classad/classadCache.h"
+#include "classad/compiledExpr.h"
 
 using std::string;
 using std::vector;
@@ -387,6 +390,16 @@ OptimizeAdForMatchmaking( ClassAd *ad, bool is_right, std::string *error_msg, co
 		if( !flat_requirements ) {
 				// flattened to a value
 			flat_requirements = Literal::MakeLiteral(flat_val);
+		}
+			// Route the optimized requirements through the expression
+			// cache, so that identical slots share one tree and its
+			// compiled program instead of each evaluating a private copy.
+		if( flat_requirements && ClassAdGetExpressionCaching() && ClassAdGetCompiledEvaluation() ) {
+			std::string flat_str;
+			ClassAdUnParser unparser;
+			unparser.SetOldClassAd( true, true );
+			unparser.Unparse( flat_str, flat_requirements );
+			flat_requirements = CachedExprEnvelope::cache( ATTR_REQUIREMENTS, flat_requirements, flat_str );
 		}
 		if( flat_requirements ) {
 				// save original requirements
@@ -1808,17 +1808,17 @@ MakeOperation (OpKind op, ExprTree *e1, ExprTree *e2, ExprTree *e3)
 {
 	Operation *opnode = NULL;
 	if (op == PARENTHESES_OP) {
-		opnode = new OperationParens(e1);
+		opnode = CLASSAD_NEW_EXPR(OperationParens, e1);
 	} else if (op == UNARY_PLUS_OP || op == UNARY_MINUS_OP || op == LOGICAL_NOT_OP || op == BITWISE_NOT_OP) {// unary ops
-		opnode = new Operation1(op, e1);
+		opnode = CLASSAD_NEW_EXPR(Operation1, op, e1);
 	} else if (op == TERNARY_OP) {
 		if (e2) {
-			opnode = new Operation3(e1, e2, e3);
+			opnode = CLASSAD_NEW_EXPR(Operation3, e1, e2, e3);
 		} else {
-			opnode = new Operation2(ELVIS_OP, e1, e3);
+			opnode = CLASSAD_NEW_EXPR(Operation2, ELVIS_OP, e1, e3);
 		}
 	} else {
-		opnode = new Operation2(op, e1, e2);
+		opnode = CLASSAD_NEW_EXPR(Operation2, op, e1, e2);
 	}
 	if( !opnode ) {
 		CondorErrno = ERR_MEM_ALLOC_FAILED;
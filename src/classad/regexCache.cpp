@@ -0,0 +1,158 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2024, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+
+#include "classad/common.h"
+#include "classad/regexCache.h"
+
+#define PCRE2_CODE_UNIT_WIDTH 8
+#include <pcre2.h>
+
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace classad {
+
+struct RegexCacheEntry {
+	std::string key;
+	// NULL if the pattern failed to compile; we remember that too.
+	std::shared_ptr<pcre2_code> code;
+};
+
+// Entries are kept most recently used first.  Evaluation can happen in
+// several threads at once (see ParallelIsAMatch), so everything is done
+// under the mutex.  The compiled code is handed out as a shared_ptr so
+// that an entry can be evicted while another thread is still matching
+// with it.
+struct RegexCache {
+	std::mutex lock;
+	std::list<RegexCacheEntry> lru;
+	std::unordered_map<std::string, std::list<RegexCacheEntry>::iterator> index;
+	size_t max_patterns{256};
+	uint64_t hits{0};
+	uint64_t misses{0};
+
+	void trim(size_t max_size) {
+		while (lru.size() > max_size) {
+			index.erase(lru.back().key);
+			lru.pop_back();
+		}
+	}
+};
+
+static RegexCache &
+theRegexCache()
+{
+	// never destroyed, evaluation may happen during static destruction
+	static RegexCache *cache = new RegexCache;
+	return *cache;
+}
+
+static std::shared_ptr<pcre2_code>
+compile(const char *pattern, uint32_t options, bool jit)
+{
+	int error_code;
+	PCRE2_SIZE error_offset;
+	PCRE2_SPTR pattern_pcre2 = reinterpret_cast<const unsigned char *>(pattern);
+
+	pcre2_code *re = pcre2_compile(pattern_pcre2, PCRE2_ZERO_TERMINATED, options, &error_code, &error_offset, NULL);
+	if ( ! re) {
+		return std::shared_ptr<pcre2_code>();
+	}
+	if (jit) {
+		// Fails harmlessly if the library was built without JIT support,
+		// or the pattern can't be JIT compiled; pcre2_match() then uses
+		// the interpreter.  The interpreter is also used for the match
+		// options that JIT code doesn't support.
+		pcre2_jit_compile(re, PCRE2_JIT_COMPLETE);
+	}
+	return std::shared_ptr<pcre2_code>(re, pcre2_code_free);
+}
+
+void ClassAdSetRegexCacheSize(size_t max_patterns)
+{
+	RegexCache &cache = theRegexCache();
+	std::lock_guard<std::mutex> guard(cache.lock);
+	cache.max_patterns = max_patterns;
+	cache.trim(max_patterns);
+}
+
+size_t ClassAdGetRegexCacheSize()
+{
+	RegexCache &cache = theRegexCache();
+	std::lock_guard<std::mutex> guard(cache.lock);
+	return cache.max_patterns;
+}
+
+void ClassAdGetRegexCacheStats(RegexCacheStats &stats)
+{
+	RegexCache &cache = theRegexCache();
+	std::lock_guard<std::mutex> guard(cache.lock);
+	stats.hits = cache.hits;
+	stats.misses = cache.misses;
+	stats.entries = cache.lru.size();
+}
+
+std::shared_ptr<pcre2_code>
+CompileRegex(const char *pattern, uint32_t options)
+{
+	RegexCache &cache = theRegexCache();
+
+	std::string key(pattern);
+	key.push_back('\0');
+	key.append(reinterpret_cast<const char *>(&options), sizeof(options));
+
+	bool caching;
+	{
+		std::lock_guard<std::mutex> guard(cache.lock);
+		caching = cache.max_patterns > 0;
+		auto found = cache.index.find(key);
+		if (found != cache.index.end()) {
+			cache.hits++;
+			cache.lru.splice(cache.lru.begin(), cache.lru, found->second);
+			return found->second->code;
+		}
+		cache.misses++;
+	}
+
+	if ( ! caching) {
+		// JIT compiling costs more than it saves for a single match
+		return compile(pattern, options, false);
+	}
+
+	// Compile without holding the lock.  If another thread compiles the
+	// same pattern meanwhile, the first one to get back keeps its entry.
+	std::shared_ptr<pcre2_code> code = compile(pattern, options, true);
+
+	std::lock_guard<std::mutex> guard(cache.lock);
+	auto found = cache.index.find(key);
+	if (found != cache.index.end()) {
+		return found->second->code;
+	}
+	if (cache.max_patterns > 0) {
+		cache.lru.push_front(RegexCacheEntry{key, code});
+		cache.index[key] = cache.lru.begin();
+		cache.trim(cache.max_patterns);
+	}
+	return code;
+}
+
+} // classad
@@ -30,6 +30,9 @@
 #include "condor_universe.h"
 #include "ipv6_hostname.h"
 #include "condor_threads.h"
+#include <mutex>
+#include <condition_variable>
+#include <thread>
 #include "classad_helpers.h"
 
 #include "condor_claimid_parser.h"
@@ -59,6 +62,7 @@ extern "C" char* CondorPlatform( void );
 
 CollectorStats CollectorDaemon::collectorStats( false, 0 );
 CollectorEngine CollectorDaemon::collector( &collectorStats );
+CollectorChangeFeed CollectorDaemon::change_feed( &collectorStats );
 int CollectorDaemon::HandleQueryInProcPolicy = HandleQueryInProcSmallTableAndQuery;
 int CollectorDaemon::ClientTimeout;
 int CollectorDaemon::QueryTimeout;
@@ -90,6 +94,19 @@ int CollectorDaemon::max_pending_query_workers = 50;
 int CollectorDaemon::max_query_worktime = 0;
 int CollectorDaemon::active_query_workers = 0;
 int CollectorDaemon::pending_query_workers = 0;
+bool CollectorDaemon::use_query_threads = false;
+std::map<int, double> CollectorDaemon::query_worker_start_times;
+
+// the queries waiting for a query thread, and the number of threads. this is
+// never destroyed, because idle query threads wait on it until the daemon exits.
+struct query_thread_pool {
+	std::mutex lock;
+	std::condition_variable cv;
+	std::deque<CollectorDaemon::query_snapshot *> queue;
+	int threads = 0;
+	int idle = 0;
+};
+static query_thread_pool & query_threads = *new query_thread_pool;
 
 #ifdef TRACK_QUERIES_BY_SUBSYS
 bool CollectorDaemon::want_track_queries_by_subsys = false;
@@ -311,6 +328,11 @@ void CollectorDaemon::Init()
 	daemonCore->Register_CommandWithPayload(QUERY_MULTIPLE_PVT_ADS,"QUERY_MULTIPLE_PVT_ADS",
 		receive_query_cedar,"receive_query_cedar",NEGOTIATOR);
 
+	// install command handler for subscriptions to changes in the ads
+	daemonCore->Register_CommandWithPayload(SUBSCRIBE_ADS,"SUBSCRIBE_ADS",
+		receive_subscription,"receive_subscription",READ);
+	collector.setChangeFeed(&change_feed);
+
 	// install command handlers for invalidations
 	daemonCore->Register_CommandWithPayload(INVALIDATE_STARTD_ADS,"INVALIDATE_STARTD_ADS",
 		receive_invalidation,"receive_invalidation",ADVERTISE_STARTD_PERM);
@@ -354,6 +376,8 @@ void CollectorDaemon::Init()
 		receive_update,"receive_update",ADVERTISE_STARTD_PERM);
 	daemonCore->Register_CommandWithPayload(MERGE_STARTD_AD,"MERGE_STARTD_AD",
 		receive_update,"receive_update",NEGOTIATOR);
+	daemonCore->Register_CommandWithPayload(UPDATE_STARTD_AD_DELTA,"UPDATE_STARTD_AD_DELTA",
+		receive_update,"receive_update",ADVERTISE_STARTD_PERM);
 	daemonCore->Register_CommandWithPayload(UPDATE_SCHEDD_AD,"UPDATE_SCHEDD_AD",
 		receive_update,"receive_update",ADVERTISE_SCHEDD_PERM);
 	daemonCore->Register_CommandWithPayload(UPDATE_SUBMITTOR_AD,"UPDATE_SUBMITTOR_AD",
@@ -442,6 +466,10 @@ collector_runtime_probe HandleQueryForked_runtime;
 collector_runtime_probe HandleQueryMissedFork_runtime;
 collector_runtime_probe HandleLocateForked_runtime;
 collector_runtime_probe HandleLocateMissedFork_runtime;
+collector_runtime_probe QueryForkDispatch_runtime;
+collector_runtime_probe QueryForkLatency_runtime;
+collector_runtime_probe QueryThreadDispatch_runtime;
+collector_runtime_probe QueryThreadLatency_runtime;
 
 
 template <typename T>
@@ -638,6 +666,37 @@ CollectorDaemon::pending_query_entry_t *  CollectorDaemon::make_query_entry(
 	return query_entry;
 }
 
+// Count the table scans of a query that the query indexes will narrow, and
+// the ads they will skip. This is done before the query is handed to a
+// worker, because a forked worker cannot update our statistics.
+void CollectorDaemon::count_query_plans(const pending_query_entry_t * query_entry)
+{
+	for (int ix = 0; ix < query_entry->num_adtypes; ++ix) {
+		const AdTypes whichAds = (AdTypes) query_entry->adt[ix].whichAds;
+		std::vector<CollectorHashTable *> tables;
+		if (whichAds == GENERIC_AD) {
+			tables.push_back(collector.getGenericHashTable(query_entry->adt[ix].tag));
+		} else if (whichAds != ANY_AD) {
+			tables.push_back(collector.getHashTable(whichAds));
+		} else if (ix == 0) {
+			const char * mytype = query_entry->adt[ix].match_mytype ? query_entry->adt[ix].tag : nullptr;
+			tables = collector.getAnyHashTables(mytype);
+		}
+
+		for (CollectorHashTable * table : tables) {
+			if ( ! table) { continue; }
+			CollectorIndex::QueryPlan plan;
+			if (collector.planQuery(*table, query_entry->adt[ix].constraint, plan)) {
+				collectorStats.global.IndexedQueryScans += 1;
+				collectorStats.global.IndexSkippedAds += table->getNumElements() - (long)plan.NumCandidates();
+			} else {
+				collectorStats.global.FullQueryScans += 1;
+			}
+		}
+		if (whichAds == ANY_AD) { break; }
+	}
+}
+
 
 int CollectorDaemon::receive_query_cedar(int command,
 										 Stream* sock)
@@ -689,6 +748,7 @@ int CollectorDaemon::receive_query_cedar(int command,
 		goto END;
 	}
 	query_entry->sock = sock;
+	count_query_plans(query_entry);
 	is_locate = query_entry->is_locate;
 	if (is_locate) { rt.runtime = &HandleLocate_runtime; }
 
@@ -821,7 +881,7 @@ int CollectorDaemon::receive_query_cedar(int command,
 		}
 
 		// Update a few statistics
-		if ( !daemonCore->DoFakeCreateThread() ) {  // if we are configured to really fork()...
+		if ( !daemonCore->DoFakeCreateThread() && !use_query_threads ) {  // if we are configured to really fork()...
 			if (did_we_fork == TRUE) {
 				// A new worker was forked off
 				if (is_locate) { rt.runtime = &HandleLocateForked_runtime; } else { rt.runtime = &HandleQueryForked_runtime; }
@@ -853,6 +913,57 @@ END:
 }
 
 
+// Start a subscription to the ads of one type that match a query.  The
+// query ad is like that of QUERY_GENERIC_ADS: its TargetType names the
+// table, and its Requirements and Projection are honored.
+int CollectorDaemon::receive_subscription(int /*command*/, Stream* sock)
+{
+	// a subscription holds its socket open to stream changes on, which takes TCP
+	if (sock->type() != Stream::reli_sock) {
+		dprintf(D_ALWAYS, "Refusing subscription from %s, it did not come over TCP\n", sock->peer_description());
+		return FALSE;
+	}
+	ReliSock * rsock = static_cast<ReliSock*>(sock);
+	ClassAd * query = new ClassAd();
+
+	sock->decode();
+	sock->timeout(ClientTimeout);
+	if ( ! getClassAd(sock, *query) || ! sock->end_of_message()) {
+		dprintf(D_ALWAYS, "Failed to receive subscription query from %s\n", sock->peer_description());
+		delete query;
+		return FALSE;
+	}
+
+	std::string target;
+	query->LookupString(ATTR_TARGET_TYPE, target);
+	AdTypes whichAds = AdTypeStringToWhichAds(target.c_str());
+	if (whichAds == STARTD_AD) {
+		whichAds = get_realish_startd_adtype(target.c_str());
+	}
+
+	CollectorHashTable * table = nullptr;
+	if (whichAds == STARTD_PVT_AD || whichAds == ANY_AD || whichAds == BOGUS_AD) {
+		// private ads need NEGOTIATOR authorization, and Any is many tables
+	} else if (whichAds == NO_AD || whichAds == GENERIC_AD) {
+		if ( ! target.empty()) {
+			table = collector.getGenericHashTable(istring(target.c_str()));
+		}
+	} else {
+		table = collector.getHashTable(whichAds);
+	}
+	if ( ! table) {
+		dprintf(D_ALWAYS, "Refusing subscription to %s ads from %s, they can't be subscribed to\n",
+		        target.c_str(), sock->peer_description());
+		CollectorChangeFeed::Reject(rsock, "Invalid " ATTR_TARGET_TYPE);
+		delete query;
+		return FALSE;
+	}
+
+	bool skip_absent = false;
+	ExprTree * constraint = get_query_filter(query, ATTR_REQUIREMENTS, skip_absent);
+	return change_feed.Subscribe(*table, target.c_str(), query, constraint, skip_absent, rsock);
+}
+
 // Return 1 if forked a worker, 0 if not, and -1 upon an error.
 int CollectorDaemon::QueryReaper(int pid, int /* exit_status */ )
 {
@@ -863,6 +974,12 @@ int CollectorDaemon::QueryReaper(int pid, int /* exit_status */ )
 			active_query_workers--;
 		}
 		collectorStats.global.ActiveQueryWorkers = active_query_workers;
+
+		auto it = query_worker_start_times.find(pid);
+		if (it != query_worker_start_times.end()) {
+			QueryForkLatency_runtime += _condor_debug_get_time_double() - it->second;
+			query_worker_start_times.erase(it);
+		}
 	}
 
 	// Grab a queue_entry to service, ignoring "stale" (old) entries.
@@ -937,8 +1054,23 @@ int CollectorDaemon::QueryReaper(int pid, int /* exit_status */ )
 		}
 	}  // end of while queue_entry == NULL
 
-	// If we have made it here, we are allowed to fork another worker
-	// to handle the query represented by query_entry. Fork one!
+	// If we have made it here, we are allowed to start another worker
+	// to handle the query represented by query_entry.  If so configured,
+	// hand it to a query thread, otherwise fork one.
+	if (use_query_threads) {
+		Stream *sock = query_entry->sock;
+		query_entry->sock = NULL;
+		start_query_thread(query_entry, sock);
+
+		active_query_workers++;
+		collectorStats.global.ActiveQueryWorkers = active_query_workers;
+		dprintf(D_ALWAYS,
+				"QueryWorker: started new %squery thread ( max %d active %d pending %d )\n",
+				high_prio_query ? "high priority " : "",
+				max_query_workers, active_query_workers, pending_query_workers);
+		return 1;
+	}
+
 	// First stash a copy of query_entry->sock and query_entry->cad so 
 	// we can deallocate the memory associated with these after a succesfull 
 	// call to Create_Thread - we need to stash them away because DaemonCore will
@@ -946,9 +1078,11 @@ int CollectorDaemon::QueryReaper(int pid, int /* exit_status */ )
 	Stream *sock = query_entry->sock;
 	query_entry->sock = NULL;
 	ClassAd *query_classad = query_entry->cad;
+	double fork_start_time = _condor_debug_get_time_double();
 	int tid = daemonCore->
 		Create_Thread((ThreadStartFunc)&CollectorDaemon::receive_query_cedar_worker_thread,
 		    (void *)query_entry, sock, ReaperId);
+	QueryForkDispatch_runtime += _condor_debug_get_time_double() - fork_start_time;
 	if (tid == FALSE) {
 		dprintf(D_ALWAYS,
 				"ERROR: Create_Thread failed trying to fork a QueryWorker!\n");
@@ -959,6 +1093,7 @@ int CollectorDaemon::QueryReaper(int pid, int /* exit_status */ )
 	}
 
 	// If we made it here, we forked off another worker. 
+	query_worker_start_times[tid] = fork_start_time;
 
 	// Increment our count of active workers
 	active_query_workers++;
@@ -987,20 +1122,25 @@ int CollectorDaemon::QueryReaper(int pid, int /* exit_status */ )
 
 int CollectorDaemon::receive_query_cedar_worker_thread(void *in_query_entry, Stream* sock)
 {
-	int return_status = TRUE;
-	_condor_runtime runtime;
-	double tick_time = runtime.begin;
-	double query_time = 0;
-	double send_time = 0;
-
-	// Pull out relavent state from query_entry
 	pending_query_entry_t *query_entry = (pending_query_entry_t *) in_query_entry;
-	ClassAd *query = query_entry->cad;
-	bool is_locate = query_entry->is_locate;
-	bool wants_pvt_attrs = false;
-	int num_adtypes = (query_entry->num_adtypes > 0) ? query_entry->num_adtypes : 1;
-	std::deque<CollectorRecord*> results;
+	bool filter_private_attrs = query_filters_private_attrs(query_entry->cad, sock);
+
+	query_result_info info;
+	int return_status = serve_query(query_entry, sock, filter_private_attrs, nullptr, info);
+	if (info.sent) {
+		log_query_info(query_entry, sock, filter_private_attrs, info);
+	}
 
+	// All done.  Note that DaemonCore will supposedly free() the query_entry
+	// struct itself and also delete sock.
+	return return_status;
+}
+
+// Returns false if the query may be sent the private attributes of the ads.
+// This must be called on the main thread.
+bool CollectorDaemon::query_filters_private_attrs(ClassAd * query, Stream * sock)
+{
+	bool wants_pvt_attrs = false;
 	query->LookupBool(ATTR_SEND_PRIVATE_ATTRIBUTES, wants_pvt_attrs);
 
 		// If our peer is at least 8.9.3 and has NEGOTIATOR authz, then we'll
@@ -1026,6 +1166,51 @@ int CollectorDaemon::receive_query_cedar_worker_thread(void *in_query_entry, Str
 		dprintf(D_SECURITY|D_FULLDEBUG, "Administrator requesting private attributes - will not filter.\n");
 		filter_private_attrs = false;
 	}
+	return filter_private_attrs;
+}
+
+// if querying collector ads, and the collectors own ad appears in the results,
+// then we want to shove in current statistics. we do this by chaining a
+// temporary stats ad into the ad to be returned, and publishing updated
+// statistics into the stats ad.  we do this because if the verbosity level
+// is increased we do NOT want to put the high-verbosity attributes into
+// our persistent collector ad.  Returns NULL if the query wants the stored
+// statistics.  This must be called on the main thread.
+ClassAd * CollectorDaemon::make_self_stats_ad(ClassAd * query, CollectorRecordAds * self_ads, bool filter_private_attrs)
+{
+	std::string stats_config;
+	query->LookupString("STATISTICS_TO_PUBLISH",stats_config);
+	if (stats_config == "stored") {
+		return nullptr;
+	}
+	dprintf(D_ALWAYS,"Updating collector stats using a chained ad and config=%s\n", stats_config.c_str());
+	ClassAd * stats_ad = new ClassAd();
+	if (!filter_private_attrs) {
+		stats_ad->CopyFrom(*self_ads->m_pvtAd);
+	}
+	daemonCore->dc_stats.Publish(*stats_ad, stats_config.c_str());
+	daemonCore->monitor_data.ExportData(stats_ad, true);
+	collectorStats.publishGlobal(stats_ad, stats_config.c_str());
+	return stats_ad;
+}
+
+// Find and send the ads the query asks for.  If snapshot is NULL, this reads
+// the collector's tables and must run on the main thread (or in a forked
+// worker); otherwise it reads only the snapshot and can run on a query thread.
+int CollectorDaemon::serve_query(pending_query_entry_t * query_entry, Stream * sock, bool filter_private_attrs,
+	query_snapshot * snapshot, query_result_info & info)
+{
+	int return_status = TRUE;
+	_condor_runtime runtime;
+	double tick_time = runtime.begin;
+	double query_time = 0;
+	double send_time = 0;
+
+	// Pull out relavent state from query_entry
+	ClassAd *query = query_entry->cad;
+	int num_adtypes = (query_entry->num_adtypes > 0) ? query_entry->num_adtypes : 1;
+	std::deque<CollectorRecordAds*> results;
+	CollectorAdsRef self_ads = snapshot ? snapshot->self_ads : collector.getSelfAds();
 
 	// See if query ad asks for server-side projection
 	std::string projection;
@@ -1059,20 +1244,31 @@ int CollectorDaemon::receive_query_cedar_worker_thread(void *in_query_entry, Str
 		results.clear();
 
 		CollectorHashTable * table = nullptr;
-		if (whichAds == GENERIC_AD) {
+		if (snapshot) {
+			// the snapshot has only the ads of the tables the query wants
+		} else if (whichAds == GENERIC_AD) {
 			table = collector.getGenericHashTable(query_entry->adt[ix].tag);
 		} else if (whichAds != ANY_AD) {
 			table = collector.getHashTable(whichAds);
 		}
-		if (table) {
-			collector.walkHashTable (*table,
+		if (snapshot) {
+			if (ix < (int)snapshot->ads.size()) {
+				for (const CollectorAdsRef & ads : snapshot->ads[ix]) {
+					if ( ! op.query_scanAds(ads.get())) break;
+				}
+			}
+			if (whichAds == ANY_AD) {
+				num_adtypes = 1; // don't allow Any as part of a multi-table scan.
+			}
+		} else if (table) {
+			collector.walkQueryCandidates (*table, op.__filter__,
 				[&op](CollectorRecord*cr){
 					return op.query_scanFunc(cr);
 				});
 		} else if (ix==0 && whichAds == ANY_AD) {
 			std::vector<CollectorHashTable *> tables = collector.getAnyHashTables(op.__mytype__);
 			for (auto table : tables) {
-				collector.walkHashTable (*table,
+				collector.walkQueryCandidates (*table, op.__filter__,
 					[&op](CollectorRecord*cr){
 						return op.query_scanFunc(cr);
 					});
@@ -1119,31 +1315,25 @@ int CollectorDaemon::receive_query_cedar_worker_thread(void *in_query_entry, Str
 			}
 		}
 
-		for (CollectorRecord* curr_rec : results)
+		classad::MatchClassAd proj_match;
+		ClassAd proj_target;
+		for (CollectorRecordAds* curr_ads : results)
 		{
-			ClassAd* ad_to_send = filter_private_attrs ? curr_rec->m_publicAd : curr_rec->m_pvtAd;
-			// if querying collector ads, and the collectors own ad appears in this list.
-			// then we want to shove in current statistics. we do this by chaining a
-			// temporary stats ad into the ad to be returned, and publishing updated
-			// statistics into the stats ad.  we do this because if the verbosity level
-			// is increased we do NOT want to put the high-verbosity attributes into
-			// our persistent collector ad.
+			ClassAd* ad_to_send = filter_private_attrs ? curr_ads->m_publicAd : curr_ads->m_pvtAd;
+			// if querying collector ads, and the collectors own ad appears in this list,
+			// send it with current statistics chained in.
 			ClassAd * stats_ad = NULL;
-			if ((whichAds == COLLECTOR_AD) && collector.isSelfAd(curr_rec)) {
+			bool own_stats_ad = false;
+			if ((whichAds == COLLECTOR_AD) && curr_ads == self_ads.get()) {
 				dprintf(D_ALWAYS,"Query includes collector's self ad\n");
-				// update stats in the collector ad before we return it.
-				std::string stats_config;
-				query->LookupString("STATISTICS_TO_PUBLISH",stats_config);
-				if (stats_config != "stored") {
-					dprintf(D_ALWAYS,"Updating collector stats using a chained ad and config=%s\n", stats_config.c_str());
-					stats_ad = new ClassAd();
-					if (!filter_private_attrs) {
-						stats_ad->CopyFrom(*curr_rec->m_pvtAd);
-					}
-					daemonCore->dc_stats.Publish(*stats_ad, stats_config.c_str());
-					daemonCore->monitor_data.ExportData(stats_ad, true);
-					collectorStats.publishGlobal(stats_ad, stats_config.c_str());
-					stats_ad->ChainToAd(curr_rec->m_publicAd);
+				if (snapshot) {
+					stats_ad = snapshot->self_stats_ad.get();
+				} else {
+					stats_ad = make_self_stats_ad(query, curr_ads, filter_private_attrs);
+					own_stats_ad = true;
+				}
+				if (stats_ad) {
+					stats_ad->ChainToAd(curr_ads->m_publicAd);
 					ad_to_send = stats_ad; // send the stats ad instead of the self ad.
 				}
 			}
@@ -1151,7 +1341,18 @@ int CollectorDaemon::receive_query_cedar_worker_thread(void *in_query_entry, Str
 			if (evaluate_projection) {
 				active_proj->clear();
 				projection.clear();
-				if (EvalString(attr_projection.c_str(), query, curr_rec->m_publicAd, projection) && ! projection.empty()) {
+				// This may be a query thread, so use a match ad of our own rather than the
+				// one EvalString() shares, and make the target an ad chained to the one being
+				// sent, since matching sets the scope of the target and other threads may be
+				// evaluating that ad at the same time.
+				proj_target.ChainToAd(curr_ads->m_publicAd);
+				proj_match.ReplaceLeftAd(query);
+				proj_match.ReplaceRightAd(&proj_target);
+				bool have_projection = query->EvaluateAttrString(attr_projection, projection);
+				proj_match.RemoveLeftAd();
+				proj_match.RemoveRightAd();
+				proj_target.Unchain();
+				if (have_projection && ! projection.empty()) {
 					StringTokenIterator list(projection);
 					const std::string * attr;
 					while ((attr = list.next_string())) { active_proj->insert(*attr); }
@@ -1163,7 +1364,7 @@ int CollectorDaemon::receive_query_cedar_worker_thread(void *in_query_entry, Str
 
 			if (stats_ad) {
 				stats_ad->Unchain();
-				delete stats_ad;
+				if (own_stats_ad) { delete stats_ad; }
 			}
 
 			if (send_failed)
@@ -1207,26 +1408,151 @@ int CollectorDaemon::receive_query_cedar_worker_thread(void *in_query_entry, Str
 
 	send_time += runtime.tick(tick_time);
 
+	info.matched = op.__numAds__;
+	info.skipped = op.__failed__ + op.__absent__;
+	info.query_time = query_time;
+	info.send_time = send_time;
+	info.filter = op.__filter__;
+	info.limit = op.__resultLimit__;
+	info.projection = projection;
+	info.sent = true;
+
+END:
+	return return_status;
+}
+
+void CollectorDaemon::log_query_info(const pending_query_entry_t * query_entry, Stream * sock, bool filter_private_attrs,
+	const query_result_info & info)
+{
 	dprintf (D_ALWAYS,
 			 "Query info: matched=%d; skipped=%d; query_time=%f; send_time=%f; type=%s; requirements={%s}; locate=%d; limit=%d; from=%s; peer=%s; projection={%s}; filter_private_attrs=%d\n",
-			 op.__numAds__,
-			 op.__failed__ + op.__absent__,
-			 query_time,
-			 send_time,
+			 info.matched,
+			 info.skipped,
+			 info.query_time,
+			 info.send_time,
 			 query_entry->label ? query_entry->label : "?",
-			 op.__filter__ ? ExprTreeToString(op.__filter__) : "",
-			 is_locate,
-			 (op.__resultLimit__ == INT_MAX) ? 0 : op.__resultLimit__,
+			 info.filter ? ExprTreeToString(info.filter) : "",
+			 query_entry->is_locate,
+			 (info.limit == INT_MAX) ? 0 : info.limit,
 			 query_entry->subsys,
 			 sock->peer_description(),
-			 projection.c_str(),
+			 info.projection.c_str(),
 			 filter_private_attrs);
-END:
-	
-	// All done.  Deallocate memory allocated in this method.  Note that DaemonCore 
-	// will supposedly free() the query_entry struct itself and also delete sock.
+}
 
-	return return_status;
+// Serve a query on a query thread, from a snapshot of the ads it might
+// want.  Returns false if the query could not be handed to a thread,
+// in which case the caller still owns the query entry and socket.
+bool CollectorDaemon::start_query_thread(pending_query_entry_t * query_entry, Stream * sock)
+{
+	double start_time = _condor_debug_get_time_double();
+
+	query_snapshot * snapshot = new query_snapshot;
+	snapshot->query_entry = query_entry;
+	snapshot->sock = sock;
+	snapshot->start_time = start_time;
+	snapshot->filter_private_attrs = query_filters_private_attrs(query_entry->cad, sock);
+
+	int num_adtypes = (query_entry->num_adtypes > 0) ? query_entry->num_adtypes : 1;
+	snapshot->ads.resize(num_adtypes);
+	for (int ix = 0; ix < num_adtypes; ++ix) {
+		const AdTypes whichAds = (AdTypes) query_entry->adt[ix].whichAds;
+		ExprTree * constraint = query_entry->adt[ix].constraint;
+		std::vector<CollectorAdsRef> & ads = snapshot->ads[ix];
+
+		CollectorHashTable * table = nullptr;
+		if (whichAds == GENERIC_AD) {
+			table = collector.getGenericHashTable(query_entry->adt[ix].tag);
+		} else if (whichAds != ANY_AD) {
+			table = collector.getHashTable(whichAds);
+		}
+		if (table) {
+			collector.snapshotQueryCandidates(*table, constraint, ads);
+		} else if (ix == 0 && whichAds == ANY_AD) {
+			const char * mytype = (query_entry->adt[ix].match_mytype) ? query_entry->adt[ix].tag : nullptr;
+			for (auto table : collector.getAnyHashTables(mytype)) {
+				collector.snapshotQueryCandidates(*table, constraint, ads);
+			}
+			break;
+		} else {
+			dprintf (D_ALWAYS, "Error no collector table for %s\n", query_entry->adt[ix].tag);
+		}
+
+		if (whichAds == COLLECTOR_AD && ! snapshot->self_ads) {
+			snapshot->self_ads = collector.getSelfAds();
+			if (snapshot->self_ads) {
+				snapshot->self_stats_ad.reset(make_self_stats_ad(query_entry->cad, snapshot->self_ads.get(), snapshot->filter_private_attrs));
+			}
+		}
+	}
+
+	{
+		std::lock_guard<std::mutex> guard(query_threads.lock);
+		query_threads.queue.push_back(snapshot);
+		// start another thread unless there is one waiting for work
+		if (query_threads.idle < (int)query_threads.queue.size()) {
+			std::thread(query_thread_main).detach();
+			++query_threads.threads;
+			++query_threads.idle;
+			dprintf(D_FULLDEBUG, "QueryWorker: started query thread %d\n", query_threads.threads);
+		}
+	}
+	query_threads.cv.notify_one();
+
+	QueryThreadDispatch_runtime += _condor_debug_get_time_double() - start_time;
+	return true;
+}
+
+// The body of each query thread: serve the queries handed to it, forever.
+void CollectorDaemon::query_thread_main()
+{
+	for (;;) {
+		query_snapshot * snapshot = nullptr;
+		{
+			std::unique_lock<std::mutex> guard(query_threads.lock);
+			query_threads.cv.wait(guard, []{ return ! query_threads.queue.empty(); });
+			snapshot = query_threads.queue.front();
+			query_threads.queue.pop_front();
+			--query_threads.idle;
+		}
+
+		snapshot->return_status = serve_query(snapshot->query_entry, snapshot->sock,
+			snapshot->filter_private_attrs, snapshot, snapshot->info);
+
+		{
+			std::lock_guard<std::mutex> guard(query_threads.lock);
+			++query_threads.idle;
+		}
+		daemonCore->Register_PumpWork_TS(query_thread_done, nullptr, snapshot);
+	}
+}
+
+// Called on the main thread when a query thread is done with a query.
+int CollectorDaemon::query_thread_done(void * /*cls*/, void * data)
+{
+	query_snapshot * snapshot = (query_snapshot *)data;
+	pending_query_entry_t * query_entry = snapshot->query_entry;
+
+	if (snapshot->info.sent) {
+		log_query_info(query_entry, snapshot->sock, snapshot->filter_private_attrs, snapshot->info);
+	}
+	QueryThreadLatency_runtime += _condor_debug_get_time_double() - snapshot->start_time;
+
+	// release the ads here, on the main thread, which may be the last to refer to them
+	delete snapshot->sock;
+	delete query_entry->cad;
+	free(query_entry);
+	delete snapshot;
+
+	dprintf(D_FULLDEBUG, "QueryWorker: thread done with query\n");
+	if (active_query_workers > 0 ) {
+		active_query_workers--;
+	}
+	collectorStats.global.ActiveQueryWorkers = active_query_workers;
+
+	// serve the next pending query, if any
+	QueryReaper(-1, -1);
+	return 0;
 }
 
 AdTypes
@@ -1513,6 +1839,16 @@ int CollectorDaemon::receive_update(int command, Stream* sock)
 			// which already does all the necessary logging.
 		}
 
+		if (insert == -5)
+		{
+			// A delta update that does not follow the ad we have. The
+			// collector engine has asked the startd for whole ads, which
+			// are likely to come on this same socket.
+			if( sock->type() == Stream::reli_sock ) {
+				return stashSocket( (ReliSock *)sock );
+			}
+		}
+
 		return FALSE;
 
 	}
@@ -1520,8 +1856,17 @@ int CollectorDaemon::receive_update(int command, Stream* sock)
 	CollectorEngine_ru_collect_runtime += rt.tick(rt_last);
 #endif
 
+	// from here on, a delta update is an update of the merged ad
+	if (command == UPDATE_STARTD_AD_DELTA) {
+		command = UPDATE_STARTD_AD;
+	}
+
 	/* let the off-line plug-in have at it */
-	offline_plugin_.update ( command, *record->m_publicAd );
+	if (offline_plugin_.enabled()) {
+		record->MakeWritable();
+		offline_plugin_.update ( command, *record->m_publicAd );
+		record->Reindex();
+	}
 
 #if defined(UNIX) && !defined(DARWIN)
 	// JEF TODO Should we use the private ad here?
@@ -1661,7 +2006,11 @@ int CollectorDaemon::receive_update_expect_ack(int command,
     }
 
 	if(record) {
-		offline_plugin_.update ( command, *record->m_publicAd );
+		if (offline_plugin_.enabled()) {
+			record->MakeWritable();
+			offline_plugin_.update ( command, *record->m_publicAd );
+			record->Reindex();
+		}
 
 #if defined(UNIX) && !defined(DARWIN)
 		// JEF TODO Should we use the private ad here?
@@ -1714,9 +2063,9 @@ CollectorDaemon::stashSocket( ReliSock* sock )
 	return KEEP_STREAM;
 }
 
-int CollectorDaemon::collect_op::query_scanFunc (CollectorRecord *record)
+int CollectorDaemon::collect_op::query_scanAds (CollectorRecordAds *ads)
 {
-	ClassAd* cad = record->m_publicAd;
+	ClassAd* cad = ads->m_publicAd;
 
 	if (__mytype__ && MATCH != strcasecmp(__mytype__, GetMyTypeName(*cad))) {
 		return 1;
@@ -1734,7 +2083,7 @@ int CollectorDaemon::collect_op::query_scanFunc (CollectorRecord *record)
 		} else {
 			// Found a match
 			__numAds__++;
-			__results__->push_back(record);
+			__results__->push_back(ads);
 			if (__numAds__ >= __resultLimit__) {
 				rc = 0; // tell it to stop iterating, we have all the results we want
 			}
@@ -1754,16 +2103,17 @@ int CollectorDaemon::collect_op::query_scanFunc (CollectorRecord *record)
 //
 int CollectorDaemon::collect_op::expiration_scanFunc (CollectorRecord *record)
 {
-    return setAttrLastHeardFrom( record->m_publicAd, 1 );
+    return setAttrLastHeardFrom( record, 1 );
 }
 
 int CollectorDaemon::collect_op::invalidation_scanFunc (CollectorRecord *record)
 {
-    return setAttrLastHeardFrom( record->m_publicAd, 0 );
+    return setAttrLastHeardFrom( record, 0 );
 }
 
-int CollectorDaemon::collect_op::setAttrLastHeardFrom (ClassAd* cad, unsigned long time)
+int CollectorDaemon::collect_op::setAttrLastHeardFrom (CollectorRecord* record, unsigned long time)
 {
+	ClassAd* cad = record->m_publicAd;
 	if (__mytype__) {
 		std::string type = "";
 		cad->LookupString( ATTR_MY_TYPE, type );
@@ -1777,7 +2127,9 @@ int CollectorDaemon::collect_op::setAttrLastHeardFrom (ClassAd* cad, unsigned lo
 	if ( EvalExprToBool( __filter__, cad, NULL, result ) &&
 		 result.IsBooleanValueEquiv(val) && val ) {
 
-		cad->Assign( ATTR_LAST_HEARD_FROM, time );
+		record->MakeWritable();
+		record->m_publicAd->Assign( ATTR_LAST_HEARD_FROM, time );
+		record->Reindex( ATTR_LAST_HEARD_FROM );
         __numAds__++;
     }
 
@@ -2014,6 +2366,12 @@ void CollectorDaemon::Config()
 		tmp = NULL;
 	}
 
+	std::string index_attrs;
+	param(index_attrs, "COLLECTOR_QUERY_INDEXES");
+	collector.setQueryIndexes(split(index_attrs));
+
+	change_feed.Config();
+
 	init_classad(i);
 
     // set the appropriate parameters in the collector engine
@@ -2110,6 +2468,11 @@ void CollectorDaemon::Config()
 	max_pending_query_workers = param_integer ("COLLECTOR_QUERY_WORKERS_PENDING", 50, 0);
 	max_query_worktime = param_integer("COLLECTOR_QUERY_MAX_WORKTIME",0,0);
 	reserved_for_highprio_query_workers = param_integer("COLLECTOR_QUERY_WORKERS_RESERVE_FOR_HIGH_PRIO",1,0);
+	use_query_threads = param_boolean("COLLECTOR_QUERY_USE_THREADS", false);
+	if (use_query_threads) {
+		// query threads log, so logging must be thread safe from now on
+		dprintf_make_thread_safe();
+	}
 
 	// max_query_workers had better be at least one greater than reserved_for_highprio_query_workers,
 	// or condor_status queries will never be answered.
@@ -22,11 +22,14 @@
 
 #include <vector>
 #include <queue>
+#include <map>
+#include <memory>
 
 #include "condor_classad.h"
 #include "forkwork.h"
 
 #include "collector_engine.h"
+#include "collector_feed.h"
 #include "collector_stats.h"
 #include "dc_collector.h"
 #include "offline_plugin.h"
@@ -77,10 +80,11 @@ public:
 	static int receive_invalidation(int, Stream*);
 	static int receive_update(int, Stream*);
     static int receive_update_expect_ack(int, Stream*);
+	static int receive_subscription(int, Stream*);
 
 	struct collect_op {
 		ClassAd* __query__ = nullptr;
-		std::deque<CollectorRecord*> * __results__;
+		std::deque<CollectorRecordAds*> * __results__;
 		ExprTree *__filter__ = nullptr;
 		const char * __mytype__ = nullptr; // implicit filter, if non-null return only ads with this mytype
 		bool __skip_absent__ = false; // implicit filter
@@ -90,11 +94,12 @@ public:
 		int __absent__ = 0;
 
 		//void process_query_public(AdTypes, ClassAd *query, std::deque<CollectorRecord*> * results);
-		int query_scanFunc(CollectorRecord*);
+		int query_scanFunc(CollectorRecord* record) { return query_scanAds(record->m_ads.get()); }
+		int query_scanAds(CollectorRecordAds*);
 		void process_invalidation(AdTypes, ClassAd&, Stream*);
 		int invalidation_scanFunc(CollectorRecord*);
 		int expiration_scanFunc(CollectorRecord*);
-		int setAttrLastHeardFrom( ClassAd* cad, unsigned long time );
+		int setAttrLastHeardFrom( CollectorRecord* record, unsigned long time );
 	};
 	static ClassAd * process_global_query( const char *constraint, void *arg );
 	static int select_by_match( ClassAd *cad );
@@ -160,6 +165,44 @@ public:
 	} pending_query_entry_t;
 	static pending_query_entry_t * make_query_entry(AdTypes whichAds, ClassAd * query, bool allow_pvt=false);
 	static ExprTree * get_query_filter(ClassAd* query, const std::string & attr, bool & skip_absent);
+	static void count_query_plans(const pending_query_entry_t * query_entry);
+
+	// how a query went, for the log
+	struct query_result_info {
+		int matched = 0;
+		int skipped = 0;
+		double query_time = 0;
+		double send_time = 0;
+		ExprTree * filter = nullptr;
+		int limit = INT_MAX;
+		std::string projection;
+		bool sent = false;
+	};
+
+	// the ads a query thread looks at, and what it needs from the main thread to send them.
+	// the references keep the ads alive and unchanged while the main thread goes on
+	// updating the tables; see CollectorRecord::MakeWritable().
+	struct query_snapshot {
+		pending_query_entry_t * query_entry = nullptr;
+		Stream * sock = nullptr;
+		bool filter_private_attrs = true;
+		std::vector<std::vector<CollectorAdsRef>> ads; // for each adtype of the query
+		CollectorAdsRef self_ads;
+		std::unique_ptr<ClassAd> self_stats_ad;  // stats to send in place of self_ads, if any
+		double start_time = 0;
+		int return_status = FALSE;
+		query_result_info info;
+	};
+
+	static bool query_filters_private_attrs(ClassAd * query, Stream * sock);
+	static ClassAd * make_self_stats_ad(ClassAd * query, CollectorRecordAds * self_ads, bool filter_private_attrs);
+	static int serve_query(pending_query_entry_t * query_entry, Stream * sock, bool filter_private_attrs,
+	                       query_snapshot * snapshot, query_result_info & info);
+	static void log_query_info(const pending_query_entry_t * query_entry, Stream * sock, bool filter_private_attrs,
+	                           const query_result_info & info);
+	static bool start_query_thread(pending_query_entry_t * query_entry, Stream * sock);
+	static void query_thread_main();
+	static int query_thread_done(void * cls, void * data);
 
 	static std::queue<pending_query_entry_t *> query_queue_high_prio;
 	static std::queue<pending_query_entry_t *> query_queue_low_prio;
@@ -171,6 +214,8 @@ public:
 	static int reserved_for_highprio_query_workers; // from config file
 	static int active_query_workers;
 	static int pending_query_workers;
+	static bool use_query_threads;  // from config file
+	static std::map<int, double> query_worker_start_times; // of the forked workers, by pid
 
 #ifdef TRACK_QUERIES_BY_SUBSYS
 	static bool want_track_queries_by_subsys;
@@ -180,6 +225,7 @@ public:
 protected:
 	static CollectorStats collectorStats;
 	static CollectorEngine collector;
+	static CollectorChangeFeed change_feed;
 	static Timeslice view_sock_timeslice;
     static std::vector<vc_entry> vc_list;
 	static ConstraintHolder vc_projection;
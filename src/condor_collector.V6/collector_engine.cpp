@@ -28,11 +28,14 @@
 #include "condor_attributes.h"
 #include "condor_daemon_core.h"
 #include "classad_merge.h"
+#include "daemon.h"
+#include "dc_message.h"
 #include <algorithm>
 //-------------------------------------------------------------
 
 #include "collector.h"
 #include "collector_engine.h"
+#include "collector_feed.h"
 
 // Map of *_ADTYPE string to a whichAds (i.e. which collector table enum value)
 // This returns return a std::array at compile time that other
@@ -114,8 +117,7 @@ CollectorEngine::CollectorEngine (CollectorStats *stats ) :
 	NegotiatorAds (&adNameHashFunction),
 	HadAds        (&adNameHashFunction),
 	GridAds       (&adNameHashFunction),
-	GenericAds    (&hashFunction),
-	__self_ad__(0)
+	GenericAds    (&hashFunction)
 {
 	clientTimeout = 20;
 	machineUpdateInterval = 30;
@@ -288,6 +290,7 @@ CollectorEngine::invalidateAds(CollectorHashTable *table, const char *targetType
 						"\t\t**** Invalidating ad: \"%s\"\n",
 						hkString.c_str());
 				delete record;
+				adChanged(*table, hk);
 				count++;
 			}
 		}
@@ -408,6 +411,56 @@ walkHashTable (AdTypes adType, int (*scanFunction)(CollectorRecord *))
 }
 #endif
 
+void
+CollectorEngine::setQueryIndexes(const std::vector<std::string> & attrs)
+{
+	if (attrs == m_indexAttrs) {
+		return;
+	}
+
+	// records remove themselves from their old index when it is deleted
+	m_indexes.clear();
+	m_indexAttrs = attrs;
+	if (m_indexAttrs.empty()) {
+		dprintf(D_ALWAYS, "Collector query indexes disabled\n");
+		return;
+	}
+
+	std::string attr_list = join(m_indexAttrs, ",");
+	dprintf(D_ALWAYS, "Indexing collector ads by %s\n", attr_list.c_str());
+
+	std::vector<CollectorHashTable *> tables = getAnyHashTables();
+	tables.push_back(&StartdPrivateAds);
+	for (CollectorHashTable * table : tables) {
+		CollectorIndex * index = getIndex(*table);
+		walkHashTable(*table, [index](CollectorRecord * record) {
+			index->Insert(record);
+			return 1;
+		});
+	}
+}
+
+CollectorIndex *
+CollectorEngine::getIndex(CollectorHashTable & table)
+{
+	if (m_indexAttrs.empty()) {
+		return nullptr;
+	}
+	std::unique_ptr<CollectorIndex> & index = m_indexes[&table];
+	if ( ! index) {
+		index.reset(new CollectorIndex(m_indexAttrs));
+	}
+	return index.get();
+}
+
+void
+CollectorEngine::adChanged(CollectorHashTable & table, const AdNameHashKey & hk)
+{
+	if (m_changeFeed) {
+		m_changeFeed->AdChanged(table, hk);
+	}
+}
+
 CollectorHashTable *CollectorEngine::findOrCreateTable(const istring &type)
 {
 	CollectorHashTable *table=0;
@@ -528,6 +581,7 @@ bool CollectorEngine::ValidateClassAd(int command,ClassAd *clientAd,Sock *sock)
 	  case MERGE_STARTD_AD:
 	  case UPDATE_STARTD_AD:
 	  case UPDATE_STARTD_AD_WITH_ACK:
+	  case UPDATE_STARTD_AD_DELTA:
 		  ipattr = ATTR_STARTD_IP_ADDR;
 		  break;
 	  case UPDATE_OWN_SUBMITTOR_AD:
@@ -805,6 +859,41 @@ collect (int command,ClassAd *clientAd,const condor_sockaddr& from,int &insert,S
 							  clientAd, hk, hashString, insert, from );
 		break;
 
+	  case UPDATE_STARTD_AD_DELTA:
+		if (!makeStartdAdHashKey (hk, clientAd))
+		{
+			dprintf (D_ALWAYS, "Could not make hashkey --- ignoring ad\n");
+			insert = -3;
+			retVal = nullptr;
+			break;
+		}
+		hk.sprint(hashString);
+		retVal=applyDeltaClassAd (StartdSlotAds, "MachineSlotAd", "Slot",
+							  clientAd, hk, hashString, insert );
+		if ( ! retVal) {
+			requestFullUpdate(*clientAd, hashString);
+			insert = -5;
+			break;
+		}
+
+		// the private ad is sent whole
+		if (sock) {
+			pvtAd = new ClassAd;
+			if( !getClassAdEx(sock, *pvtAd, m_get_ad_options) )
+			{
+				dprintf(D_FULLDEBUG,"\t(Could not get startd's private ad)\n");
+				delete pvtAd;
+				break;
+			}
+			CopyAttribute( ATTR_MY_TYPE, *pvtAd, *retVal->m_publicAd );
+			CopyAttribute( ATTR_MY_ADDRESS, *pvtAd, *retVal->m_publicAd );
+			CopyAttribute( ATTR_NAME, *pvtAd, *retVal->m_publicAd );
+			(void) updateClassAd (StartdPrivateAds, "MachinePvtAd ", "MachinePvt", true,
+								  pvtAd, hk, hashString, insPvt,
+								  from );
+		}
+		break;
+
 	  case UPDATE_SCHEDD_AD:
 		if (!makeScheddAdHashKey (hk, clientAd))
 		{
@@ -1074,10 +1163,12 @@ int CollectorEngine::remove(CollectorHashTable * table, AdNameHashKey &hk, AdTyp
 				dprintf (D_ALWAYS,"\t\t**** Removed(%d) %s (sim) ad: \"%s\"\n",
 					num, STARTD_DAEMON_ADTYPE, hkString.c_str() );
 				delete daemon;
+				adChanged(StartdDaemonAds, hk);
 			}
 		}
 
 		delete record;
+		adChanged(*table, hk);
 	}
 	return iRet;
 }
@@ -1114,9 +1205,13 @@ int CollectorEngine::expire(CollectorHashTable * hTable, AdNameHashKey & hKey) {
 	int rVal = 0;
 	CollectorRecord* record = nullptr;
 	if( hTable->lookup( hKey, record ) != -1 ) {
+		record->MakeWritable();
 		record->m_publicAd->Assign( ATTR_LAST_HEARD_FROM, 1 );
 
 		if( CollectorDaemon::offline_plugin_.expire( * record->m_publicAd ) == true ) {
+			record->m_publicAd->Assign( ATTR_COLLECTOR_CHANGE_TIME, time(nullptr) );
+			record->Reindex();
+			adChanged(*hTable, hKey);
 			return rVal;
 		}
 
@@ -1132,6 +1227,7 @@ int CollectorEngine::expire(CollectorHashTable * hTable, AdNameHashKey & hKey) {
 		dprintf( D_ALWAYS, "\t\t**** Removed(%d) stale ad(s): \"%s\"\n", rVal, hkString.c_str() );
 
 		delete record;
+		adChanged(*hTable, hKey);
 	}
 	return rVal;
 }
@@ -1164,14 +1260,13 @@ remove (AdTypes adType, AdNameHashKey &hk)
 	if (!LookupByAdType(adType, table, func)) {
 		return 0;
 	}
-	return !table->remove(hk);
+	if (table->remove(hk) != 0) {
+		return 0;
+	}
+	adChanged(*table, hk);
+	return 1;
 }
 
-void CollectorEngine::
-identifySelfAd(CollectorRecord * ad)
-{
-	__self_ad__ = (void*)ad;
-}
 
 extern bool   last_updateClassAd_was_insert;
 
@@ -1204,6 +1299,7 @@ updateClassAd (CollectorHashTable &hashTable,
 		}	
 		ad->Assign(ATTR_LAST_HEARD_FROM, now);
 	}
+	ad->Assign(ATTR_COLLECTOR_CHANGE_TIME, time(nullptr));
 
 	// this time stamped ad is the new ad
 	new_ad = ad;
@@ -1230,6 +1326,10 @@ updateClassAd (CollectorHashTable &hashTable,
 		{
 			EXCEPT ("Error inserting ad (out of memory)");
 		}
+		if (CollectorIndex * index = getIndex(hashTable)) {
+			index->Insert(record);
+		}
+		adChanged(hashTable, hk);
 
 		insert = 1;
 
@@ -1278,6 +1378,7 @@ updateClassAd (CollectorHashTable &hashTable,
 
 		// Now, finally, store the new ClassAd
 		record->ReplaceAds(new_ad, new_pvt_ad);
+		adChanged(hashTable, hk);
 
 		insert = 0;
 		return record;
@@ -1319,17 +1420,142 @@ mergeClassAd (CollectorHashTable &hashTable,
 		new_ad_copy.Delete(ATTR_MY_TYPE);
 		new_ad_copy.Delete(ATTR_TARGET_TYPE);
 
+			// The merge changes the ad, but is not an update from the daemon,
+			// so LastHeardFrom stays as it is.
+		new_ad_copy.Assign(ATTR_COLLECTOR_CHANGE_TIME, time(nullptr));
+
 		ClassAd new_pvt_ad;
 		movePrivateAttrs(new_ad_copy, new_pvt_ad);
 
 		// Now, finally, merge the new ClassAd into the old one
+		record->MakeWritable();
 		MergeClassAds(record->m_publicAd, &new_ad_copy, true);
 		MergeClassAds(record->m_pvtAd, &new_pvt_ad, true);
+		record->Reindex();
+		adChanged(hashTable, hk);
 	}
 	delete new_ad;
 	return record;
 }
 
+CollectorRecord * CollectorEngine::
+applyDeltaClassAd (CollectorHashTable &hashTable,
+			   const char *adType,
+			   const char *label,
+			   ClassAd *delta_ad,
+			   AdNameHashKey &hk,
+			   const std::string &hashString,
+			   int  &insert )
+{
+	CollectorRecord* record = nullptr;
+
+	insert = 0;
+
+	if ( hashTable.lookup (hk, record) == -1)
+	{
+		dprintf (D_ALWAYS, "%s: Cannot apply delta update for ** \"%s\" because "
+				 "no existing ad matches.\n", adType, hashString.c_str() );
+		return nullptr;
+	}
+
+	// the delta applies only to the ad of the update right before it
+	ClassAd *old_ad = record->m_publicAd;
+	long long new_seq = 0, old_seq = 0;
+	time_t new_stime = 0, old_stime = 0;
+	if ( ! delta_ad->LookupInteger( ATTR_UPDATE_SEQUENCE_NUMBER, new_seq ) ||
+		 ! old_ad->LookupInteger( ATTR_UPDATE_SEQUENCE_NUMBER, old_seq ) ||
+		 ! delta_ad->LookupInteger( ATTR_DAEMON_START_TIME, new_stime ) ||
+		 ! old_ad->LookupInteger( ATTR_DAEMON_START_TIME, old_stime ) ||
+		 new_stime != old_stime || new_seq != old_seq + 1 )
+	{
+		dprintf (D_ALWAYS, "%s: Cannot apply delta update %lld for \"%s\" to update %lld\n",
+				 adType, new_seq, hashString.c_str(), old_seq );
+		return nullptr;
+	}
+
+	dprintf (D_FULLDEBUG, "%s: Applying delta update of %d attributes for ... \"%s\"\n",
+			 adType, (int)delta_ad->size(), hashString.c_str() );
+
+	collectorStats->update( label, old_ad, delta_ad );
+	collectorStats->global.DeltaUpdates += 1;
+
+	time_t now = time(nullptr);
+	delta_ad->Assign(ATTR_LAST_HEARD_FROM, now);
+	delta_ad->Assign(ATTR_COLLECTOR_CHANGE_TIME, now);
+
+	// the delta can't change what kind of ad this is
+	delta_ad->Delete(ATTR_MY_TYPE);
+	delta_ad->Delete(ATTR_TARGET_TYPE);
+
+	std::string removed;
+	if (delta_ad->LookupString(ATTR_UPDATE_DELTA_REMOVED_ATTRS, removed)) {
+		delta_ad->Delete(ATTR_UPDATE_DELTA_REMOVED_ATTRS);
+	}
+
+	if ( m_forwardFilteringEnabled ) {
+		bool forward = false;
+		time_t last_forwarded = 0;
+		old_ad->LookupInteger( ATTR_LAST_FORWARDED, last_forwarded );
+		if ( last_forwarded + m_forwardInterval < now ) {
+			forward = true;
+		} else {
+			for (const auto& attr : m_forwardWatchList) {
+				if (delta_ad->Lookup(attr)) {
+					forward = true;
+					break;
+				}
+			}
+		}
+		delta_ad->Assign( ATTR_SHOULD_FORWARD, forward );
+		delta_ad->Assign( ATTR_LAST_FORWARDED, forward ? now : last_forwarded );
+	}
+
+	ClassAd pvt_delta;
+	movePrivateAttrs(*delta_ad, pvt_delta);
+
+	record->MakeWritable();
+	for (const auto & attr : StringTokenIterator(removed)) {
+		record->m_publicAd->Delete(attr);
+		record->m_pvtAd->Delete(attr);
+	}
+	record->m_publicAd->Update(*delta_ad);
+	record->m_pvtAd->Update(pvt_delta);
+	record->Reindex();
+	adChanged(hashTable, hk);
+
+	delete delta_ad;
+	return record;
+}
+
+void CollectorEngine::
+requestFullUpdate (ClassAd &delta_ad, const std::string &hashString)
+{
+	std::string addr;
+	if ( ! delta_ad.LookupString(ATTR_MY_ADDRESS, addr)) {
+		return;
+	}
+
+	// every slot of the startd is likely to fail the same way, but we only
+	// have to ask once, since the startd sends all of its slot ads whole.
+	time_t now = time(nullptr);
+	time_t & last_request = m_fullUpdateRequests[addr];
+	if (last_request + FULL_UPDATE_REQUEST_HOLDOFF > now) {
+		return;
+	}
+	last_request = now;
+	collectorStats->global.DeltaUpdatesRejected += 1;
+
+	dprintf (D_ALWAYS, "Asking startd %s to send whole slot ads, because of \"%s\"\n",
+			 addr.c_str(), hashString.c_str() );
+
+	ClassAd request;
+	CopyAttribute(ATTR_NAME, request, delta_ad);
+	classy_counted_ptr<Daemon> startd = new Daemon(DT_STARTD, addr.c_str());
+	classy_counted_ptr<ClassAdMsg> msg = new ClassAdMsg(SEND_FULL_STARTD_UPDATE, request);
+	msg->setTimeout(clientTimeout);
+	startd->sendMsg(msg.get());
+}
+
 
 void
 CollectorEngine::
@@ -1347,6 +1573,14 @@ housekeeper( int /* timerID */ )
 
 	dprintf (D_ALWAYS, "Housekeeper:  Ready to clean old ads\n");
 
+	for (auto it = m_fullUpdateRequests.begin(); it != m_fullUpdateRequests.end(); ) {
+		if (it->second + FULL_UPDATE_REQUEST_HOLDOFF <= now) {
+			it = m_fullUpdateRequests.erase(it);
+		} else {
+			++it;
+		}
+	}
+
 	// TODO: clean StartdSlotAds, StartdPrivateAds and StartdDaemon ads in a single pass
 	// to make sure that the tables stay in sync?
 
@@ -1403,7 +1637,7 @@ housekeeper( int /* timerID */ )
 }
 
 void CollectorEngine::
-cleanHashTable (CollectorHashTable &hashTable, time_t now, HashFunc makeKey) const
+cleanHashTable (CollectorHashTable &hashTable, time_t now, HashFunc makeKey)
 {
 	CollectorRecord *record;
 	int             timeStamp;
@@ -1443,8 +1677,12 @@ cleanHashTable (CollectorHashTable &hashTable, time_t now, HashFunc makeKey) con
 				   potentially mark the ad absent. if expire() returns false, then delete
 				   the ad as planned; if it return true, it was likely marked as absent,
 				   so then this ad should NOT be deleted. */
+				record->MakeWritable();
 				if ( CollectorDaemon::offline_plugin_.expire( *record->m_publicAd ) == true ) {
 					// plugin say to not delete this ad, so continue
+					record->m_publicAd->Assign( ATTR_COLLECTOR_CHANGE_TIME, now );
+					record->Reindex();
+					adChanged(hashTable, hk);
 					continue;
 				} else {
 					dprintf (D_ALWAYS,"\t\t**** Removing stale ad: \"%s\"\n", hkString.c_str() );
@@ -1455,6 +1693,7 @@ cleanHashTable (CollectorHashTable &hashTable, time_t now, HashFunc makeKey) con
 				dprintf (D_ALWAYS, "\t\tError while removing ad\n");
 			}
 			delete record;
+			adChanged(hashTable, hk);
 		}
 	}
 }
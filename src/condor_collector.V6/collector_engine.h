@@ -23,19 +23,49 @@
 #include "condor_classad.h"
 
 #include "collector_stats.h"
+#include "collector_index.h"
 #include "hashkey.h"
 
-struct CollectorRecord
+#include <memory>
+
+class CollectorChangeFeed;
+
+// The ads of a CollectorRecord. Query threads hold references to these
+// while they work, so they must not be changed while anything but the
+// record refers to them; see CollectorRecord::MakeWritable().
+struct CollectorRecordAds
 {
-	CollectorRecord(ClassAd* public_ad, ClassAd* pvt_ad)
+	CollectorRecordAds(ClassAd* public_ad, ClassAd* pvt_ad)
 		: m_publicAd(public_ad), m_pvtAd(pvt_ad) { m_pvtAd->ChainToAd(m_publicAd); }
-	~CollectorRecord() { delete m_publicAd; delete m_pvtAd; }
-	void ReplaceAds(ClassAd* public_ad, ClassAd* pvt_ad)
-	{ delete m_publicAd; delete m_pvtAd; m_publicAd=public_ad; m_pvtAd=pvt_ad; m_pvtAd->ChainToAd(m_publicAd); }
+	~CollectorRecordAds() { delete m_publicAd; delete m_pvtAd; }
+	CollectorRecordAds(const CollectorRecordAds &) = delete;
+	CollectorRecordAds & operator=(const CollectorRecordAds &) = delete;
 
 	ClassAd* m_publicAd;
 	ClassAd* m_pvtAd;
 };
+typedef std::shared_ptr<CollectorRecordAds> CollectorAdsRef;
+
+struct CollectorRecord
+{
+	CollectorRecord(ClassAd* public_ad, ClassAd* pvt_ad)
+		: m_ads(std::make_shared<CollectorRecordAds>(public_ad, pvt_ad))
+		, m_publicAd(public_ad), m_pvtAd(pvt_ad), m_index(nullptr) {}
+	~CollectorRecord() { if (m_index) { m_index->Remove(this); } }
+	void ReplaceAds(ClassAd* public_ad, ClassAd* pvt_ad)
+	{ m_ads = std::make_shared<CollectorRecordAds>(public_ad, pvt_ad); m_publicAd=public_ad; m_pvtAd=pvt_ad; Reindex(); }
+	// call before changing the ads in place, copies them if a query is using them
+	void MakeWritable() {
+		if (m_ads.use_count() > 1) { ReplaceAds(new ClassAd(*m_publicAd), new ClassAd(*m_pvtAd)); }
+	}
+	// call after changing the public ad in place, or just attr of it
+	void Reindex(const char * attr = nullptr) { if (m_index) { m_index->Update(this, attr); } }
+
+	CollectorAdsRef m_ads;
+	ClassAd* m_publicAd; // same as m_ads->m_publicAd
+	ClassAd* m_pvtAd;    // same as m_ads->m_pvtAd
+	CollectorIndex* m_index; // the index of the table this is in, if any
+};
 
 // type for the hash tables ...
 typedef HashTable <AdNameHashKey, CollectorRecord *> CollectorHashTable;
@@ -103,6 +133,45 @@ class CollectorEngine : public Service
 
 	std::vector<CollectorHashTable *> getAnyHashTables(const char * mytype = nullptr);
 
+	// set the attributes to index the ads of every table by, and
+	// rebuild the indexes if they changed.
+	void setQueryIndexes(const std::vector<std::string> & attrs);
+
+	// the index of a table, or null if no attributes are indexed
+	CollectorIndex * getIndex(CollectorHashTable & table);
+
+	// plan a query of the table with the given constraint, returns
+	// false if the table must be scanned.
+	bool planQuery(CollectorHashTable & table, ExprTree * constraint, CollectorIndex::QueryPlan & plan) {
+		CollectorIndex * index = getIndex(table);
+		return index && index->MakePlan(constraint, plan);
+	}
+
+	// like walkHashTable, but only visits the ads that might satisfy the
+	// constraint, which the callable must still check.
+	template <typename Func>
+	int walkQueryCandidates(CollectorHashTable & table, ExprTree * constraint, Func fn) {
+		CollectorIndex::QueryPlan plan;
+		if ( ! planQuery(table, constraint, plan)) {
+			return walkHashTable(table, fn);
+		}
+		std::vector<CollectorRecord *> candidates;
+		getIndex(table)->Candidates(plan, candidates);
+		for (CollectorRecord * record : candidates) {
+			if (!fn(record)) break;
+		}
+		return 1;
+	}
+
+	// add references to the ads that might satisfy the constraint to the snapshot,
+	// which a query thread can then use while this thread goes on changing the table.
+	void snapshotQueryCandidates(CollectorHashTable & table, ExprTree * constraint, std::vector<CollectorAdsRef> & snapshot) {
+		walkQueryCandidates(table, constraint, [&snapshot](CollectorRecord * record) {
+			snapshot.push_back(record->m_ads);
+			return 1;
+		});
+	}
+
 	// templated version of the above that uses a callable for the walk function
 	template <typename Func>
 	int walkHashTable(CollectorHashTable & table, Func fn) {
@@ -145,11 +214,14 @@ class CollectorEngine : public Service
 	}
 
 
-	// register the collector's own ad pointer, and check to see if a given ad is that ad.
+	// the subscriptions to tell about each ad inserted, changed or removed
+	void setChangeFeed(CollectorChangeFeed * feed) { m_changeFeed = feed; }
+
+	// register the collector's own ad, and get its ads to check if a given ad is that ad.
 	// this is used to allow us to recognise the collector ad during iteration and automatically
 	// insert fresh stats into it when it is fetched.
-	void identifySelfAd(CollectorRecord * record);
-	bool isSelfAd(void * ad) { return __self_ad__ != NULL && __self_ad__ == ad; }
+	void identifySelfAd(CollectorRecord * record) { m_selfAds = record->m_ads; }
+	CollectorAdsRef getSelfAds() const { return m_selfAds.lock(); }
 
 	// Publish stats into the collector's ClassAd
 	//int publishStats( ClassAd *ad );
@@ -185,6 +257,10 @@ class CollectorEngine : public Service
 	// table for "generic" ad types
 	GenericAdHashTable GenericAds;
 
+	// secondary indexes of the tables, by the attributes in m_indexAttrs
+	std::vector<std::string> m_indexAttrs;
+	std::map<const CollectorHashTable *, std::unique_ptr<CollectorIndex>> m_indexes;
+
 	// for walking through the generic hash tables
 	static int (*genericTableScanFunction)(CollectorRecord *);
 	static int genericTableWalker(CollectorHashTable *cht);
@@ -196,7 +272,7 @@ class CollectorEngine : public Service
 
 	void  housekeeper ( int timerID = -1 );
 	int  housekeeperTimerID;
-	void cleanHashTable (CollectorHashTable &, time_t, HashFunc) const;
+	void cleanHashTable (CollectorHashTable &, time_t, HashFunc);
 	CollectorRecord* updateClassAd(CollectorHashTable&,const char*, const char *, bool,
 						   ClassAd*,AdNameHashKey&, const std::string &, int &,
 						   const condor_sockaddr& );
@@ -210,14 +286,34 @@ class CollectorEngine : public Service
 							int  &insert,
 							const condor_sockaddr& /*from*/ );
 
+	// apply a delta update to the ad it follows, returns NULL if there is
+	// no such ad, in which case the caller still owns the delta.
+	CollectorRecord* applyDeltaClassAd (CollectorHashTable &hashTable,
+							const char *adType,
+							const char *label,
+							ClassAd *delta_ad,
+							AdNameHashKey &hk,
+							const std::string &hashString,
+							int  &insert );
+
+	// ask the startd that sent a delta update we could not apply for whole ads,
+	// at most once per FULL_UPDATE_REQUEST_HOLDOFF seconds
+	void requestFullUpdate(ClassAd &delta_ad, const std::string &hashString);
+	static const int FULL_UPDATE_REQUEST_HOLDOFF = 10;
+	std::map<std::string, time_t> m_fullUpdateRequests;
+
 	// support for dynamically created tables
 	CollectorHashTable *findOrCreateTable(const istring &str);
 
 	bool ValidateClassAd(int command,ClassAd *clientAd,Sock *sock);
 
-	void* __self_ad__; // contains address of last Ad for this collector added to the hashtable, do NOT free from here
-					   // this pointer is only used to recognise this collector's ad during a condor_status query
-					   // so it's harmless if this pointer is out of date.
+	// the ads of this collector's own record. this is only used to recognise the collector's
+	// ad during a condor_status query, so it's harmless if it is out of date.
+	std::weak_ptr<CollectorRecordAds> m_selfAds;
+
+	// tell the change feed the ad with key hk in the table was inserted, changed or removed
+	void adChanged(CollectorHashTable & table, const AdNameHashKey & hk);
+	CollectorChangeFeed * m_changeFeed{nullptr};
 
 	// Statistics
 	CollectorStats	*collectorStats;
@@ -0,0 +1,311 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2024, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+#include "condor_common.h"
+#include "condor_debug.h"
+#include "condor_config.h"
+#include "condor_attributes.h"
+#include "condor_daemon_core.h"
+#include "compat_classad_util.h"
+#include "dc_collector.h"
+#include "reli_sock.h"
+
+#include "collector_feed.h"
+
+#include <algorithm>
+
+CollectorChangeFeed::~CollectorChangeFeed()
+{
+	for (Subscription * sub : subscriptions) {
+		delete sub;
+	}
+	subscriptions.clear();
+}
+
+void
+CollectorChangeFeed::Config()
+{
+	max_subscriptions = param_integer("COLLECTOR_MAX_SUBSCRIPTIONS", 100, 0);
+}
+
+int
+CollectorChangeFeed::Subscribe(CollectorHashTable & table, const char * label, ClassAd * query,
+                               ExprTree * constraint, bool skip_absent, ReliSock * sock)
+{
+	if ((int)subscriptions.size() >= max_subscriptions) {
+		dprintf(D_ALWAYS, "Refusing subscription to %s ads from %s, there are already %d (COLLECTOR_MAX_SUBSCRIPTIONS)\n",
+		        label, sock->peer_description(), (int)subscriptions.size());
+		Reject(sock, "Too many subscriptions");
+		delete query;
+		return FALSE;
+	}
+
+	Subscription * sub = new Subscription;
+	sub->table = &table;
+	sub->label = label;
+	sub->sock = sock;
+	sub->query.reset(query);
+	sub->constraint = constraint;
+	sub->skip_absent = skip_absent;
+
+	std::string projection;
+	if (query->LookupString(ATTR_PROJECTION, projection)) {
+		for (const auto & attr : StringTokenIterator(projection)) {
+			sub->projection.insert(attr);
+		}
+	}
+
+	// the ads in the table now are the snapshot, and whether they
+	// match is checked as they are sent.
+	AdNameHashKey hk;
+	CollectorRecord * record = nullptr;
+	table.startIterations();
+	while (table.iterate(hk, record)) {
+		sub->snapshot.push_back(hk);
+	}
+
+	// we never read from the socket again, so it is ready to read
+	// when the subscriber hangs up.
+	int rc = daemonCore->Register_Socket(sock, "Ads Subscription",
+		(SocketHandlercpp)&CollectorChangeFeed::SubscriberGone,
+		"CollectorChangeFeed::SubscriberGone", this);
+	if (rc < 0) {
+		dprintf(D_ALWAYS, "Failed to register subscription socket from %s\n", sock->peer_description());
+		delete sub;
+		return FALSE;
+	}
+
+	dprintf(D_ALWAYS, "Subscription to %s ads from %s, sending snapshot of %d ads\n",
+	        label, sock->peer_description(), (int)sub->snapshot.size());
+
+	subscriptions.push_back(sub);
+	collectorStats->global.ActiveSubscriptions = (int)subscriptions.size();
+	ScheduleFlush(0);
+	return KEEP_STREAM;
+}
+
+void
+CollectorChangeFeed::Reject(ReliSock * sock, const char * reason)
+{
+	int event = DCCollector::ADS_EVENT_ERROR;
+	std::string msg(reason);
+	sock->encode();
+	if ( ! sock->put(event) || ! sock->put(msg) || ! sock->end_of_message()) {
+		dprintf(D_FULLDEBUG, "Failed to send subscription error to %s\n", sock->peer_description());
+	}
+}
+
+void
+CollectorChangeFeed::AdChanged(CollectorHashTable & table, const AdNameHashKey & hk)
+{
+	std::string key;
+	for (Subscription * sub : subscriptions) {
+		if (sub->table != &table) {
+			continue;
+		}
+		if (key.empty()) {
+			hk.sprint(key);
+		}
+		sub->changed.emplace(key, hk);
+		ScheduleFlush(0);
+	}
+}
+
+void
+CollectorChangeFeed::ScheduleFlush(time_t delay)
+{
+	if (flush_timer >= 0) {
+		if (delay < flush_delay) {
+			daemonCore->Reset_Timer(flush_timer, delay);
+			flush_delay = delay;
+		}
+		return;
+	}
+	flush_timer = daemonCore->Register_Timer(delay,
+		(TimerHandlercpp)&CollectorChangeFeed::Flush,
+		"CollectorChangeFeed::Flush", this);
+	flush_delay = delay;
+}
+
+void
+CollectorChangeFeed::Flush(int /* timerID */)
+{
+	flush_timer = -1;
+
+	bool any_backlog = false;
+	std::vector<Subscription *> subs(subscriptions); // Remove() changes the list
+	for (Subscription * sub : subs) {
+		bool backlog = false;
+		if ( ! Send(*sub, backlog)) {
+			dprintf(D_ALWAYS, "Ending subscription to %s ads from %s, failed to send\n",
+			        sub->label.c_str(), sub->sock->peer_description());
+			Remove(sub);
+			continue;
+		}
+		any_backlog = any_backlog || backlog;
+	}
+
+	// try a subscriber that can't keep up again later, or sooner if
+	// there are more changes.
+	if (any_backlog) {
+		ScheduleFlush(1);
+	}
+}
+
+bool
+CollectorChangeFeed::Send(Subscription & sub, bool & backlog)
+{
+	if (sub.unfinished_eom) {
+		int rval = sub.sock->finish_end_of_message();
+		if (sub.sock->clear_backlog_flag()) {
+			backlog = true;
+			return true;
+		} else if ( ! rval) {
+			return false;
+		}
+		sub.unfinished_eom = false;
+	}
+
+	std::string key;
+	while ( ! backlog && sub.snapshot_sent < sub.snapshot.size()) {
+		const AdNameHashKey & hk = sub.snapshot[sub.snapshot_sent++];
+		hk.sprint(key);
+		if ( ! SendAd(sub, hk, key, backlog)) {
+			return false;
+		}
+	}
+
+	if ( ! backlog && ! sub.snapshot_done) {
+		sub.snapshot_done = true;
+		sub.snapshot.clear();
+		sub.snapshot.shrink_to_fit();
+		key.clear();
+		if ( ! SendEvent(sub, DCCollector::ADS_EVENT_SNAPSHOT_DONE, key, nullptr, backlog)) {
+			return false;
+		}
+	}
+
+	while ( ! backlog && ! sub.changed.empty()) {
+		auto it = sub.changed.begin();
+		key = it->first;
+		AdNameHashKey hk = it->second;
+		sub.changed.erase(it);
+		if ( ! SendAd(sub, hk, key, backlog)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// send the current ad for a key if it matches, else tell the subscriber
+// to forget it if it has it.
+bool
+CollectorChangeFeed::SendAd(Subscription & sub, const AdNameHashKey & hk, const std::string & key, bool & backlog)
+{
+	CollectorRecord * record = nullptr;
+	if (sub.table->lookup(hk, record) == 0 && record) {
+		ClassAd * ad = record->m_publicAd;
+		classad::Value result;
+		bool val = false;
+		bool matches = ! sub.constraint ||
+			(EvalExprToBool(sub.constraint, ad, nullptr, result) && result.IsBooleanValueEquiv(val) && val);
+		bool absent = false;
+		if (matches && sub.skip_absent && ad->LookupBool(ATTR_ABSENT, absent) && absent) {
+			matches = false;
+		}
+		if (matches) {
+			sub.has_ads.insert(key);
+			return SendEvent(sub, DCCollector::ADS_EVENT_UPDATED, key, ad, backlog);
+		}
+	}
+
+	if (sub.has_ads.erase(key)) {
+		return SendEvent(sub, DCCollector::ADS_EVENT_REMOVED, key, nullptr, backlog);
+	}
+	return true;
+}
+
+bool
+CollectorChangeFeed::SendEvent(Subscription & sub, int event, const std::string & key, ClassAd * ad, bool & backlog)
+{
+	ReliSock * sock = sub.sock;
+	sock->encode();
+
+	bool ok;
+	{
+		BlockingModeGuard guard(sock, true);
+		ok = sock->put(event) && sock->put(key);
+	}
+	if (ok && ad) {
+		int rval = putClassAd(sock, *ad, PUT_CLASSAD_NON_BLOCKING | PUT_CLASSAD_NO_PRIVATE,
+		                      sub.projection.empty() ? nullptr : &sub.projection);
+		if (rval == 2) {
+			backlog = true;
+		} else if ( ! rval) {
+			ok = false;
+		}
+	}
+	if ( ! ok) {
+		return false;
+	}
+
+	int rval = sock->end_of_message_nonblocking();
+	if (sock->clear_backlog_flag() || backlog) {
+		sub.unfinished_eom = true;
+		backlog = true;
+	} else if ( ! rval) {
+		return false;
+	}
+
+	collectorStats->global.SubscriptionEvents += 1;
+	return true;
+}
+
+void
+CollectorChangeFeed::Remove(Subscription * sub)
+{
+	auto it = std::find(subscriptions.begin(), subscriptions.end(), sub);
+	if (it != subscriptions.end()) {
+		subscriptions.erase(it);
+	}
+	daemonCore->Cancel_Socket(sub->sock);
+	delete sub->sock;
+	delete sub;
+	collectorStats->global.ActiveSubscriptions = (int)subscriptions.size();
+}
+
+int
+CollectorChangeFeed::SubscriberGone(Stream * sock)
+{
+	for (auto it = subscriptions.begin(); it != subscriptions.end(); ++it) {
+		Subscription * sub = *it;
+		if (sub->sock == sock) {
+			dprintf(D_ALWAYS, "Subscription to %s ads from %s ended\n",
+			        sub->label.c_str(), sub->sock->peer_description());
+			subscriptions.erase(it);
+			delete sub;
+			break;
+		}
+	}
+	collectorStats->global.ActiveSubscriptions = (int)subscriptions.size();
+
+	// daemon core closes the socket
+	return FALSE;
+}
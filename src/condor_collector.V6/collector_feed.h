@@ -0,0 +1,110 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2024, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+#ifndef __COLLECTOR_FEED_H__
+#define __COLLECTOR_FEED_H__
+
+#include "condor_classad.h"
+#include "collector_engine.h"
+
+#include <vector>
+#include <string>
+#include <map>
+#include <memory>
+#include <unordered_set>
+
+class ReliSock;
+
+// The subscriptions made with the SUBSCRIBE_ADS command.  A subscriber
+// sends a query ad for one type of ad, and gets back an event for each
+// ad of that type that matches the query's constraint, then an event
+// marking the end of that snapshot, then an event each time a matching
+// ad is inserted or changed, or is removed or stops matching.  See
+// DCCollector::subscribeAds() for the protocol.
+//
+// Changes are not sent as they happen.  The CollectorEngine tells us
+// the key of each ad it changes, and the current ads for the keys are
+// sent at the end of the event cycle.  So a subscriber gets one event
+// for an ad that changed many times while it was not reading, and what
+// we hold for a slow subscriber is bounded by the number of ads.
+class CollectorChangeFeed : public Service {
+public:
+	explicit CollectorChangeFeed(CollectorStats * stats) : collectorStats(stats) {}
+	~CollectorChangeFeed();
+
+	void Config();
+
+	// Start a subscription to the ads of table that match constraint,
+	// which is an attribute of query.  Takes ownership of query, and of
+	// sock if it returns KEEP_STREAM.
+	int Subscribe(CollectorHashTable & table, const char * label, ClassAd * query,
+	              ExprTree * constraint, bool skip_absent, ReliSock * sock);
+
+	// Send an error event in reply to a subscription we did not start.
+	static void Reject(ReliSock * sock, const char * reason);
+
+	// Called by the CollectorEngine after the ad with key hk is
+	// inserted into table, changed, or removed from it.
+	void AdChanged(CollectorHashTable & table, const AdNameHashKey & hk);
+
+	size_t NumSubscriptions() const { return subscriptions.size(); }
+
+private:
+	struct Subscription {
+		CollectorHashTable * table{nullptr};
+		std::string label;
+		ReliSock * sock{nullptr};
+		std::unique_ptr<ClassAd> query;
+		ExprTree * constraint{nullptr};	// points into query
+		bool skip_absent{false};
+		classad::References projection;
+
+		// the keys of the ads in the table when we started, to send first
+		std::vector<AdNameHashKey> snapshot;
+		size_t snapshot_sent{0};
+		bool snapshot_done{false};
+
+		// the keys of the ads changed since we last sent, by key string
+		std::map<std::string, AdNameHashKey> changed;
+
+		// the keys of the ads the subscriber has
+		std::unordered_set<std::string> has_ads;
+
+		bool unfinished_eom{false};
+	};
+
+	// send what we can without blocking, returns false if the
+	// subscriber is gone.  sets backlog if some is left to send.
+	bool Send(Subscription & sub, bool & backlog);
+	bool SendAd(Subscription & sub, const AdNameHashKey & hk, const std::string & key, bool & backlog);
+	bool SendEvent(Subscription & sub, int event, const std::string & key, ClassAd * ad, bool & backlog);
+	void Remove(Subscription * sub);
+
+	void Flush(int timerID = -1);
+	void ScheduleFlush(time_t delay);
+	int SubscriberGone(Stream * sock);
+
+	CollectorStats * collectorStats;
+	std::vector<Subscription *> subscriptions;
+	int flush_timer{-1};
+	time_t flush_delay{0};
+	int max_subscriptions{100};
+};
+
+#endif // __COLLECTOR_FEED_H__
@@ -0,0 +1,425 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2024, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+#include "condor_common.h"
+#include "condor_debug.h"
+#include "compat_classad_util.h"
+#include "stl_string_utils.h"
+
+#include "collector.h"
+#include "collector_index.h"
+
+#include <math.h>
+
+// integers beyond this can't be compared exactly as doubles
+static const double MAX_EXACT_INT = 9007199254740992.0; // 2^53
+
+CollectorIndex::CollectorIndex(const std::vector<std::string> &names)
+{
+	for (const std::string &name : names) {
+		std::string key(name);
+		lower_case(key);
+		if (attr_ids.count(key)) {
+			continue;
+		}
+		attr_ids[key] = (int)attr_names.size();
+		attr_names.push_back(name);
+	}
+	attrs.resize(attr_names.size());
+}
+
+CollectorIndex::~CollectorIndex()
+{
+	for (auto &[record, record_keys] : keys) {
+		record->m_index = nullptr;
+	}
+}
+
+int
+CollectorIndex::FindAttr(const std::string &attr) const
+{
+	std::string key(attr);
+	lower_case(key);
+	auto it = attr_ids.find(key);
+	return it == attr_ids.end() ? -1 : it->second;
+}
+
+void
+CollectorIndex::IndexAttr(CollectorRecord *record, int attr, std::vector<Key> &record_keys)
+{
+	classad::ExprTree *expr = record->m_publicAd->Lookup(attr_names[attr]);
+	if ( ! expr) {
+		// a missing attribute is undefined, which never satisfies
+		// a clause the index serves.
+		return;
+	}
+
+	AttrIndex &ix = attrs[attr];
+	Key key;
+	key.attr = attr;
+	key.kind = OTHER_VALUE;
+	key.num = 0;
+
+	classad::Value val;
+	long long ival;
+	double rval;
+	bool bval;
+	if ( ! ExprTreeIsLiteral(expr, val)) {
+		key.kind = OTHER_VALUE;
+	} else if (val.IsIntegerValue(ival)) {
+		if (fabs((double)ival) < MAX_EXACT_INT) {
+			key.kind = NUMBER_VALUE;
+			key.num = (double)ival;
+		}
+	} else if (val.IsRealValue(rval)) {
+		if ( ! std::isnan(rval)) {
+			key.kind = NUMBER_VALUE;
+			key.num = rval;
+		}
+	} else if (val.IsBooleanValue(bval)) {
+		key.kind = bval ? TRUE_VALUE : FALSE_VALUE;
+	} else if (val.IsStringValue(key.str)) {
+		key.kind = STRING_VALUE;
+		lower_case(key.str);
+	}
+
+	switch (key.kind) {
+	case STRING_VALUE: ix.strings[key.str].insert(record); break;
+	case NUMBER_VALUE: ix.numbers[key.num].insert(record); ix.num_numbers++; break;
+	case TRUE_VALUE:   ix.trues.insert(record); break;
+	case FALSE_VALUE:  ix.falses.insert(record); break;
+	case OTHER_VALUE:  ix.others.insert(record); break;
+	}
+	record_keys.push_back(std::move(key));
+}
+
+void
+CollectorIndex::UnindexKey(CollectorRecord *record, const Key &key)
+{
+	AttrIndex &ix = attrs[key.attr];
+	switch (key.kind) {
+	case STRING_VALUE: {
+		auto it = ix.strings.find(key.str);
+		if (it != ix.strings.end()) {
+			it->second.erase(record);
+			if (it->second.empty()) { ix.strings.erase(it); }
+		}
+		break;
+	}
+	case NUMBER_VALUE: {
+		auto it = ix.numbers.find(key.num);
+		if (it != ix.numbers.end() && it->second.erase(record)) {
+			ix.num_numbers--;
+			if (it->second.empty()) { ix.numbers.erase(it); }
+		}
+		break;
+	}
+	case TRUE_VALUE:  ix.trues.erase(record); break;
+	case FALSE_VALUE: ix.falses.erase(record); break;
+	case OTHER_VALUE: ix.others.erase(record); break;
+	}
+}
+
+void
+CollectorIndex::Insert(CollectorRecord *record)
+{
+	ASSERT( ! record->m_index || record->m_index == this);
+	if (record->m_index == this) {
+		Update(record);
+		return;
+	}
+	std::vector<Key> &record_keys = keys[record];
+	for (int attr = 0; attr < (int)attrs.size(); ++attr) {
+		IndexAttr(record, attr, record_keys);
+	}
+	record->m_index = this;
+}
+
+void
+CollectorIndex::Remove(CollectorRecord *record)
+{
+	auto it = keys.find(record);
+	if (it != keys.end()) {
+		for (const Key &key : it->second) {
+			UnindexKey(record, key);
+		}
+		keys.erase(it);
+	}
+	if (record->m_index == this) {
+		record->m_index = nullptr;
+	}
+}
+
+void
+CollectorIndex::Update(CollectorRecord *record, const char *attr_name)
+{
+	auto it = keys.find(record);
+	if (it == keys.end()) {
+		return;
+	}
+	std::vector<Key> &record_keys = it->second;
+	if (attr_name) {
+		int attr = FindAttr(attr_name);
+		if (attr < 0) {
+			return;
+		}
+		for (size_t ix = 0; ix < record_keys.size(); ++ix) {
+			if (record_keys[ix].attr == attr) {
+				UnindexKey(record, record_keys[ix]);
+				record_keys.erase(record_keys.begin() + ix);
+				break;
+			}
+		}
+		IndexAttr(record, attr, record_keys);
+		return;
+	}
+	for (const Key &key : record_keys) {
+		UnindexKey(record, key);
+	}
+	record_keys.clear();
+	for (int attr = 0; attr < (int)attrs.size(); ++attr) {
+		IndexAttr(record, attr, record_keys);
+	}
+}
+
+// Fill in the plan for one && clause of a query constraint.  Returns
+// false if the clause can't be served by the index.
+bool
+CollectorIndex::PlanClause(classad::ExprTree *clause, QueryPlan &plan) const
+{
+	clause = SkipExprParens(clause);
+	if ( ! clause) {
+		return false;
+	}
+
+	// returns the index of the attribute if expr is Attr or MY.Attr
+	auto indexed_ref = [this](classad::ExprTree *expr) -> int {
+		expr = SkipExprParens(expr);
+		if ( ! expr || expr->GetKind() != classad::ExprTree::ATTRREF_NODE) {
+			return -1;
+		}
+		classad::ExprTree *scope = nullptr;
+		std::string attr;
+		bool absolute = false;
+		((classad::AttributeReference*)expr)->GetComponents(scope, attr, absolute);
+		if (absolute) {
+			return -1;
+		}
+		if (scope) {
+			std::string scope_name;
+			if ( ! ExprTreeIsAttrRef(scope, scope_name) || strcasecmp(scope_name.c_str(), "MY") != 0) {
+				return -1;
+			}
+		}
+		return FindAttr(attr);
+	};
+
+	int attr = indexed_ref(clause);
+	classad::Value lit;
+	classad::Operation::OpKind op = classad::Operation::EQUAL_OP;
+
+	if (attr >= 0) {
+		// a bare Attr must be true
+		lit.SetBooleanValue(true);
+	} else if (clause->GetKind() == classad::ExprTree::OP_NODE) {
+		classad::ExprTree *t1, *t2, *t3;
+		((classad::Operation*)clause)->GetComponents(op, t1, t2, t3);
+		if ((attr = indexed_ref(t1)) >= 0 && ExprTreeIsLiteral(t2, lit)) {
+			// Attr op literal
+		} else if (ExprTreeIsLiteral(t1, lit) && (attr = indexed_ref(t2)) >= 0) {
+			// literal op Attr, turn it around
+			switch (op) {
+			case classad::Operation::LESS_THAN_OP:        op = classad::Operation::GREATER_THAN_OP; break;
+			case classad::Operation::LESS_OR_EQUAL_OP:    op = classad::Operation::GREATER_OR_EQUAL_OP; break;
+			case classad::Operation::GREATER_THAN_OP:     op = classad::Operation::LESS_THAN_OP; break;
+			case classad::Operation::GREATER_OR_EQUAL_OP: op = classad::Operation::LESS_OR_EQUAL_OP; break;
+			default: break;
+			}
+		} else {
+			return false;
+		}
+	} else {
+		return false;
+	}
+
+	bool equality = (op == classad::Operation::EQUAL_OP || op == classad::Operation::META_EQUAL_OP);
+	bool ordering = (op == classad::Operation::LESS_THAN_OP || op == classad::Operation::LESS_OR_EQUAL_OP ||
+	                 op == classad::Operation::GREATER_THAN_OP || op == classad::Operation::GREATER_OR_EQUAL_OP);
+
+	long long ival;
+	double rval;
+	bool bval;
+	plan.attr = attr;
+	plan.op = op;
+	plan.str.clear();
+	plan.num = 0;
+	if (lit.IsIntegerValue(ival)) {
+		if ( ! (equality || ordering) || fabs((double)ival) >= MAX_EXACT_INT) {
+			return false;
+		}
+		plan.kind = NUMBER_VALUE;
+		plan.num = (double)ival;
+	} else if (lit.IsRealValue(rval)) {
+		if ( ! (equality || ordering) || std::isnan(rval)) {
+			return false;
+		}
+		plan.kind = NUMBER_VALUE;
+		plan.num = rval;
+	} else if (lit.IsBooleanValue(bval)) {
+		if ( ! equality) {
+			return false;
+		}
+		plan.kind = bval ? TRUE_VALUE : FALSE_VALUE;
+	} else if (lit.IsStringValue(plan.str)) {
+		if ( ! equality) {
+			return false;
+		}
+		plan.kind = STRING_VALUE;
+		lower_case(plan.str);
+	} else {
+		return false;
+	}
+
+	plan.candidates = CountCandidates(plan);
+	return true;
+}
+
+// Calls fn on each set of records with a number in the range op num,
+// or on all of them if in_range is false.
+template <typename Func>
+static void
+for_each_number(const std::map<double, std::unordered_set<CollectorRecord *>> &numbers,
+                bool in_range, classad::Operation::OpKind op, double num, Func fn)
+{
+	auto begin = numbers.begin();
+	auto end = numbers.end();
+	if (in_range) {
+		switch (op) {
+		case classad::Operation::LESS_THAN_OP:        end = numbers.lower_bound(num); break;
+		case classad::Operation::LESS_OR_EQUAL_OP:    end = numbers.upper_bound(num); break;
+		case classad::Operation::GREATER_THAN_OP:     begin = numbers.upper_bound(num); break;
+		case classad::Operation::GREATER_OR_EQUAL_OP: begin = numbers.lower_bound(num); break;
+		default: begin = numbers.lower_bound(num); end = numbers.upper_bound(num); break;
+		}
+	}
+	for (auto it = begin; it != end; ++it) {
+		fn(it->second);
+	}
+}
+
+size_t
+CollectorIndex::CountCandidates(const QueryPlan &plan) const
+{
+	const AttrIndex &ix = attrs[plan.attr];
+	size_t count = ix.others.size();
+	switch (plan.kind) {
+	case STRING_VALUE: {
+		auto it = ix.strings.find(plan.str);
+		if (it != ix.strings.end()) { count += it->second.size(); }
+		break;
+	}
+	case NUMBER_VALUE:
+			// booleans may be compared as numbers
+		count += ix.trues.size() + ix.falses.size();
+		for_each_number(ix.numbers, true, plan.op, plan.num,
+			[&count](const RecordSet &set) { count += set.size(); });
+		break;
+	case TRUE_VALUE:
+		count += ix.trues.size() + ix.num_numbers;
+		break;
+	case FALSE_VALUE:
+		count += ix.falses.size() + ix.num_numbers;
+		break;
+	}
+	return count;
+}
+
+bool
+CollectorIndex::MakePlan(classad::ExprTree *constraint, QueryPlan &plan) const
+{
+	plan = QueryPlan();
+	if ( ! constraint || attrs.empty()) {
+		return false;
+	}
+
+	// walk the && clauses, keeping the one that admits the fewest ads
+	std::vector<classad::ExprTree *> pending;
+	pending.push_back(SkipExprEnvelope(constraint));
+	while ( ! pending.empty()) {
+		classad::ExprTree *expr = SkipExprParens(pending.back());
+		pending.pop_back();
+		if ( ! expr) {
+			continue;
+		}
+		if (expr->GetKind() == classad::ExprTree::OP_NODE) {
+			classad::Operation::OpKind op;
+			classad::ExprTree *t1, *t2, *t3;
+			((classad::Operation*)expr)->GetComponents(op, t1, t2, t3);
+			if (op == classad::Operation::LOGICAL_AND_OP) {
+				pending.push_back(t2);
+				pending.push_back(t1);
+				continue;
+			}
+		}
+		QueryPlan clause_plan;
+		if (PlanClause(expr, clause_plan) &&
+			(plan.empty() || clause_plan.candidates < plan.candidates)) {
+			plan = clause_plan;
+		}
+	}
+	return ! plan.empty();
+}
+
+void
+CollectorIndex::Candidates(const QueryPlan &plan, std::vector<CollectorRecord *> &records) const
+{
+	records.clear();
+	if (plan.empty()) {
+		return;
+	}
+	records.reserve(plan.candidates);
+
+		// the sets are disjoint, as each record is in only one place
+		// for each attribute
+	const AttrIndex &ix = attrs[plan.attr];
+	auto add = [&records](const RecordSet &set) {
+		records.insert(records.end(), set.begin(), set.end());
+	};
+	switch (plan.kind) {
+	case STRING_VALUE: {
+		auto it = ix.strings.find(plan.str);
+		if (it != ix.strings.end()) { add(it->second); }
+		break;
+	}
+	case NUMBER_VALUE:
+		add(ix.trues);
+		add(ix.falses);
+		for_each_number(ix.numbers, true, plan.op, plan.num, add);
+		break;
+	case TRUE_VALUE:
+		add(ix.trues);
+		for_each_number(ix.numbers, false, plan.op, plan.num, add);
+		break;
+	case FALSE_VALUE:
+		add(ix.falses);
+		for_each_number(ix.numbers, false, plan.op, plan.num, add);
+		break;
+	}
+	add(ix.others);
+}
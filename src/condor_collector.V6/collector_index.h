@@ -0,0 +1,132 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2024, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+#ifndef __COLLECTOR_INDEX_H__
+#define __COLLECTOR_INDEX_H__
+
+#include "condor_classad.h"
+
+#include <vector>
+#include <string>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+
+struct CollectorRecord;
+
+// Secondary indexes of the ads in one collector table, by the values of
+// a configured set of attributes (COLLECTOR_QUERY_INDEXES).  For each
+// attribute there is a hash index of the ads where it is a string or a
+// boolean, and an ordered index of the ads where it is a number.  Ads
+// where it is an expression are kept aside, and always considered.
+//
+// A query plan picks, out of the && clauses of a query's constraint,
+// the one of the form Attr op literal (or literal op Attr) that the
+// index narrows to the fewest ads.  Ads not in the plan's candidates
+// cannot satisfy the constraint; the candidates still have to be
+// checked against the whole constraint.
+//
+// Records are indexed by their public ad.  A record in an index removes
+// itself when it is deleted and reindexes itself when its ads are
+// replaced; code that changes a record's public ad in place must call
+// CollectorRecord::Reindex().
+class CollectorIndex {
+public:
+	class QueryPlan {
+	public:
+		QueryPlan() : attr(-1), op(classad::Operation::__NO_OP__), kind(0), num(0), candidates(0) {}
+
+		bool empty() const { return attr < 0; }
+
+		// the number of ads the plan admits
+		size_t NumCandidates() const { return candidates; }
+
+	private:
+		friend class CollectorIndex;
+
+		int attr;
+		classad::Operation::OpKind op;
+		int kind;			// the ValueKind of the literal
+		std::string str;	// lower cased
+		double num;
+		size_t candidates;
+	};
+
+	explicit CollectorIndex(const std::vector<std::string> &attrs);
+	~CollectorIndex();
+
+	// Index a record, which must not be in another index.
+	void Insert(CollectorRecord *record);
+
+	// Remove a record from the index.
+	void Remove(CollectorRecord *record);
+
+	// Index a record again, after its public ad changed.  If attr is
+	// given, only that attribute changed.
+	void Update(CollectorRecord *record, const char *attr = nullptr);
+
+	// Build a plan for the query constraint.  Returns false and leaves
+	// the plan empty if no clause of the constraint can be served by
+	// the index.
+	bool MakePlan(classad::ExprTree *constraint, QueryPlan &plan) const;
+
+	// The ads admitted by the plan, in no particular order.
+	void Candidates(const QueryPlan &plan, std::vector<CollectorRecord *> &records) const;
+
+	size_t size() const { return keys.size(); }
+
+	const std::vector<std::string> &Attributes() const { return attr_names; }
+
+private:
+	enum ValueKind { STRING_VALUE, NUMBER_VALUE, TRUE_VALUE, FALSE_VALUE, OTHER_VALUE };
+
+	typedef std::unordered_set<CollectorRecord *> RecordSet;
+
+	struct AttrIndex {
+		// keyed by lower cased value, since == ignores case
+		std::unordered_map<std::string, RecordSet> strings;
+		std::map<double, RecordSet> numbers;
+		size_t num_numbers{0};
+		RecordSet trues;
+		RecordSet falses;
+		// ads where the attribute is not a literal
+		RecordSet others;
+	};
+
+	// where a record is indexed for one attribute
+	struct Key {
+		int attr;
+		ValueKind kind;
+		std::string str;
+		double num;
+	};
+
+	int FindAttr(const std::string &attr) const;
+	void IndexAttr(CollectorRecord *record, int attr, std::vector<Key> &record_keys);
+	void UnindexKey(CollectorRecord *record, const Key &key);
+	bool PlanClause(classad::ExprTree *clause, QueryPlan &plan) const;
+	size_t CountCandidates(const QueryPlan &plan) const;
+
+	std::vector<std::string> attr_names;
+	std::unordered_map<std::string, int> attr_ids;	// by lower cased name
+	std::vector<AttrIndex> attrs;
+	std::unordered_map<CollectorRecord *, std::vector<Key>> keys;
+};
+
+#endif // __COLLECTOR_INDEX_H__
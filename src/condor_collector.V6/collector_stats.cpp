@@ -376,6 +376,15 @@ void UpdatesStats::Init()
 	STATS_POOL_ADD(Pool, "", PendingQueries, IF_BASICPUB);
 	STATS_POOL_ADD_VAL_PUB_RECENT(Pool, "", DroppedQueries, IF_BASICPUB);
 
+	// stats for the query indexes
+	STATS_POOL_ADD_VAL_PUB_RECENT(Pool, "", IndexedQueryScans, IF_BASICPUB);
+	STATS_POOL_ADD_VAL_PUB_RECENT(Pool, "", FullQueryScans, IF_BASICPUB);
+	STATS_POOL_ADD_VAL_PUB_RECENT(Pool, "", IndexSkippedAds, IF_BASICPUB);
+	STATS_POOL_ADD_VAL_PUB_RECENT(Pool, "", DeltaUpdates, IF_BASICPUB);
+	STATS_POOL_ADD_VAL_PUB_RECENT(Pool, "", DeltaUpdatesRejected, IF_BASICPUB);
+	STATS_POOL_ADD(Pool, "", ActiveSubscriptions, IF_BASICPUB);
+	STATS_POOL_ADD_VAL_PUB_RECENT(Pool, "", SubscriptionEvents, IF_BASICPUB);
+
 	ADD_EXTERN_RUNTIME(Pool, HandleQuery, IF_VERBOSEPUB);
 	ADD_EXTERN_RUNTIME(Pool, HandleLocate, IF_VERBOSEPUB);
 
@@ -384,6 +393,12 @@ void UpdatesStats::Init()
 	ADD_EXTERN_RUNTIME(Pool, HandleLocateForked, IF_VERBOSEPUB);
 	ADD_EXTERN_RUNTIME(Pool, HandleLocateMissedFork, IF_VERBOSEPUB);
 
+	// the cost of serving queries in forked workers vs query threads
+	ADD_EXTERN_RUNTIME(Pool, QueryForkDispatch, IF_BASICPUB);
+	ADD_EXTERN_RUNTIME(Pool, QueryForkLatency, IF_BASICPUB);
+	ADD_EXTERN_RUNTIME(Pool, QueryThreadDispatch, IF_BASICPUB);
+	ADD_EXTERN_RUNTIME(Pool, QueryThreadLatency, IF_BASICPUB);
+
 #ifdef TRACK_QUERIES_BY_SUBSYS
     #define ADD_SUBSYS_PROBES(pool,subsys,as) \
 	   pool.AddProbe("InProcQueriesFrom" #subsys, &InProcQueriesFrom[SUBSYSTEM_ID_##subsys], "InProcQueriesFrom" #subsys, as | InProcQueriesFrom[SUBSYSTEM_ID_##subsys].PubDefault); \
@@ -172,6 +172,19 @@ struct UpdatesStats {
 	stats_entry_abs<int> PendingQueries;
 	stats_entry_recent<long> DroppedQueries;
 
+	// query index hits
+	stats_entry_recent<long> IndexedQueryScans;
+	stats_entry_recent<long> FullQueryScans;
+	stats_entry_recent<long> IndexSkippedAds;
+
+	// startd delta updates applied, and startds asked for whole ads instead
+	stats_entry_recent<long> DeltaUpdates;
+	stats_entry_recent<long> DeltaUpdatesRejected;
+
+	// subscriptions to changes in the ads, and the events sent to them
+	stats_entry_abs<int> ActiveSubscriptions;
+	stats_entry_recent<long> SubscriptionEvents;
+
 #ifdef TRACK_QUERIES_BY_SUBSYS
 	stats_entry_recent<long> InProcQueriesFrom[SUBSYSTEM_ID_COUNT]; // Track subsystems < the AUTO subsys.
 	stats_entry_recent<long> ForkQueriesFrom[SUBSYSTEM_ID_COUNT]; // Track subsystems < the AUTO subsys.
@@ -0,0 +1,299 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2024, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+#include "condor_common.h"
+#include "condor_debug.h"
+#include "truncate.h"
+#include "view_history.h"
+
+#include <algorithm>
+
+static const char HistoryMagic[4] = { 'V', 'H', 'S', 'T' };
+static const uint32_t HistoryVersion = 1;
+static const long HeaderSize = sizeof(HistoryMagic) + 2 * sizeof(uint32_t);
+static const uint32_t MaxKeyLength = 64 * 1024;
+
+template <typename T> static void
+put(std::string & buf, const T & val)
+{
+	buf.append(reinterpret_cast<const char *>(&val), sizeof(val));
+}
+
+template <typename T> static bool
+get(FILE * fp, T & val)
+{
+	return fread(&val, sizeof(val), 1, fp) == 1;
+}
+
+void
+ViewHistoryFile::Clear()
+{
+	m_size = 0;
+	m_samples.clear();
+	m_keys.clear();
+	m_keyIds.clear();
+	m_rows.clear();
+}
+
+bool
+ViewHistoryFile::Open(const std::string & filename, int columns)
+{
+	Clear();
+	m_filename = filename;
+	m_columns = columns;
+
+	FILE * fp = safe_fopen_wrapper_follow(m_filename.c_str(), "rb");
+	if ( ! fp) {
+		return true;
+	}
+
+	fseek(fp, 0, SEEK_END);
+	long file_size = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+	if (file_size == 0) {
+		fclose(fp);
+		return true;
+	}
+
+	char magic[sizeof(HistoryMagic)];
+	uint32_t version = 0, file_columns = 0;
+	if (fread(magic, sizeof(magic), 1, fp) != 1 || memcmp(magic, HistoryMagic, sizeof(magic)) != 0 ||
+	    ! get(fp, version) || version != HistoryVersion ||
+	    ! get(fp, file_columns) || (int)file_columns != m_columns) {
+		dprintf(D_ALWAYS, "%s is not a history file with %d columns\n", m_filename.c_str(), m_columns);
+		fclose(fp);
+		return false;
+	}
+
+	// read the keys and where each sample is, up to the first record
+	// we can't read all of.
+	long good = HeaderSize;
+	std::vector<uint32_t> ids;
+	unsigned char type;
+	while (get(fp, type)) {
+		if (type == 'K') {
+			uint32_t len = 0;
+			if ( ! get(fp, len) || len > MaxKeyLength) break;
+			std::string key(len, '\0');
+			if (len && fread(&key[0], len, 1, fp) != 1) break;
+			m_keyIds.emplace(key, (unsigned int)m_keys.size());
+			m_keys.emplace_back(std::move(key));
+			m_rows.emplace_back();
+		} else if (type == 'S') {
+			int64_t t = 0;
+			uint32_t rows = 0;
+			if ( ! get(fp, t) || ! get(fp, rows)) break;
+			long offset = ftell(fp);
+			if ((file_size - offset) / (long)sizeof(float) / (m_columns + 1) < (long)rows) break;
+			ids.resize(rows);
+			if (rows && fread(ids.data(), sizeof(uint32_t), rows, fp) != rows) break;
+			if (std::any_of(ids.begin(), ids.end(), [&](uint32_t id) { return id >= m_keys.size(); })) break;
+			unsigned int sample = (unsigned int)m_samples.size();
+			for (unsigned int row = 0; row < rows; ++row) {
+				m_rows[ids[row]].push_back(Row{sample, row});
+			}
+			m_samples.push_back(Sample{(time_t)t, offset, rows});
+			fseek(fp, (long)(rows * m_columns * sizeof(float)), SEEK_CUR);
+		} else {
+			break;
+		}
+		good = ftell(fp);
+	}
+	fclose(fp);
+
+	if (good < file_size) {
+		dprintf(D_ALWAYS, "History file %s ends with an incomplete record, truncating it from %ld to %ld bytes\n",
+		        m_filename.c_str(), file_size, good);
+		if (truncate(m_filename.c_str(), good) < 0) {
+			dprintf(D_ALWAYS, "Could not truncate %s, errno=%d\n", m_filename.c_str(), errno);
+		}
+	}
+	m_size = good;
+
+	dprintf(D_FULLDEBUG, "History file %s has %d samples of %d keys\n",
+	        m_filename.c_str(), (int)m_samples.size(), (int)m_keys.size());
+	return true;
+}
+
+bool
+ViewHistoryFile::Append(time_t t, const std::vector<std::string> & names, const std::vector<const float *> & values)
+{
+	std::string buf;
+	if (m_size == 0) {
+		buf.append(HistoryMagic, sizeof(HistoryMagic));
+		put(buf, HistoryVersion);
+		put(buf, (uint32_t)m_columns);
+	}
+
+	std::vector<uint32_t> ids;
+	ids.reserve(names.size());
+	std::vector<std::string> new_keys;
+	for (const auto & name : names) {
+		auto it = m_keyIds.find(name);
+		if (it != m_keyIds.end()) {
+			ids.push_back(it->second);
+			continue;
+		}
+		auto pending = std::find(new_keys.begin(), new_keys.end(), name);
+		ids.push_back((uint32_t)(m_keys.size() + (pending - new_keys.begin())));
+		if (pending == new_keys.end()) {
+			new_keys.push_back(name);
+			buf += 'K';
+			put(buf, (uint32_t)name.size());
+			buf += name;
+		}
+	}
+
+	buf += 'S';
+	put(buf, (int64_t)t);
+	put(buf, (uint32_t)names.size());
+	long offset = m_size + (long)buf.size();
+	buf.append(reinterpret_cast<const char *>(ids.data()), ids.size() * sizeof(uint32_t));
+	for (int col = 0; col < m_columns; ++col) {
+		for (const float * row : values) {
+			put(buf, row[col]);
+		}
+	}
+
+	FILE * fp = safe_fopen_wrapper_follow(m_filename.c_str(), "ab");
+	if ( ! fp) {
+		dprintf(D_ALWAYS, "Could not open history file %s for appending, errno=%d\n", m_filename.c_str(), errno);
+		return false;
+	}
+	bool ok = fwrite(buf.data(), buf.size(), 1, fp) == 1;
+	if (fclose(fp) != 0) ok = false;
+	if ( ! ok) {
+		dprintf(D_ALWAYS, "Could not write to history file %s, errno=%d\n", m_filename.c_str(), errno);
+		// cut off what we wrote
+		Open(m_filename, m_columns);
+		return false;
+	}
+
+	for (auto & key : new_keys) {
+		m_keyIds.emplace(key, (unsigned int)m_keys.size());
+		m_keys.emplace_back(std::move(key));
+		m_rows.emplace_back();
+	}
+	unsigned int sample = (unsigned int)m_samples.size();
+	for (unsigned int row = 0; row < ids.size(); ++row) {
+		m_rows[ids[row]].push_back(Row{sample, row});
+	}
+	m_samples.push_back(Sample{t, offset, (unsigned int)ids.size()});
+	m_size += (long)buf.size();
+	return true;
+}
+
+size_t
+ViewHistoryFile::FirstSample(time_t t) const
+{
+	return std::lower_bound(m_samples.begin(), m_samples.end(), t,
+		[](const Sample & s, time_t t) { return s.time < t; }) - m_samples.begin();
+}
+
+void
+ViewHistoryFile::ListKeys(time_t from, time_t to, const std::function<void(const std::string &)> & fn) const
+{
+	if (to < from) return;
+	size_t first = FirstSample(from);
+	size_t end = std::upper_bound(m_samples.begin(), m_samples.end(), to,
+		[](time_t t, const Sample & s) { return t < s.time; }) - m_samples.begin();
+	if (first >= end) return;
+
+	for (size_t id = 0; id < m_keys.size(); ++id) {
+		const auto & rows = m_rows[id];
+		auto it = std::lower_bound(rows.begin(), rows.end(), first,
+			[](const Row & r, size_t s) { return r.sample < s; });
+		if (it != rows.end() && it->sample < end) {
+			fn(m_keys[id]);
+		}
+	}
+}
+
+bool
+ViewHistoryFile::ReadValues(FILE * fp, const Sample & sample, unsigned int row, float * values) const
+{
+	for (int col = 0; col < m_columns; ++col) {
+		long pos = sample.offset + (long)((sample.rows + (size_t)col * sample.rows + row) * sizeof(float));
+		if (fseek(fp, pos, SEEK_SET) != 0 || ! get(fp, values[col])) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool
+ViewHistoryFile::Scan(time_t from, time_t to, const std::string & key,
+                      const std::function<bool(time_t, const std::string &, const float *)> & fn) const
+{
+	if (to < from) return true;
+	size_t first = FirstSample(from);
+	size_t end = std::upper_bound(m_samples.begin(), m_samples.end(), to,
+		[](time_t t, const Sample & s) { return t < s.time; }) - m_samples.begin();
+	if (first >= end) return true;
+
+	const std::vector<Row> * key_rows = nullptr;
+	if (key != "*") {
+		auto it = m_keyIds.find(key);
+		if (it == m_keyIds.end()) return true;
+		key_rows = &m_rows[it->second];
+	}
+
+	FILE * fp = safe_fopen_wrapper_follow(m_filename.c_str(), "rb");
+	if ( ! fp) {
+		dprintf(D_ALWAYS, "Could not open history file %s, errno=%d\n", m_filename.c_str(), errno);
+		return false;
+	}
+
+	bool ok = true;
+	std::vector<float> values(m_columns);
+	if (key_rows) {
+		// one key: read just its values from each sample
+		auto it = std::lower_bound(key_rows->begin(), key_rows->end(), first,
+			[](const Row & r, size_t s) { return r.sample < s; });
+		for ( ; ok && it != key_rows->end() && it->sample < end; ++it) {
+			const Sample & sample = m_samples[it->sample];
+			ok = ReadValues(fp, sample, it->row, values.data()) &&
+			     fn(sample.time, key, values.data());
+		}
+	} else {
+		// every key: read whole samples
+		std::vector<uint32_t> ids;
+		std::vector<float> cols;
+		for (size_t s = first; ok && s < end; ++s) {
+			const Sample & sample = m_samples[s];
+			ids.resize(sample.rows);
+			cols.resize((size_t)sample.rows * m_columns);
+			if (fseek(fp, sample.offset, SEEK_SET) != 0 ||
+			    (sample.rows && fread(ids.data(), sizeof(uint32_t), sample.rows, fp) != sample.rows) ||
+			    (cols.size() && fread(cols.data(), sizeof(float), cols.size(), fp) != cols.size())) {
+				ok = false;
+				break;
+			}
+			for (unsigned int row = 0; ok && row < sample.rows; ++row) {
+				for (int col = 0; col < m_columns; ++col) {
+					values[col] = cols[(size_t)col * sample.rows + row];
+				}
+				ok = fn(sample.time, m_keys[ids[row]], values.data());
+			}
+		}
+	}
+
+	fclose(fp);
+	return ok;
+}
@@ -0,0 +1,96 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2024, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+#ifndef _VIEW_HISTORY_H_
+#define _VIEW_HISTORY_H_
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <functional>
+
+// One history file of the view server, holding the samples of one data
+// set at one history level.  The file is binary and columnar:
+//
+//   header:  magic, version, number of columns
+//   'K' record:  a key (submitter, machine or group name) seen for the
+//                first time, which gets the next key id
+//   'S' record:  a sample, which is the time, the number of rows, the key
+//                id of each row, then each column of float values
+//
+// Each name is written once per file rather than once per sample, and
+// the values are stored as floats rather than text.  Opening a file reads
+// the key records and the key ids of the samples, so the file stays on
+// disk but we know which sample and row holds each key at each time, and
+// a query reads only the values it sends.
+class ViewHistoryFile {
+public:
+	ViewHistoryFile() = default;
+
+	// Forget what we know and index filename, which need not exist.  A
+	// truncated record at the end, left by a crash, is cut off.  Returns
+	// false if the file is not a history file with this many columns.
+	bool Open(const std::string & filename, int columns);
+
+	const std::string & FileName() const { return m_filename; }
+	// the time of the first sample, or -1 if there are none
+	time_t StartTime() const { return m_samples.empty() ? -1 : m_samples.front().time; }
+	long Size() const { return m_size; }
+
+	// Append a sample at time t.  names must be sorted, values holds
+	// at least as many floats for each name as there are columns.
+	bool Append(time_t t, const std::vector<std::string> & names, const std::vector<const float *> & values);
+
+	// Call fn for each key with a sample between from and to.
+	void ListKeys(time_t from, time_t to, const std::function<void(const std::string &)> & fn) const;
+
+	// Call fn with the time, key and values of the samples between from
+	// and to, in time order and sorted by key within a sample.  key is
+	// "*" for all keys.  Stops and returns false if fn returns false or
+	// the file can't be read.
+	bool Scan(time_t from, time_t to, const std::string & key,
+	          const std::function<bool(time_t, const std::string &, const float *)> & fn) const;
+
+private:
+	struct Sample {
+		time_t time;
+		long offset;	// of the key ids
+		unsigned int rows;
+	};
+	struct Row {
+		unsigned int sample;
+		unsigned int row;
+	};
+
+	void Clear();
+	// the first sample at or after t
+	size_t FirstSample(time_t t) const;
+	bool ReadValues(FILE * fp, const Sample & sample, unsigned int row, float * values) const;
+
+	std::string m_filename;
+	int m_columns{0};
+	long m_size{0};
+
+	std::vector<Sample> m_samples;
+	std::vector<std::string> m_keys;	// by key id
+	std::unordered_map<std::string, unsigned int> m_keyIds;
+	std::vector<std::vector<Row>> m_rows;	// by key id, in sample order
+};
+
+#endif
@@ -40,11 +40,9 @@ DataSetInfo ViewServer::DataSet[DataSetCount][HistoryLevels];
 time_t ViewServer::TimeStamp;
 int ViewServer::HistoryTimer;
 std::string ViewServer::DataFormat[DataSetCount];
+int ViewServer::DataColumns[DataSetCount];
 AccHash* ViewServer::GroupHash;
 bool ViewServer::KeepHistory;
-std::map< std::string, int >* ViewServer::FileHash;
-std::vector<ExtIntArray *> *ViewServer::TimesArray;
-std::vector<ExtOffArray *> *ViewServer::OffsetsArray;
 
 //-----------------------
 // Constructor
@@ -121,17 +119,21 @@ void ViewServer::Init()
 		}
 	}
 	GroupHash = new AccHash;
-	FileHash = new std::map<std::string, int>;
-	OffsetsArray = new std::vector< ExtOffArray*>;
-	TimesArray = new std::vector<ExtIntArray*>;
 
-	// File data format
+	// Format of the data sent to condor_stats, and the number of values
+	// stored in the history files
 
-	DataFormat[SubmittorData]="%d\t%s\t:\t%.0f\t%.0f\n";
-	DataFormat[SubmittorGroupsData]="%d\t%s\t:\t%.0f\t%.0f\n";
-	DataFormat[StartdData]="%d\t%s\t:\t%.0f\t%7.3f\t%.0f\n";
-	DataFormat[GroupsData]="%d\t%s\t:\t%.1f\t%.1f\t%.1f\t%.1f\t%.1f\t%.1f\t%.1f\t%.1f\t%.1f\n";
-	DataFormat[CkptData]="%d\t%s\t:\t%.3f\t%.3f\t%.3f\t%.3f\n";
+	DataFormat[SubmittorData]="%lld\t%s\t:\t%.0f\t%.0f\n";
+	DataFormat[SubmittorGroupsData]="%lld\t%s\t:\t%.0f\t%.0f\n";
+	DataFormat[StartdData]="%lld\t%s\t:\t%.0f\t%7.3f\t%.0f\n";
+	DataFormat[GroupsData]="%lld\t%s\t:\t%.1f\t%.1f\t%.1f\t%.1f\t%.1f\t%.1f\t%.1f\t%.1f\t%.1f\n";
+	DataFormat[CkptData]="%lld\t%s\t:\t%.3f\t%.3f\t%.3f\t%.3f\n";
+
+	DataColumns[SubmittorData]=2;
+	DataColumns[SubmittorGroupsData]=2;
+	DataColumns[StartdData]=3;
+	DataColumns[GroupsData]=VIEW_STATE_MAX;
+	DataColumns[CkptData]=4;
 
 	return;
 }
@@ -180,20 +182,118 @@ void ViewServer::Config()
 		EXCEPT("POOL_HISTORY_DIR (%s) does not exist.",history_dir);
 	}
 
+	std::string FileName;
 	for (int i=0; i<DataSetCount; i++) {
 		for (int j=0; j<HistoryLevels; j++) {
 			DataSet[i][j].MaxSamples=4*((int) pow((double)4,(double)j));
 			DataSet[i][j].NumSamples=0;
-			formatstr(DataSet[i][j].OldFileName, "%s/viewhist%d.%d.old",history_dir,i,j);
-			DataSet[i][j].OldStartTime=FindFileStartTime(DataSet[i][j].OldFileName.c_str());
-			formatstr(DataSet[i][j].NewFileName, "%s/viewhist%d.%d.new",history_dir,i,j);
-			DataSet[i][j].NewStartTime=FindFileStartTime(DataSet[i][j].NewFileName.c_str());
+			formatstr(FileName, "%s/viewdata%d.%d.old",history_dir,i,j);
+			OpenHistoryFile(DataSet[i][j].OldFile, FileName, DataColumns[i]);
+			formatstr(FileName, "%s/viewdata%d.%d.new",history_dir,i,j);
+			OpenHistoryFile(DataSet[i][j].NewFile, FileName, DataColumns[i]);
+
+			// Carry over the text history files of older versions, oldest first
+			if (DataSet[i][j].OldFile.Size() == 0 && DataSet[i][j].NewFile.Size() == 0) {
+				formatstr(FileName, "%s/viewhist%d.%d.old",history_dir,i,j);
+				ConvertLegacyHistoryFile(DataSet[i][j].OldFile, FileName, DataColumns[i]);
+			}
+			if (DataSet[i][j].NewFile.Size() == 0) {
+				formatstr(FileName, "%s/viewhist%d.%d.new",history_dir,i,j);
+				ConvertLegacyHistoryFile(DataSet[i][j].NewFile, FileName, DataColumns[i]);
+			}
 		}
 	}
 
 	return;
 }
 
+//-------------------------------------------------------------------
+// Index a history file, moving it aside if we can't read it
+//-------------------------------------------------------------------
+
+void ViewServer::OpenHistoryFile(ViewHistoryFile& File, const std::string& FileName, int Columns)
+{
+	if (!File.Open(FileName, Columns)) {
+		std::string BadFileName = FileName + ".bad";
+		dprintf(D_ALWAYS,"Moving unreadable history file %s to %s\n",FileName.c_str(),BadFileName.c_str());
+		if (rotate_file(FileName.c_str(), BadFileName.c_str()) < 0) {
+			EXCEPT("Could not rename history file %s",FileName.c_str());
+		}
+		File.Open(FileName, Columns);
+	}
+	dprintf(D_ALWAYS,"FileName=%s , StartTime=%lld\n",FileName.c_str(),(long long)File.StartTime());
+}
+
+//-------------------------------------------------------------------
+// Append the samples of a text history file written by older versions
+// to File, then move the text file aside so it is converted only once.
+// Each line of the text file is "time<tab>name<tab>:<tab>values..."
+// and the lines of one sample share the time.
+//-------------------------------------------------------------------
+
+void ViewServer::ConvertLegacyHistoryFile(ViewHistoryFile& File, const std::string& LegacyName, int Columns)
+{
+	FILE* fp = safe_fopen_wrapper_follow(LegacyName.c_str(), "r");
+	if (!fp) return;
+
+	dprintf(D_ALWAYS,"Converting history file %s to %s\n",LegacyName.c_str(),File.FileName().c_str());
+
+	time_t SampleTime = -1;
+	std::map<std::string, std::vector<float>> Rows;
+	int Samples = 0, BadLines = 0;
+	bool ok = true;
+
+	auto AppendSample = [&]() {
+		if (Rows.empty()) return;
+		std::vector<std::string> Names;
+		std::vector<const float*> Values;
+		for (const auto& [Name, Row] : Rows) {
+			Names.push_back(Name);
+			Values.push_back(Row.data());
+		}
+		if (ok && !File.Append(SampleTime, Names, Values)) {
+			dprintf(D_ALWAYS,"Could not write history file %s\n",File.FileName().c_str());
+			ok = false;
+		}
+		++Samples;
+		Rows.clear();
+	};
+
+	std::string line;
+	while (ok && readLine(line, fp)) {
+		const char* p = line.c_str();
+		char* end = nullptr;
+		long long t = strtoll(p, &end, 10);
+		const char* name_start = (end && *end == '\t') ? end+1 : nullptr;
+		const char* name_end = name_start ? strchr(name_start, '\t') : nullptr;
+		if (!name_end || name_end[1] != ':') {
+			++BadLines;
+			continue;
+		}
+		std::vector<float> Row(Columns, 0.0f);
+		p = name_end+2;
+		for (int k=0; k<Columns; k++) {
+			Row[k] = strtof(p, &end);
+			if (end == p) break;
+			p = end;
+		}
+		if ((time_t)t != SampleTime) {
+			AppendSample();
+			SampleTime = (time_t)t;
+		}
+		Rows[std::string(name_start, name_end-name_start)] = std::move(Row);
+	}
+	fclose(fp);
+	AppendSample();
+
+	if (!ok) return;
+	dprintf(D_ALWAYS,"Converted %d samples from %s, skipped %d bad lines\n",Samples,LegacyName.c_str(),BadLines);
+	std::string DoneName = LegacyName + ".converted";
+	if (rotate_file(LegacyName.c_str(), DoneName.c_str()) < 0) {
+		dprintf(D_ALWAYS,"Could not rename history file %s\n",LegacyName.c_str());
+	}
+}
+
 //-------------------------------------------------------------------
 // Fast shutdown
 //-------------------------------------------------------------------
@@ -298,14 +398,16 @@ int ViewServer::HandleQuery(Stream* sock, int command, time_t FromDate, time_t T
 	int OldFlag=1, NewFlag=1;
 
 	for (int j=0; j<HistoryLevels; j++) {
-		if (FromDate>=DataSet[DataSetIdx][j].NewStartTime && DataSet[DataSetIdx][j].NewStartTime!=-1) {
+		time_t NewStartTime=DataSet[DataSetIdx][j].NewFile.StartTime();
+		time_t OldStartTime=DataSet[DataSetIdx][j].OldFile.StartTime();
+		if (FromDate>=NewStartTime && NewStartTime!=-1) {
 			HistoryLevel=j;
 			OldFlag=0;
 			break;
 		}
-		else if (FromDate>=DataSet[DataSetIdx][j].OldStartTime && DataSet[DataSetIdx][j].OldStartTime!=-1) {
+		else if (FromDate>=OldStartTime && OldStartTime!=-1) {
 			HistoryLevel=j;
-			if (ToDate<DataSet[DataSetIdx][j].NewStartTime) NewFlag=0;
+			if (ToDate<NewStartTime) NewFlag=0;
 			break;
 		}
 	}
@@ -314,8 +416,8 @@ int ViewServer::HandleQuery(Stream* sock, int command, time_t FromDate, time_t T
 		time_t LevelStartTime;
 		time_t MinStartTime=-1;
 		for (int j=0; j<HistoryLevels; j++) {
-			LevelStartTime=DataSet[DataSetIdx][j].OldStartTime;
-			if (LevelStartTime==-1) LevelStartTime=DataSet[DataSetIdx][j].NewStartTime;
+			LevelStartTime=DataSet[DataSetIdx][j].OldFile.StartTime();
+			if (LevelStartTime==-1) LevelStartTime=DataSet[DataSetIdx][j].NewFile.StartTime();
 			if (LevelStartTime!=-1) {
 				if (LevelStartTime<MinStartTime || MinStartTime==-1) {
 					MinStartTime=LevelStartTime;
@@ -327,17 +429,18 @@ int ViewServer::HandleQuery(Stream* sock, int command, time_t FromDate, time_t T
 
 	dprintf(D_ALWAYS,"DataSetIdx=%d, HistoryLevel=%d, OldFlag=%d, NewFlag=%d\n",DataSetIdx,HistoryLevel,OldFlag,NewFlag);
 	if (HistoryLevel==-1) return 0;
-	dprintf(D_ALWAYS,"OldStartTime=%lld , NewStartTime=%lld\n",(long long) DataSet[DataSetIdx][HistoryLevel].OldStartTime,(long long) DataSet[DataSetIdx][HistoryLevel].NewStartTime);
+	const DataSetInfo& Info=DataSet[DataSetIdx][HistoryLevel];
+	dprintf(D_ALWAYS,"OldStartTime=%lld , NewStartTime=%lld\n",(long long) Info.OldFile.StartTime(),(long long) Info.NewFile.StartTime());
 
 	// Read file and send Data
 
 	if (ListFlag) {
 		std::set<std::string> Names;
-		if (OldFlag) SendListReply(sock, DataSet[DataSetIdx][HistoryLevel].OldFileName,FromDate,ToDate,Names);
-		if (NewFlag) SendListReply(sock, DataSet[DataSetIdx][HistoryLevel].NewFileName,FromDate,ToDate,Names);
+		if (OldFlag) SendListReply(sock, Info.OldFile,FromDate,ToDate,Names);
+		if (NewFlag) SendListReply(sock, Info.NewFile,FromDate,ToDate,Names);
 	} else {
-		if (OldFlag) SendDataReply(sock, DataSet[DataSetIdx][HistoryLevel].OldFileName,FromDate,ToDate,Options,Arg);
-		if (NewFlag) SendDataReply(sock, DataSet[DataSetIdx][HistoryLevel].NewFileName,FromDate,ToDate,Options,Arg);
+		if (OldFlag) SendDataReply(sock, DataSetIdx, Info.OldFile,FromDate,ToDate,Options,Arg);
+		if (NewFlag) SendDataReply(sock, DataSetIdx, Info.NewFile,FromDate,ToDate,Options,Arg);
 	}
 
 	return 0;
@@ -348,164 +451,54 @@ int ViewServer::HandleQuery(Stream* sock, int command, time_t FromDate, time_t T
 // requested time range
 //---------------------------------------------------------------------
 
-int ViewServer::SendListReply(Stream* sock,const std::string& FileName, time_t FromDate, time_t ToDate, std::set<std::string>& Names)
+int ViewServer::SendListReply(Stream* sock,const ViewHistoryFile& File, time_t FromDate, time_t ToDate, std::set<std::string>& Names)
 {
-	time_t T = 0;
-	int file_array_index;
-	ExtIntArray* times_array = NULL;
-	ExtOffArray* offsets = NULL;
-
-		// first find out which vector to use, by checking the hash
-	auto file_itr = FileHash->find(FileName);
-	if (file_itr == FileHash->end()) {
-
-			// FileName was not found in the FileHash
-			// Create the necessary arrays and set the index appropriately
-		// dprintf(D_ALWAYS, "No cache found for this file, generating new one...\n");
-		times_array = new ExtIntArray(100);
-		offsets = new ExtOffArray(100);
-		file_array_index = OffsetsArray->size();
-		FileHash->emplace(FileName, file_array_index);
-		TimesArray->push_back(times_array);
-		OffsetsArray->push_back(offsets);
-	} else {
-			// otherwise just get the appropriate array
-		file_array_index = file_itr->second;
-		times_array = (TimesArray->at( file_array_index ));
-		offsets = (OffsetsArray->at( file_array_index ));
-	}
-
-	FILE* fp=safe_fopen_wrapper_follow(FileName.c_str(),"r");
-	if (!fp) return -1;
-
-		//find the offset to search at
-	fpos_t* search_offset = findOffset(fp, FromDate, ToDate, times_array, offsets);
-	if(search_offset != NULL) {
-			// set the seek to the correct spot and begin searching the file
-		if(fsetpos(fp, search_offset) < 0) {
-				// something failed, so get out of here
-			fclose(fp);
-			return -1;
-		}
-	}
-
-	std::string Arg;
-	std::string line;
-	int new_offset_counter = 1;		// every fifty loops, mark an offset
-	while(readLine(line,fp)) {
-
-		T = ReadTimeAndName(line, Arg);
-		if( times_array->size() < offsets->size() ) {
-				// a file offset was recorded before this line was read; now
-				// store the time that was on the marked line
-			times_array->push_back( T );
-		}
-
-		if (T > ToDate) break;
-		if (T < FromDate) {
-				// continue to the next loop; but first, if 50 times have been
-				// checked, mark the position in the file and the time
-			addNewOffset(fp, new_offset_counter, T, times_array, offsets);
-			continue;
+	int Status=0;
+	File.ListKeys(FromDate, ToDate, [&](const std::string& Name) {
+		if (Status<0 || !Names.insert(Name).second) return;
+
+			// Send the name...
+		std::string Arg(Name);
+		if (!sock->code(Arg)) {
+			dprintf(D_ALWAYS,"Can't send name to client!\n");
+			Status=-1;
+			return;
 		}
 
-		if (Names.count(Arg) == 0) {
-			Names.insert(Arg);
-				// Send the name...
-			if (!sock->code(Arg)) {
-				dprintf(D_ALWAYS,"Can't send name to client!\n");
-				fclose(fp);
-				return -1;
-			}
-
-			// with a newline
-			char newline = '\n';
-			if (!sock->code(newline)) {
-				dprintf(D_ALWAYS,"Can't send trailing newline to client!\n");
-				fclose(fp);
-				return -1;
-			}
+		// with a newline
+		char newline = '\n';
+		if (!sock->code(newline)) {
+			dprintf(D_ALWAYS,"Can't send trailing newline to client!\n");
+			Status=-1;
 		}
-		addNewOffset(fp, new_offset_counter, T, times_array, offsets);
-	}
-
-	fclose(fp);
-	return 0;
+	});
+	return Status;
 }
 
-int ViewServer::SendDataReply(Stream* sock,const std::string& FileName, time_t FromDate, time_t ToDate, int Options, const std::string& Arg)
+//---------------------------------------------------------------------
+// Send the data for the requested name (or "*" for all) from the
+// specified file for the requested time range
+//---------------------------------------------------------------------
+
+int ViewServer::SendDataReply(Stream* sock,int DataSetIdx,const ViewHistoryFile& File, time_t FromDate, time_t ToDate, int Options, const std::string& Arg)
 {
-	std::string InpLine;
 	int Status=0;
 	time_t NewTime, OldTime;
 	float OutTime;
-	time_t T = 0;
-	int file_array_index;
-	ExtIntArray* times_array = NULL;
-	ExtOffArray* offsets = NULL;
-	// dprintf(D_ALWAYS, "Caches found=%d, looking for correct one...\n", TimesArray->length());
-
-		// first find out which vector to use, by checking the hash
-	auto file_itr = FileHash->find(FileName);
-	if (file_itr == FileHash->end()) {
-
-			// FileName was not found in the FileHash
-			// Create the necessary arrays and set the index appropriately
-		// dprintf(D_ALWAYS, "No cache found for this file, generating new one...\n");
-		times_array = new ExtIntArray(100);
-		offsets = new ExtOffArray(100);
-		file_array_index = OffsetsArray->size();
-		FileHash->emplace(FileName, file_array_index);
-		TimesArray->push_back( times_array );
-		OffsetsArray->push_back( offsets );
-	} else {
-
-			// otherwise just get the appropriate array
-		file_array_index = file_itr->second;
-		times_array = (TimesArray->at( file_array_index ));
-		offsets = (OffsetsArray->at( file_array_index ));
-		// dprintf(D_ALWAYS, "Cache found for this file, %d indices\n", times_array->length());
-	}
+	std::string InpLine;
 
 	OldTime = 0;
-	FILE* fp=safe_fopen_wrapper_follow(FileName.c_str(),"r");
-	if (!fp) return -1;
-
-		//find the offset to search at
-	fpos_t* search_offset = findOffset(fp, FromDate, ToDate, times_array, offsets);
-	if(search_offset != NULL) {
-			// set the seek to the correct spot and begin searching the file
-		if(fsetpos(fp, search_offset) < 0) {
-				// something failed, so get out of here
-			fclose(fp);
-			return -1;
-		}
-	}
-
-	int new_offset_counter = 1;		// every fifty loops, mark an offset
-	while(readLine(InpLine,fp)) {
-
-		T=ReadTimeChkName(InpLine,Arg);
-		if( times_array->size() < offsets->size() ) {
-				// a file offset was recorded before this line was read; now
-				// store the time that was on the marked line
-			times_array->push_back( T );
-		}
-		// dprintf(D_ALWAYS,"T=%d\n",T);
-
-		if (T>ToDate) break;
-		if (T<FromDate) {
-				// continue to the next loop; but first, if 50 times have been
-				// checked, mark the position in the file and the time
-			addNewOffset(fp, new_offset_counter, T, times_array, offsets);
-			continue;
+	bool ok = File.Scan(FromDate, ToDate, Arg, [&](time_t T, const std::string& Name, const float* Data) {
+		double Values[VIEW_STATE_MAX] = {};
+		for (int k=0; k<DataColumns[DataSetIdx]; k++) {
+			Values[k]=Data[k];
 		}
+		formatstr(InpLine,DataFormat[DataSetIdx].c_str(),(long long)T,Name.c_str(),Values[0],Values[1],Values[2],Values[3],Values[4],Values[5],Values[6],Values[7],Values[8]);
 
 		if (Options) {
 			if (!sock->code(InpLine)) {
 				dprintf(D_ALWAYS,"Can't send information to client!\n");
-				Status=-1;
-				break;
+				return false;
 			}
 		}
 		else {
@@ -514,193 +507,21 @@ int ViewServer::SendDataReply(Stream* sock,const std::string& FileName, time_t F
 			const char *tmp = strchr(InpLine.c_str(),':');
 			OutTime=float(T-FromDate)/float(ToDate-FromDate);
 			NewTime=(int)rint(1000*OutTime);
-			if (NewTime==OldTime) continue;
-            OldTime=NewTime;
+			if (NewTime==OldTime) return true;
+			OldTime=NewTime;
 			snprintf(OutLine,sizeof(OutLine),"%.2f%s",OutTime*100,tmp+1);
 			if (!sock->put(OutLine)) {
 				dprintf(D_ALWAYS,"Can't send information to client!\n");
-				Status=-1;
-				break;
+				return false;
 			}
 		}
-		addNewOffset(fp, new_offset_counter, T, times_array, offsets);
-	}
+		return true;
+	});
+	if (!ok) Status=-1;
 
-	fclose(fp);
 	return Status;
 }
 
-//*******************************************************************
-// Utility files for recording offsets in the condor_stats files.
-//*******************************************************************
-
-//-------------------------------------------------------------------
-// Increments the counter, and then if it's reached 50, adds the
-// offset to the list.
-//-------------------------------------------------------------------
-
-void
-ViewServer::addNewOffset(FILE* &fp, int &offset_ctr, time_t read_time, ExtIntArray* times_array, ExtOffArray* offsets) {
-	if( ++offset_ctr == 50) {
-		offset_ctr = 0;
-		if (times_array->empty() || read_time > times_array->back()) {
-				// mark the position in the file now, but wait to mark the time
-				// until after the line is read
-			// dprintf(D_ALWAYS, "Adding new offset to the cache\n");
-			fpos_t *tmp_offset_ptr = new fpos_t;
-			fgetpos(fp, tmp_offset_ptr);
-			offsets->push_back(tmp_offset_ptr);
-		} else {
-			// dprintf(D_ALWAYS, "I would mark an offset, but it would most likely be a duplicate.\n");
-		}
-	}
-}
-
-//-------------------------------------------------------------------
-// Sets the offset to the appropriate spot in the file to minimize
-// linear searching of the file.
-//-------------------------------------------------------------------
-
-fpos_t*
-ViewServer::findOffset(FILE* & /*fp*/, time_t FromDate, time_t ToDate, ExtIntArray* times_array, ExtOffArray* offsets) {
-	fpos_t* search_offset_ptr = NULL;
-	if( times_array->size() == 0 ) {
-
-			// linear progression, return null to inform the rest of the code
-			// to start at the beginning
-		// dprintf(D_ALWAYS, "No cache, starting at the beginning of the file...\n");
-		return NULL;
-
-	} else if( times_array->at( 0 ) > FromDate ) {
-
-		if( times_array->front() > ToDate ) {
-				// if this is the case then the record won't be found, so end
-			// dprintf(D_ALWAYS, "Impossible request\n");
-			return NULL;
-		} else {
-				// this file begins in the middle of the requested interval, so
-				// start at the beginning of the file.
-			// dprintf(D_ALWAYS, "Carrying over from previous file at the beginning\n");
-			return NULL;
-		}
-
-	} else if( times_array->back() < FromDate ) {
-
-			// linear progression, but start with the latest known offset
-		// dprintf(D_ALWAYS, "Requesting time at the end of where the current cache knows\n");
-		search_offset_ptr = offsets->back();
-
-	} else {
-
-			// binary search through times_array[] for the latest time not
-			// greater than FromDate
-		// dprintf(D_ALWAYS, "Binary searching the cache table, request should be quick\n");
-		int low = 0;
-		int high = times_array->size()-1;
-		int mid;
-		while( high - low > 1 ) {
-			mid = (high - low) / 2 + low;
-			if( times_array->at( mid ) < FromDate ) {
-				low = mid;
-			} else {
-				high = mid;
-			}
-		}
-			// now we've found the approximate spot in the array; time to find
-			// the exact location and set the appropriate offset
-		if( times_array->at( low + 1 ) < FromDate ) {
-			search_offset_ptr = offsets->at( low + 1 );
-		} else if( times_array->at( low ) < FromDate ) {
-			search_offset_ptr = offsets->at( low );
-		} else {
-			return NULL;
-		}
-	}
-	return search_offset_ptr;
-}
-
-//*******************************************************************
-// Utility functions for reading the history files & data
-//*******************************************************************
-
-//-------------------------------------------------------------------
-// Read the first entry to decide the time of the earliest entry
-// in the file
-//-------------------------------------------------------------------
-
-time_t ViewServer::FindFileStartTime(const char *Name)
-{
-	std::string line;
-	time_t T=-1;
-	FILE* fp=safe_fopen_wrapper_follow(Name,"r");
-	if (fp) {
-		if (readLine(line,fp)) {
-			T=ReadTime(line.c_str());
-		} else {
-			T=-1; // fgets failed, return -1 instead of parsing uninit memory
-			dprintf(D_ALWAYS, "Failed to parse first line of %s\n", Name);
-		}
-		fclose(fp);
-	}
-	dprintf(D_ALWAYS,"FileName=%s , StartTime=%lld\n",Name,(long long)T);
-	return T;
-}
-
-//-------------------------------------------------------------------
-// Parse the entry time from the line
-//-------------------------------------------------------------------
-
-time_t ViewServer::ReadTime(const char* Line)
-{
-	long long t=-1;
-	if (sscanf(Line,"%lld",&t)!=1) return -1;
-	return t;
-}
-
-//-------------------------------------------------------------------
-// Parse the entry time and name from the line
-//-------------------------------------------------------------------
-
-time_t ViewServer::ReadTimeAndName(const std::string &line, std::string& Name)
-{
-	time_t t=-1;
-
-	// Line contains int, tab, a string, tab then junk
-	char *endOfInt = nullptr;
-	t = strtol(line.c_str(), &endOfInt, 10);
-	if (endOfInt) {
-		endOfInt++; // skip past tabl
-		char *endOfString = endOfInt;
-		while (*endOfString != '\t') endOfString++;
-		Name = std::string(endOfInt, endOfString);
-		return t;
-	} else {
-		// Some kind of error
-		return -1;
-	}
-}
-
-//-------------------------------------------------------------------
-// Parse the time and check for the specified name
-//-------------------------------------------------------------------
-
-time_t ViewServer::ReadTimeChkName(const std::string &line, const std::string& Name)
-{
-	time_t t=-1;
-	//if (sscanf(Line,"%d %s",&t,tmp)!=2) return -1;
-	char *p = nullptr;
-	t = strtol(line.c_str(), &p, 10);
-	if (p) {
-		p++; // skip the tab separator
-		char *endOfString = p;
-		while (*endOfString != '\t') endOfString++;
-
-		if (Name != "*" && Name != std::string(p, endOfString)) return -1;
-		return t;
-	}
-	return t;
-}
-
 //*********************************************************************
 // History file writing functions
 //*********************************************************************
@@ -711,9 +532,8 @@ time_t ViewServer::ReadTimeChkName(const std::string &line, const std::string& N
 
 void ViewServer::WriteHistory(int /* tid */)
 {
-	FILE* DataFile;
-	struct stat statbuf;
-	std::string outline;
+	std::vector<std::string> Names;
+	std::vector<const float*> Values;
 
 	// Accumulate data
 
@@ -743,82 +563,43 @@ void ViewServer::WriteHistory(int /* tid */)
 
 		for (int j=0; j<HistoryLevels; j++) {
 
-			// Open files for writing
+			// Write once for every MaxSamples samples
 
 			DataSet[i][j].NumSamples++;
 			if (DataSet[i][j].NumSamples<DataSet[i][j].MaxSamples) continue;
 			DataSet[i][j].NumSamples=0;
-			dprintf(D_FULLDEBUG,"Opening file %s\n",DataSet[i][j].NewFileName.c_str());
-			DataFile=safe_fopen_wrapper_follow(DataSet[i][j].NewFileName.c_str(),"a");
-			if (!DataFile) {
-				dprintf(D_ALWAYS,"Could not open data file %s for appending!!! errno=%d\n",DataSet[i][j].NewFileName.c_str(),errno);
-				EXCEPT("Could not open data file appending!!!");
-			}
 
-			// Iterate through accumulated values
+			// Append the accumulated values as one sample
 
-			for (auto& [Key, GenRec]: *DataSet[i][j].AccData) {
-				formatstr(outline,DataFormat[i].c_str(),TimeStamp,Key.c_str(),GenRec->Data[0],GenRec->Data[1],GenRec->Data[2],GenRec->Data[3],GenRec->Data[4],GenRec->Data[5],GenRec->Data[6], GenRec->Data[7], GenRec->Data[8]);
-				delete GenRec;
-				fputs(outline.c_str(), DataFile);
+			Names.clear();
+			Values.clear();
+			for (const auto& [Key, GenRec]: *DataSet[i][j].AccData) {
+				Names.push_back(Key);
+				Values.push_back(GenRec->Data);
+			}
+			if (!DataSet[i][j].NewFile.Append(TimeStamp, Names, Values)) {
+				EXCEPT("Could not append to data file %s!!!",DataSet[i][j].NewFile.FileName().c_str());
 			}
 
 			// Clear accumulated values
 
+			for (auto& [Key, GenRec]: *DataSet[i][j].AccData) {
+				delete GenRec;
+			}
 			DataSet[i][j].AccData->clear();
 
-			// close file
-
-			fclose(DataFile);
-			dprintf(D_FULLDEBUG,"Closing file %s\n",DataSet[i][j].NewFileName.c_str());
-
-			// Update file start time
-
-			if (DataSet[i][j].NewStartTime==-1) DataSet[i][j].NewStartTime=TimeStamp;
-
 			// Check for size limitation and take necessary action
 
-			if (stat(DataSet[i][j].NewFileName.c_str(),&statbuf)) {
-				dprintf(D_ALWAYS,"Could not check data file %s size, that we just wrote to. Errno=%d\n",DataSet[i][j].NewFileName.c_str(),errno);
-				continue;
-			}
-			if (statbuf.st_size>MaxFileSize) {
-				int r = rotate_file(DataSet[i][j].NewFileName.c_str(), DataSet[i][j].OldFileName.c_str());
+			if (DataSet[i][j].NewFile.Size()>MaxFileSize) {
+				std::string NewFileName = DataSet[i][j].NewFile.FileName();
+				std::string OldFileName = DataSet[i][j].OldFile.FileName();
+				int r = rotate_file(NewFileName.c_str(), OldFileName.c_str());
 				if (r < 0) {
-					dprintf(D_ALWAYS,"Could not rename %s to %s (%d)\n", DataSet[i][j].NewFileName.c_str(), DataSet[i][j].OldFileName.c_str(), errno);
+					dprintf(D_ALWAYS,"Could not rename %s to %s (%d)\n", NewFileName.c_str(), OldFileName.c_str(), errno);
 					EXCEPT("Could not rename data file");
 				}
-				int newFileIndex = -1;
-				int oldFileIndex = -1;
-				auto new_file_itr = FileHash->end();
-				auto old_file_itr = FileHash->find(DataSet[i][j].OldFileName);
-				if (old_file_itr != FileHash->end()) {
-					oldFileIndex = old_file_itr->second;
-						// get rid of the old arrays and make new ones
-					delete (*TimesArray)[oldFileIndex];
-					for (auto p: *(*OffsetsArray)[oldFileIndex]) {
-						delete p;
-					}
-					delete (*OffsetsArray)[oldFileIndex];
-					(*TimesArray)[oldFileIndex] = new ExtIntArray;
-					(*OffsetsArray)[oldFileIndex] = new ExtOffArray;
-					new_file_itr = FileHash->find(DataSet[i][j].NewFileName);
-					if (new_file_itr != FileHash->end()) {
-						newFileIndex = new_file_itr->second;
-							// switch the indices to avoid copying data
-						old_file_itr->second = newFileIndex;
-						new_file_itr->second = oldFileIndex;
-					}
-				}
-				else if((new_file_itr = FileHash->find(DataSet[i][j].NewFileName)) != FileHash->end()) {
-					newFileIndex = new_file_itr->second;
-						// if no file got overwritten, then just add to the
-						// hash and arrays
-					FileHash->erase(new_file_itr);
-					(*FileHash)[DataSet[i][j].OldFileName] = newFileIndex;
-				}
-				DataSet[i][j].OldStartTime=DataSet[i][j].NewStartTime;
-				DataSet[i][j].NewStartTime=-1;
+				OpenHistoryFile(DataSet[i][j].OldFile, OldFileName, DataColumns[i]);
+				OpenHistoryFile(DataSet[i][j].NewFile, NewFileName, DataColumns[i]);
 			}
 		}
 	}
@@ -23,6 +23,7 @@
 //---------------------------------------------------
 
 #include "collector.h"
+#include "view_history.h"
 #include <set>
 #include <map>
 
@@ -60,14 +61,11 @@ struct GeneralRecord {
 //---------------------------------------------------
 
 typedef std::map<std::string, GeneralRecord*> AccHash;
-typedef std::vector< time_t > ExtIntArray;
-typedef std::vector< fpos_t* > ExtOffArray;
 
 //---------------------------------------------------
 
 struct DataSetInfo {
-	std::string OldFileName, NewFileName;
-	time_t OldStartTime, NewStartTime;
+	ViewHistoryFile OldFile, NewFile;
 	int NumSamples, MaxSamples;
 	AccHash* AccData;
 };
@@ -88,8 +86,8 @@ public:
 
 	static int ReceiveHistoryQuery(int, Stream*);
 	static int HandleQuery(Stream*, int cmd, time_t FromDate, time_t ToDate, int Options, std::string Arg);
-	static int SendListReply(Stream*,const std::string& FileName, time_t FromDate, time_t ToDatei, std::set<std::string>& Names);
-	static int SendDataReply(Stream*,const std::string& FileName, time_t FromDate, time_t ToDate, int Options, const std::string& Arg);
+	static int SendListReply(Stream*,const ViewHistoryFile& File, time_t FromDate, time_t ToDate, std::set<std::string>& Names);
+	static int SendDataReply(Stream*,int DataSetIdx,const ViewHistoryFile& File, time_t FromDate, time_t ToDate, int Options, const std::string& Arg);
 
 	static void WriteHistory(int tid);
 	static int SubmittorScanFunc(CollectorRecord*);
@@ -114,6 +112,7 @@ private:
 
 	static DataSetInfo DataSet[DataSetCount][HistoryLevels];
 	static std::string DataFormat[DataSetCount];
+	static int DataColumns[DataSetCount];
 	
 	// Variables used during iteration
 
@@ -122,12 +121,6 @@ private:
 
 	static GeneralRecord* GetAccData(AccHash* AccData,const std::string& Key);
 
-	// Variables used for quick searches by condor_stats
-
-	static std::map< std::string, int >* FileHash;
-	static std::vector< ExtIntArray* >* TimesArray;
-	static std::vector< ExtOffArray* >* OffsetsArray;
-
 	// misc variables
 
 	static int HistoryTimer;
@@ -135,15 +128,8 @@ private:
 
 	// Utility functions
 
-	static void addNewOffset(FILE*&, int &offset_ctr, time_t read_time,
-						ExtIntArray* times_array, ExtOffArray* offsets);
-	static fpos_t* findOffset(FILE*&, time_t FromDate, time_t ToDate,
-						ExtIntArray* times_array, ExtOffArray* offsets);
-
-	static time_t ReadTime(const char* Line);
-	static time_t ReadTimeAndName(const std::string &line, std::string& Name);
-	static time_t ReadTimeChkName(const std::string &line, const std::string& Name);
-	static time_t FindFileStartTime(const char *Name);
+	static void OpenHistoryFile(ViewHistoryFile& File, const std::string& FileName, int Columns);
+	static void ConvertLegacyHistoryFile(ViewHistoryFile& File, const std::string& LegacyName, int Columns);
 };
 
 
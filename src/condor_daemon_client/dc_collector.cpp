@@ -218,6 +218,69 @@ DCCollector::requestScheddToken(const std::string &schedd_name,
 	return true;
 }
 
+ReliSock *
+DCCollector::subscribeAds(ClassAd & query, CondorError & err)
+{
+	ReliSock * rsock = new ReliSock();
+	rsock->timeout(20);
+	if ( ! connectSock(rsock)) {
+		err.pushf("DCCollector", 2, "Failed to connect "
+			"to remote daemon at '%s'", _addr.c_str());
+		delete rsock;
+		return nullptr;
+	}
+
+	if ( ! startCommand(SUBSCRIBE_ADS, rsock, 20, &err)) {
+		err.pushf("DAEMON", 1, "failed to start "
+			"command for subscription with remote collector at '%s'.",
+			_addr.c_str());
+		delete rsock;
+		return nullptr;
+	}
+
+	rsock->encode();
+	if ( ! putClassAd(rsock, query) || ! rsock->end_of_message()) {
+		err.pushf("DAEMON", 1, "Failed to send subscription query to "
+			"remote collector at '%s'",
+			_addr.c_str());
+		delete rsock;
+		return nullptr;
+	}
+
+	rsock->decode();
+	return rsock;
+}
+
+DCCollector::AdsEvent
+DCCollector::readAdsEvent(ReliSock * sock, std::string & key, ClassAd & ad)
+{
+	int event = ADS_EVENT_ERROR;
+	key.clear();
+	ad.Clear();
+
+	sock->decode();
+	if ( ! sock->get(event) || ! sock->get(key)) {
+		dprintf(D_FULLDEBUG, "DCCollector::readAdsEvent() failed to read event\n");
+		return ADS_EVENT_ERROR;
+	}
+	if (event == ADS_EVENT_UPDATED && ! getClassAd(sock, ad)) {
+		dprintf(D_FULLDEBUG, "DCCollector::readAdsEvent() failed to read ad\n");
+		return ADS_EVENT_ERROR;
+	}
+	if ( ! sock->end_of_message()) {
+		return ADS_EVENT_ERROR;
+	}
+
+	switch (event) {
+	case ADS_EVENT_UPDATED:
+	case ADS_EVENT_REMOVED:
+	case ADS_EVENT_SNAPSHOT_DONE:
+		return (AdsEvent)event;
+	default:
+		return ADS_EVENT_ERROR;
+	}
+}
+
 void
 DCCollector::reconfig( void )
 {
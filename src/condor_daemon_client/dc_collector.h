@@ -123,6 +123,35 @@ public:
 		const std::vector<std::string> &authz_bounding_set,
 		int lifetime, std::string &token, CondorError &err);
 
+		/// The events of a subscription made with subscribeAds()
+	enum AdsEvent {
+		ADS_EVENT_ERROR = 0,		// the subscription failed
+		ADS_EVENT_UPDATED = 1,		// a matching ad was inserted or changed
+		ADS_EVENT_REMOVED = 2,		// an ad was removed or no longer matches
+		ADS_EVENT_SNAPSHOT_DONE = 3,	// all ads that matched at the start were sent
+	};
+
+		/** Subscribe to the ads of one type that match a query ad, as
+			made by CondorQuery::getQueryAd().  The collector sends an
+			ADS_EVENT_UPDATED event for each matching ad, then
+			ADS_EVENT_SNAPSHOT_DONE, and from then on an event each time
+			a matching ad is inserted, changed or removed, or stops
+			matching.  An ad that changes several times before the
+			collector gets to send it is sent once.
+			@return the socket to read the events from with
+			readAdsEvent(), or NULL on failure.  Delete the socket to
+			end the subscription.
+		*/
+	ReliSock* subscribeAds(ClassAd & query, CondorError & err);
+
+		/** Read the next event of a subscription, waiting for it if the
+			socket is blocking.  key identifies the ad across events, and
+			ad is set for ADS_EVENT_UPDATED.  Returns ADS_EVENT_ERROR, with
+			the reason in key if the collector gave one, if the
+			subscription failed.
+		*/
+	static AdsEvent readAdsEvent(ReliSock * sock, std::string & key, ClassAd & ad);
+
 private:
 
 	std::string constructorName;
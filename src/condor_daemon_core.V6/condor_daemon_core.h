@@ -63,6 +63,10 @@
 #include <vector>
 #include <memory>
 #include <deque>
+#ifndef WIN32
+#include <mutex>
+#include <thread>
+#endif
 
 #include "../condor_procd/proc_family_io.h"
 class ProcFamilyInterface;
@@ -1320,6 +1324,18 @@ class DaemonCore : public Service
     time_t GetNextRuntime(int id) {return t.GetNextRuntime(id);}
 	//@}
 
+    /** Register a function to call just before each command, socket,
+        timer, signal and reaper handler is called, with the description
+        of the handler.  There is one hook, registering another replaces it.
+        The hook must not register or cancel the handler it is called for.
+    */
+    void Register_Pre_Handler_Hook(std::function<void(const char * handler_descrip)> hook) {
+        m_pre_handler_hook = std::move(hook);
+    }
+    void CallPreHandlerHook(const char * handler_descrip) {
+        if (m_pre_handler_hook) { m_pre_handler_hook(handler_descrip ? handler_descrip : ""); }
+    }
+
     /** Not_Yet_Documented
         @param flag   Not_Yet_Documented
         @param indent Not_Yet_Documented
@@ -1839,6 +1855,12 @@ class DaemonCore : public Service
 	   stats_entry_recent<int> AsyncPipe;      //  number of times async_pipe was signalled
       #endif
 	   stats_entry_abs<int> UdpQueueDepth;  // Unread bytes for the UDP command port 
+	   stats_entry_recent<int64_t> RegexCacheHits;   // ClassAd regexps found in the compiled pattern cache
+	   stats_entry_recent<int64_t> RegexCacheMisses; // ClassAd regexps that had to be compiled
+	   stats_entry_abs<int64_t> ExprCacheEntries;    // distinct expressions in the ClassAd cache
+	   stats_entry_abs<int64_t> ExprCacheReferences; // ad attributes that use them
+	   stats_entry_abs<int64_t> ExprCacheBytes;      // held by the cached expressions
+	   stats_entry_abs<int64_t> ExprCacheBytesSaved; // that the ads would hold without the cache
 
 		
        stats_entry_recent<Probe> PumpCycle;   // count of pump cycles plus sum of cycle time with min/max/avg/std 
@@ -2177,6 +2199,8 @@ class DaemonCore : public Service
 	std::vector<ReapEnt>  reapTable;      // reaper table
     int                 defaultReaper;
 
+    std::function<void(const char *)> m_pre_handler_hook;
+
     class PidEntry : public Service
     {
 	public:
@@ -2256,8 +2280,16 @@ class DaemonCore : public Service
     __declspec(align(MEMORY_ALLOCATION_ALIGNMENT))
     SLIST_HEADER        PumpWorkHead; // list head for async PumpWorkCallback items.
 #else
-    // implement for non windows?
+    struct PumpWorkItem
+    {
+        PumpWorkCallback callback;
+        void *           cls;
+        void *           data;
+    };
 
+    std::mutex               PumpWorkLock;  // guards PumpWorkList
+    std::deque<PumpWorkItem> PumpWorkList;  // async PumpWorkCallback items, in FIFO order
+    std::thread::id          dcmainThreadId;
 #endif
     int  DoPumpWork(); // call on main thread to handle all of work in the PumpWork list, returns number of callbacks handled
             
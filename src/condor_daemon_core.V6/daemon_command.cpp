@@ -776,7 +776,7 @@ DaemonCommandProtocol::CommandProtocolResult DaemonCommandProtocol::ReadCommand(
 						resp_ad.Assign(ATTR_SEC_RETURN_CODE, "SID_NOT_FOUND");
 
 						m_sock->encode();
-						if (!putClassAd(m_sock, resp_ad) || !m_sock->end_of_message()) {
+						if (!putClassAd(m_sock, resp_ad, PUT_CLASSAD_NO_BINARY) || !m_sock->end_of_message()) {
 							dprintf(D_ERROR, "DC_AUTHENTICATE: Failed to send unknown session reply to peer at %s.\n", m_sock->peer_description());
 						}
 					} else {
@@ -1060,7 +1060,8 @@ DaemonCommandProtocol::CommandProtocolResult DaemonCommandProtocol::ReadCommand(
 						dPrintAd( D_SECURITY, *m_policy );
 					}
 					m_sock->encode();
-					if (!putClassAd(m_sock, *m_policy) ||
+					// the client reads the ads of the handshake with getPODClassAd(), which takes only text
+					if (!putClassAd(m_sock, *m_policy, PUT_CLASSAD_NO_BINARY) ||
 						!m_sock->end_of_message()) {
 						dprintf (D_ERROR, "SECMAN: Error sending response classad to %s!\n", m_sock->peer_description());
 						dPrintAd (D_ERROR, m_auth_info);
@@ -1140,7 +1141,7 @@ DaemonCommandProtocol::CommandProtocolResult DaemonCommandProtocol::ReadCommand(
 							return CommandProtocolFinished;
 						}
 						m_sock->encode();
-						if (!putClassAd(m_sock, ad) || !m_sock->end_of_message()) {
+						if (!putClassAd(m_sock, ad, PUT_CLASSAD_NO_BINARY) || !m_sock->end_of_message()) {
 							dprintf(D_ERROR, "DC_AUTHENTICATE: Failed to send nonce to peer at %s.\n", m_sock->peer_description());
 							m_result = false;
 							return CommandProtocolFinished;
@@ -1724,7 +1725,7 @@ DaemonCommandProtocol::CommandProtocolResult DaemonCommandProtocol::SendResponse
 		}
 
 		m_sock->encode();
-		if (! putClassAd(m_sock, pa_ad) ||
+		if (! putClassAd(m_sock, pa_ad, PUT_CLASSAD_NO_BINARY) ||
 			! m_sock->end_of_message() ) {
 			dprintf (D_ERROR, "DC_AUTHENTICATE: unable to send session %s info to %s!\n", m_sid.c_str(), m_sock->peer_description());
 			m_result = FALSE;
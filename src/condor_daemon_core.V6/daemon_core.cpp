@@ -269,6 +269,8 @@ DaemonCore::DaemonCore()
 
 #ifdef WIN32
 	dcmainThreadId = ::GetCurrentThreadId();
+#else
+	dcmainThreadId = std::this_thread::get_id();
 #endif
 
 #ifndef WIN32
@@ -808,10 +810,14 @@ int DaemonCore::Register_PumpWork_TS(PumpWorkCallback handler, void* cls, void*
 	}
 	return 1;
 #else
-	// implement for non-windows?
-	dprintf(D_ERROR, "Register_PumpWork_TS(%p, %p, %p) called, but has not (yet) been implemented on this platform\n",
-			handler, cls, data);
-	return -1;
+	{
+		std::lock_guard<std::mutex> guard(PumpWorkLock);
+		PumpWorkList.push_back(PumpWorkItem{handler, cls, data});
+	}
+	if (std::this_thread::get_id() != dcmainThreadId) {
+		Do_Wake_up_select();
+	}
+	return 1;
 #endif
 }
 
@@ -851,8 +857,18 @@ int DaemonCore::DoPumpWork() {
 	}
 	return citems;
 #else
-	// implement for non-windows?
-	return 0;
+	std::deque<PumpWorkItem> work;
+	{
+		std::lock_guard<std::mutex> guard(PumpWorkLock);
+		work.swap(PumpWorkList);
+	}
+	if ( ! work.empty()) {
+		dprintf(D_DAEMONCORE, "Processing %d pump work item(s)\n", (int)work.size());
+	}
+	for (const PumpWorkItem & item : work) {
+		item.callback(item.cls, item.data);
+	}
+	return (int)work.size();
 #endif
 }
 
@@ -3510,6 +3526,7 @@ DaemonCore::callSignalHandlers(double & runtime) {
 				// call the handlers
 				for( const auto & handlerEntry : sigEntry.handlers ) {
 					if(! handlerEntry.valid) { continue; }
+					CallPreHandlerHook(handlerEntry.handler_descrip.c_str());
 					handlerEntry.handler(sigEntry.num);
 					// update per-timer runtime and count statistics
 					if(! handlerEntry.handler_descrip.empty() ) {
@@ -3560,7 +3577,7 @@ void DaemonCore::Driver()
 	for(;;)
 	{
 		// handle queued pump work. these are like zero timeout one-shot timers
-		// but unlike timers, can be registered from any thread (only Windows needs the second part)
+		// but unlike timers, can be registered from any thread
 		// We do this before the signal handlers so that pump work can be used to raise a signal
 		int num_pumpwork_fired = DoPumpWork();
 
@@ -4211,23 +4228,31 @@ DaemonCore::CallSocketHandler( const size_t i, bool default_to_HandleCommand )
 		selector.set_timeout( 0, 0 );
 		selector.add_fd( sockTable[i].iosock->get_file_desc(), Selector::IO_READ );
 
-		while ( msg_cnt && frag_cnt ) {
-			selector.execute();
+		// Datagrams already received in a batch (see UDP_RECEIVE_BATCH_SIZE)
+		// are handled even past the per-cycle limits, since select()
+		// would not report them again.
+		auto pending = [&]() {
+			return ((SafeSock *)sockTable[i].iosock)->pendingPackets();
+		};
+		while ( (msg_cnt && frag_cnt) || pending() ) {
+			if ( !pending() ) {
+				selector.execute();
 
-			if ( !selector.has_ready() ) {
-				// No more data, we're done
-				break;
+				if ( !selector.has_ready() ) {
+					// No more data, we're done
+					break;
+				}
 			}
 
 			if ( !sockTable[i].iosock->handle_incoming_packet() )
 			{
 				// Looks like we got a fragment, try reading some more
-				frag_cnt--;
+				if ( frag_cnt ) { frag_cnt--; }
 				continue;
 			}
 			// We don't care about the return value for UDP command sockets
 			HandleReq(i);
-			msg_cnt--;
+			if ( msg_cnt ) { msg_cnt--; }
 
 			// Make sure we didn't leak our priv state
 			CheckPrivState();
@@ -4343,6 +4368,8 @@ DaemonCore::CallSocketHandler_worker( int i, bool default_to_HandleCommand, Stre
 			handler_start_time = _condor_debug_get_time_double();
 		}
 
+		CallPreHandlerHook(sockTable[i].handler_descrip);
+
 	if ( sockTable[i].handler ) {
 			// a C handler
 		result = (*( sockTable[i].handler))(sockTable[i].iosock);
@@ -4607,6 +4634,8 @@ DaemonCore::CallCommandHandler(int req,Stream *stream,bool delete_stream,bool ch
 		
 		handler_start_time = _condor_debug_get_time_double();
 
+		CallPreHandlerHook(comTable[index].handler_descrip);
+
 		// call the handler function; first curr_dataptr for GetDataPtr()
 		curr_dataptr = &(comTable[index].data_ptr);
 
@@ -9499,6 +9528,16 @@ DaemonCore::InitDCCommandSocket( int command_port )
 			}
 		}
 
+			// Receive UDP commands in batches, so a burst of updates
+			// costs fewer system calls.
+		if( it->has_safesock() ) {
+			int batch_size = param_integer("UDP_RECEIVE_BATCH_SIZE", 1, 1, 1024);
+			it->ssock()->setReceiveBatchSize(batch_size);
+			if( batch_size > 1 ) {
+				dprintf(D_FULLDEBUG, "Receiving up to %d UDP datagrams per read\n", batch_size);
+			}
+		}
+
 			// now register these new command sockets.
 			// Note: In other parts of the code, we assume that the
 			// first command socket registered is TCP, so we must
@@ -10070,6 +10109,8 @@ DaemonCore::CallReaper(int reaper_id, char const *whatexited, pid_t pid, int exi
 		"%d <%s>\n",
 		whatexited, (unsigned long)pid, exit_status, reaper_id, hdescrip.c_str());
 
+	CallPreHandlerHook(reaper->handler_descrip);
+
 	if ( reaper->handler ) {
 		// a C handler
 		(*(reaper->handler))(pid,exit_status);
@@ -24,6 +24,7 @@
 #include "classad_helpers.h" // for cleanStringForUseAsAttr
 #include "condor_config.h"   // for param
 #include "../condor_procapi/procapi.h"
+#include "classad/classadCache.h" // for ClassAdGetExprCacheStats
 #include <limits>
 
 int configured_statistics_window_quantum() {
@@ -41,6 +42,21 @@ static void self_monitor(int /* tid */)
     daemonCore->monitor_data.CollectData();
     daemonCore->dc_stats.Tick(daemonCore->monitor_data.last_sample_time);
     daemonCore->dc_stats.DebugOuts += dprintf_getCount();
+
+    // the regex cache counts since startup, we want what happened since the last sample
+    static classad::RegexCacheStats last_regex_stats = {0, 0, 0};
+    classad::RegexCacheStats regex_stats;
+    classad::ClassAdGetRegexCacheStats(regex_stats);
+    daemonCore->dc_stats.RegexCacheHits += (int64_t)(regex_stats.hits - last_regex_stats.hits);
+    daemonCore->dc_stats.RegexCacheMisses += (int64_t)(regex_stats.misses - last_regex_stats.misses);
+    last_regex_stats = regex_stats;
+
+    classad::ExprCacheStats expr_stats;
+    classad::ClassAdGetExprCacheStats(expr_stats);
+    daemonCore->dc_stats.ExprCacheEntries = (int64_t)expr_stats.entries;
+    daemonCore->dc_stats.ExprCacheReferences = (int64_t)expr_stats.references;
+    daemonCore->dc_stats.ExprCacheBytes = (int64_t)expr_stats.bytes;
+    daemonCore->dc_stats.ExprCacheBytesSaved = (int64_t)expr_stats.bytes_saved;
 }
 
 SelfMonitorData::SelfMonitorData()
@@ -235,6 +251,12 @@ void DaemonCore::Stats::Init(bool enable)
    //DC_STATS_ADD_RECENT(Pool, PipeBytes,     IF_BASICPUB);
    DC_STATS_ADD_RECENT(Pool, DebugOuts,     IF_VERBOSEPUB);
    DC_STATS_ADD_RECENT(Pool, PumpCycle,     IF_VERBOSEPUB);
+   DC_STATS_ADD_RECENT(Pool, RegexCacheHits,   IF_BASICPUB);
+   DC_STATS_ADD_RECENT(Pool, RegexCacheMisses, IF_BASICPUB);
+   STATS_POOL_ADD_VAL(Pool, "DC", ExprCacheEntries,    IF_BASICPUB);
+   STATS_POOL_ADD_VAL(Pool, "DC", ExprCacheReferences, IF_BASICPUB);
+   STATS_POOL_ADD_VAL(Pool, "DC", ExprCacheBytes,      IF_BASICPUB);
+   STATS_POOL_ADD_VAL(Pool, "DC", ExprCacheBytesSaved, IF_BASICPUB);
    STATS_POOL_ADD_VAL(Pool, "DC", UdpQueueDepth,  IF_BASICPUB);
    STATS_POOL_PUB_PEAK(Pool, "DC", UdpQueueDepth,  IF_BASICPUB);
    DC_STATS_ADD_DEF(Pool, Commands, IF_BASICPUB);
@@ -442,6 +442,7 @@ TimerManager::Timeout(int * pNumFired /*= NULL*/, double * pruntime /*=NULL*/)
 		// by service*.  If we were told the handler is a c function, we call
 		// it and pass the service* as a parameter.
 		if( in_timeout->std_handler ) {
+			if (daemonCore) { daemonCore->CallPreHandlerHook(in_timeout->event_descrip); }
 			in_timeout->std_handler(in_timeout->id);
 		}
 
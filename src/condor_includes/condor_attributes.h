@@ -86,6 +86,7 @@
 #define ATTR_CHIRP_DELAYED_ATTRS  "ChirpDelayedAttrs"
 #define ATTR_CLAIM_STARTD  "ClaimStartd"
 #define ATTR_COD_CLAIMS  "CODClaims"
+#define ATTR_COLLECTOR_CHANGE_TIME  "CollectorChangeTime"
 #define ATTR_COLLECTOR_HOST  "CollectorHost"
 #define ATTR_COMMAND  "Command"
 #define ATTR_COMMON_INPUT_CATALOGS "CommonInputCatalogs"
@@ -519,6 +520,24 @@
 #define ATTR_JOB_UNIVERSE  "JobUniverse"
 #define ATTR_JOB_WALL_CLOCK_CKPT  "WallClockCheckpoint"
 #define ATTR_JOB_QUEUE_BIRTHDATE  "JobQueueBirthdate"
+#define ATTR_JOB_QUEUE_COMPACTION_STALL_TIME  "JobQueueCompactionStallTime"
+#define ATTR_JOB_QUEUE_COMPACTION_STALL_TIME_MAX  "JobQueueCompactionStallTimeMax"
+#define ATTR_JOB_QUEUE_COMPACTION_TIME  "JobQueueCompactionTime"
+#define ATTR_JOB_QUEUE_COMPACTIONS  "JobQueueCompactions"
+#define ATTR_JOB_QUEUE_INDEXED_QUERIES  "JobQueueIndexedQueries"
+#define ATTR_JOB_QUEUE_INDEXED_QUERY_FRACTION  "JobQueueIndexedQueryFraction"
+#define ATTR_JOB_QUEUE_INIT_TIME  "JobQueueInitTime"
+#define ATTR_JOB_QUEUE_LOAD_PARSE_TIME  "JobQueueLoadParseTime"
+#define ATTR_JOB_QUEUE_LOAD_PLAY_TIME  "JobQueueLoadPlayTime"
+#define ATTR_JOB_QUEUE_LOAD_RECORDS  "JobQueueLoadRecords"
+#define ATTR_JOB_QUEUE_LOAD_THREADS  "JobQueueLoadThreads"
+#define ATTR_JOB_QUEUE_LOAD_TIME  "JobQueueLoadTime"
+#define ATTR_JOB_QUEUE_LOG_COMMITS  "JobQueueLogCommits"
+#define ATTR_JOB_QUEUE_LOG_SYNC_BATCH_MAX  "JobQueueLogSyncBatchMax"
+#define ATTR_JOB_QUEUE_LOG_SYNC_TIME  "JobQueueLogSyncTime"
+#define ATTR_JOB_QUEUE_LOG_SYNC_TIME_MAX  "JobQueueLogSyncTimeMax"
+#define ATTR_JOB_QUEUE_LOG_SYNCS  "JobQueueLogSyncs"
+#define ATTR_JOB_QUEUE_QUERIES  "JobQueueQueries"
 #define ATTR_JOB_REQUIRES_SANDBOX  "JobRequiresSandbox"
 #define ATTR_JOB_CURRENT_RECONNECT_ATTEMPT "JobCurrentReconnectAttempt"
 #define ATTR_TOTAL_JOB_RECONNECT_ATTEMPTS "TotalJobReconnectAttempts"
@@ -922,6 +941,7 @@
 #define ATTR_CLASSAD_LIFETIME  "ClassAdLifetime"
 #define ATTR_UPDATE_PRIO  "UpdatePrio"
 #define ATTR_UPDATE_SEQUENCE_NUMBER  "UpdateSequenceNumber"
+#define ATTR_UPDATE_DELTA_REMOVED_ATTRS  "UpdateDeltaRemovedAttrs"
 #define ATTR_USE_PARROT  "UseParrot"
 #define ATTR_USER  "User"
 #define ATTR_USERREC_OPT_prefix "_userrec_opt_"
@@ -1264,6 +1284,11 @@ extern const char ATTR_SEC_AUTHENTICATED_USER [];
 #define ATTR_LAST_NEGOTIATION_CYCLE_TRIMMED_SLOTS  "LastNegotiationCycleTrimmedSlots"
 #define ATTR_LAST_NEGOTIATION_CYCLE_CANDIDATE_SLOTS  "LastNegotiationCycleCandidateSlots"
 #define ATTR_LAST_NEGOTIATION_CYCLE_SLOT_SHARE_ITER  "LastNegotiationCycleSlotShareIter"
+#define ATTR_LAST_NEGOTIATION_CYCLE_GROUP_QUOTA_ASSIGN_TIME  "LastNegotiationCycleGroupQuotaAssignTime"
+#define ATTR_LAST_NEGOTIATION_CYCLE_GROUP_QUOTA_FAIRSHARE_TIME  "LastNegotiationCycleGroupQuotaFairshareTime"
+#define ATTR_LAST_NEGOTIATION_CYCLE_GROUP_QUOTA_ROUND_ROBIN_TIME  "LastNegotiationCycleGroupQuotaRoundRobinTime"
+#define ATTR_LAST_NEGOTIATION_CYCLE_GROUP_QUOTA_RECOMPUTED  "LastNegotiationCycleGroupQuotaRecomputed"
+#define ATTR_LAST_NEGOTIATION_CYCLE_GROUP_QUOTA_REUSED  "LastNegotiationCycleGroupQuotaReused"
 #define ATTR_LAST_NEGOTIATION_CYCLE_NUM_SCHEDULERS  "LastNegotiationCycleNumSchedulers"
 #define ATTR_LAST_NEGOTIATION_CYCLE_NUM_IDLE_JOBS  "LastNegotiationCycleNumIdleJobs"
 #define ATTR_LAST_NEGOTIATION_CYCLE_NUM_JOBS_CONSIDERED  "LastNegotiationCycleNumJobsConsidered"
@@ -1275,10 +1300,17 @@ extern const char ATTR_SEC_AUTHENTICATED_USER [];
 #define ATTR_LAST_NEGOTIATION_CYCLE_ACTIVE_SUBMITTER_COUNT  "LastNegotiationCycleActiveSubmitterCount"
 #define ATTR_LAST_NEGOTIATION_CYCLE_MATCH_RATE  "LastNegotiationCycleMatchRate"
 #define ATTR_LAST_NEGOTIATION_CYCLE_MATCH_RATE_SUSTAINED  "LastNegotiationCycleMatchRateSustained"
+#define ATTR_LAST_NEGOTIATION_CYCLE_MATCH_EVALS_AVOIDED  "LastNegotiationCycleMatchEvalsAvoided"
+#define ATTR_LAST_NEGOTIATION_CYCLE_PARALLEL_MATCH_TIME  "LastNegotiationCycleParallelMatchTime"
+#define ATTR_LAST_NEGOTIATION_CYCLE_PARALLEL_MATCH_EFFICIENCY  "LastNegotiationCycleParallelMatchEfficiency"
+#define ATTR_LAST_NEGOTIATION_CYCLE_SHARED_MATCHLIST_HITS  "LastNegotiationCycleSharedMatchListHits"
+#define ATTR_LAST_NEGOTIATION_CYCLE_SHARED_MATCHLIST_MISSES  "LastNegotiationCycleSharedMatchListMisses"
+#define ATTR_LAST_NEGOTIATION_CYCLE_REUSED_SLOTS  "LastNegotiationCycleReusedSlots"
 #define ATTR_LAST_NEGOTIATION_CYCLE_PIES  "LastNegotiationCyclePies"
 #define ATTR_LAST_NEGOTIATION_CYCLE_PIE_SPINS  "LastNegotiationCyclePieSpins"
 #define ATTR_LAST_NEGOTIATION_CYCLE_PREFETCH_DURATION  "LastNegotiationCyclePrefetchDuration"
 #define ATTR_LAST_NEGOTIATION_CYCLE_PREFETCH_CPU_TIME  "LastNegotiationCyclePrefetchCpuTime"
+#define ATTR_LAST_NEGOTIATION_CYCLE_PREFETCH_WAIT_TIME  "LastNegotiationCyclePrefetchWaitTime"
 #define ATTR_LAST_NEGOTIATION_CYCLE_SCHEDDS_OUT_OF_TIME  "LastNegotiationCycleScheddsOutOfTime"
 #define ATTR_LAST_NEGOTIATION_CYCLE_CPU_TIME  "LastNegotiationCycleCpuTime"
 #define ATTR_LAST_NEGOTIATION_CYCLE_PHASE1_CPU_TIME  "LastNegotiationCyclePhase1CpuTime"
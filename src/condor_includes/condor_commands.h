@@ -67,7 +67,7 @@ const int REQUEST_CLAIM_SLOT_AD          = 7;
 
 
 constexpr const
-std::array<std::pair<int, const char *>, 212> makeCommandTable() {
+std::array<std::pair<int, const char *>, 213> makeCommandTable() {
 	return {{ // Yes, we need two...
 
 /****
@@ -426,6 +426,8 @@ std::array<std::pair<int, const char *>, 212> makeCommandTable() {
 		{REHOME, "REHOME"},
 #define COMMAND_DATA_SLOT (SCHED_VERS+163)
 		{COMMAND_DATA_SLOT, "COMMAND_DATA_SLOT"},
+#define SEND_FULL_STARTD_UPDATE (SCHED_VERS+164) // Ask a startd to send whole slot ads, because the collector could not apply a delta update
+		{SEND_FULL_STARTD_UPDATE, "SEND_FULL_STARTD_UPDATE"},
 
 
 #define HAD_ALIVE_CMD                   (HAD_COMMANDS_BASE + 0)
@@ -762,7 +764,7 @@ static_assert(makeCommandTable().back().first == COMMAND_LAST, "Is the size of t
 *** Command ids used by the collector 
 ************/
 constexpr const
-std::array<std::pair<int, const char *>, 64> makeCollectorCommandTable() {
+std::array<std::pair<int, const char *>, 66> makeCollectorCommandTable() {
 	return {{ 
 #define UPDATE_STARTD_AD		0
 		{UPDATE_STARTD_AD, "UPDATE_STARTD_AD"},
@@ -937,6 +939,14 @@ std::array<std::pair<int, const char *>, 64> makeCollectorCommandTable() {
 
 		// (83 reserved)
 
+			// Update a startd slot ad with only the attributes that changed since the last update
+#define UPDATE_STARTD_AD_DELTA 84
+		{UPDATE_STARTD_AD_DELTA, "UPDATE_STARTD_AD_DELTA"},
+
+			// Get the ads that match a query, then the changes to them as they happen
+#define SUBSCRIBE_ADS 85
+		{SUBSCRIBE_ADS, "SUBSCRIBE_ADS"},
+
 #define COLLECTOR_COMMAND_LAST (INT_MAX - 1)			// used by the Win32 credd only
 		{COLLECTOR_COMMAND_LAST, "COLLECTOR_COMMAND_LAST"},
 	}};
@@ -41,6 +41,14 @@ int condor_sendto(int sockfd, const void* buf, size_t len, int flags,
 int condor_recvfrom(int sockfd, void* buf, size_t buf_size, int flags,
 		condor_sockaddr& addr);
 
+// Receive up to count datagrams with one system call where the platform
+// has recvmmsg(), else one datagram.  Datagram i is stored at
+// bufs + i*buf_size; its length and sender are stored in lengths[i] and
+// addrs[i].  Waits (if the socket blocks) for the first datagram only.
+// Returns the number of datagrams received, or -1 with errno set.
+int condor_recvfrom_batch(int sockfd, char* bufs, size_t buf_size, int count,
+		int* lengths, condor_sockaddr* addrs);
+
 struct addrinfo;
 // create a socket based on addrinfo
 int condor_socket(const addrinfo& ai);
@@ -44,6 +44,11 @@ int relisock_gsi_put(void *arg,  void *buf, size_t size);
 
 class Authentication;
 class Condor_MD_MAC;
+
+namespace classad {
+class ClassAdBinaryNames;
+}
+
 /** The ReliSock class implements the Sock interface with TCP. */
 
 #define GET_FILE_OPEN_FAILED -2
@@ -295,6 +300,11 @@ public:
 		// Reset the message digests for header integrity.
 	void resetHeaderMD();
 
+		// The attribute names sent or received in the current message
+		// by putClassAd() and getClassAd() in the binary ClassAd encoding.
+		// Cleared at end of message.
+	classad::ClassAdBinaryNames &getBinaryAdNames();
+
 	void SetXferAliveCallback(std::function<void(void)> &f) {m_xfer_alive_callback = f;}
 	void ClearXferAliveCallback() {m_xfer_alive_callback = {};}
 	void XferPingAliveTime()      const {if (m_xfer_alive_callback) m_xfer_alive_callback();}
@@ -422,6 +432,7 @@ protected:
 	std::unique_ptr<EVP_MD_CTX, decltype(&EVP_MD_CTX_free)> m_recv_md_ctx;
 #endif
 	std::vector<unsigned char> m_final_mds;
+	std::unique_ptr<classad::ClassAdBinaryNames> m_binary_ad_names;
 	bool m_final_send_header{false};
 	bool m_final_recv_header{false};
 	bool m_finished_send_header{false};
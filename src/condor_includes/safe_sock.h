@@ -32,6 +32,8 @@
 #include "condor_random_num.h"
 #include "SafeMsg.h"
 
+#include <vector>
+
 static const int SAFE_SOCK_HASH_BUCKET_SIZE = 7;
 static const int SAFE_SOCK_MAX_BTW_PKT_ARVL = 10;
 
@@ -115,6 +117,15 @@ public:
 	int attach_to_file_desc(int);
 #endif
 	static int recvQueueDepth(int port);
+
+	/** Receive up to this many datagrams per system call, when a
+		message is wanted and none are queued.  The extra datagrams are
+		queued for the following calls to handle_incoming_packet().
+	*/
+	void setReceiveBatchSize(int size);
+
+	/// @return true if datagrams received by an earlier call are queued
+	bool pendingPackets() const { return _batchNext < _batchCount; }
 	
 
 	//	byte operations
@@ -169,6 +180,14 @@ protected:
 	int m_udp_network_mtu;
 	int m_udp_loopback_mtu;
 
+	// datagrams received but not yet handled (see setReceiveBatchSize())
+	int _batchSize;
+	int _batchCount;
+	int _batchNext;
+	std::vector<char> _batchBufs;
+	std::vector<int> _batchLengths;
+	std::vector<condor_sockaddr> _batchFrom;
+
 	// statistics variables
 	static unsigned long _noMsgs;
 	static unsigned long _whole;;
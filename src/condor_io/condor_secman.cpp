@@ -1979,8 +1979,9 @@ SecManStartCommand::sendAuthInfo_inner()
 	}
 
 	// send the classad
-	// if we are resuming, use the projection so we send the minimum number of attributes
-	if (! putClassAd(m_sock, m_auth_info, 0, m_have_session ? SecMan::getResumeProj() : NULL)) {
+	// if we are resuming, use the projection so we send the minimum number of attributes.
+	// the server reads it with getPODClassAd(), which only takes the text encoding.
+	if (! putClassAd(m_sock, m_auth_info, PUT_CLASSAD_NO_BINARY, m_have_session ? SecMan::getResumeProj() : NULL)) {
 		dprintf ( D_ALWAYS, "SECMAN: failed to send auth_info (resume was %i)\n", m_have_session);
 		m_errstack->push( "SECMAN", SECMAN_ERR_COMMUNICATIONS_ERROR,
 						"Failed to send auth_info." );
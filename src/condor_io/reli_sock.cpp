@@ -37,6 +37,7 @@
 #include "shared_port_client.h"
 #include "basename.h"
 #include "ipv6_hostname.h"
+#include "classad/binaryCodec.h"
 
 #ifdef WIN32
 #include <mswsock.h>	// For TransmitFile()
@@ -144,6 +145,9 @@ ReliSock::close()
 	// Purge send and receive buffers at the relisock level
 	snd_msg.reset();
 	rcv_msg.reset();
+	if (m_binary_ad_names) {
+		m_binary_ad_names->Clear();
+	}
 	m_finished_send_header = false;
 	m_finished_recv_header = false;
 	m_final_send_header = false;
@@ -567,11 +571,24 @@ ReliSock::end_of_message()
 	return end_of_message_internal();
 }
 
+classad::ClassAdBinaryNames &
+ReliSock::getBinaryAdNames()
+{
+	if ( ! m_binary_ad_names) {
+		m_binary_ad_names.reset(new classad::ClassAdBinaryNames);
+	}
+	return *m_binary_ad_names;
+}
+
 int 
 ReliSock::end_of_message_internal()
 {
 	int ret_val = FALSE;
 
+	if (m_binary_ad_names) {
+		m_binary_ad_names->Clear();
+	}
+
 	if (crypto_state_ && crypto_state_->m_keyInfo.getProtocol() != CONDOR_AESGCM) {
 		resetCrypto();
 	}
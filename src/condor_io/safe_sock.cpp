@@ -54,6 +54,9 @@ void SafeSock::init()
 	_msgReady = false;
 	_longMsg = NULL;
 	_tOutBtwPkts = SAFE_SOCK_MAX_BTW_PKT_ARVL;
+	_batchSize = 1;
+	_batchCount = 0;
+	_batchNext = 0;
 
 	// initialize msgID
 	if(_outMsgID.msgNo == 0) { // first object of this class
@@ -115,6 +118,8 @@ SafeSock::~SafeSock()
 
 int SafeSock::close()
 {
+	_batchCount = 0;
+	_batchNext = 0;
 	return Sock::close();
 }
 
@@ -396,7 +401,7 @@ int SafeSock::get_bytes(void *dta, int size)
 {
 	ASSERT( size > 0 );
 	while(!_msgReady) {
-		if(_timeout > 0) {
+		if(_timeout > 0 && !pendingPackets()) {
 			Selector selector;
 			selector.set_timeout( _timeout );
 			selector.add_fd( _sock, Selector::IO_READ );
@@ -475,7 +480,7 @@ int SafeSock::get_ptr(void *&ptr, char delim)
 	int size;
 
 	while(!_msgReady) {
-		if(_timeout > 0) {
+		if(_timeout > 0 && !pendingPackets()) {
 			Selector selector;
 			selector.set_timeout( _timeout );
 			selector.add_fd( _sock, Selector::IO_READ );
@@ -507,7 +512,7 @@ int SafeSock::get_ptr(void *&ptr, char delim)
 int SafeSock::peek(char &c)
 {
 	while(!_msgReady) {
-		if(_timeout > 0) {
+		if(_timeout > 0 && !pendingPackets()) {
 			Selector selector;
 			selector.set_timeout( _timeout );
 			selector.add_fd( _sock, Selector::IO_READ );
@@ -582,12 +587,37 @@ int SafeSock::handle_incoming_packet()
 	}
 
 
-	received = condor_recvfrom(_sock, _shortMsg.dataGram, 
-							   SAFE_MSG_MAX_PACKET_SIZE, 0, _who);
+	if( _batchSize > 1 && !pendingPackets() ) {
+		_batchNext = 0;
+		_batchCount = condor_recvfrom_batch(_sock, _batchBufs.data(),
+							SAFE_MSG_MAX_PACKET_SIZE, _batchSize,
+							_batchLengths.data(), _batchFrom.data());
+		if(_batchCount < 0) {
+			_batchCount = 0;
+			dprintf(D_NETWORK, "recvmmsg failed: errno = %d\n", errno);
+			return FALSE;
+		}
+		if (_batchCount > 1) {
+			dprintf(D_NETWORK, "RECV batch of %d datagrams at %s\n",
+					_batchCount, sock_to_string(_sock));
+		}
+	}
 
-	if(received < 0) {
-		dprintf(D_NETWORK, "recvfrom failed: errno = %d\n", errno);
-		return FALSE;
+	if( pendingPackets() ) {
+		received = _batchLengths[_batchNext];
+		_who = _batchFrom[_batchNext];
+		memcpy(_shortMsg.dataGram,
+			   &_batchBufs[(size_t)_batchNext * SAFE_MSG_MAX_PACKET_SIZE],
+			   received);
+		_batchNext++;
+	} else {
+		received = condor_recvfrom(_sock, _shortMsg.dataGram, 
+								   SAFE_MSG_MAX_PACKET_SIZE, 0, _who);
+
+		if(received < 0) {
+			dprintf(D_NETWORK, "recvfrom failed: errno = %d\n", errno);
+			return FALSE;
+		}
 	}
 
 	if (IsDebugLevel(D_NETWORK))
@@ -855,7 +885,7 @@ int SafeSock::getMsgSize()
 	int result;
 
 	while(!_msgReady) {
-		if(_timeout > 0) {
+		if(_timeout > 0 && !pendingPackets()) {
 			Selector selector;
 			selector.set_timeout( _timeout );
 			selector.add_fd( _sock, Selector::IO_READ );
@@ -975,6 +1005,31 @@ SafeSock::recvQueueDepth([[maybe_unused]] int port) {
 	return depth;
 }
 
+void
+SafeSock::setReceiveBatchSize(int size)
+{
+	if (size < 1) {
+		size = 1;
+	}
+	if (size == _batchSize) {
+		return;
+	}
+	// datagrams already queued are dropped, as a full socket buffer would
+	_batchSize = size;
+	_batchCount = 0;
+	_batchNext = 0;
+	if (_batchSize > 1) {
+		_batchBufs.resize((size_t)_batchSize * SAFE_MSG_MAX_PACKET_SIZE);
+		_batchLengths.resize(_batchSize);
+		_batchFrom.resize(_batchSize);
+	} else {
+		_batchBufs.clear();
+		_batchBufs.shrink_to_fit();
+		_batchLengths.clear();
+		_batchFrom.clear();
+	}
+}
+
 int
 SafeSock::do_reverse_connect(char const *,bool,CondorError *)
 {
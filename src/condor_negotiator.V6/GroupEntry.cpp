@@ -7,6 +7,9 @@
 #include <deque>
 
  std::map<std::string, GroupEntry*, GroupEntry::ci_less> GroupEntry::hgq_submitter_group_map;
+GroupEntry::HgqStats GroupEntry::hgq_stats = {};
+bool GroupEntry::hgq_incremental = true;
+bool GroupEntry::hgq_allow_quota_oversub = false;
 
 double calculate_subtree_usage(Accountant &accountant, GroupEntry *group) {
 	double subtree_usage = 0.0;
@@ -43,7 +46,10 @@ GroupEntry::GroupEntry():
 	children(),
 	chmap(),
 	sort_ad(new ClassAd()),
-	sort_key(0)
+	sort_key(0),
+	hgq_recording(false),
+	assigned_from(-1),
+	assigned_quota(0)
 {
 }
 
@@ -127,6 +133,8 @@ GroupEntry::hgq_construct_tree(
 	const bool default_autoregroup = param_boolean("GROUP_AUTOREGROUP", false);
 	if (default_autoregroup) global_autoregroup = true;
 	if (default_accept_surplus) global_accept_surplus = true;
+	hgq_allow_quota_oversub = param_boolean("NEGOTIATOR_ALLOW_QUOTA_OVERSUBSCRIPTION", false);
+	hgq_incremental = param_boolean("GROUP_QUOTA_INCREMENTAL", true);
 
 	// build the tree structure from our group path info
 	for (unsigned long j = 0;  j < groups.size();  ++j) {
@@ -244,15 +252,16 @@ GroupEntry::hgq_construct_tree(
 
 /*static*/ void
 GroupEntry::hgq_prepare_for_matchmaking(double hgq_total_quota, GroupEntry *hgq_root_group, std::vector<GroupEntry *> &hgq_groups, Accountant &accountant, std::vector<ClassAd*> &submitterAds) {
+	double start_time = _condor_debug_get_time_double();
+
 	// Fill in latest usage/prio info for the groups.
 	// While we're at it, reset fields prior to reloading from submitter ads.
+	// The quotas are left as they are, hgq_assign_quotas() sets them.
 
 	for( GroupEntry *group : hgq_groups) {
-		group->quota = 0;
 		group->requested = 0;
 		group->currently_requested = 0;
 		group->allocated = 0;
-		group->subtree_quota = 0;
 		group->subtree_requested = 0;
 		if (NULL == group->submitterAds) group->submitterAds = new std::vector<ClassAd*>;
 		group->submitterAds->clear();
@@ -335,6 +344,7 @@ GroupEntry::hgq_prepare_for_matchmaking(double hgq_total_quota, GroupEntry *hgq_
 	dprintf(D_ALWAYS, "group quota: Quotas have been assigned to the following groups\n");
 	hgq_root_group->displayGroups(D_ALWAYS, false);
 
+	hgq_stats.assign_time += _condor_debug_get_time_double() - start_time;
 	return;
 }
 
@@ -376,14 +386,20 @@ GroupEntry::hgq_negotiate_with_all_groups(GroupEntry *hgq_root_group, std::vecto
 		}
 
 		// Allocate group slot quotas to satisfy group job requests
+		double start_time = _condor_debug_get_time_double();
+		hgq_start_pass(hgq_groups, 0);
 		double surplus_quota = hgq_root_group->hgq_fairshare();
+		double fairshare_done = _condor_debug_get_time_double();
+		hgq_stats.fairshare_time += fairshare_done - start_time;
 
 		// This step is not relevant in a weighted-slot scenario, where slots may
 		// have a floating-point cost != 1.
 		if (!accountant.UsingWeightedSlots()) {
 			// Recover any fractional slot remainders from fairshare algorithm,
 			// and distribute them using round robin.
+			hgq_start_pass(hgq_groups, 1);
 			surplus_quota += hgq_root_group->hgq_recover_remainders();
+			hgq_stats.round_robin_time += _condor_debug_get_time_double() - fairshare_done;
 		}
 
 		if (autoregroup) {
@@ -538,12 +554,31 @@ GroupEntry::hgq_negotiate_with_all_groups(GroupEntry *hgq_root_group, std::vecto
 
 void
 GroupEntry::hgq_assign_quotas(double quota) {
+	// A subtree given the same quota as last time is assigned the same
+	// quotas.  Only the root's quota is changed after it is assigned (for
+	// autoregroup), so put that back.
+	if (hgq_incremental && quota == this->assigned_from) {
+		this->quota = this->assigned_quota;
+		hgq_stats.reused += 1;
+		return;
+	}
+	hgq_stats.recomputed += 1;
+	this->assigned_from = quota;
+
 	dprintf(D_FULLDEBUG, "group quotas: subtree %s receiving quota= %g\n", this->name.c_str(), quota);
 
-	bool allow_quota_oversub = param_boolean("NEGOTIATOR_ALLOW_QUOTA_OVERSUBSCRIPTION", false);
+	const bool allow_quota_oversub = hgq_allow_quota_oversub;
 
-	// if quota is zero, we can leave this subtree with default quotas of zero
-	if (quota <= 0) return;
+	// if quota is zero, this subtree gets quotas of zero
+	if (quota <= 0) {
+		this->quota = 0;
+		this->subtree_quota = 0;
+		this->assigned_quota = 0;
+		for (GroupEntry* child : this->children) {
+			child->hgq_assign_quotas(0);
+		}
+		return;
+	}
 
 	// incoming quota is quota for subtree
 	this->subtree_quota = quota;
@@ -611,11 +646,12 @@ GroupEntry::hgq_assign_quotas(double quota) {
 	}
 
 	if (this->quota < 0) this->quota = 0;
+	this->assigned_quota = this->quota;
 	dprintf(D_FULLDEBUG, "group quotas: group %s assigned quota= %g\n", this->name.c_str(), this->quota);
 }
 
 double
-GroupEntry::hgq_fairshare() {
+GroupEntry::compute_fairshare() {
 	dprintf(D_FULLDEBUG, "group quotas: fairshare (1): group= %s  quota= %g  requested= %g\n",
 			this->name.c_str(), this->quota, this->requested);
 
@@ -647,7 +683,7 @@ GroupEntry::hgq_fairshare() {
 	}
 
 	// allocate any available surplus to current node and subtree
-	surplus = this->hgq_allocate_surplus(surplus);
+	surplus = this->compute_allocate_surplus(surplus);
 
 	dprintf(D_FULLDEBUG, "group quotas: fairshare (3): group= %s  surplus= %g  subtree_requested= %g\n",
 			this->name.c_str(), surplus, this->subtree_requested);
@@ -657,7 +693,7 @@ GroupEntry::hgq_fairshare() {
 }
 
 double
-GroupEntry::hgq_allocate_surplus(double surplus) {
+GroupEntry::compute_allocate_surplus(double surplus) {
 	dprintf(D_FULLDEBUG, "group quotas: allocate-surplus (1): group= %s  surplus= %g  subtree-requested= %g\n", this->name.c_str(), surplus, this->subtree_requested);
 
 	// Nothing to allocate
@@ -770,7 +806,7 @@ void round_for_precision(double& x) {
 }
 
 double
-GroupEntry::hgq_recover_remainders() {
+GroupEntry::compute_recover_remainders() {
 	dprintf(D_FULLDEBUG, "group quotas: recover-remainders (1): group= %s  allocated= %g  requested= %g\n",
 			this->name.c_str(), this->allocated, this->requested);
 
@@ -804,7 +840,7 @@ GroupEntry::hgq_recover_remainders() {
 	}
 
 	// allocate any available surplus to current node and subtree
-	surplus = this->hgq_round_robin(surplus);
+	surplus = this->compute_round_robin(surplus);
 
 	dprintf(D_FULLDEBUG, "group quotas: recover-remainder (3): group= %s  surplus= %g  subtree_requested= %g\n",
 			this->name.c_str(), surplus, this->subtree_requested);
@@ -814,7 +850,7 @@ GroupEntry::hgq_recover_remainders() {
 }
 
 double
-GroupEntry::hgq_round_robin(double surplus) {
+GroupEntry::compute_round_robin(double surplus) {
 	dprintf(D_FULLDEBUG, "group quotas: round-robin (1): group= %s  surplus= %g  subtree-requested= %g\n", this->name.c_str(), surplus, this->subtree_requested);
 
 	// Sanity check -- I expect these to be integer values by the time I get here.
@@ -937,6 +973,183 @@ GroupEntry::hgq_round_robin(double surplus) {
 	return surplus;
 }
 
+double
+GroupEntry::hgq_fairshare() {
+	double surplus = 0;
+	if ( ! hgq_begin_step(HGQ_FAIRSHARE, 0, surplus)) {
+		surplus = compute_fairshare();
+		hgq_end_step(HGQ_FAIRSHARE, surplus);
+	}
+	return surplus;
+}
+
+double
+GroupEntry::hgq_allocate_surplus(double surplus) {
+	double result = 0;
+	if ( ! hgq_begin_step(HGQ_ALLOCATE_SURPLUS, surplus, result)) {
+		result = compute_allocate_surplus(surplus);
+		hgq_end_step(HGQ_ALLOCATE_SURPLUS, result);
+	}
+	return result;
+}
+
+double
+GroupEntry::hgq_recover_remainders() {
+	double surplus = 0;
+	if ( ! hgq_begin_step(HGQ_RECOVER_REMAINDERS, 0, surplus)) {
+		surplus = compute_recover_remainders();
+		hgq_end_step(HGQ_RECOVER_REMAINDERS, surplus);
+	}
+	return surplus;
+}
+
+double
+GroupEntry::hgq_round_robin(double surplus) {
+	double result = 0;
+	if ( ! hgq_begin_step(HGQ_ROUND_ROBIN, surplus, result)) {
+		result = compute_round_robin(surplus);
+		hgq_end_step(HGQ_ROUND_ROBIN, result);
+	}
+	return result;
+}
+
+/*static*/ void
+GroupEntry::hgq_start_pass(std::vector<GroupEntry *> &hgq_groups, int pass) {
+	// Decide which groups can replay their steps of this pass.  hgq_groups
+	// is in breadth-first order, so going backwards we come to the children
+	// of a group before the group.
+	for (auto it = hgq_groups.rbegin(); it != hgq_groups.rend(); ++it) {
+		GroupEntry *group = *it;
+		HgqLog &log = group->hgq_log[pass];
+		bool same = false;
+		if (pass == 0) {
+			same = (group->quota == log.quota) && (group->subtree_quota == log.subtree_quota) &&
+				(group->requested == log.requested);
+			log.quota = group->quota;
+			log.subtree_quota = group->subtree_quota;
+			log.requested = group->requested;
+		} else {
+			// the round robin starts from where the fairshare pass left the
+			// group, which is where it left it last time if every step was
+			// replayed.  A log of round robin steps only goes with the
+			// fairshare steps it came after, so drop any the group was not
+			// called for this time, and the round robin log with them.
+			HgqLog &fairshare = group->hgq_log[0];
+			if (fairshare.next < fairshare.steps.size()) {
+				fairshare.steps.resize(fairshare.next);
+				log.steps.clear();
+			}
+			// A group's round robin time only matters when it requests
+			// something, which it does if it has any left to request after
+			// the fairshare pass, or is about to recover a remainder.
+			double remainder = group->allocated - floor(group->allocated);
+			double rr_time = (group->requested + remainder > 0) ? group->rr_time : DBL_MAX;
+			same = ! fairshare.computed && (rr_time == log.rr_time);
+			log.rr_time = rr_time;
+		}
+		log.replay = hgq_incremental && same && ! log.steps.empty();
+		for (GroupEntry *child : group->children) {
+			log.replay = log.replay && child->hgq_log[pass].replay;
+		}
+		log.next = 0;
+		log.computed = false;
+	}
+}
+
+// Start a step of a pass.  If it can be replayed, replay it, set result
+// to what it returned, and return true.  Otherwise start logging it in
+// place of the rest of the old log, and return false.
+bool
+GroupEntry::hgq_begin_step(HgqStepKind kind, double arg, double &result) {
+	if ( ! hgq_incremental) {
+		hgq_stats.recomputed += 1;
+		return false;
+	}
+
+	const int pass = kind / 2;
+	HgqLog &log = hgq_log[pass];
+	if (log.replay && log.next < log.steps.size() &&
+		log.steps[log.next].kind == kind && log.steps[log.next].arg == arg)
+	{
+		// Nothing changed below us, so the steps taken below us during
+		// this one would be the same too, just set what they left behind.
+		const HgqStep &step = log.steps[log.next++];
+		for (const HgqState &state : step.subtree) {
+			state.group->hgq_restore_state(state, pass);
+		}
+		hgq_restore_state(step.after, pass);
+		result = step.result;
+		hgq_stats.reused += 1 + step.subtree.size();
+		hgq_step_done(step, pass);
+		return true;
+	}
+
+	log.replay = false;
+	log.computed = true;
+	log.steps.resize(log.next);
+	if (pass == 0) {
+		// the round robin log came after different fairshare steps
+		hgq_log[1].steps.clear();
+	}
+	log.steps.emplace_back();
+	log.steps.back().kind = kind;
+	log.steps.back().arg = arg;
+	hgq_recording = true;
+	hgq_stats.recomputed += 1;
+	return false;
+}
+
+void
+GroupEntry::hgq_end_step(HgqStepKind kind, double result) {
+	if ( ! hgq_incremental) {
+		return;
+	}
+
+	const int pass = kind / 2;
+	HgqLog &log = hgq_log[pass];
+	HgqStep &step = log.steps.back();
+	log.next += 1;
+	step.result = result;
+	hgq_save_state(step.after, pass);
+	hgq_recording = false;
+	hgq_step_done(step, pass);
+}
+
+void
+GroupEntry::hgq_save_state(HgqState &state, int pass) const {
+	state.group = const_cast<GroupEntry *>(this);
+	state.next = hgq_log[pass].next;
+	state.allocated = this->allocated;
+	state.requested = this->requested;
+	state.subtree_requested = this->subtree_requested;
+	state.subtree_rr_time = this->subtree_rr_time;
+	state.rr = this->rr;
+}
+
+void
+GroupEntry::hgq_restore_state(const HgqState &state, int pass) {
+	hgq_log[pass].next = state.next;
+	this->allocated = state.allocated;
+	this->requested = state.requested;
+	this->subtree_requested = state.subtree_requested;
+	// the fairshare pass leaves these alone
+	if (pass == 1) {
+		this->subtree_rr_time = state.subtree_rr_time;
+		this->rr = state.rr;
+	}
+}
+
+// A step ended, so if our parent is logging the step it is in, add what
+// this step left us and the groups below us with to it.
+void
+GroupEntry::hgq_step_done(const HgqStep &step, int pass) {
+	if ( ! parent || ! parent->hgq_recording) {
+		return;
+	}
+	std::vector<HgqState> &subtree = parent->hgq_log[pass].steps.back().subtree;
+	subtree.insert(subtree.end(), step.subtree.begin(), step.subtree.end());
+	subtree.push_back(step.after);
+}
 
 void hgq_allocate_surplus_loop(
 		bool by_quota,
@@ -64,6 +64,18 @@ struct GroupEntry {
 
 		void displayGroups(int dprintfLevel, bool onlyConfigInfo, bool firstLine = true) const;
 
+		// Time spent in each phase of the quota computations, and how many
+		// steps of them were computed and how many were replayed, since the
+		// negotiator last reset them.
+		struct HgqStats {
+			double assign_time;
+			double fairshare_time;
+			double round_robin_time;
+			long recomputed;
+			long reused;
+		};
+		static HgqStats hgq_stats;
+
 		// these are set from configuration
 		std::string name;
 		double config_quota;
@@ -104,6 +116,70 @@ struct GroupEntry {
 		// attributes for configurable sorting
 		ClassAd* sort_ad;
 		double sort_key;
+
+		// The quota computations are incremental.  The configuration does
+		// not change for the life of the tree, so a subtree given the same
+		// quota as last time has the same quotas as last time.  And each
+		// group keeps a log of the steps of the last fairshare pass, and of
+		// the last remainder round robin pass, that it took part in: the
+		// surplus offered to it, and the values it and the groups below it
+		// were left with.  When nothing that goes into a pass (quotas,
+		// demand, round robin times) changed anywhere in a group's subtree
+		// since, the steps it is offered the same surplus for are replayed
+		// from the log by setting those values, without visiting the
+		// subtree again.
+		enum HgqStepKind { HGQ_FAIRSHARE, HGQ_ALLOCATE_SURPLUS, HGQ_RECOVER_REMAINDERS, HGQ_ROUND_ROBIN };
+		struct HgqState {
+			GroupEntry *group;
+			size_t next;	// where the group is in its log
+			double allocated;
+			double requested;
+			double subtree_requested;
+			double subtree_rr_time;
+			bool rr;
+		};
+		struct HgqStep {
+			HgqStepKind kind;
+			double arg;
+			double result;
+			HgqState after;
+			// the groups below that took steps during this one, in the
+			// order those steps ended, and what each step left them with
+			std::vector<HgqState> subtree;
+		};
+		struct HgqLog {
+			std::vector<HgqStep> steps;
+			size_t next = 0;
+			bool replay = false;
+			bool computed = false;
+			// the inputs of the pass the steps are from
+			double quota = 0;
+			double subtree_quota = 0;
+			double requested = 0;
+			double rr_time = 0;
+		};
+
+		static void hgq_start_pass(std::vector<GroupEntry *> &hgq_groups, int pass);
+
+	private:
+		double compute_fairshare();
+		double compute_allocate_surplus(double surplus);
+		double compute_recover_remainders();
+		double compute_round_robin(double surplus);
+
+		bool hgq_begin_step(HgqStepKind kind, double arg, double &result);
+		void hgq_end_step(HgqStepKind kind, double result);
+		void hgq_save_state(HgqState &state, int pass) const;
+		void hgq_restore_state(const HgqState &state, int pass);
+		void hgq_step_done(const HgqStep &step, int pass);
+
+		HgqLog hgq_log[2];
+		bool hgq_recording;
+		double assigned_from;
+		double assigned_quota;
+
+		static bool hgq_incremental;
+		static bool hgq_allow_quota_oversub;
 };
 
 struct group_order {
@@ -0,0 +1,128 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2024, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+#include "condor_common.h"
+#include "condor_debug.h"
+#include "condor_attributes.h"
+#include "stl_string_utils.h"
+#include "MatchListCache.h"
+
+void
+MatchListCache::Entry::Add(ClassAd *slot)
+{
+	index[slot] = (int)matches.size();
+	matches.push_back(slot);
+	ranks.emplace_back();
+}
+
+int
+MatchListCache::Entry::IndexOf(const ClassAd *slot) const
+{
+	auto it = index.find(slot);
+	return it == index.end() ? -1 : it->second;
+}
+
+void
+MatchListCache::Init(const std::vector<ClassAd *> &stable_slots, size_t unstable,
+                     const classad::References &refs, size_t max)
+{
+	Clear();
+	stable.insert(stable_slots.begin(), stable_slots.end());
+	num_unstable = unstable;
+	match_refs = refs;
+	max_entries = max;
+}
+
+void
+MatchListCache::Clear()
+{
+	stable.clear();
+	removed.clear();
+	num_unstable = 0;
+	match_refs.clear();
+	entries.clear();
+	age.clear();
+	max_entries = 0;
+}
+
+void
+MatchListCache::MakeKey(ClassAd &request, std::string &key) const
+{
+	key.clear();
+
+		// start with the attributes matching refers to, and add the
+		// attributes of the request that those refer to, and so on.
+	classad::References attrs(match_refs);
+	attrs.insert(ATTR_REQUIREMENTS);
+	attrs.insert(ATTR_RANK);
+	std::vector<std::string> pending(attrs.begin(), attrs.end());
+	classad::References refs;
+	while ( ! pending.empty()) {
+		std::string attr = std::move(pending.back());
+		pending.pop_back();
+		classad::ExprTree *expr = request.Lookup(attr);
+		if ( ! expr) {
+			continue;
+		}
+		refs.clear();
+		request.GetInternalReferences(expr, refs, false);
+		for (const std::string &ref: refs) {
+			if (attrs.insert(ref).second) {
+				pending.push_back(ref);
+			}
+		}
+	}
+
+		// the References set is ordered without regard to case
+	classad::ClassAdUnParser unparser;
+	unparser.SetOldClassAd(true, true);
+	std::string name;
+	for (const std::string &attr: attrs) {
+		classad::ExprTree *expr = request.Lookup(attr);
+		if ( ! expr) {
+			continue;
+		}
+		name = attr;
+		lower_case(name);
+		key += name;
+		key += '=';
+		unparser.Unparse(key, expr);
+		key += '\n';
+	}
+}
+
+MatchListCache::Entry *
+MatchListCache::Find(const std::string &key)
+{
+	auto it = entries.find(key);
+	return it == entries.end() ? nullptr : &it->second;
+}
+
+MatchListCache::Entry &
+MatchListCache::Insert(const std::string &key)
+{
+	while (entries.size() >= max_entries && ! age.empty()) {
+		entries.erase(age.front());
+		age.pop_front();
+	}
+	age.push_back(key);
+	Entry &entry = entries[key];
+	entry = Entry();
+	return entry;
+}
@@ -0,0 +1,121 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2024, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+#ifndef MATCH_LIST_CACHE_H
+#define MATCH_LIST_CACHE_H
+
+#include "condor_common.h"
+#include "compat_classad.h"
+
+#include <vector>
+#include <string>
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
+
+// The slots that match each kind of request seen in a negotiation cycle,
+// shared by all submitters.
+//
+// The per-submitter MatchList only lasts while the negotiator sees jobs
+// of one autocluster from one submitter.  This cache remembers, for the
+// rest of the cycle, which slots matched a request and how the request
+// ranked them, so a request from any submitter that evaluates the same
+// way only has to be put through the submitter specific checks
+// (preemption, limits, the schedd's address) rather than matched
+// against the pool again.
+//
+// Requests are keyed by their signature: the attributes that slots and
+// negotiator expressions refer to, as found by compute_significant_attrs(),
+// plus the request's Requirements and Rank, plus whatever attributes of
+// the request those refer to in turn.
+//
+// Only stable slots are remembered; slots with a consumption policy or
+// that want to be reevaluated change as they are matched, so they must
+// be matched against each request.  Slots taken out of the cycle must be
+// passed to Remove(), and the cache must be cleared before the slot ads
+// are deleted.
+class MatchListCache {
+public:
+	struct Ranks {
+		Ranks() : PreJobRankValue(0), RankValue(0), PostJobRankValue(0), valid(false) {}
+		double PreJobRankValue;
+		double RankValue;
+		double PostJobRankValue;
+		bool valid;
+	};
+
+	struct Entry {
+		// stable slots that match, in the order they were offered
+		std::vector<ClassAd *> matches;
+		// how the request ranked each of matches, once it has
+		std::vector<Ranks> ranks;
+
+		void Add(ClassAd *slot);
+
+		// the position of a slot in matches, or -1 if it doesn't match
+		int IndexOf(const ClassAd *slot) const;
+
+	private:
+		std::unordered_map<const ClassAd *, int> index;
+	};
+
+	MatchListCache() : num_unstable(0), max_entries(0) {}
+
+	// Start a cycle.  stable_slots are the slots whose match with a
+	// request can be remembered, num_unstable the count of the others,
+	// and match_refs the attributes referred to by slots and negotiator
+	// expressions.  Keeps no more than max_entries request signatures.
+	void Init(const std::vector<ClassAd *> &stable_slots, size_t num_unstable,
+	          const classad::References &match_refs, size_t max_entries);
+
+	// Forget everything.
+	void Clear();
+
+	// true if the cache is not in use this cycle
+	bool empty() const { return max_entries == 0; }
+
+	bool IsStable(const ClassAd *slot) const { return stable.count(slot) != 0; }
+	size_t NumUnstable() const { return num_unstable; }
+
+	// The slot has been matched or given up on for the rest of the cycle.
+	void Remove(const ClassAd *slot) { if ( ! empty()) { removed.insert(slot); } }
+	bool IsRemoved(const ClassAd *slot) const { return removed.count(slot) != 0; }
+
+	// The signature of a request.
+	void MakeKey(ClassAd &request, std::string &key) const;
+
+	// The entry for a signature, or NULL.
+	Entry *Find(const std::string &key);
+
+	// A new, empty entry for a signature, making room if need be.
+	Entry &Insert(const std::string &key);
+
+	size_t size() const { return entries.size(); }
+
+private:
+	std::unordered_set<const ClassAd *> stable;
+	std::unordered_set<const ClassAd *> removed;
+	size_t num_unstable;
+	classad::References match_refs;
+	std::unordered_map<std::string, Entry> entries;
+	std::deque<std::string> age;	// keys, oldest first
+	size_t max_entries;
+};
+
+#endif
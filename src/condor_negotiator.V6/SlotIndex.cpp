@@ -0,0 +1,320 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2024, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+#include "condor_common.h"
+#include "condor_debug.h"
+#include "condor_attributes.h"
+#include "compat_classad_util.h"
+#include "stl_string_utils.h"
+#include "SlotIndex.h"
+
+#include <algorithm>
+#include <math.h>
+
+// the satisfied counts in a MatchPlan are unsigned char
+static const int MAX_PLAN_CLAUSES = 250;
+
+// integers beyond this can't be compared exactly as doubles
+static const double MAX_EXACT_INT = 9007199254740992.0; // 2^53
+
+bool
+SlotIndex::MatchPlan::Admits(const ClassAd *slot) const
+{
+	if (num_clauses == 0 || ! slot_ids) {
+		return true;
+	}
+	auto it = slot_ids->find(slot);
+	if (it == slot_ids->end()) {
+		return true;
+	}
+	return satisfied[it->second] == num_clauses;
+}
+
+void
+SlotIndex::Init(const std::vector<ClassAd *> &slot_ads, const classad::References &volatile_attrs)
+{
+	Clear();
+	slots = slot_ads;
+	slot_ids.reserve(slots.size());
+	for (size_t ix = 0; ix < slots.size(); ++ix) {
+		slot_ids[slots[ix]] = (int)ix;
+	}
+	unindexed = volatile_attrs;
+}
+
+void
+SlotIndex::Clear()
+{
+	slots.clear();
+	slot_ids.clear();
+	attrs.clear();
+	unindexed.clear();
+}
+
+SlotIndex::AttrIndex &
+SlotIndex::GetAttrIndex(const std::string &attr)
+{
+	auto found = attrs.find(attr);
+	if (found != attrs.end()) {
+		return found->second;
+	}
+
+	AttrIndex &ix = attrs[attr];
+	classad::Value val;
+	for (size_t id = 0; id < slots.size(); ++id) {
+		classad::ExprTree *expr = slots[id]->Lookup(attr);
+		if ( ! expr) {
+			// a missing attribute evaluates to undefined, which
+			// never satisfies any of the clauses we index.
+			continue;
+		}
+
+		long long ival;
+		double rval;
+		bool bval;
+		std::string sval;
+		if ( ! ExprTreeIsLiteral(expr, val)) {
+			ix.others.push_back(id);
+		} else if (val.IsIntegerValue(ival)) {
+			if (fabs((double)ival) < MAX_EXACT_INT) {
+				ix.numbers.emplace_back((double)ival, id);
+			} else {
+				ix.others.push_back(id);
+			}
+		} else if (val.IsRealValue(rval)) {
+			if ( ! std::isnan(rval)) {
+				ix.numbers.emplace_back(rval, id);
+			} else {
+				ix.others.push_back(id);
+			}
+		} else if (val.IsBooleanValue(bval)) {
+			(bval ? ix.trues : ix.falses).push_back(id);
+		} else if (val.IsStringValue(sval)) {
+			std::string key(sval);
+			lower_case(key);
+			ix.strings[key].emplace_back(id, sval);
+		} else {
+			ix.others.push_back(id);
+		}
+	}
+	std::sort(ix.numbers.begin(), ix.numbers.end());
+
+	dprintf(D_FULLDEBUG, "SlotIndex: indexed %s for %zu slots (%zu numeric, %zu string values, %zu boolean, %zu other)\n",
+		attr.c_str(), slots.size(), ix.numbers.size(), ix.strings.size(),
+		ix.trues.size() + ix.falses.size(), ix.others.size());
+	return ix;
+}
+
+void
+SlotIndex::AdmitIds(const std::vector<int> &ids, MatchPlan &plan)
+{
+	for (int id : ids) {
+		plan.satisfied[id]++;
+	}
+}
+
+void
+SlotIndex::AdmitNumbers(const AttrIndex &ix, classad::Operation::OpKind op, double num, MatchPlan &plan)
+{
+	auto begin = ix.numbers.begin();
+	auto end = ix.numbers.end();
+	auto lower = std::lower_bound(begin, end, num,
+		[](const std::pair<double,int> &a, double b) { return a.first < b; });
+	auto upper = std::upper_bound(begin, end, num,
+		[](double a, const std::pair<double,int> &b) { return a < b.first; });
+
+	switch (op) {
+	case classad::Operation::LESS_THAN_OP:        end = lower; break;
+	case classad::Operation::LESS_OR_EQUAL_OP:    end = upper; break;
+	case classad::Operation::GREATER_THAN_OP:     begin = upper; break;
+	case classad::Operation::GREATER_OR_EQUAL_OP: begin = lower; break;
+	default: begin = lower; end = upper; break;
+	}
+	for (auto it = begin; it != end; ++it) {
+		plan.satisfied[it->second]++;
+	}
+}
+
+// Add the constraint imposed by one && clause of the job's requirements
+// to the plan.  Returns false if the clause can't be served by the index.
+bool
+SlotIndex::AddClause(classad::ExprTree *clause, MatchPlan &plan)
+{
+	clause = SkipExprParens(clause);
+	if ( ! clause) {
+		return false;
+	}
+
+	// returns true if expr is TARGET.<attr>
+	auto is_target_ref = [](classad::ExprTree *expr, std::string &attr) -> bool {
+		expr = SkipExprParens(expr);
+		if ( ! expr || expr->GetKind() != classad::ExprTree::ATTRREF_NODE) {
+			return false;
+		}
+		classad::ExprTree *scope = nullptr;
+		bool absolute = false;
+		((classad::AttributeReference*)expr)->GetComponents(scope, attr, absolute);
+		std::string scope_name;
+		return ! absolute && ExprTreeIsAttrRef(scope, scope_name) &&
+			strcasecmp(scope_name.c_str(), "TARGET") == 0;
+	};
+
+	std::string attr;
+	classad::Value lit;
+	classad::Operation::OpKind op = classad::Operation::IS_OP;
+
+	if (is_target_ref(clause, attr)) {
+		// a bare TARGET.Attr must be true
+		op = classad::Operation::EQUAL_OP;
+		lit.SetBooleanValue(true);
+	} else if (clause->GetKind() == classad::ExprTree::OP_NODE) {
+		classad::ExprTree *t1, *t2, *t3;
+		((classad::Operation*)clause)->GetComponents(op, t1, t2, t3);
+		if (is_target_ref(t1, attr) && ExprTreeIsLiteral(t2, lit)) {
+			// TARGET.Attr op literal
+		} else if (ExprTreeIsLiteral(t1, lit) && is_target_ref(t2, attr)) {
+			// literal op TARGET.Attr, turn it around
+			switch (op) {
+			case classad::Operation::LESS_THAN_OP:        op = classad::Operation::GREATER_THAN_OP; break;
+			case classad::Operation::LESS_OR_EQUAL_OP:    op = classad::Operation::GREATER_OR_EQUAL_OP; break;
+			case classad::Operation::GREATER_THAN_OP:     op = classad::Operation::LESS_THAN_OP; break;
+			case classad::Operation::GREATER_OR_EQUAL_OP: op = classad::Operation::LESS_OR_EQUAL_OP; break;
+			default: break;
+			}
+		} else {
+			return false;
+		}
+	} else {
+		return false;
+	}
+
+	bool is_equality = (op == classad::Operation::EQUAL_OP || op == classad::Operation::META_EQUAL_OP);
+	bool is_relational = (op == classad::Operation::LESS_THAN_OP || op == classad::Operation::LESS_OR_EQUAL_OP ||
+		op == classad::Operation::GREATER_THAN_OP || op == classad::Operation::GREATER_OR_EQUAL_OP);
+	if ( ! is_equality && ! is_relational) {
+		return false;
+	}
+	if (unindexed.count(attr)) {
+		return false;
+	}
+
+	long long ival;
+	double num = 0;
+	bool bval;
+	std::string sval;
+	bool is_number = false;
+	if (lit.IsIntegerValue(ival)) {
+		if (fabs((double)ival) >= MAX_EXACT_INT) { return false; }
+		num = (double)ival;
+		is_number = true;
+	} else if (lit.IsRealValue(num)) {
+		if (std::isnan(num)) { return false; }
+		is_number = true;
+	} else if (lit.IsBooleanValue(bval)) {
+		if ( ! is_equality) { return false; }
+	} else if (lit.IsStringValue(sval)) {
+		if ( ! is_equality) { return false; }
+	} else {
+		return false;
+	}
+
+	const AttrIndex &ix = GetAttrIndex(attr);
+
+	// slots we can't reason about are always admitted
+	AdmitIds(ix.others, plan);
+
+	if (is_number) {
+		AdmitNumbers(ix, op, num, plan);
+		if (op != classad::Operation::META_EQUAL_OP) {
+			// leave it to the evaluator to decide how booleans compare
+			// with numbers.
+			AdmitIds(ix.trues, plan);
+			AdmitIds(ix.falses, plan);
+		}
+	} else if (lit.IsBooleanValue(bval)) {
+		AdmitIds(bval ? ix.trues : ix.falses, plan);
+		if (op != classad::Operation::META_EQUAL_OP) {
+			for (const auto &[val, id] : ix.numbers) {
+				plan.satisfied[id]++;
+			}
+		}
+	} else {
+		std::string key(sval);
+		lower_case(key);
+		auto found = ix.strings.find(key);
+		if (found != ix.strings.end()) {
+			for (const auto &[id, str] : found->second) {
+				// == is case insensitive, =?= is not
+				if (op == classad::Operation::EQUAL_OP || str == sval) {
+					plan.satisfied[id]++;
+				}
+			}
+		}
+	}
+
+	plan.num_clauses++;
+	return true;
+}
+
+bool
+SlotIndex::MakePlan(ClassAd &request, MatchPlan &plan)
+{
+	plan.num_clauses = 0;
+	plan.satisfied.clear();
+	plan.slot_ids = &slot_ids;
+
+	if (slots.empty()) {
+		return false;
+	}
+
+	classad::ExprTree *requirements = request.LookupExpr(ATTR_REQUIREMENTS);
+	if ( ! requirements) {
+		return false;
+	}
+
+	plan.satisfied.assign(slots.size(), 0);
+
+	// walk the top level && clauses
+	std::vector<classad::ExprTree *> pending;
+	pending.push_back(requirements);
+	while ( ! pending.empty() && plan.num_clauses < MAX_PLAN_CLAUSES) {
+		classad::ExprTree *expr = SkipExprParens(pending.back());
+		pending.pop_back();
+		if ( ! expr) {
+			continue;
+		}
+		if (expr->GetKind() == classad::ExprTree::OP_NODE) {
+			classad::Operation::OpKind op;
+			classad::ExprTree *t1, *t2, *t3;
+			((classad::Operation*)expr)->GetComponents(op, t1, t2, t3);
+			if (op == classad::Operation::LOGICAL_AND_OP) {
+				pending.push_back(t2);
+				pending.push_back(t1);
+				continue;
+			}
+		}
+		AddClause(expr, plan);
+	}
+
+	if (plan.num_clauses == 0) {
+		plan.satisfied.clear();
+		return false;
+	}
+	return true;
+}
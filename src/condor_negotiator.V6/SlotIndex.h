@@ -0,0 +1,114 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2024, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+#ifndef SLOT_INDEX_H
+#define SLOT_INDEX_H
+
+#include "condor_common.h"
+#include "compat_classad.h"
+
+#include <vector>
+#include <string>
+#include <map>
+#include <unordered_map>
+
+// Per-attribute indexes over the slot ads of a negotiation cycle, used to
+// rule out slots that cannot satisfy a job's Requirements without doing a
+// full match evaluation.
+//
+// A job's Requirements are decomposed into their top level && clauses.
+// Clauses of the form TARGET.Attr op <literal> (op is one of == =?= < <= > >=)
+// and bare TARGET.Attr are looked up in an index of Attr, which is built the
+// first time a job references it.  Numeric values are kept sorted, string
+// values are hashed.  A slot is a candidate for a job if every indexed clause
+// admits it; all other clauses are left to the full evaluation.
+//
+// The index is conservative: a slot whose attribute is not a literal, or
+// whose literal is of a type for which the outcome of the comparison is not
+// obvious, is always a candidate.  A slot that is rejected by a MatchPlan
+// cannot match the job.  Slots that are not in the index are always
+// candidates.
+//
+// The index holds pointers to the slot ads; it must be cleared before the
+// ads are deleted.  Slot attributes that change during the cycle must not
+// be indexed, see Init().
+class SlotIndex {
+public:
+	class MatchPlan {
+	public:
+		MatchPlan() : num_clauses(0) {}
+
+		// true if the plan does not restrict the set of slots
+		bool empty() const { return num_clauses == 0; }
+
+		// false if the slot is known not to match the job
+		bool Admits(const ClassAd *slot) const;
+
+		int NumClauses() const { return num_clauses; }
+
+	private:
+		friend class SlotIndex;
+
+		// count of indexed clauses satisfied, by slot id
+		std::vector<unsigned char> satisfied;
+		const std::unordered_map<const ClassAd *, int> *slot_ids{nullptr};
+		int num_clauses;
+	};
+
+	SlotIndex() {}
+
+	// Index the given slots.  Attributes named in volatile_attrs are
+	// never indexed, this is for attributes the negotiator itself
+	// modifies during the cycle.
+	void Init(const std::vector<ClassAd *> &slots, const classad::References &volatile_attrs);
+
+	// Forget all slots and indexes.
+	void Clear();
+
+	bool empty() const { return slots.empty(); }
+
+	// Build a plan for matching the given job against the indexed slots.
+	// Returns false and leaves the plan empty if the job's Requirements
+	// have no clauses that can be served by the index.
+	bool MakePlan(ClassAd &request, MatchPlan &plan);
+
+private:
+	struct AttrIndex {
+		// slots with a numeric value, sorted by value
+		std::vector<std::pair<double, int>> numbers;
+		// slots with a string value, keyed by lower cased value
+		std::unordered_map<std::string, std::vector<std::pair<int, std::string>>> strings;
+		std::vector<int> trues;
+		std::vector<int> falses;
+		// slots with a value we can't reason about
+		std::vector<int> others;
+	};
+
+	AttrIndex &GetAttrIndex(const std::string &attr);
+	bool AddClause(classad::ExprTree *clause, MatchPlan &plan);
+	void AdmitIds(const std::vector<int> &ids, MatchPlan &plan);
+	void AdmitNumbers(const AttrIndex &ix, classad::Operation::OpKind op, double num, MatchPlan &plan);
+
+	std::vector<ClassAd *> slots;
+	std::unordered_map<const ClassAd *, int> slot_ids;
+	std::map<std::string, AttrIndex, classad::CaseIgnLTStr> attrs;
+	classad::References unindexed;
+};
+
+#endif
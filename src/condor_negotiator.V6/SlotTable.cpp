@@ -0,0 +1,151 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2024, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+#include "condor_common.h"
+#include "condor_debug.h"
+#include "condor_attributes.h"
+#include "stl_string_utils.h"
+#include "SlotTable.h"
+
+void
+SlotTable::Configure(bool enable, const std::string & new_settings)
+{
+	if (enable != enabled || new_settings != settings) {
+		if ( ! slots.empty()) {
+			dprintf(D_FULLDEBUG, "Slot table settings changed, forgetting %zu slots\n", slots.size());
+		}
+		Clear();
+	}
+	enabled = enable;
+	settings = new_settings;
+}
+
+void
+SlotTable::Clear()
+{
+	slots.clear();
+	ref_counts.clear();
+	since = 0;
+	invalid = false;
+}
+
+std::string
+SlotTable::Projection(const std::string & projection) const
+{
+	if (since <= 0) {
+		return projection;
+	}
+
+	std::string expr;
+	formatstr(expr, "ifThenElse(" ATTR_COLLECTOR_CHANGE_TIME " is undefined || " ATTR_COLLECTOR_CHANGE_TIME " >= %lld, %s, "
+	          "\"" ATTR_NAME " " ATTR_MY_TYPE " " ATTR_STARTD_IP_ADDR " " ATTR_COLLECTOR_CHANGE_TIME "\")",
+	          (long long)since, projection.empty() ? "\"\"" : ("(" + projection + ")").c_str());
+	return expr;
+}
+
+void
+SlotTable::StartCycle()
+{
+	++cycle;
+	invalid = false;
+	reused = 0;
+	updated = 0;
+}
+
+const ClassAd *
+SlotTable::Lookup(const std::string & id, time_t changed)
+{
+	auto it = slots.find(id);
+	if (it == slots.end() || it->second.changed != changed) {
+		invalid = true;
+		return nullptr;
+	}
+	it->second.cycle = cycle;
+	++reused;
+	return it->second.ad.get();
+}
+
+void
+SlotTable::ReleaseRefs(Entry & entry)
+{
+	for (auto ref : entry.refs) {
+		if (--ref->second <= 0) {
+			ref_counts.erase(ref);
+		}
+	}
+	entry.refs.clear();
+}
+
+void
+SlotTable::Update(const std::string & id, time_t changed, const ClassAd & ad)
+{
+	Entry & entry = slots[id];
+	ReleaseRefs(entry);
+	entry.ad.reset(new ClassAd(ad));
+	entry.changed = changed;
+	entry.cycle = cycle;
+	++updated;
+
+	// list values are ignored, as in compute_significant_attrs()
+	classad::References refs;
+	for (auto it = entry.ad->begin(); it != entry.ad->end(); ++it) {
+		if (it->second->GetKind() == classad::ExprTree::EXPR_LIST_NODE) {
+			continue;
+		}
+		entry.ad->GetExternalReferences(it->second, refs, true);
+	}
+	entry.refs.reserve(refs.size());
+	for (const auto & ref : refs) {
+		auto rc = ref_counts.emplace(ref, 0).first;
+		++rc->second;
+		entry.refs.push_back(rc);
+	}
+}
+
+void
+SlotTable::EndCycle()
+{
+	since = 0;
+	for (auto it = slots.begin(); it != slots.end(); ) {
+		if (it->second.cycle != cycle) {
+			ReleaseRefs(it->second);
+			it = slots.erase(it);
+		} else {
+			since = std::max(since, it->second.changed);
+			++it;
+		}
+	}
+
+	// we can't trust what we have, so fetch everything next cycle
+	if (invalid) {
+		dprintf(D_ALWAYS, "Slot table is out of date, will fetch all slot ads next cycle\n");
+		since = 0;
+	}
+
+	dprintf(D_FULLDEBUG, "Slot table has %zu slots, %zu reused and %zu updated this cycle\n",
+	        slots.size(), reused, updated);
+}
+
+void
+SlotTable::GetExternalReferences(classad::References & refs) const
+{
+	for (const auto & [ref, count] : ref_counts) {
+		refs.insert(ref);
+	}
+}
@@ -0,0 +1,116 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2024, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+#ifndef SLOT_TABLE_H
+#define SLOT_TABLE_H
+
+#include "condor_common.h"
+#include "compat_classad.h"
+
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <unordered_map>
+
+// The slot ads of the last negotiation cycle, as they were after the
+// negotiator prepared them for matchmaking (NegotiatorRequirements
+// swapped in, SlotWeight filled in, optimized as the right ad).
+//
+// The collector stamps each ad with the time it last changed the ad,
+// whether by an update from the startd or otherwise, as when it merges
+// in the negotiator's matches or marks the ad absent.  Once we have a
+// table, the slot ads are fetched with a projection that sends an ad
+// that has not changed since the last cycle as just its key, and we use
+// the ad we prepared from it then.  (Ads from a collector that doesn't
+// stamp them are always sent whole.)  So each cycle only fetches, parses and prepares the ads that
+// changed.  The ads of a cycle are copies, the negotiator changes them
+// as it matches.
+//
+// We also keep the external references of each prepared ad, which are
+// what compute_significant_attrs() needs from the slots, so they are
+// only found for the ads that changed.
+//
+// The table must be cleared when the settings that shape the prepared
+// ads change, which Configure() does.  If the collector sends the key of
+// an ad we don't have, or of another version than we have (as when the
+// negotiator fails over to another collector), the slot is left out of
+// that cycle and the next cycle fetches all of the ads.
+class SlotTable {
+public:
+	SlotTable() : enabled(false), since(0), cycle(0), invalid(false), reused(0), updated(0) {}
+
+	// settings is what the prepared ads depend on; the table is cleared
+	// if it changes.
+	void Configure(bool enable, const std::string & settings);
+	bool Enabled() const { return enabled; }
+	void Clear();
+
+	// Wrap the projection expression the slot ads are fetched with (empty
+	// for all attributes) so that ads not changed since the last cycle
+	// are sent as just their key.
+	std::string Projection(const std::string & projection) const;
+
+	void StartCycle();
+
+	// Is an ad the collector last changed at this time just a key?
+	bool IsStub(time_t changed) const { return since > 0 && changed < since; }
+
+	// The prepared ad for a key sent by itself, or NULL if we don't have
+	// that version of it.
+	const ClassAd * Lookup(const std::string & id, time_t changed);
+
+	// Remember the prepared ad for a slot.
+	void Update(const std::string & id, time_t changed, const ClassAd & ad);
+
+	// Forget the slots that were not in this cycle.
+	void EndCycle();
+
+	// Add the external references of all of the slot ads.
+	void GetExternalReferences(classad::References & refs) const;
+
+	size_t NumReused() const { return reused; }
+	size_t NumUpdated() const { return updated; }
+	size_t size() const { return slots.size(); }
+
+private:
+	typedef std::map<std::string, int, classad::CaseIgnLTStr> RefCounts;
+
+	struct Entry {
+		std::unique_ptr<ClassAd> ad;
+		time_t changed;		// collector change time of the ad
+		unsigned int cycle;
+		std::vector<RefCounts::iterator> refs;
+	};
+
+	void ReleaseRefs(Entry & entry);
+
+	bool enabled;
+	std::string settings;
+	time_t since;		// collector time of the newest ad in the table
+	unsigned int cycle;
+	bool invalid;		// fetch all of the ads next cycle
+	size_t reused;
+	size_t updated;
+
+	std::unordered_map<std::string, Entry> slots;
+	RefCounts ref_counts;	// how many ads refer to each attribute
+};
+
+#endif
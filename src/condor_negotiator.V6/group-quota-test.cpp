@@ -0,0 +1,183 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2024, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+// Checks that the incremental group quota computation comes up with the
+// same quotas and allocations as computing everything again, over a run of
+// negotiation cycles where the demand, usage and pool size change a little
+// at a time.
+
+#include "condor_common.h"
+#include "condor_config.h"
+#include "condor_attributes.h"
+#include "GroupEntry.h"
+
+#include <random>
+
+// Just enough of the accountant to test
+
+static std::map<std::string, double> usage;
+
+double
+Accountant::GetWeightedResourcesUsed(const std::string &name) {
+	return usage[name];
+}
+
+bool
+Accountant::UsingWeightedSlots() const { return false; }
+
+Accountant::Accountant() {}
+Accountant::~Accountant() {}
+
+static const char * group_names[] = { "a", "a.x", "a.y", "a.y.p", "a.y.q", "b", "b.x", "b.y", "c" };
+static const int group_count = sizeof(group_names) / sizeof(group_names[0]);
+
+struct Result {
+	double quota;
+	double allocated;
+	double requested;
+	std::vector<int> limits;
+};
+
+// Run one negotiation cycle for the tree, with the submitters asking for
+// demand[i] slots in group i, and set result to the quota, allocation and
+// negotiation limits of each group.
+static void
+run_cycle(GroupEntry *root, std::vector<GroupEntry *> &groups, double pool_size,
+          const std::vector<int> &demand, std::map<std::string, Result> &result)
+{
+	std::vector<ClassAd *> submitterAds;
+	for (int i = 0; i < group_count; ++i) {
+		ClassAd *ad = new ClassAd();
+		std::string name;
+		formatstr(name, "%s.user@submit.example.com", group_names[i]);
+		ad->Assign(ATTR_NAME, name);
+		ad->Assign(ATTR_IDLE_JOBS, demand[i]);
+		ad->Assign(ATTR_RUNNING_JOBS, 0);
+		ad->Assign(ATTR_WEIGHTED_IDLE_JOBS, demand[i]);
+		ad->Assign(ATTR_WEIGHTED_RUNNING_JOBS, 0);
+		submitterAds.push_back(ad);
+	}
+
+	Accountant accountant;
+	groupQuotasHashType groupQuotasHash;
+	result.clear();
+	auto negotiate = [&result](GroupEntry *g, int limit) {
+		result[g->name].limits.push_back(limit);
+	};
+
+	GroupEntry::Initialize(root);
+	GroupEntry::hgq_prepare_for_matchmaking(pool_size, root, groups, accountant, submitterAds);
+	GroupEntry::hgq_negotiate_with_all_groups(root, groups, groupQuotasHash, pool_size, accountant, negotiate, true);
+
+	for (GroupEntry *group : groups) {
+		Result &r = result[group->name];
+		r.quota = group->quota;
+		r.allocated = group->allocated;
+		r.requested = group->requested;
+	}
+	for (ClassAd *ad : submitterAds) { delete ad; }
+}
+
+int
+main(int /*argc*/, char ** /*argv*/) {
+	config_host(nullptr, CONFIG_OPT_WANT_META | CONFIG_OPT_USE_THIS_ROOT_CONFIG | CONFIG_OPT_NO_EXIT, "ONLY_ENV");
+	dprintf_set_tool_debug("TOOL", 0);
+
+	// a mix of dynamic quotas, which leave fractions for the round robin,
+	// and static ones, some groups taking surplus and some not
+	param_insert("GROUP_NAMES", "a, a.x, a.y, a.y.p, a.y.q, b, b.x, b.y, c");
+	param_insert("GROUP_QUOTA_DYNAMIC_a", "0.45");
+	param_insert("GROUP_QUOTA_DYNAMIC_a.x", "0.3");
+	param_insert("GROUP_QUOTA_DYNAMIC_a.y", "0.6");
+	param_insert("GROUP_QUOTA_DYNAMIC_a.y.p", "0.55");
+	param_insert("GROUP_QUOTA_DYNAMIC_a.y.q", "0.35");
+	param_insert("GROUP_QUOTA_DYNAMIC_b", "0.35");
+	param_insert("GROUP_QUOTA_b.x", "7");
+	param_insert("GROUP_QUOTA_DYNAMIC_b.y", "0.25");
+	param_insert("GROUP_QUOTA_c", "11");
+	param_insert("GROUP_ACCEPT_SURPLUS", "true");
+	param_insert("GROUP_ACCEPT_SURPLUS_b.x", "false");
+	param_insert("GROUP_QUOTA_INCREMENTAL", "true");
+
+	bool autoregroup = false, accept_surplus = false;
+	std::vector<GroupEntry *> groups;
+	GroupEntry *root = GroupEntry::hgq_construct_tree(groups, autoregroup, accept_surplus);
+
+	std::mt19937 rng(20);
+	std::vector<int> demand(group_count);
+	for (int &d : demand) { d = rng() % 40; }
+	double pool_size = 97;
+
+	unsigned failures = 0;
+	long reused = 0;
+	for (int cycle = 0; cycle < 100; ++cycle) {
+		// Change a little of the input, or nothing at all
+		switch (rng() % 6) {
+		case 0: break;
+		case 1: demand[rng() % group_count] = rng() % 40; break;
+		case 2: demand[rng() % group_count] = 0; break;
+		case 3: usage[group_names[rng() % group_count]] = rng() % 15; break;
+		case 4: pool_size = 60 + rng() % 80; break;
+		case 5: groups[rng() % groups.size()]->rr_time -= 1 + rng() % 100; break;
+		}
+
+		// Compute the cycle from scratch in a new tree, with the same round
+		// robin times.  Whether the computation is incremental is set when a
+		// tree is built, so build one more to turn it back on after.
+		param_insert("GROUP_QUOTA_INCREMENTAL", "false");
+		std::vector<GroupEntry *> full_groups;
+		GroupEntry *full_root = GroupEntry::hgq_construct_tree(full_groups, autoregroup, accept_surplus);
+		for (size_t i = 0; i < groups.size(); ++i) {
+			full_groups[i]->rr_time = groups[i]->rr_time;
+		}
+		std::map<std::string, Result> full;
+		run_cycle(full_root, full_groups, pool_size, demand, full);
+		delete full_root;
+
+		param_insert("GROUP_QUOTA_INCREMENTAL", "true");
+		delete GroupEntry::hgq_construct_tree(full_groups, autoregroup, accept_surplus);
+
+		GroupEntry::hgq_stats = {};
+		std::map<std::string, Result> incremental;
+		run_cycle(root, groups, pool_size, demand, incremental);
+		reused += GroupEntry::hgq_stats.reused;
+
+		for (const auto & [name, want] : full) {
+			const Result &got = incremental[name];
+			if (got.quota != want.quota || got.allocated != want.allocated ||
+				got.requested != want.requested || got.limits != want.limits) {
+				++failures;
+				fprintf(stderr, "cycle %d group %s: incremental quota= %g allocated= %g requested= %g, full quota= %g allocated= %g requested= %g\n",
+						cycle, name.c_str(), got.quota, got.allocated, got.requested, want.quota, want.allocated, want.requested);
+			}
+		}
+	}
+
+	// if nothing was replayed, this did not test anything
+	if (reused == 0) {
+		++failures;
+		fprintf(stderr, "no steps of the quota computation were replayed\n");
+	}
+	printf("%ld steps replayed\n", reused);
+
+	if (failures == 0) {
+		fprintf(stdout, "No failures detected.\n");
+	}
+	return failures;
+}
@@ -44,6 +44,8 @@
 #include <vector>
 #include <string>
 #include <deque>
+#include <algorithm>
+#include <iterator>
 
 #if defined(WANT_CONTRIB) && defined(WITH_MANAGEMENT) && defined(UNIX)
 #include "NegotiatorPlugin.h"
@@ -88,19 +90,46 @@ public:
 
     time_t prefetch_duration;
     double prefetch_cpu_time;
+    double prefetch_wait_time;
 
     int total_slots;
     int trimmed_slots;
     int candidate_slots;
 
+    // slot ads not fetched because they had not changed since the last cycle
+    int reused_slots;
+
     int slot_share_iterations;
 
+    // time spent in the phases of the group quota computations, and the
+    // steps of them that were computed and that were reused
+    double group_quota_assign_time;
+    double group_quota_fairshare_time;
+    double group_quota_round_robin_time;
+    int group_quota_recomputed;
+    int group_quota_reused;
+
     int num_idle_jobs;
     int num_jobs_considered;
 
 	int matches;
 	int rejections;
 
+    // match evaluations skipped because the slot index ruled the slot out
+    int match_evals_avoided;
+
+    // requests whose matches were found in, or added to, the matches
+    // shared between submitters
+    int shared_matchlist_hits;
+    int shared_matchlist_misses;
+
+    // time spent in ParallelIsAMatch(), the time the threads were busy
+    // matching, and wall time * threads (so busy / capacity is the
+    // parallel efficiency)
+    double par_match_wall_time;
+    double par_match_busy_time;
+    double par_match_capacity;
+
     int pies;
     int pie_spins;
 
@@ -131,14 +160,27 @@ NegotiationCycleStats::NegotiationCycleStats():
     phase4_cpu_time(0.0),
     prefetch_duration(0),
     prefetch_cpu_time(0.0),
+    prefetch_wait_time(0.0),
     total_slots(0),
     trimmed_slots(0),
     candidate_slots(0),
+    reused_slots(0),
     slot_share_iterations(0),
+    group_quota_assign_time(0.0),
+    group_quota_fairshare_time(0.0),
+    group_quota_round_robin_time(0.0),
+    group_quota_recomputed(0),
+    group_quota_reused(0),
     num_idle_jobs(0),
     num_jobs_considered(0),
 	matches(0),
 	rejections(0),
+    match_evals_avoided(0),
+    shared_matchlist_hits(0),
+    shared_matchlist_misses(0),
+    par_match_wall_time(0.0),
+    par_match_busy_time(0.0),
+    par_match_capacity(0.0),
     pies(0),
     pie_spins(0),
     active_schedds(),
@@ -432,6 +474,9 @@ Matchmaker ()
 
 	want_globaljobprio = false;
 	want_matchlist_caching = false;
+	want_slot_index = false;
+	shared_matchlist_cache_size = 0;
+	want_parse_arena = false;
 	PublishCrossSlotPrios = false;
 	ConsiderPreemption = true;
 	ConsiderEarlyPreemption = false;
@@ -495,6 +540,10 @@ Matchmaker ()
 	slotWeightStr = 0;
 	m_staticRanks = false;
 	m_dryrun = false;
+	m_prefetchActive = false;
+	m_prefetchTimeout = 0;
+	m_prefetchDeadline = -1;
+	m_prefetchAttempted = m_prefetchSuccessful = 0;
 }
 
 Matchmaker::
@@ -816,6 +865,9 @@ reinitialize ()
 
 	want_globaljobprio = param_boolean("USE_GLOBAL_JOB_PRIOS",false);
 	want_matchlist_caching = param_boolean("NEGOTIATOR_MATCHLIST_CACHING",true);
+	want_slot_index = param_boolean("NEGOTIATOR_USE_SLOT_INDEX",true);
+	shared_matchlist_cache_size = param_integer("NEGOTIATOR_SHARED_MATCHLIST_CACHE_SIZE",100,0);
+	want_parse_arena = param_boolean("NEGOTIATOR_PARSE_ADS_IN_ARENA",true);
 	PublishCrossSlotPrios = param_boolean("NEGOTIATOR_CROSS_SLOT_PRIOS", false);
 	ConsiderPreemption = param_boolean("NEGOTIATOR_CONSIDER_PREEMPTION",true);
 	ConsiderEarlyPreemption = param_boolean("NEGOTIATOR_CONSIDER_EARLY_PREEMPTION",false);
@@ -908,6 +960,13 @@ reinitialize ()
 
 	force_my_slot_weight = param_boolean("FORCE_NEGOTIATOR_SLOT_WEIGHT", false);
 
+	// the prepared slot ads depend on these, so forget them if they change
+	std::string slot_table_settings;
+	formatstr(slot_table_settings, "%s\n%d\n%s\n%d",
+		strSlotConstraint ? strSlotConstraint : "", (int)ConsiderPreemption,
+		slotWeightStr, (int)force_my_slot_weight);
+	slotTable.Configure(param_boolean("NEGOTIATOR_INCREMENTAL_SLOT_TABLE", true), slot_table_settings);
+
 
 	// done
 	return TRUE;
@@ -1605,6 +1664,7 @@ compute_significant_attrs(std::vector<ClassAd *> & startdAds, std::string & sig_
 {
 	dprintf(D_FULLDEBUG,"Entering compute_significant_attrs()\n");
 	sig_attrs.clear();
+	job_match_references.clear();
 
 	// Figure out list of all external attribute references in all startd ads
 	//
@@ -1612,22 +1672,30 @@ compute_significant_attrs(std::vector<ClassAd *> & startdAds, std::string & sig_
 	// base ClassAd method GetExternalReferences(), building up a merged
 	// set of full reference names and then call TrimReferenceNames()
 	// on that.
+	//
+	// The slot table already has the references of each slot ad.
 	ClassAd *sample_startd_ad = nullptr;
 	classad::References external_references;
-	for (ClassAd *startd_ad: startdAds) {
-		if ( !sample_startd_ad ) {
-			sample_startd_ad = new ClassAd(*startd_ad);
-		}
-		classad::ClassAd::const_iterator attr_it;
-		for ( attr_it = startd_ad->begin(); attr_it != startd_ad->end(); attr_it++ ) {
-			// ignore list type values when computing external refs.
-			// this prevents Child* and AvailableGPUs slot attributes from polluting the sig attrs
-			if (attr_it->second->GetKind() == classad::ExprTree::EXPR_LIST_NODE) {
-				continue;
+	if (slotTable.Enabled() && ! startdAds.empty()) {
+		sample_startd_ad = new ClassAd(*startdAds.front());
+		slotTable.GetExternalReferences(external_references);
+	}
+	else {
+		for (ClassAd *startd_ad: startdAds) {
+			if ( !sample_startd_ad ) {
+				sample_startd_ad = new ClassAd(*startd_ad);
 			}
-			startd_ad->GetExternalReferences( attr_it->second, external_references, true );
-		}
-	}	// while startd_ad
+			classad::ClassAd::const_iterator attr_it;
+			for ( attr_it = startd_ad->begin(); attr_it != startd_ad->end(); attr_it++ ) {
+				// ignore list type values when computing external refs.
+				// this prevents Child* and AvailableGPUs slot attributes from polluting the sig attrs
+				if (attr_it->second->GetKind() == classad::ExprTree::EXPR_LIST_NODE) {
+					continue;
+				}
+				startd_ad->GetExternalReferences( attr_it->second, external_references, true );
+			}
+		}	// while startd_ad
+	}
 
 	// Now add external attributes references from negotiator policy exprs; at
 	// this point, we only have to worry about PREEMPTION_REQUIREMENTS.
@@ -1725,6 +1793,10 @@ compute_significant_attrs(std::vector<ClassAd *> & startdAds, std::string & sig_
 	// Simplify the attribute references
 	TrimReferenceNames( external_references, true );
 
+	// Matches can be shared between requests that agree on all of these,
+	// including the ones the schedd need not send.
+	job_match_references = external_references;
+
 		// Always get rid of the follow attrs:
 		//    CurrentTime - for obvious reasons
 		//    RemoteUserPrio - not needed since we negotiate per user
@@ -1843,18 +1915,25 @@ int count_effective_slots(std::vector<ClassAd *>& startdAds, ExprTree* constrain
 }
 
 
-static int 
-CountMatches(const std::vector<ClassAd *> &ads, classad::ExprTree* constraint) {
-	// Check for null constraint.
+// The ads that satisfy a constraint.  The constraint is evaluated against
+// all of the ads at once, which is much faster than one ad at a time for
+// a simple constraint on attributes of the slots.
+static std::vector<ClassAd *>
+SelectMatches(const std::vector<ClassAd *> &ads, classad::ExprTree* constraint) {
+	std::vector<ClassAd *> matches;
 	if (constraint == nullptr) {
-		return 0;
+		return matches;
 	}
 
-	int matchCount  = 0;
-	for (ClassAd *ad: ads) {
-		matchCount += EvalExprBool(ad, constraint);
+	classad::AdBatch batch(ads.begin(), ads.end());
+	std::vector<unsigned char> matched;
+	matches.reserve(classad::BatchExpr(constraint).EvaluateBool(batch, matched));
+	for (size_t ix = 0; ix < ads.size(); ++ix) {
+		if (matched[ix]) {
+			matches.push_back(ads[ix]);
+		}
 	}
-	return matchCount;
+	return matches;
 }
 
 void
@@ -1974,6 +2053,7 @@ Matchmaker::negotiationTime( int /* timerID */ )
 	// Save this for future use.
 	int cTotalSlots = startdAds.size();
     negotiation_cycle_stats[0]->total_slots = cTotalSlots;
+    negotiation_cycle_stats[0]->reused_slots = slotTable.Enabled() ? (int)slotTable.NumReused() : 0;
 
 	double minSlotWeight = 0;
 	double untrimmedSlotWeightTotal = sumSlotWeights(startdAds,&minSlotWeight,NULL);
@@ -2002,11 +2082,12 @@ Matchmaker::negotiationTime( int /* timerID */ )
     int effectivePoolsize = 0;
     // Restrict number of slots available for determining quotas
     if (SlotPoolsizeConstraint != nullptr) {
-        cPoolsize = CountMatches(startdAds, SlotPoolsizeConstraint);
+        std::vector<ClassAd *> poolAds = SelectMatches(startdAds, SlotPoolsizeConstraint);
+        cPoolsize = (int)poolAds.size();
         if (cPoolsize > 0) {
             dprintf(D_ALWAYS,"NEGOTIATOR_SLOT_POOLSIZE_CONSTRAINT constraint reduces slot count from %d to %d\n", cTotalSlots, cPoolsize);
-            weightedPoolsize = (accountant.UsingWeightedSlots()) ? sumSlotWeights(startdAds, NULL, SlotPoolsizeConstraint) : cPoolsize;
-            effectivePoolsize = count_effective_slots(startdAds, SlotPoolsizeConstraint);
+            weightedPoolsize = (accountant.UsingWeightedSlots()) ? sumSlotWeights(poolAds, NULL, NULL) : cPoolsize;
+            effectivePoolsize = count_effective_slots(poolAds, NULL);
         } else {
             dprintf(D_ALWAYS, "WARNING: 0 out of %d slots match NEGOTIATOR_SLOT_POOLSIZE_CONSTRAINT\n", cTotalSlots);
         }
@@ -2047,6 +2128,9 @@ Matchmaker::negotiationTime( int /* timerID */ )
 	// available during matchmaking
 	addRemoteUserPrios( startdAds );
 
+	buildSlotIndex( startdAds );
+	buildMatchListCache( startdAds );
+
 	SetupMatchSecurity(submitterAds);
 
     if (hgq_groups.size() <= 1) {
@@ -2077,6 +2161,7 @@ Matchmaker::negotiationTime( int /* timerID */ )
                 hgq_total_quota,
                 (accountant.UsingWeightedSlots()) ? " weighted" : "");
 
+		GroupEntry::hgq_stats = GroupEntry::HgqStats();
 		GroupEntry::hgq_prepare_for_matchmaking(hgq_total_quota, hgq_root_group, hgq_groups, accountant, submitterAds);
 
 		auto callback = [&](GroupEntry *g, int slots) -> void {
@@ -2120,6 +2205,12 @@ Matchmaker::negotiationTime( int /* timerID */ )
 						callback,
 						accept_surplus);
 
+		const GroupEntry::HgqStats &hgq_stats = GroupEntry::hgq_stats;
+		negotiation_cycle_stats[0]->group_quota_assign_time = hgq_stats.assign_time;
+		negotiation_cycle_stats[0]->group_quota_fairshare_time = hgq_stats.fairshare_time;
+		negotiation_cycle_stats[0]->group_quota_round_robin_time = hgq_stats.round_robin_time;
+		negotiation_cycle_stats[0]->group_quota_recomputed = (int)hgq_stats.recomputed;
+		negotiation_cycle_stats[0]->group_quota_reused = (int)hgq_stats.reused;
     }
 
     // Leave this in as an easter egg for dev/testing purposes.
@@ -2132,6 +2223,10 @@ Matchmaker::negotiationTime( int /* timerID */ )
         dprintf(D_ALWAYS, "end sleep: %d seconds\n", insert_duration);
     }
 
+    // the slot index points into allAds, which is about to go away
+    slotIndex.Clear();
+    matchListCache.Clear();
+
     // ----- Done with the negotiation cycle
     dprintf( D_ALWAYS, "---------- Finished Negotiation Cycle ----------\n" );
 
@@ -2826,6 +2921,7 @@ negotiateWithGroup ( bool isFloorRound,
 				submitterIter++;
 			}
 		}
+		endPrefetch();
 		dprintf( D_FULLDEBUG, " resources used scheddUsed= %f\n",scheddUsed);
 
 	} while ( ( pieLeft < pieLeftOrig || submitterAds.size() < submitterAdsCountOrig )
@@ -3180,12 +3276,20 @@ obtainAdsFromCollector (
 	if (strSlotConstraint && strSlotConstraint[0]) {
 		publicQuery.addORConstraint(strSlotConstraint);
 	}
+	std::string projection;
 	if (!ConsiderPreemption) {
 		const char *projectionString =
 			"ifThenElse((State == \"Claimed\"&&PartitionableSlot=!=true),\"Name MyType State Activity StartdIpAddr AccountingGroup Owner RemoteUser Requirements SlotWeight ConcurrencyLimits\",\"\") ";
-		publicQuery.setDesiredAttrsExpr(projectionString);
+		projection = projectionString;
 		dprintf(D_ALWAYS, "Not considering preemption, therefore constraining idle machines with %s\n", projectionString);
 	}
+	if (slotTable.Enabled()) {
+		// just the key of slots that haven't changed since the last cycle
+		projection = slotTable.Projection(projection);
+	}
+	if ( ! projection.empty()) {
+		publicQuery.setDesiredAttrsExpr(projection.c_str());
+	}
 	publicQuery.convertToMulti(STARTD_SLOT_ADTYPE, true, true, false);
 	// TODO: add this to the query and get rid of separate query for private ads?
 	// publicQuery.convertToMulti(STARTD_PVT_ADTYPE, true, true, false);
@@ -3224,9 +3328,17 @@ obtainAdsFromCollector (
 	}
 #endif
 
+	// The ads of a cycle are all deleted together at the end of it, so
+	// parse them into an arena rather than allocating each node.
+	classad::ExprArena parse_arena;
+	classad::ExprArena *ads_arena = want_parse_arena ? &parse_arena : nullptr;
+
 	dprintf(D_ALWAYS,"  Getting startd private ads ...\n");
 	ClassAdList startdPvtAdList;
-	result = collects->query (privateQuery, startdPvtAdList);
+	{
+		classad::ExprArenaScope arena_scope(ads_arena);
+		result = collects->query (privateQuery, startdPvtAdList);
+	}
 	if( result!=Q_OK ) {
 		dprintf(D_ALWAYS, "Couldn't fetch ads: %s\n", getStrQueryResult(result));
 		return false;
@@ -3234,7 +3346,10 @@ obtainAdsFromCollector (
 
     CondorError errstack;
 	dprintf(D_ALWAYS, "  Getting Scheduler, Submitter and Machine ads ...\n");
-	result = collects->query (publicQuery, allAds, &errstack);
+	{
+		classad::ExprArenaScope arena_scope(ads_arena);
+		result = collects->query (publicQuery, allAds, &errstack);
+	}
 	if( result!=Q_OK ) {
 		dprintf(D_ALWAYS, "Couldn't fetch ads: %s\n",
            errstack.code() ? errstack.getFullText(false).c_str() : getStrQueryResult(result)
@@ -3244,6 +3359,7 @@ obtainAdsFromCollector (
 
 	dprintf(D_ALWAYS, "  Sorting %d ads ...\n",allAds.MyLength());
 
+	slotTable.StartCycle();
 	allAds.Open();
 	while( (ad=allAds.Next()) ) {
 
@@ -3272,6 +3388,24 @@ obtainAdsFromCollector (
 				continue;
 			}
 
+			// If the collector sent just the key of this ad, because it
+			// hasn't changed since the last cycle, use the ad we prepared
+			// from it then.
+			time_t changeTime = 0;
+			bool hasChangeTime = ad->LookupInteger(ATTR_COLLECTOR_CHANGE_TIME, changeTime);
+			bool prepared = false;
+			if (slotTable.Enabled() && hasChangeTime && slotTable.IsStub(changeTime)) {
+				const ClassAd *preparedAd = slotTable.Lookup(MachineAdID(ad), changeTime);
+				if ( ! preparedAd) {
+					dprintf(D_ALWAYS, "No prepared ad for unchanged slot %s, leaving it out of this cycle\n", remoteHost);
+					free(remoteHost);
+					remoteHost = NULL;
+					continue;
+				}
+				*ad = *preparedAd;
+				prepared = true;
+			}
+
 			// Next, let's transform the ad. The first thing we might
 			// do is replace the Requirements attribute with whatever
 			// we find in NegotiatorRequirements
@@ -3279,7 +3413,7 @@ obtainAdsFromCollector (
 			const char *subReqs;
 			subReqs = NULL;
 			negReqTree = reqTree = NULL;
-			negReqTree = ad->LookupExpr(ATTR_NEGOTIATOR_REQUIREMENTS);
+			negReqTree = prepared ? NULL : ad->LookupExpr(ATTR_NEGOTIATOR_REQUIREMENTS);
 			if ( negReqTree != NULL ) {
 
 				// Save the old requirements expression
@@ -3301,7 +3435,7 @@ obtainAdsFromCollector (
 				ad->AssignExpr(ATTR_REQUIREMENTS, subReqs);
 			}
 
-			if( reevaluate_ad && newSequence != -1 ) {
+			if( reevaluate_ad && newSequence != -1 && !prepared ) {
 				oldAd = NULL;
 				oldAdEntry = NULL;
 
@@ -3399,13 +3533,19 @@ obtainAdsFromCollector (
 			ad->Assign("MachineMatchCount", 0);
 			ad->Delete("OfflineMatches");
 
-			// If startd didn't set a slot weight expression, add in our own
-			double slot_weight;
-			if (force_my_slot_weight || ! ad->LookupFloat(ATTR_SLOT_WEIGHT, slot_weight)) {
-				ad->AssignExpr(ATTR_SLOT_WEIGHT, slotWeightStr);
-			}
+			if ( ! prepared) {
+				// If startd didn't set a slot weight expression, add in our own
+				double slot_weight;
+				if (force_my_slot_weight || ! ad->LookupFloat(ATTR_SLOT_WEIGHT, slot_weight)) {
+					ad->AssignExpr(ATTR_SLOT_WEIGHT, slotWeightStr);
+				}
+
+				OptimizeMachineAdForMatchmaking( ad );
 
-			OptimizeMachineAdForMatchmaking( ad );
+				if (slotTable.Enabled()) {
+					slotTable.Update(MachineAdID(ad), changeTime, *ad);
+				}
+			}
 
 			startdAds.emplace_back(ad);
 		} else if( !strcmp(GetMyTypeName(*ad),SUBMITTER_ADTYPE) ) {
@@ -3480,6 +3620,9 @@ obtainAdsFromCollector (
         remoteHost = NULL;
 	}
 	allAds.Close();
+	if (slotTable.Enabled()) {
+		slotTable.EndCycle();
+	}
 
 	// In the processing of allAds above, if want_globaljobprio is true,
 	// we may have created additional submitter ads and inserted them
@@ -3513,6 +3656,10 @@ obtainAdsFromCollector (
 
 	dprintf(D_ALWAYS, "Public ads include %zu submitter, %zu startd\n",
 		submitterAds.size(), startdAds.size() );
+	if (slotTable.Enabled()) {
+		dprintf(D_ALWAYS, "Reused %zu unchanged startd ads from the last cycle\n",
+			slotTable.NumReused() );
+	}
 
 	return true;
 }
@@ -3684,39 +3831,6 @@ bool makeSubmitterScheddHash(const ClassAd &ad, std::string &hash)
 }
 
 
-typedef std::deque<ClassAd*> ScheddWork;
-typedef classad_shared_ptr<ScheddWork> ScheddWorkPtr;
-typedef std::map<std::string, ScheddWorkPtr> ScheddWorkMap;
-typedef classad_shared_ptr<ResourceRequestList> RRLPtr;
-typedef std::map<std::string, std::pair<ClassAd*, RRLPtr> > CurrentWorkMap;
-
-static bool
-assignWork(const ScheddWorkMap &workMap, CurrentWorkMap &curWork, ScheddWork &negotiations)
-{
-	negotiations.clear();
-	unsigned workAssigned = 0;
-	for (const auto & schedd_it : workMap)
-	{
-		if (!schedd_it.second.get()) {continue;} // null pointer.
-
-		CurrentWorkMap::iterator cur_it = curWork.find(schedd_it.first);
-		if (cur_it != curWork.end()) {continue;} // Already work for this schedd.
-
-		ScheddWork & workRef = *schedd_it.second;
-		if (workRef.empty()) {continue;} // No work for this schedd.
-
-		RRLPtr emptyPtr;
-		std::pair<ClassAd*, RRLPtr> work( workRef.front(), emptyPtr );
-		curWork.insert(cur_it, std::make_pair(schedd_it.first, work));
-		negotiations.push_back(workRef.front());
-		workRef.pop_front();
-		workAssigned++;
-	}
-	dprintf(D_FULLDEBUG, "Assigned %u units of work for prefetching.\n", workAssigned);
-	return workAssigned;
-}
-
-
 void
 Matchmaker::prefetchResourceRequestLists(std::vector<ClassAd *> &submitterAds)
 {
@@ -3725,10 +3839,9 @@ Matchmaker::prefetchResourceRequestLists(std::vector<ClassAd *> &submitterAds)
 		return;
 	}
 
-	ReliSock *sock;
-
 	m_cachedRRLs.clear();
-	ScheddWorkMap scheddWorkQueues;
+	m_prefetchQueues.clear();
+	m_prefetchCurrent.clear();
 	unsigned todoPrefetches = 0;
 	for (ClassAd *submitterAd: submitterAds) {
 		std::string scheddAddr;
@@ -3736,152 +3849,168 @@ Matchmaker::prefetchResourceRequestLists(std::vector<ClassAd *> &submitterAds)
 		{
 			continue;
 		}
-		ScheddWorkMap::iterator iter = scheddWorkQueues.find(scheddAddr);
-		if (iter == scheddWorkQueues.end())
-		{
-			ScheddWorkPtr work_ptr(new ScheddWork());
-			iter = scheddWorkQueues.insert(iter, std::make_pair(scheddAddr, work_ptr));
-		}
-		iter->second->push_back(submitterAd);
+		m_prefetchQueues[scheddAddr].push_back(submitterAd);
 		todoPrefetches++;
 	}
 	dprintf(D_ALWAYS, "Starting prefetch round; %u potential prefetches to do.\n", todoPrefetches);
 
 	// Make sure our socket cache is big enough for all our current schedds.
-	if (static_cast<unsigned>(sockCache->size()) < scheddWorkQueues.size())
+	if (static_cast<unsigned>(sockCache->size()) < m_prefetchQueues.size())
 	{
-		sockCache->resize(scheddWorkQueues.size()+1);
+		sockCache->resize(m_prefetchQueues.size()+1);
 	}
-	
-	CurrentWorkMap currentWork;
-	ScheddWork negotiations;
-	typedef std::map<int, std::pair<ClassAd*, RRLPtr> > FDToRRLMap;
-	FDToRRLMap fdToRRL;
-	unsigned attemptedPrefetches = 0, successfulPrefetches = 0;
-	double startTime = _condor_debug_get_time_double();
-	int prefetchTimeout = param_integer("NEGOTIATOR_PREFETCH_REQUESTS_TIMEOUT", NegotiatorTimeout);
+
+	m_prefetchActive = true;
+	m_prefetchAttempted = m_prefetchSuccessful = 0;
+	m_prefetchTimeout = param_integer("NEGOTIATOR_PREFETCH_REQUESTS_TIMEOUT", NegotiatorTimeout);
 	int prefetchCycle = param_integer("NEGOTIATOR_PREFETCH_REQUESTS_MAX_TIME");
-	double deadline = (prefetchCycle > 0) ? (startTime + prefetchCycle) : -1;
+	m_prefetchDeadline = (prefetchCycle > 0) ? (_condor_debug_get_time_double() + prefetchCycle) : -1;
 
-	Selector selector;
-	while (assignWork(scheddWorkQueues, currentWork, negotiations) || !currentWork.empty())
+	startPrefetches("");
+
+	if (param_boolean("NEGOTIATOR_PREFETCH_REQUESTS_PIPELINE", true))
+	{
+		// The rest of the round is done between and during negotiations;
+		// see waitForPrefetch() and negotiate().
+		dprintf(D_ALWAYS, "Prefetch round started with %zu sessions in flight; continuing it while negotiating.\n", m_prefetchCurrent.size());
+		return;
+	}
+
+	while (m_prefetchActive && !m_prefetchCurrent.empty())
+	{
+		servicePrefetch(m_prefetchTimeout, "");
+	}
+	endPrefetch();
+}
+
+
+void
+Matchmaker::startPrefetches(const std::string &busySchedd)
+{
+	ReliSock *sock;
+	unsigned workAssigned = 0;
+	for (auto & [scheddAddr, work] : m_prefetchQueues)
 	{
-		dprintf(D_FULLDEBUG, "Starting prefetch loop.\n");
-		// Start a bunch of negotiations
-		for (ScheddWork::const_iterator it=negotiations.begin(); it!=negotiations.end(); it++)
+		if (work.empty()) {continue;} // No work for this schedd.
+		if (scheddAddr == busySchedd) {continue;} // Socket in use for negotiation.
+		if (m_prefetchCurrent.count(scheddAddr)) {continue;} // Already work for this schedd.
+
+		ClassAd *submitterAd = work.front();
+		work.pop_front();
+		workAssigned++;
+
+		std::string submitter; getSubmitter(*submitterAd, submitter);
+		dprintf(D_ALWAYS, "Starting prefetch negotiation for %s.\n", submitter.c_str());
+		classad_shared_ptr<ResourceRequestList> rrl;
+		m_prefetchAttempted++;
+		bool success = false;
+		if (startNegotiateProtocol(submitter, *submitterAd, sock, rrl))
 		{
-			std::string submitter; getSubmitter(**it, submitter);
-			std::string scheddAddr; getScheddAddr(**it, scheddAddr);
-			dprintf(D_ALWAYS, "Starting prefetch negotiation for %s.\n", submitter.c_str());
-			classad_shared_ptr<ResourceRequestList> rrl;
-			attemptedPrefetches++;
-			bool success = false;
-			if (startNegotiateProtocol(submitter, **it, sock, rrl))
+			switch (rrl->tryRetrieve(sock))
 			{
-				switch (rrl->tryRetrieve(sock))
-				{
-				case ResourceRequestList::RRL_DONE:
-				case ResourceRequestList::RRL_NO_MORE_JOBS:
-				{
-					dprintf(D_FULLDEBUG, "Prefetch negotiation immediately finished.\n");
-					if (rrl->needsEndNegotiateNow()) {endNegotiate(scheddAddr);}
-					std::string hash; makeSubmitterScheddHash(**it, hash);
-					m_cachedRRLs[hash] = rrl;
-					CurrentWorkMap::iterator iter = currentWork.find(scheddAddr);
-					if (iter != currentWork.end()) {currentWork.erase(iter);}
-					else {dprintf(D_ALWAYS, "ERROR: Did prefetch work, but couldn't find it in the internal TODO list\n");}
-					success = true;
-					successfulPrefetches++;
-					break;
-				}
-				case ResourceRequestList::RRL_ERROR:
-					success = false;
-					break;
-				case ResourceRequestList::RRL_CONTINUE:
-					dprintf(D_FULLDEBUG, "Prefetch negotiation would block.\n");
-					currentWork[scheddAddr] = std::make_pair(*it, rrl);
-					success = true;
-					break;
-				}
-			}
-			if (!success)
+			case ResourceRequestList::RRL_DONE:
+			case ResourceRequestList::RRL_NO_MORE_JOBS:
 			{
-				dprintf(D_ALWAYS, "Failed to prefetch resource request lists for %s(%s).\n", submitter.c_str(), scheddAddr.c_str());
-				scheddWorkQueues[scheddAddr]->clear();
-				CurrentWorkMap::iterator iter = currentWork.find(scheddAddr);
-				if (iter != currentWork.end()) {currentWork.erase(iter);}
+				dprintf(D_FULLDEBUG, "Prefetch negotiation immediately finished.\n");
+				if (rrl->needsEndNegotiateNow()) {endNegotiate(scheddAddr);}
+				std::string hash; makeSubmitterScheddHash(*submitterAd, hash);
+				m_cachedRRLs[hash] = rrl;
+				success = true;
+				m_prefetchSuccessful++;
+				break;
+			}
+			case ResourceRequestList::RRL_ERROR:
+				success = false;
+				break;
+			case ResourceRequestList::RRL_CONTINUE:
+				dprintf(D_FULLDEBUG, "Prefetch negotiation would block.\n");
+				m_prefetchCurrent[scheddAddr] = std::make_pair(submitterAd, rrl);
+				success = true;
+				break;
 			}
 		}
-
-		if ((deadline >= 0) && (_condor_debug_get_time_double() > deadline))
+		if (!success)
 		{
-			dprintf(D_ALWAYS, "Prefetch cycle hit deadline of %d; skipping remaining submitters.\n", prefetchCycle);
-			break;
+			dprintf(D_ALWAYS, "Failed to prefetch resource request lists for %s(%s).\n", submitter.c_str(), scheddAddr.c_str());
+			work.clear();
 		}
+	}
+	if (workAssigned) {
+		dprintf(D_FULLDEBUG, "Assigned %u units of work for prefetching.\n", workAssigned);
+	}
+}
 
-		// Non-blocking reads of RRLs
-		selector.reset();
-		selector.set_timeout(prefetchTimeout);
 
-			// Put together the selector.
-		unsigned workCount = 0;
-		fdToRRL.clear();
-		for (CurrentWorkMap::const_iterator it=currentWork.begin(); it!=currentWork.end(); it++)
-		{
-			ReliSock *sock = sockCache->findReliSock(it->first);
-			if (!sock) {continue;}
-			int fd = sock->get_file_desc();
-			selector.add_fd(fd, Selector::IO_READ);
-			fdToRRL[fd] = it->second;
-			workCount++;
-		}
-		if (!workCount) {continue;}
-		dprintf(D_FULLDEBUG, "Waiting on the results of %u negotiation sessions.\n", workCount);
+void
+Matchmaker::servicePrefetch(int timeout, const std::string &busySchedd)
+{
+	if (!m_prefetchActive) {return;}
+
+	// Non-blocking reads of RRLs
+	Selector selector;
+	selector.set_timeout(timeout);
+
+		// Put together the selector.
+	std::map<int, std::string> fdToSchedd;
+	for (auto it = m_prefetchCurrent.begin(); it != m_prefetchCurrent.end(); )
+	{
+		ReliSock *sock = sockCache->findReliSock(it->first);
+		if (!sock) {
+			dprintf(D_ALWAYS, "Lost connection to %s while prefetching; skipping it.\n", it->first.c_str());
+			it = m_prefetchCurrent.erase(it);
+			continue;
+		}
+		int fd = sock->get_file_desc();
+		selector.add_fd(fd, Selector::IO_READ);
+		fdToSchedd[fd] = it->first;
+		++it;
+	}
+
+	if (!fdToSchedd.empty())
+	{
+		if (timeout) {
+			dprintf(D_FULLDEBUG, "Waiting on the results of %zu negotiation sessions.\n", fdToSchedd.size());
+		}
 		selector.execute();
-		if (selector.timed_out() || selector.failed())
+		if (selector.failed() || (selector.timed_out() && timeout))
 		{
-			for (FDToRRLMap::const_iterator it = fdToRRL.begin(); it != fdToRRL.end(); it++)
+			for (const auto & [fd, scheddAddr] : fdToSchedd)
 			{
-				std::string scheddAddr; getScheddAddr(*(it->second.first), scheddAddr);
-				scheddWorkQueues[scheddAddr]->clear();
-				ReliSock *sock = sockCache->findReliSock(scheddAddr);
-				if (!sock) {continue;}
-				CurrentWorkMap::iterator iter = currentWork.find(scheddAddr);
-				if (iter != currentWork.end()) {currentWork.erase(iter);}
+				m_prefetchQueues[scheddAddr].clear();
+				m_prefetchCurrent.erase(scheddAddr);
 				endNegotiate(scheddAddr);
-				sockCache->invalidateSock(scheddAddr.c_str());
+				sockCache->invalidateSock(scheddAddr);
 				if (selector.timed_out()) {dprintf(D_ALWAYS, "Timeout when prefetching from %s; will skip this schedd for the remainder of prefetch cycle.\n", scheddAddr.c_str());}
 				else {dprintf(D_ALWAYS, "Failure when waiting on results of negotiations sessions (%s, errno=%d).\n", strerror(selector.select_errno()), selector.select_errno());}
 			}
 		}
-		else
+		else if (!selector.timed_out())
 			// Try getting the RRL for all ready sockets.
-		for (FDToRRLMap::const_iterator it = fdToRRL.begin(); it != fdToRRL.end(); it++)
+		for (const auto & [fd, scheddAddr] : fdToSchedd)
 		{
-			if (!selector.fd_ready(it->first, Selector::IO_READ)) {continue;}
-			ResourceRequestList &rrl = *(it->second.second);
-			std::string scheddAddr; getScheddAddr(*(it->second.first), scheddAddr);
+			if (!selector.fd_ready(fd, Selector::IO_READ)) {continue;}
 			ReliSock *sock = sockCache->findReliSock(scheddAddr);
-			if (!sock) {continue;}
-			switch (rrl.tryRetrieve(sock)) {
+			CurrentWorkMap::iterator iter = m_prefetchCurrent.find(scheddAddr);
+			if (!sock || iter == m_prefetchCurrent.end()) {continue;}
+			ClassAd *submitterAd = iter->second.first;
+			RRLPtr rrl = iter->second.second;
+			switch (rrl->tryRetrieve(sock)) {
 			case ResourceRequestList::RRL_DONE:
 			case ResourceRequestList::RRL_NO_MORE_JOBS:
 			{
 					// Successfully prefetched a RRL; cache it in the negotiator.
-				if (rrl.needsEndNegotiateNow()) {endNegotiate(scheddAddr);}
-				std::string hash; makeSubmitterScheddHash(*(it->second.first), hash);
-				m_cachedRRLs[hash] = it->second.second;
-				CurrentWorkMap::iterator iter = currentWork.find(scheddAddr);
-				if (iter != currentWork.end()) {currentWork.erase(iter);}
-				successfulPrefetches++;
+				if (rrl->needsEndNegotiateNow()) {endNegotiate(scheddAddr);}
+				std::string hash; makeSubmitterScheddHash(*submitterAd, hash);
+				m_cachedRRLs[hash] = rrl;
+				m_prefetchCurrent.erase(iter);
+				m_prefetchSuccessful++;
 				break;
 			}
 			case ResourceRequestList::RRL_ERROR:
 			{
 					// Do not attempt further prefetching with this schedd.
-				scheddWorkQueues[scheddAddr]->clear();
-				CurrentWorkMap::iterator iter = currentWork.find(scheddAddr);
-				if (iter != currentWork.end()) {currentWork.erase(iter);}
+				m_prefetchQueues[scheddAddr].clear();
+				m_prefetchCurrent.erase(iter);
 				dprintf(D_ALWAYS, "Error when prefetching from %s; will skip this schedd for the remainder of prefetch cycle.\n", scheddAddr.c_str());
 				break;
 			}
@@ -3890,22 +4019,69 @@ Matchmaker::prefetchResourceRequestLists(std::vector<ClassAd *> &submitterAds)
 				break;
 			}
 		}
+	}
 
-		if ((deadline >= 0) && (_condor_debug_get_time_double() > deadline))
-		{
-			dprintf(D_ALWAYS, "Prefetch cycle hit deadline of %d; skipping remaining submitters.\n", prefetchCycle);
-			break;
+	if ((m_prefetchDeadline >= 0) && (_condor_debug_get_time_double() > m_prefetchDeadline))
+	{
+		dprintf(D_ALWAYS, "Prefetch cycle hit deadline of %d; skipping remaining submitters.\n",
+		        param_integer("NEGOTIATOR_PREFETCH_REQUESTS_MAX_TIME"));
+		endPrefetch();
+		return;
+	}
+
+	startPrefetches(busySchedd);
+}
+
+
+void
+Matchmaker::waitForPrefetch(const ClassAd &submitterAd, const std::string &scheddAddr)
+{
+	if (!m_prefetchActive) {return;}
+
+	// We negotiate in the order the prefetches were queued in, so the
+	// submitters queued ahead of this one were passed over this spin.
+	ScheddWorkMap::iterator queue = m_prefetchQueues.find(scheddAddr);
+	if (queue != m_prefetchQueues.end())
+	{
+		ScheddWork &work = queue->second;
+		ScheddWork::iterator it = std::find(work.begin(), work.end(), &submitterAd);
+		if (it != work.end()) {
+			work.erase(work.begin(), it + 1);
 		}
 	}
+
+	// The socket is shared by all of the submitters of the schedd, so
+	// the prefetch in flight on it has to finish first, whether or not
+	// it is for this submitter.
+	if (!m_prefetchCurrent.count(scheddAddr)) {return;}
+
+	double startTime = _condor_debug_get_time_double();
+	dprintf(D_FULLDEBUG, "Waiting for prefetch from %s to finish.\n", scheddAddr.c_str());
+	while (m_prefetchActive && m_prefetchCurrent.count(scheddAddr))
+	{
+		servicePrefetch(m_prefetchTimeout, scheddAddr);
+	}
+	negotiation_cycle_stats[0]->prefetch_wait_time += _condor_debug_get_time_double() - startTime;
+}
+
+
+void
+Matchmaker::endPrefetch()
+{
+	if (!m_prefetchActive) {return;}
+	m_prefetchActive = false;
+	m_prefetchQueues.clear();
+
 	unsigned timedOutPrefetches = 0;
-	for (CurrentWorkMap::const_iterator it=currentWork.begin(); it!=currentWork.end(); it++)
+	for (const auto & [scheddAddr, work] : m_prefetchCurrent)
 	{
 		timedOutPrefetches++;
-		dprintf(D_ALWAYS, "At end of the prefetch cycle, still waiting on response from %s; giving up and invalidating socket.\n", it->first.c_str());
-		endNegotiate(it->first);
-		sockCache->invalidateSock(it->first);
+		dprintf(D_ALWAYS, "At end of the prefetch cycle, still waiting on response from %s; giving up and invalidating socket.\n", scheddAddr.c_str());
+		endNegotiate(scheddAddr);
+		sockCache->invalidateSock(scheddAddr);
 	}
-	dprintf(D_ALWAYS, "Prefetch summary: %u attempted, %u successful.\n", attemptedPrefetches, successfulPrefetches);
+	m_prefetchCurrent.clear();
+	dprintf(D_ALWAYS, "Prefetch summary: %u attempted, %u successful.\n", m_prefetchAttempted, m_prefetchSuccessful);
 	if (timedOutPrefetches)
 	{
 		dprintf(D_ALWAYS, "There were %u prefetches in progress when timeout limit was reached.\n", timedOutPrefetches);
@@ -3936,6 +4112,11 @@ classad_shared_ptr<ResourceRequestList>
 Matchmaker::startNegotiate(const std::string &submitter, const ClassAd &submitterAd, ReliSock *&sock)
 {
 	RRLPtr request_list;
+	std::string scheddAddr;
+	if (getScheddAddr(submitterAd, scheddAddr))
+	{
+		waitForPrefetch(submitterAd, scheddAddr);
+	}
 	std::string hash; makeSubmitterScheddHash(submitterAd, hash);
 	RRLHash::iterator iter = m_cachedRRLs.find(hash);
 	if (iter != m_cachedRRLs.end())
@@ -4180,6 +4361,10 @@ negotiate(char const* groupName, char const *submitterName, const ClassAd *submi
 
 		daemonCore->ServiceCommandSocket();
 
+		// Likewise read the request lists other schedds have sent, and
+		// start the next prefetches, without blocking.
+		servicePrefetch(0, scheddAddr);
+
 		currentTime = time(NULL);
 
 		if (currentTime >= deadline) {
@@ -4429,6 +4614,7 @@ negotiate(char const* groupName, char const *submitterName, const ClassAd *submi
 				if (it != startdAds.end()) {
 					startdAds.erase(it);
 				}
+				matchListCache.Remove(offer);
 			}
 			// 2e(iv).  if the matchmaking protocol failed to talk to the
 			//			schedd, invalidate the connection and return
@@ -4488,6 +4674,7 @@ negotiate(char const* groupName, char const *submitterName, const ClassAd *submi
                 // 2g.  Delete ad from list so that it will not be considered again in
 		        // this negotiation cycle
 				startdAds.erase(std::ranges::find(startdAds,offer));
+				matchListCache.Remove(offer);
     		}
             // traditional match cost is just slot weight expression
             match_cost = accountant.GetSlotWeight(offer);
@@ -4836,14 +5023,91 @@ matchmakingAlgorithm(const char *submitterName, const char *scheddAddr, const ch
 
 	bool allow_pslot_preemption = param_boolean("ALLOW_PSLOT_PREEMPTION", false);
 	double allocatedWeight = 0.0;
-		// Set up for parallel matchmaking, if enabled
-	std::vector<ClassAd *> par_candidates;
-	std::vector<ClassAd *> par_matches;
+		// Use the slot index to rule out slots that can't satisfy the
+		// job's requirements without evaluating them.  The index is
+		// empty (and so is the plan) when a slot that doesn't match
+		// could still be chosen by pslotMultiMatch().
+	SlotIndex::MatchPlan plan;
+	slotIndex.MakePlan(request, plan);
 
 	int num_threads =  param_integer("NEGOTIATOR_NUM_THREADS", 1);
+
+		// Find the stable slots that match an equivalent request, from
+		// this submitter or another, or match them now if this is the
+		// first such request of the cycle.  Only the slots that aren't
+		// stable then need to be matched below.
+	MatchListCache::Entry *shared = nullptr;
+	if ( ! matchListCache.empty()) {
+		std::string key;
+		matchListCache.MakeKey(request, key);
+		shared = matchListCache.Find(key);
+		if (shared) {
+			negotiation_cycle_stats[0]->shared_matchlist_hits++;
+		} else {
+			negotiation_cycle_stats[0]->shared_matchlist_misses++;
+			shared = &matchListCache.Insert(key);
+
+			std::vector<ClassAd *> stable;
+			for (ClassAd *candidate: startdAds) {
+				if ( ! matchListCache.IsStable(candidate)) {
+					continue;
+				}
+				if ( ! plan.Admits(candidate)) {
+					negotiation_cycle_stats[0]->match_evals_avoided++;
+					continue;
+				}
+				stable.push_back(candidate);
+			}
+			if (num_threads > 1) {
+				std::vector<bool> stable_matched;
+				ParallelMatchStats par_stats;
+				ParallelIsAMatch(&request, stable, stable_matched, num_threads, false, &par_stats);
+				negotiation_cycle_stats[0]->par_match_wall_time += par_stats.wall_time;
+				negotiation_cycle_stats[0]->par_match_busy_time += par_stats.busy_time;
+				negotiation_cycle_stats[0]->par_match_capacity += par_stats.wall_time * par_stats.threads;
+				for (size_t ix = 0; ix < stable.size(); ++ix) {
+					if (stable_matched[ix]) { shared->Add(stable[ix]); }
+				}
+			} else {
+				for (ClassAd *candidate: stable) {
+					if (IsAMatch(&request, candidate)) { shared->Add(candidate); }
+				}
+			}
+		}
+	}
+
+		// The offers to consider.  If every slot is stable, that's just
+		// the ones known to match that are still on offer.
+	std::vector<ClassAd *> shared_offers;
+	if (shared && matchListCache.NumUnstable() == 0) {
+		shared_offers.reserve(shared->matches.size());
+		for (ClassAd *candidate: shared->matches) {
+			if ( ! matchListCache.IsRemoved(candidate)) {
+				shared_offers.push_back(candidate);
+			}
+		}
+	}
+	const std::vector<ClassAd *> &offers = (shared && matchListCache.NumUnstable() == 0) ? shared_offers : startdAds;
+
+		// Set up for parallel matchmaking, if enabled.  par_matched[i]
+		// is true if the request matches offers[i].
+	std::vector<bool> par_matched;
+
 	if (num_threads > 1) {
-		par_candidates = startdAds;
-		ParallelIsAMatch(&request, par_candidates, par_matches, num_threads, false);
+		std::vector<ClassAd *> par_candidates(offers);
+		for (ClassAd *&candidate: par_candidates) {
+			if (shared && matchListCache.IsStable(candidate)) {
+				candidate = nullptr;
+			} else if ( ! plan.empty() && ! plan.Admits(candidate)) {
+				candidate = nullptr;
+				negotiation_cycle_stats[0]->match_evals_avoided++;
+			}
+		}
+		ParallelMatchStats par_stats;
+		ParallelIsAMatch(&request, par_candidates, par_matched, num_threads, false, &par_stats);
+		negotiation_cycle_stats[0]->par_match_wall_time += par_stats.wall_time;
+		negotiation_cycle_stats[0]->par_match_busy_time += par_stats.busy_time;
+		negotiation_cycle_stats[0]->par_match_capacity += par_stats.wall_time * par_stats.threads;
 	}
 
 	// scan the offer ads
@@ -4855,7 +5119,13 @@ matchmakingAlgorithm(const char *submitterName, const char *scheddAddr, const ch
 	bool isIPv6 = false;
 	getSinfulStringProtocolBools( false, false, scheddAddr, isIPv4, isIPv6 );
 
-	for (ClassAd *candidate: startdAds) {
+		// offers that match the request, ranked after the scan, and
+		// the position of each in the shared entry, or -1
+	std::vector<AdListEntry> matches;
+	std::vector<int> match_shared_ix;
+
+	for (size_t cix = 0; cix < offers.size(); ++cix) {
+		ClassAd *candidate = offers[cix];
 		bool v4 = false;
 		bool v6 = false;
 		candidate->LookupString( "MyAddress", machineAddr );
@@ -4899,6 +5169,25 @@ matchmakingAlgorithm(const char *submitterName, const char *scheddAddr, const ch
 			}
 		}
 
+		int shared_ix = -1;
+		bool known_match = false;
+		if (shared && matchListCache.IsStable(candidate)) {
+			shared_ix = shared->IndexOf(candidate);
+			if (shared_ix < 0) {
+				dprintf(D_MACHINE, "Job %d.%d does not match with %s (as an equivalent request did not).\n",
+				        cluster_id, proc_id, machine_name.c_str());
+				continue;
+			}
+			known_match = true;
+		} else if ( ! plan.Admits(candidate)) {
+			dprintf(D_MACHINE, "Job %d.%d does not match with %s (ruled out by slot index).\n",
+			        cluster_id, proc_id, machine_name.c_str());
+			if (num_threads <= 1) {
+				negotiation_cycle_stats[0]->match_evals_avoided++;
+			}
+			continue;
+		}
+
         consumption_map_t consumption;
         bool has_cp = cp_supports_policy(*candidate);
         bool cp_sufficient = true;
@@ -4915,10 +5204,10 @@ matchmakingAlgorithm(const char *submitterName, const char *scheddAddr, const ch
         // requested via consumption policy must also be available from
         // the resource
 		bool is_a_match = false;
-		if (num_threads > 1) {
-			is_a_match = cp_sufficient &&
-				(par_matches.end() !=
-					std::find(par_matches.begin(), par_matches.end(), candidate));
+		if (known_match) {
+			is_a_match = true;
+		} else if (num_threads > 1) {
+			is_a_match = cp_sufficient && par_matched[cix];
 		} else {
 			is_a_match = cp_sufficient && IsAMatch(&request, candidate);
 		}
@@ -5078,7 +5367,68 @@ matchmakingAlgorithm(const char *submitterName, const char *scheddAddr, const ch
 			}
 		}
 
-		calculateRanks(request, candidate, candidatePreemptState, candidateRankValue, candidatePreJobRankValue, candidatePostJobRankValue, candidatePreemptRankValue);
+		matches.emplace_back();
+		matches.back().ad = candidate;
+		matches.back().PreemptStateValue = candidatePreemptState;
+		matches.back().DslotClaims = candidateDslotClaims;
+		match_shared_ix.push_back(shared_ix);
+
+		if (m_staticRanks) {
+			double weight = 1.0;
+			candidate->LookupFloat(ATTR_SLOT_WEIGHT, weight);
+			allocatedWeight += weight;
+			if (allocatedWeight > submitterLimit) {
+				break;
+			}
+		}
+	}
+
+		// Rank the matches.  This is done after the scan of the offers,
+		// so that it can be spread over several threads.  Ranks of
+		// stable slots that an equivalent request already ranked are
+		// reused, the rest are remembered.
+	if (shared) {
+		std::vector<AdListEntry> unranked;
+		std::vector<size_t> unranked_ix;
+		for (size_t ix = 0; ix < matches.size(); ++ix) {
+			AdListEntry &entry = matches[ix];
+			int six = match_shared_ix[ix];
+			if (six >= 0 && entry.PreemptStateValue == NO_PREEMPTION && shared->ranks[six].valid) {
+				const MatchListCache::Ranks &ranks = shared->ranks[six];
+				entry.PreJobRankValue = ranks.PreJobRankValue;
+				entry.RankValue = ranks.RankValue;
+				entry.PostJobRankValue = ranks.PostJobRankValue;
+				entry.PreemptRankValue = -(FLT_MAX);
+				continue;
+			}
+			unranked.push_back(std::move(entry));
+			unranked_ix.push_back(ix);
+		}
+		calculateRanks(request, unranked, num_threads);
+		for (size_t ix = 0; ix < unranked.size(); ++ix) {
+			size_t mix = unranked_ix[ix];
+			matches[mix] = std::move(unranked[ix]);
+			int six = match_shared_ix[mix];
+			if (six >= 0) {
+				MatchListCache::Ranks &ranks = shared->ranks[six];
+				ranks.PreJobRankValue = matches[mix].PreJobRankValue;
+				ranks.RankValue = matches[mix].RankValue;
+				ranks.PostJobRankValue = matches[mix].PostJobRankValue;
+				ranks.valid = true;
+			}
+		}
+	} else {
+		calculateRanks(request, matches, num_threads);
+	}
+
+	for (AdListEntry &entry: matches) {
+		ClassAd *candidate = entry.ad;
+		candidateRankValue = entry.RankValue;
+		candidatePreJobRankValue = entry.PreJobRankValue;
+		candidatePostJobRankValue = entry.PostJobRankValue;
+		candidatePreemptRankValue = entry.PreemptRankValue;
+		candidatePreemptState = entry.PreemptStateValue;
+		candidateDslotClaims = entry.DslotClaims;
 
 		if ( MatchList ) {
 			MatchList->add_candidate(
@@ -5141,15 +5491,6 @@ matchmakingAlgorithm(const char *submitterName, const char *scheddAddr, const ch
 			bestPreemptRankValue = candidatePreemptRankValue;
 			bestDslotClaims = candidateDslotClaims;
 		}
-
-		if (m_staticRanks) {
-			double weight = 1.0;
-			candidate->LookupFloat(ATTR_SLOT_WEIGHT, weight);
-			allocatedWeight += weight;
-			if (allocatedWeight > submitterLimit) {
-				break;
-			}
-		}
 	}
 
 	if ( MatchList ) {
@@ -5165,9 +5506,18 @@ matchmakingAlgorithm(const char *submitterName, const char *scheddAddr, const ch
 
 			// only bother sorting if there is more than one entry
 		if ( MatchList->length() > 1 ) {
-			dprintf(D_FULLDEBUG,"Start of sorting MatchList (len=%d)\n",
-				MatchList->length());
-			MatchList->sort();
+				// Only the candidates the submitter's limit leaves room
+				// for need to be sorted now; this assumes a slot weight
+				// of at least 1, if it is less, more of the list gets
+				// sorted as the candidates are popped.
+			double limitLeft = std::max(submitterLimit - limitUsed, submitterLimitUnclaimed - limitUsedUnclaimed);
+			int top_k = MatchList->length();
+			if (limitLeft < top_k) {
+				top_k = std::max((int)ceil(limitLeft), 1);
+			}
+			dprintf(D_FULLDEBUG,"Start of sorting MatchList (len=%d, top %d)\n",
+				MatchList->length(), top_k);
+			MatchList->sort(top_k, num_threads);
 			dprintf(D_FULLDEBUG,"Finished sorting MatchList\n");
 		}
 		// Pop top candidate off the list to hand out as best match
@@ -5181,6 +5531,93 @@ matchmakingAlgorithm(const char *submitterName, const char *scheddAddr, const ch
 	return bestSoFar;
 }
 
+void Matchmaker::
+buildSlotIndex( std::vector<ClassAd *> &startdAds )
+{
+	slotIndex.Clear();
+	if ( ! want_slot_index) {
+		return;
+	}
+
+		// pslotMultiMatch() temporarily adds the resources of dynamic
+		// slots to their partitionable slot, which would make the
+		// index stale.
+	if (ConsiderPreemption && param_boolean("ALLOW_PSLOT_PREEMPTION", false)) {
+		dprintf(D_FULLDEBUG, "Not indexing slot ads, because ALLOW_PSLOT_PREEMPTION is true\n");
+		return;
+	}
+
+		// Slots with a consumption policy are matched against modified
+		// request attributes and have their resources deducted as they
+		// match, and slots that want to be reevaluated change after
+		// each match.  Leave all of those out of the index; slots that
+		// are not indexed are always considered for matching.
+	std::vector<ClassAd *> indexable;
+	indexable.reserve(startdAds.size());
+	for (ClassAd *ad: startdAds) {
+		bool reevaluate_ad = false;
+		ad->LookupBool(ATTR_WANT_AD_REVAULATE, reevaluate_ad);
+		if (reevaluate_ad || cp_supports_policy(*ad)) {
+			continue;
+		}
+		indexable.push_back(ad);
+	}
+
+		// attributes the negotiator modifies in slot ads during the cycle
+	classad::References volatile_attrs = {
+		ATTR_REQUIREMENTS, ATTR_PREEMPT_STATE_, ATTR_REMOTE_USER,
+		ATTR_REMOTE_GROUP, ATTR_REMOTE_NEGOTIATING_GROUP, ATTR_REMOTE_AUTOREGROUP,
+		ATTR_MATCHED_CONCURRENCY_LIMITS, ATTR_RESOURCE_REQUEST_CLUSTER,
+		ATTR_RESOURCE_REQUEST_PROC, CP_MATCH_COST, "PreemptDslotClaims",
+		"MachineMatchCount", "OfflineMatches", "CurMatches",
+	};
+
+	slotIndex.Init(indexable, volatile_attrs);
+	dprintf(D_FULLDEBUG, "Indexing %zu of %zu slot ads for matchmaking\n",
+		indexable.size(), startdAds.size());
+}
+
+void Matchmaker::
+buildMatchListCache( std::vector<ClassAd *> &startdAds )
+{
+	matchListCache.Clear();
+	if (shared_matchlist_cache_size <= 0) {
+		return;
+	}
+
+		// with static ranks, the scan of the slots stops once the
+		// submitter's limit is reached, filling the cache would not
+	if (m_staticRanks) {
+		dprintf(D_FULLDEBUG, "Not sharing matches between submitters, because NEGOTIATOR_IGNORE_JOB_RANKS is true\n");
+		return;
+	}
+
+		// as with the slot index, pslotMultiMatch() changes slot ads
+		// in ways that depend on the submitter.
+	if (ConsiderPreemption && param_boolean("ALLOW_PSLOT_PREEMPTION", false)) {
+		dprintf(D_FULLDEBUG, "Not sharing matches between submitters, because ALLOW_PSLOT_PREEMPTION is true\n");
+		return;
+	}
+
+		// Only slots that stay the same while they are offered can have
+		// their matches remembered; see buildSlotIndex().
+	std::vector<ClassAd *> stable;
+	stable.reserve(startdAds.size());
+	for (ClassAd *ad: startdAds) {
+		bool reevaluate_ad = false;
+		ad->LookupBool(ATTR_WANT_AD_REVAULATE, reevaluate_ad);
+		if (reevaluate_ad || cp_supports_policy(*ad)) {
+			continue;
+		}
+		stable.push_back(ad);
+	}
+
+	matchListCache.Init(stable, startdAds.size() - stable.size(),
+		job_match_references, shared_matchlist_cache_size);
+	dprintf(D_FULLDEBUG, "Sharing matches of up to %d requests between submitters, for %zu of %zu slot ads\n",
+		shared_matchlist_cache_size, stable.size(), startdAds.size());
+}
+
 void Matchmaker::
 insertNegotiatorMatchExprs( std::vector<ClassAd *> &cal )
 {
@@ -5245,6 +5682,104 @@ calculateRanks(ClassAd &request,
 	}
 }
 
+// Like EvalNegotiatorMatchRank(), for a slot ad that is in a match ad
+// with the job.  Sets failed instead of logging a failure, as this is
+// called from the ranking threads.
+static double
+EvalNegotiatorMatchRankInMatch(ExprTree *expr, ClassAd *resource, bool &failed)
+{
+	classad::Value result;
+	double rank = -(DBL_MAX);
+
+	failed = false;
+	if(expr && resource->EvaluateExpr(expr, result, classad::Value::ValueType::NUMBER_VALUES)) {
+		double val;
+		if( result.IsNumber(val) ) {
+			rank = (float)val;
+		} else {
+			failed = true;
+		}
+	} else if(expr) {
+		failed = true;
+	}
+	return rank;
+}
+
+void Matchmaker::
+calculateRanks(ClassAd &request, std::vector<AdListEntry> &matches, int num_threads)
+{
+		// static ranks are cached across jobs, which isn't thread safe,
+		// and hardly need any evaluation anyway
+	if (num_threads <= 1 || m_staticRanks || matches.size() < 2) {
+		for (AdListEntry &entry: matches) {
+			calculateRanks(request, entry.ad, entry.PreemptStateValue, entry.RankValue,
+				entry.PreJobRankValue, entry.PostJobRankValue, entry.PreemptRankValue);
+		}
+		return;
+	}
+
+	std::vector<ClassAd *> candidates;
+	candidates.reserve(matches.size());
+	for (const AdListEntry &entry: matches) {
+		candidates.push_back(entry.ad);
+	}
+
+		// which of the negotiator rank expressions failed to evaluate,
+		// logged once the threads are done
+	enum { PRE_JOB_RANK_FAILED = 1, POST_JOB_RANK_FAILED = 2, PREEMPTION_RANK_FAILED = 4 };
+	std::vector<unsigned char> failures(matches.size(), 0);
+
+	ExprTree *preJobRank = NegotiatorPreJobRank;
+	ExprTree *postJobRank = NegotiatorPostJobRank;
+	ExprTree *preemptionRank = PreemptionRank;
+
+	ParallelMatchStats par_stats;
+	ParallelForEachMatchAd(&request, candidates, num_threads,
+		[&](classad::MatchClassAd &mad, size_t ix) {
+			AdListEntry &entry = matches[ix];
+			ClassAd *job = mad.GetLeftAd();
+			ClassAd *candidate = mad.GetRightAd();
+			bool failed = false;
+
+			entry.PreJobRankValue = EvalNegotiatorMatchRankInMatch(preJobRank, candidate, failed);
+			if (failed) { failures[ix] |= PRE_JOB_RANK_FAILED; }
+
+				// the same lookup as EvalFloat(ATTR_RANK, &request, candidate)
+			double tmp = 0.0;
+			if (job->Lookup(ATTR_RANK)) {
+				if ( ! job->EvaluateAttrNumber(ATTR_RANK, tmp)) { tmp = 0.0; }
+			} else if (candidate->Lookup(ATTR_RANK)) {
+				if ( ! candidate->EvaluateAttrNumber(ATTR_RANK, tmp)) { tmp = 0.0; }
+			}
+			entry.RankValue = tmp;
+
+			entry.PostJobRankValue = EvalNegotiatorMatchRankInMatch(postJobRank, candidate, failed);
+			if (failed) { failures[ix] |= POST_JOB_RANK_FAILED; }
+
+			entry.PreemptRankValue = -(FLT_MAX);
+			if (entry.PreemptStateValue != NO_PREEMPTION) {
+				entry.PreemptRankValue = EvalNegotiatorMatchRankInMatch(preemptionRank, candidate, failed);
+				if (failed) { failures[ix] |= PREEMPTION_RANK_FAILED; }
+			}
+		}, &par_stats);
+
+	negotiation_cycle_stats[0]->par_match_wall_time += par_stats.wall_time;
+	negotiation_cycle_stats[0]->par_match_busy_time += par_stats.busy_time;
+	negotiation_cycle_stats[0]->par_match_capacity += par_stats.wall_time * par_stats.threads;
+
+	for (unsigned char failed: failures) {
+		if (failed & PRE_JOB_RANK_FAILED) {
+			dprintf(D_ALWAYS, "Failed to evaluate NEGOTIATOR_PRE_JOB_RANK expression.\n");
+		}
+		if (failed & POST_JOB_RANK_FAILED) {
+			dprintf(D_ALWAYS, "Failed to evaluate NEGOTIATOR_POST_JOB_RANK expression.\n");
+		}
+		if (failed & PREEMPTION_RANK_FAILED) {
+			dprintf(D_ALWAYS, "Failed to evaluate PREEMPTION_RANK expression.\n");
+		}
+	}
+}
+
 	// NOTE NOTE: this assumes that p-slots are not being preempted.
 bool Matchmaker::
 returnPslotToMatchList(ClassAd &request, ClassAd *offer)
@@ -5825,6 +6360,9 @@ MatchListType(int maxlen)
 	already_sorted = false;
 	adListLen = 0;
 	adListHead = 0;
+	adListSorted = 0;
+	sortThreads = 1;
+	insertSequence = maxlen;
 	m_rejForNetwork = 0;
 	m_rejForNetworkShare = 0;
 	m_rejForConcurrencyLimit = 0;
@@ -5873,6 +6411,11 @@ pop_candidate(std::string &dslot_claims)
 	ClassAd* candidate = NULL;
 
 	while ( adListHead < adListLen && !candidate ) {
+		if ( already_sorted && adListHead >= adListSorted ) {
+				// past the part of the list sort() put in order,
+				// sort as many again
+			sort_next( adListSorted );
+		}
 		candidate = AdListArray[adListHead].ad;
 		if ( candidate ) {
 			dslot_claims = AdListArray[adListHead].DslotClaims;
@@ -5904,6 +6447,7 @@ insert_candidate(ClassAd * candidate,
 	new_entry.PostJobRankValue = candidatePostJobRankValue;
 	new_entry.PreemptRankValue = candidatePreemptRankValue;
 	new_entry.PreemptStateValue = candidatePreemptState;
+	new_entry.Sequence = insertSequence++;
 	new_entry.DslotClaims.clear();
 
 		// Hand-rolled insertion sort; as the list was previously sorted,
@@ -5911,6 +6455,9 @@ insert_candidate(ClassAd * candidate,
 	int insert_idx = adListHead;
 	while ( insert_idx < adListLen - 1 )
 	{
+		if ( already_sorted && insert_idx + 1 >= adListSorted ) {
+			sort_next( adListSorted );
+		}
 		if ( sort_compare( new_entry, AdListArray[insert_idx + 1])) {
 			AdListArray[insert_idx] = AdListArray[insert_idx + 1];
 			insert_idx++;
@@ -6054,6 +6601,7 @@ add_candidate(ClassAd * candidate,
 	AdListArray[adListLen].PreemptRankValue = candidatePreemptRankValue;
 	AdListArray[adListLen].PreemptStateValue = candidatePreemptState;
 	AdListArray[adListLen].DslotClaims = candidateDslotClaims;
+	AdListArray[adListLen].Sequence = adListLen;
 
     // This hack allows me to avoid mucking with the pseudo-que-like semantics of MatchListType,
     // which ought to be replaced with something cleaner like std::deque<AdListEntry>
@@ -6113,7 +6661,9 @@ sort_compare(const AdListEntry &Elem1, const AdListEntry &Elem2)
 		 candidatePreemptRankValue == bestPreemptRankValue &&
 		 candidatePreemptState == bestPreemptState )
 	{
-		return false;
+			// so that the order doesn't depend on how the list
+			// was sorted
+		return Elem1.Sequence < Elem2.Sequence;
 	}
 
 	// the quality of a match is determined by a lexicographic sort on
@@ -6158,17 +6708,81 @@ sort_compare(const AdListEntry &Elem1, const AdListEntry &Elem2)
 }
 			
 void Matchmaker::MatchListType::
-sort()
+sort(int top_k, int threads)
 {
 	// Should only be called ONCE.  If we call for a sort more than
 	// once, this code has a bad logic errror, so ASSERT it.
 	ASSERT(already_sorted == false);
 
-	// Note: since we must use static members, sort() is
-	// _NOT_ thread safe!!!
-	std::sort(AdListArray,AdListArray + adListLen,sort_compare);
-
 	already_sorted = true;
+	sortThreads = threads;
+	adListSorted = adListHead;
+	sort_next(top_k);
+}
+
+// Move the best count entries from the unsorted part of the list to the
+// front of it, in order.  The sort_compare() ordering is total (ties are
+// broken by Sequence), so the result doesn't depend on how we get there.
+void Matchmaker::MatchListType::
+sort_next(int count)
+{
+	// lists shorter than this (per thread) aren't worth sorting in parallel
+	const int PARALLEL_SORT_MIN = 4096;
+
+	int len = adListLen - adListSorted;
+	if (len <= 0) {
+		return;
+	}
+	count = std::max(count, 1);
+	count = std::min(count, len);
+
+	AdListEntry *first = AdListArray + adListSorted;
+	AdListEntry *last = AdListArray + adListLen;
+	int threads = sortThreads;
+	if (threads > 1 && len / threads < PARALLEL_SORT_MIN) {
+		threads = std::max(len / PARALLEL_SORT_MIN, 1);
+	}
+
+	if (threads <= 1) {
+		if (count == len) {
+			std::sort(first, last, sort_compare);
+		} else {
+			std::partial_sort(first, first + count, last, sort_compare);
+		}
+		adListSorted += count;
+		return;
+	}
+
+	// Each thread puts the best count entries of its share in order at
+	// the front of the share, then the fronts are merged.
+	std::vector<AdListEntry *> begins(threads), ends(threads), tops(threads);
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(threads)
+#endif
+	for (int t = 0; t < threads; ++t) {
+		begins[t] = first + (size_t)len * t / threads;
+		ends[t] = first + (size_t)len * (t + 1) / threads;
+		tops[t] = begins[t] + std::min(count, (int)(ends[t] - begins[t]));
+		std::partial_sort(begins[t], tops[t], ends[t], sort_compare);
+	}
+
+	std::vector<AdListEntry> sorted;
+	sorted.reserve(len);
+	std::vector<AdListEntry *> heads(begins);
+	while ((int)sorted.size() < count) {
+		int best = -1;
+		for (int t = 0; t < threads; ++t) {
+			if (heads[t] < tops[t] && (best < 0 || sort_compare(*heads[t], *heads[best]))) {
+				best = t;
+			}
+		}
+		sorted.push_back(std::move(*heads[best]++));
+	}
+	for (int t = 0; t < threads; ++t) {
+		std::move(heads[t], ends[t], std::back_inserter(sorted));
+	}
+	std::move(sorted.begin(), sorted.end(), first);
+	adListSorted += count;
 }
 
 
@@ -6467,6 +7081,11 @@ Matchmaker::publishNegotiationCycleStats( ClassAd *ad )
         ATTR_LAST_NEGOTIATION_CYCLE_TRIMMED_SLOTS,
         ATTR_LAST_NEGOTIATION_CYCLE_CANDIDATE_SLOTS,
         ATTR_LAST_NEGOTIATION_CYCLE_SLOT_SHARE_ITER,
+        ATTR_LAST_NEGOTIATION_CYCLE_GROUP_QUOTA_ASSIGN_TIME,
+        ATTR_LAST_NEGOTIATION_CYCLE_GROUP_QUOTA_FAIRSHARE_TIME,
+        ATTR_LAST_NEGOTIATION_CYCLE_GROUP_QUOTA_ROUND_ROBIN_TIME,
+        ATTR_LAST_NEGOTIATION_CYCLE_GROUP_QUOTA_RECOMPUTED,
+        ATTR_LAST_NEGOTIATION_CYCLE_GROUP_QUOTA_REUSED,
         ATTR_LAST_NEGOTIATION_CYCLE_NUM_SCHEDULERS,
         ATTR_LAST_NEGOTIATION_CYCLE_NUM_IDLE_JOBS,
         ATTR_LAST_NEGOTIATION_CYCLE_NUM_JOBS_CONSIDERED,
@@ -6476,6 +7095,7 @@ Matchmaker::publishNegotiationCycleStats( ClassAd *ad )
         ATTR_LAST_NEGOTIATION_CYCLE_PIE_SPINS,
         ATTR_LAST_NEGOTIATION_CYCLE_PREFETCH_DURATION,
         ATTR_LAST_NEGOTIATION_CYCLE_PREFETCH_CPU_TIME,
+        ATTR_LAST_NEGOTIATION_CYCLE_PREFETCH_WAIT_TIME,
         ATTR_LAST_NEGOTIATION_CYCLE_CPU_TIME,
         ATTR_LAST_NEGOTIATION_CYCLE_PHASE1_CPU_TIME,
         ATTR_LAST_NEGOTIATION_CYCLE_PHASE2_CPU_TIME,
@@ -6487,7 +7107,13 @@ Matchmaker::publishNegotiationCycleStats( ClassAd *ad )
         ATTR_LAST_NEGOTIATION_CYCLE_SUBMITTERS_SHARE_LIMIT,
         ATTR_LAST_NEGOTIATION_CYCLE_ACTIVE_SUBMITTER_COUNT,
         ATTR_LAST_NEGOTIATION_CYCLE_MATCH_RATE,
-        ATTR_LAST_NEGOTIATION_CYCLE_MATCH_RATE_SUSTAINED
+        ATTR_LAST_NEGOTIATION_CYCLE_MATCH_RATE_SUSTAINED,
+        ATTR_LAST_NEGOTIATION_CYCLE_MATCH_EVALS_AVOIDED,
+        ATTR_LAST_NEGOTIATION_CYCLE_PARALLEL_MATCH_TIME,
+        ATTR_LAST_NEGOTIATION_CYCLE_PARALLEL_MATCH_EFFICIENCY,
+        ATTR_LAST_NEGOTIATION_CYCLE_SHARED_MATCHLIST_HITS,
+        ATTR_LAST_NEGOTIATION_CYCLE_SHARED_MATCHLIST_MISSES,
+        ATTR_LAST_NEGOTIATION_CYCLE_REUSED_SLOTS
     };
     const int nattrs = sizeof(attrs)/sizeof(*attrs);
 
@@ -6517,12 +7143,23 @@ Matchmaker::publishNegotiationCycleStats( ClassAd *ad )
 		SetAttrN( ad, ATTR_LAST_NEGOTIATION_CYCLE_TOTAL_SLOTS, i, (int)s->total_slots);
 		SetAttrN( ad, ATTR_LAST_NEGOTIATION_CYCLE_TRIMMED_SLOTS, i, (int)s->trimmed_slots);
         SetAttrN( ad, ATTR_LAST_NEGOTIATION_CYCLE_CANDIDATE_SLOTS, i, (int)s->candidate_slots);
+		SetAttrN( ad, ATTR_LAST_NEGOTIATION_CYCLE_REUSED_SLOTS, i, (int)s->reused_slots);
         SetAttrN( ad, ATTR_LAST_NEGOTIATION_CYCLE_SLOT_SHARE_ITER, i, (int)s->slot_share_iterations);
+		SetAttrN( ad, ATTR_LAST_NEGOTIATION_CYCLE_GROUP_QUOTA_ASSIGN_TIME, i, s->group_quota_assign_time);
+		SetAttrN( ad, ATTR_LAST_NEGOTIATION_CYCLE_GROUP_QUOTA_FAIRSHARE_TIME, i, s->group_quota_fairshare_time);
+		SetAttrN( ad, ATTR_LAST_NEGOTIATION_CYCLE_GROUP_QUOTA_ROUND_ROBIN_TIME, i, s->group_quota_round_robin_time);
+		SetAttrN( ad, ATTR_LAST_NEGOTIATION_CYCLE_GROUP_QUOTA_RECOMPUTED, i, s->group_quota_recomputed);
+		SetAttrN( ad, ATTR_LAST_NEGOTIATION_CYCLE_GROUP_QUOTA_REUSED, i, s->group_quota_reused);
 		SetAttrN( ad, ATTR_LAST_NEGOTIATION_CYCLE_NUM_SCHEDULERS, i, (int)s->active_schedds.size());
 		SetAttrN( ad, ATTR_LAST_NEGOTIATION_CYCLE_NUM_IDLE_JOBS, i, (int)s->num_idle_jobs);
 		SetAttrN( ad, ATTR_LAST_NEGOTIATION_CYCLE_NUM_JOBS_CONSIDERED, i, (int)s->num_jobs_considered);
 		SetAttrN( ad, ATTR_LAST_NEGOTIATION_CYCLE_MATCHES, i, (int)s->matches);
 		SetAttrN( ad, ATTR_LAST_NEGOTIATION_CYCLE_REJECTIONS, i, (int)s->rejections);
+		SetAttrN( ad, ATTR_LAST_NEGOTIATION_CYCLE_MATCH_EVALS_AVOIDED, i, (int)s->match_evals_avoided);
+		SetAttrN( ad, ATTR_LAST_NEGOTIATION_CYCLE_SHARED_MATCHLIST_HITS, i, (int)s->shared_matchlist_hits);
+		SetAttrN( ad, ATTR_LAST_NEGOTIATION_CYCLE_SHARED_MATCHLIST_MISSES, i, (int)s->shared_matchlist_misses);
+		SetAttrN( ad, ATTR_LAST_NEGOTIATION_CYCLE_PARALLEL_MATCH_TIME, i, s->par_match_wall_time);
+		SetAttrN( ad, ATTR_LAST_NEGOTIATION_CYCLE_PARALLEL_MATCH_EFFICIENCY, i, (s->par_match_capacity > 0) ? s->par_match_busy_time / s->par_match_capacity : double(0.0));
 		SetAttrN( ad, ATTR_LAST_NEGOTIATION_CYCLE_MATCH_RATE, i, (s->duration > 0) ? (double)(s->matches)/double(s->duration) : double(0.0));
 		SetAttrN( ad, ATTR_LAST_NEGOTIATION_CYCLE_MATCH_RATE_SUSTAINED, i, (period > 0) ? (double)(s->matches)/double(period) : double(0.0));
 		SetAttrN( ad, ATTR_LAST_NEGOTIATION_CYCLE_ACTIVE_SUBMITTER_COUNT, i, (int)s->active_submitters.size());
@@ -6531,6 +7168,7 @@ Matchmaker::publishNegotiationCycleStats( ClassAd *ad )
 		SetAttrN( ad, ATTR_LAST_NEGOTIATION_CYCLE_PREFETCH_DURATION, i, s->prefetch_duration );
 		// TODO Should we truncate these to integer values?
 		SetAttrN( ad, ATTR_LAST_NEGOTIATION_CYCLE_PREFETCH_CPU_TIME, i, s->prefetch_cpu_time );
+		SetAttrN( ad, ATTR_LAST_NEGOTIATION_CYCLE_PREFETCH_WAIT_TIME, i, s->prefetch_wait_time );
 		SetAttrN( ad, ATTR_LAST_NEGOTIATION_CYCLE_CPU_TIME, i, s->phase1_cpu_time );
 		SetAttrN( ad, ATTR_LAST_NEGOTIATION_CYCLE_PHASE1_CPU_TIME, i, s->phase1_cpu_time );
 		SetAttrN( ad, ATTR_LAST_NEGOTIATION_CYCLE_PHASE2_CPU_TIME, i, s->phase2_cpu_time );
@@ -29,10 +29,14 @@
 #include "condor_ver_info.h"
 #include "matchmaker_negotiate.h"
 #include "GroupEntry.h"
+#include "SlotIndex.h"
+#include "MatchListCache.h"
+#include "SlotTable.h"
 
 #include <vector>
 #include <string>
 #include <map>
+#include <deque>
 #include <algorithm>
 
 typedef struct MapEntry {
@@ -135,12 +139,38 @@ class Matchmaker : public Service
 		void endNegotiate(const std::string &scheddAddr);
 
 		/**
-		 * Try starting negotiations with all schedds in parallel.
+		 * Try starting negotiations with all schedds in parallel.  With
+		 * NEGOTIATOR_PREFETCH_REQUESTS_PIPELINE, this returns once the
+		 * first session with each schedd is started, and the rest of the
+		 * prefetch overlaps with negotiating with the schedds in order.
 		 */
 		void prefetchResourceRequestLists(std::vector<ClassAd *> &submitterAds);
 		typedef std::map<std::string, classad_shared_ptr<ResourceRequestList> > RRLHash;
 		RRLHash m_cachedRRLs;
 
+			// Start the next queued prefetch on each schedd that has none in
+			// flight, except busySchedd, whose socket is being negotiated on.
+		void startPrefetches(const std::string &busySchedd);
+			// Read the request lists that have arrived, waiting up to
+			// timeout seconds for one to.  If timeout is not 0 and none do,
+			// the sessions in flight are given up on.
+		void servicePrefetch(int timeout, const std::string &busySchedd);
+			// Called before negotiating with a submitter: drop the queued
+			// prefetches on its schedd up to it, and finish the one in flight.
+		void waitForPrefetch(const ClassAd &submitterAd, const std::string &scheddAddr);
+			// Give up on the prefetches not done yet.
+		void endPrefetch();
+
+		typedef std::deque<ClassAd*> ScheddWork;
+		typedef std::map<std::string, ScheddWork> ScheddWorkMap;
+		typedef std::map<std::string, std::pair<ClassAd*, RRLPtr> > CurrentWorkMap;
+		bool m_prefetchActive;
+		ScheddWorkMap m_prefetchQueues;		// submitters to prefetch, by schedd
+		CurrentWorkMap m_prefetchCurrent;	// prefetch in flight, by schedd
+		int m_prefetchTimeout;
+		double m_prefetchDeadline;
+		unsigned m_prefetchAttempted, m_prefetchSuccessful;
+
 		struct JobRanks {
                double PreJobRankValue;
                double PostJobRankValue;
@@ -279,6 +309,8 @@ class Matchmaker : public Service
 		void addRemoteUserPrios( std::vector<ClassAd *> &cal );
 		void insertNegotiatorMatchExprs(ClassAd *ad);
 		void insertNegotiatorMatchExprs(std::vector<ClassAd *> &cal );
+		void buildSlotIndex(std::vector<ClassAd *> &startdAds);
+		void buildMatchListCache(std::vector<ClassAd *> &startdAds);
 		void reeval( ClassAd *ad );
 		void updateNegCycleEndTime(time_t startTime, ClassAd *submitter);
 		friend int comparisonFunction (ClassAd *, ClassAd *,
@@ -335,6 +367,9 @@ class Matchmaker : public Service
 		ExprTree *NegotiatorPostJobRank; // rank applied after job rank
 		bool want_globaljobprio;	// cached value of config knob USE_GLOBAL_JOB_PRIOS
 		bool want_matchlist_caching;	// should we cache matches per autocluster?
+		bool want_slot_index;		// should we index slot ads to prune matchmaking?
+		int shared_matchlist_cache_size;	// requests to remember the matches of across submitters
+		bool want_parse_arena;		// should we parse the ads of a cycle into an ExprArena?
 		bool PublishCrossSlotPrios; // value of knob NEGOTIATOR_CROSS_SLOT_PRIOS, default of false
 		bool ConsiderPreemption; // if false, negotiation is faster (default=true)
 		bool ConsiderEarlyPreemption; // if false, do not preempt slots that still have retirement time
@@ -381,6 +416,9 @@ class Matchmaker : public Service
 
 		// external references in startd ads ... used for autoclustering
 		std::string job_attr_references;
+		// all job attributes referred to by startd ads and negotiator
+		// expressions, including the ones left out of job_attr_references
+		classad::References job_match_references;
 
 		// Epoch time when we started/finished most rescent negotiation cycle
 		time_t startedLastCycleTime;
@@ -412,6 +450,7 @@ class Matchmaker : public Service
 				PostJobRankValue = -(FLT_MAX);
 				PreemptRankValue = -(FLT_MAX);
 				PreemptStateValue = (Matchmaker::PreemptState)-1;
+				Sequence = 0;
 				ad = NULL;
 			}			  
 			double			RankValue;
@@ -419,10 +458,16 @@ class Matchmaker : public Service
 			double			PostJobRankValue;
 			double			PreemptRankValue;
 			PreemptState	PreemptStateValue;
+			// order in which the entry was added, breaks ties in sort_compare()
+			int				Sequence;
 			std::string			DslotClaims;
 			ClassAd *ad;
 		};
 
+			// Fill in the rank values of each of the matches, using up to
+			// num_threads threads.
+		void calculateRanks(ClassAd &request, std::vector<AdListEntry> &matches, int num_threads);
+
 		/** This class is just like ClassAdList, expept that it will
 		    also invoke Matchmaker::DeleteMatchList in the destructor.
 			We want this because DeleteMatchList will dereference pointers
@@ -494,7 +539,12 @@ class Matchmaker : public Service
 					double candidatePreemptRankValue,
 					PreemptState candidatePreemptState,
 					const std::string &candidateDslotClaims);
-			void sort();
+				// Order the list best first.  Only the first top_k entries
+				// are sorted right away; pop_candidate() sorts more of the
+				// list if it runs past them, so the order in which
+				// candidates are popped is always that of a full sort.
+				// With threads > 1, large lists are sorted in parallel.
+			void sort(int top_k, int threads);
 			int length() const { return adListLen - adListHead; }
 
 			MatchListType(int maxlen);
@@ -507,10 +557,14 @@ class Matchmaker : public Service
 			
 			// AdListEntry* peek_candidate();
 			static bool sort_compare(const AdListEntry &Elem1, const AdListEntry &Elem2);
+			void sort_next(int count);
 			AdListEntry* AdListArray;			
 			int adListMaxLen;	// max length of AdListArray
 			int adListLen;		// current length of AdListArray
 			int adListHead;
+			int adListSorted;	// entries before this one are in order, and no worse than those after it
+			int sortThreads;
+			int insertSequence;	// Sequence of the next insert_candidate() entry, after all add_candidate() entries
 			bool already_sorted;
 			// rejection reasons
 			int m_rejForNetwork; 		//   - limited network capacity?
@@ -526,6 +580,9 @@ class Matchmaker : public Service
 			
 		};
 		MatchListType* MatchList;
+		SlotIndex slotIndex;	// slot ads of the current cycle, see SlotIndex.h
+		MatchListCache matchListCache;	// matches of the current cycle, see MatchListCache.h
+		SlotTable slotTable;	// prepared slot ads of the last cycle, see SlotTable.h
 		int cachedAutoCluster;
 		char* cachedName;
 		char* cachedAddr;
@@ -0,0 +1,100 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2024, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+#include "condor_common.h"
+#include "condor_debug.h"
+#include "periodic_expr_tracker.h"
+
+void
+PeriodicExprTracker::setEnabled(bool enable)
+{
+	if (enable != m_enabled) {
+		m_enabled = enable;
+		m_full_pass_needed = true;
+		m_watched.clear();
+		m_dirty.clear();
+		m_wheel.clear();
+		m_due.clear();
+	}
+}
+
+void
+PeriodicExprTracker::jobRemoved(const JOB_ID_KEY & key)
+{
+	m_dirty.erase(key);
+	auto it = m_due.find(key);
+	if (it != m_due.end()) {
+		m_wheel.erase(std::make_pair(it->second, key));
+		m_due.erase(it);
+	}
+}
+
+bool
+PeriodicExprTracker::startPass(time_t now, std::vector<JOB_ID_KEY> & due)
+{
+	due.clear();
+	if ( ! m_enabled) {
+		return true;
+	}
+
+	if (m_full_pass_needed || (m_full_pass_interval > 0 && now - m_last_full_pass >= m_full_pass_interval)) {
+		// forget everything, the pass will tell us again
+		m_full_pass_needed = false;
+		m_last_full_pass = now;
+		m_watched.clear();
+		m_dirty.clear();
+		m_wheel.clear();
+		m_due.clear();
+		return true;
+	}
+
+	due.assign(m_dirty.begin(), m_dirty.end());
+	m_dirty.clear();
+
+	auto it = m_wheel.begin();
+	while (it != m_wheel.end() && it->first <= now) {
+		due.push_back(it->second);
+		m_due.erase(it->second);
+		it = m_wheel.erase(it);
+	}
+	return false;
+}
+
+void
+PeriodicExprTracker::jobEvaluated(const JOB_ID_KEY & key, const classad::References & refs, time_t recheck)
+{
+	if ( ! m_enabled) {
+		return;
+	}
+
+	m_watched.insert(refs.begin(), refs.end());
+
+	auto it = m_due.find(key);
+	if (it != m_due.end()) {
+		if (it->second == recheck) {
+			return;
+		}
+		m_wheel.erase(std::make_pair(it->second, key));
+		m_due.erase(it);
+	}
+	if (recheck) {
+		m_wheel.emplace(recheck, key);
+		m_due[key] = recheck;
+	}
+}
@@ -0,0 +1,88 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2024, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+#ifndef PERIODIC_EXPR_TRACKER_H
+#define PERIODIC_EXPR_TRACKER_H
+
+#include "condor_common.h"
+#include "condor_classad.h"
+#include "proc.h"
+#include <set>
+#include <map>
+#include <vector>
+
+// Keeps track of which jobs need their periodic policy expressions
+// evaluated, so that a pass of PeriodicExprHandler() need only look at the
+// jobs that changed since the last pass instead of walking the job queue.
+//
+// When a job is evaluated, the schedd tells the tracker which attributes
+// the outcome depends on, and when it may change regardless of them (because
+// an expression looks at the current time).  Those attribute names are
+// watched for all jobs: setting or deleting one of them in a job or cluster
+// ad marks it to be evaluated on the next pass.  Jobs whose outcome depends on
+// time are kept in a time ordered queue until they are due.
+//
+// A full pass, which evaluates every job and relearns the watched attributes
+// from scratch, is done at startup, after a reconfig and every so often in
+// case an ad was changed without going through the job queue.
+class PeriodicExprTracker
+{
+public:
+	// when disabled, nothing is tracked and every pass is a full pass
+	void setEnabled(bool enable);
+	bool enabled() const { return m_enabled; }
+	void setFullPassInterval(int interval) { m_full_pass_interval = interval; }
+	void requestFullPass() { m_full_pass_needed = true; }
+
+	// an attribute of a job or cluster ad was set or deleted
+	void attributeChanged(const JOB_ID_KEY & key, const char * attr) {
+		if (m_enabled && key.cluster > 0 && m_watched.count(attr)) { m_dirty.insert(key); }
+	}
+	// a new job, or something the job's attributes don't show changed
+	void jobChanged(const JOB_ID_KEY & key) {
+		if (m_enabled) { m_dirty.insert(key); }
+	}
+	// the job has left the queue
+	void jobRemoved(const JOB_ID_KEY & key);
+
+	// Start a pass.  Returns true if every job should be evaluated,
+	// otherwise the jobs and clusters to evaluate are returned in due.
+	bool startPass(time_t now, std::vector<JOB_ID_KEY> & due);
+
+	// A job was evaluated: refs are the attributes the outcome depends on
+	// and recheck is when to evaluate it again if none of them change,
+	// or 0 if there is no need to.
+	void jobEvaluated(const JOB_ID_KEY & key, const classad::References & refs, time_t recheck);
+
+	size_t numWatchedAttrs() const { return m_watched.size(); }
+	size_t numTimedJobs() const { return m_due.size(); }
+
+private:
+	bool m_enabled{false};
+	bool m_full_pass_needed{true};
+	int m_full_pass_interval{0};
+	time_t m_last_full_pass{0};
+
+	classad::References m_watched;                    // attributes that some job's policy depends on
+	std::set<JOB_ID_KEY> m_dirty;                     // jobs and clusters changed since the last pass
+	std::set<std::pair<time_t, JOB_ID_KEY>> m_wheel;  // jobs to evaluate once the time comes
+	std::map<JOB_ID_KEY, time_t> m_due;               // the time each job in the wheel is due
+};
+
+#endif // PERIODIC_EXPR_TRACKER_H
@@ -28,6 +28,7 @@
 #include "basename.h"
 #include "qmgmt.h"
 #include "qmgmt_startup_limits.h"
+#include "qmgmt_index.h"
 #include "condor_qmgr.h"
 #include "classad_collection.h"
 #include "prio_rec.h"
@@ -225,6 +226,7 @@ int		MaterializeJobs(JobQueueCluster * clusterAd, TransactionWatcher & txn, int
 
 static bool qmgmt_was_initialized = false;
 static bool job_queue_init_done = false;
+static double job_queue_init_time = 0;
 static JobQueueType *JobQueue = nullptr;
 static std::set<JOB_ID_KEY> DirtyJobIDs;
 static std::set<JOB_ID_KEY>::iterator DirtyJobIDsItr = DirtyJobIDs.begin();
@@ -300,6 +302,18 @@ static void HandleFlushJobQueueLogTimer(int tid);
 static int dirty_notice_interval = 0;
 static void PeriodicDirtyAttributeNotification(int tid);
 static void ScheduleJobQueueLogFlush();
+static bool group_commit = false;
+static int group_commit_timer_id = -1;
+static std::vector<QmgmtPeer*> group_commit_clients; // waiting for a sync before we reply to their commit
+void HandleGroupCommitTimer(int tid);
+static void GroupCommitPreHandlerHook(const char * handler_descrip);
+static bool background_compaction = false;
+static int compaction_reaper_id = -1;
+static int compaction_pid = 0;		// child writing the compacted job queue log
+static double compaction_begin = 0, compaction_stall = 0;
+// compactions of the job queue log, published in the schedd ad
+static long long compaction_count = 0;
+static double compaction_time = 0, compaction_stall_time = 0, compaction_max_stall_time = 0;
 
 bool qmgmt_all_users_trusted = false;
 static std::vector<std::string> super_users;
@@ -1443,6 +1457,63 @@ QmgmtPeer::isAuthenticated() const
 }
 
 
+// index all of the jobs in the queue, at startup or when the indexed attributes change
+static void
+RebuildJobQueueIndexes()
+{
+	JobQueueIndexClear();
+	if ( ! JobQueue || ! JobQueueIndexEnabled()) {
+		return;
+	}
+
+	double begin = _condor_debug_get_time_double();
+	JobQueueKey key;
+	JobQueuePayload ad = nullptr;
+	JobQueue->StartIterateAllClassAds();
+	while (JobQueue->Iterate(key, ad)) {
+		if (ad->IsJob()) {
+			JobQueueIndexJob(dynamic_cast<JobQueueJob*>(ad));
+		}
+	}
+	dprintf(D_FULLDEBUG, "Job queue indexes built in %.3f seconds\n", _condor_debug_get_time_double() - begin);
+}
+
+// update the indexes for a job, or for all of the jobs of a cluster
+static void
+ReindexJobQueueKey(const JobQueueKey & key)
+{
+	if (JobQueueBase::IsJobId(key)) {
+		JobQueueJob * job = GetJobAd(key);
+		if (job) {
+			JobQueueIndexJob(job);
+		} else {
+			JobQueueIndexRemove(key);
+		}
+	} else if (JobQueueBase::IsClusterId(key)) {
+		JobQueueCluster * cad = GetClusterAd(key);
+		if (cad) {
+			for (JobQueueJob * job = cad->FirstJob(); job != nullptr; job = cad->NextJob(job)) {
+				JobQueueIndexJob(job);
+			}
+		}
+	}
+}
+
+// after a transaction is committed, bring the indexes up to date for the ads it changed.
+// changed are the keys of the ads where indexed attributes were set or deleted
+static void
+UpdateJobQueueIndexes(const std::vector<JobQueueKey> & exist_keys, const std::vector<JobQueueKey> & changed)
+{
+	for (const auto & key : changed) {
+		ReindexJobQueueKey(key);
+	}
+	for (const auto & key : exist_keys) {
+		if (JobQueueBase::IsJobId(key) && ! GetJobAd(key)) {
+			JobQueueIndexRemove(key);
+		}
+	}
+}
+
 // Read out any parameters from the config file that we need and
 // initialize our internal data structures.  This is also called
 // on reconfig.
@@ -1575,7 +1646,14 @@ InitQmgmt()
     cluster_maximum_val = param_integer("SCHEDD_CLUSTER_MAXIMUM_VALUE",0,0);
 
 	flush_job_queue_log_delay = param_integer("SCHEDD_JOB_QUEUE_LOG_FLUSH_DELAY",5,0);
+	group_commit = param_boolean("SCHEDD_JOB_QUEUE_LOG_GROUP_COMMIT", false);
+	daemonCore->Register_Pre_Handler_Hook(GroupCommitPreHandlerHook);
+	background_compaction = param_boolean("SCHEDD_JOB_QUEUE_LOG_BACKGROUND_COMPACTION", false);
 	dirty_notice_interval = param_integer("SCHEDD_JOB_QUEUE_NOTIFY_UPDATES",30,0);
+
+	if (JobQueueIndexConfig() && job_queue_init_done) {
+		RebuildJobQueueIndexes();
+	}
 }
 
 void
@@ -1590,6 +1668,38 @@ GetOriginalJobQueueBirthdate()
 	return JobQueue->GetOrigLogBirthdate();
 }
 
+void
+PublishJobQueueLoadStats(ClassAd & ad)
+{
+	const ClassAdLogLoadStats & load = JobQueue->GetLoadStats();
+	ad.Assign(ATTR_JOB_QUEUE_LOAD_THREADS, load.threads);
+	ad.Assign(ATTR_JOB_QUEUE_LOAD_RECORDS, (long long)load.records);
+	ad.Assign(ATTR_JOB_QUEUE_LOAD_TIME, load.load_time);
+	ad.Assign(ATTR_JOB_QUEUE_LOAD_PARSE_TIME, load.parse_time);
+	ad.Assign(ATTR_JOB_QUEUE_LOAD_PLAY_TIME, load.play_time);
+	ad.Assign(ATTR_JOB_QUEUE_INIT_TIME, job_queue_init_time);
+}
+
+void
+PublishJobQueueSyncStats(ClassAd & ad)
+{
+	const ClassAdLogSyncStats & sync = JobQueue->GetSyncStats();
+	ad.Assign(ATTR_JOB_QUEUE_LOG_COMMITS, (long long)sync.commits);
+	ad.Assign(ATTR_JOB_QUEUE_LOG_SYNCS, (long long)sync.syncs);
+	ad.Assign(ATTR_JOB_QUEUE_LOG_SYNC_BATCH_MAX, (long long)sync.max_batch);
+	ad.Assign(ATTR_JOB_QUEUE_LOG_SYNC_TIME, sync.sync_time);
+	ad.Assign(ATTR_JOB_QUEUE_LOG_SYNC_TIME_MAX, sync.max_sync_time);
+}
+
+void
+PublishJobQueueCompactionStats(ClassAd & ad)
+{
+	ad.Assign(ATTR_JOB_QUEUE_COMPACTIONS, compaction_count);
+	ad.Assign(ATTR_JOB_QUEUE_COMPACTION_TIME, compaction_time);
+	ad.Assign(ATTR_JOB_QUEUE_COMPACTION_STALL_TIME, compaction_stall_time);
+	ad.Assign(ATTR_JOB_QUEUE_COMPACTION_STALL_TIME_MAX, compaction_max_stall_time);
+}
+
 static void
 RenamePre_7_5_5_SpoolPathsInJob( ClassAd *job_ad, char const *spool, int cluster, int proc )
 {
@@ -2265,6 +2375,8 @@ InitJobQueue(const char *job_queue_name,int max_historical_logs)
 	ASSERT(qmgmt_was_initialized);	// make certain our parameters are setup
 	ASSERT(!JobQueue);
 
+	double init_begin = _condor_debug_get_time_double();
+
 	std::string spool;
 	if( !param(spool,"SPOOL") ) {
 		EXCEPT("SPOOL must be defined.");
@@ -2287,6 +2399,7 @@ InitJobQueue(const char *job_queue_name,int max_historical_logs)
 	CheckSpoolVersion(spool.c_str(),SPOOL_MIN_VERSION_SCHEDD_SUPPORTS,SPOOL_CUR_VERSION_SCHEDD_SUPPORTS,spool_min_version,spool_cur_version);
 
 	JobQueue = new JobQueueType();
+	JobQueue->SetLoadThreads(param_integer("JOB_QUEUE_LOG_LOAD_THREADS", 1, 1));
 	if( !JobQueue->InitLogFile(job_queue_name,max_historical_logs) ) {
 		EXCEPT("Failed to initialize job queue log!");
 	}
@@ -2942,36 +3055,142 @@ InitJobQueue(const char *job_queue_name,int max_historical_logs)
 		}
 	}
 
+	job_queue_init_time = _condor_debug_get_time_double() - init_begin;
+	const ClassAdLogLoadStats & load = JobQueue->GetLoadStats();
+	dprintf(D_ALWAYS, "Job queue initialized in %.3f seconds, log of %lu records loaded by %d thread(s) in %.3f seconds\n",
+		job_queue_init_time, load.records, load.threads, load.load_time);
+
+	RebuildJobQueueIndexes();
+
 	job_queue_init_done = true;
 }
 
 
-void
-CleanJobQueue(int /* tid */)
+// time is how long the compaction took, stall how much of that the schedd spent waiting for it
+static void
+NoteJobQueueCompaction(double time, double stall)
 {
-	if (JobQueueDirty) {
-		dprintf(D_ALWAYS, "Cleaning job queue...\n");
-		JobQueue->TruncLog();
+	++compaction_count;
+	compaction_time = time;
+	compaction_stall_time = stall;
+	compaction_max_stall_time = MAX(compaction_max_stall_time, stall);
+	dprintf(D_ALWAYS, "Job queue log compacted in %.3f seconds, schedd was held up for %.3f seconds\n", time, stall);
+}
 
-		auto job_itr = PrivateAttrs.begin();
-		while (job_itr != PrivateAttrs.end()) {
-			ClassAd *job_ad = GetJobAd(job_itr->first);
-			if (job_ad == nullptr) {
-				job_itr = PrivateAttrs.erase(job_itr);
-			} else {
-				for (auto &attr : job_itr->second) {
-					if (SetAttributeString(job_itr->first.cluster, job_itr->first.proc, attr.first.c_str(), attr.second.c_str()) == 0) {
-						job_ad->Delete(attr.first);
-					}
+// after the job queue log has been compacted
+static void
+FinishCleanJobQueue()
+{
+	auto job_itr = PrivateAttrs.begin();
+	while (job_itr != PrivateAttrs.end()) {
+		ClassAd *job_ad = GetJobAd(job_itr->first);
+		if (job_ad == nullptr) {
+			job_itr = PrivateAttrs.erase(job_itr);
+		} else {
+			for (auto &attr : job_itr->second) {
+				if (SetAttributeString(job_itr->first.cluster, job_itr->first.proc, attr.first.c_str(), attr.second.c_str()) == 0) {
+					job_ad->Delete(attr.first);
 				}
-				job_itr++;
 			}
+			job_itr++;
 		}
+	}
+}
 
-		JobQueueDirty = false;
+#ifndef WIN32
+// runs in the child forked by StartJobQueueCompaction(), with a copy of the job queue
+static int
+WriteCompactedJobQueue(void * /* arg */, Stream * /* sock */)
+{
+	return JobQueue->WriteTruncLog() ? 0 : 1;
+}
+
+static int
+JobQueueCompactionReaper(int pid, int status)
+{
+	if (pid != compaction_pid || ! JobQueue) {
+		return 0; // a compaction that was cancelled
+	}
+	compaction_pid = 0;
+
+	bool written = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+	if ( ! written) {
+		dprintf(D_ALWAYS, "Failed to write the compacted job queue log (status %d), will try again later\n", status);
+	}
+	double begin = _condor_debug_get_time_double();
+	if (JobQueue->EndTruncLog(written)) {
+		double end = _condor_debug_get_time_double();
+		NoteJobQueueCompaction(end - compaction_begin, compaction_stall + end - begin);
+		FinishCleanJobQueue();
+	} else {
+		// the changes the compaction was to cover still need it
+		JobQueueDirty = true;
+	}
+	return 0;
+}
+
+// Compact the job queue log in a forked child, which writes the copy of
+// the job queue it gets from fork() to a new log while the schedd goes
+// on.  The reaper then appends what was committed in the meantime to the
+// new log and swaps it in.  Returns false if the log should be compacted
+// in the foreground instead.
+static bool
+StartJobQueueCompaction()
+{
+	if (compaction_pid) {
+		return true; // still compacting
+	}
+	double begin = _condor_debug_get_time_double();
+	if ( ! JobQueue->BeginTruncLog()) {
+		return false;
+	}
+	if (compaction_reaper_id < 0) {
+		compaction_reaper_id = daemonCore->Register_Reaper("JobQueueCompactionReaper",
+			JobQueueCompactionReaper, "JobQueueCompactionReaper");
+	}
+	compaction_pid = daemonCore->Create_Thread(WriteCompactedJobQueue, nullptr, nullptr, compaction_reaper_id);
+	if ( ! compaction_pid) {
+		dprintf(D_ALWAYS, "Failed to create a process to compact the job queue log\n");
+		JobQueue->EndTruncLog(false);
+		return false;
 	}
+	compaction_begin = begin;
+	compaction_stall = _condor_debug_get_time_double() - begin;
+	// The child compacts the job queue as it is now, changes made from
+	// now on set JobQueueDirty again, so they get a compaction of their own.
+	JobQueueDirty = false;
+	return true;
 }
+#endif
 
+void
+CleanJobQueue(int tid)
+{
+	if (JobQueueDirty || compaction_pid) {
+#ifndef WIN32
+		// only the periodic timer compacts in the background,
+		// on shutdown we need the log compacted before we return.
+		if (tid >= 0 && background_compaction && (compaction_pid || StartJobQueueCompaction())) {
+			return;
+		}
+		if (compaction_pid) {
+			// TruncLog() cancels the compaction in progress
+			daemonCore->Send_Signal(compaction_pid, SIGKILL);
+			compaction_pid = 0;
+		}
+#else
+		(void)tid;
+#endif
+		dprintf(D_ALWAYS, "Cleaning job queue...\n");
+		double begin = _condor_debug_get_time_double();
+		JobQueue->TruncLog();
+		double elapsed = _condor_debug_get_time_double() - begin;
+		NoteJobQueueCompaction(elapsed, elapsed);
+
+		FinishCleanJobQueue();
+		JobQueueDirty = false;
+	}
+}
 
 void
 DestroyJobQueue( )
@@ -2988,7 +3207,7 @@ DestroyJobQueue( )
 	// object deleted by the time the child cleanup is attempted.
 	schedd_forker.DeleteAll( );
 
-	if (JobQueueDirty) {
+	if (JobQueueDirty || compaction_pid) {
 			// We can't destroy it until it's clean.
 		CleanJobQueue();
 	}
@@ -3713,6 +3932,121 @@ unsetQSock()
 }
 
 
+// Group commit: a durable commit by a qmgmt client is written to the log
+// without an fsync, and the client's connection is set aside until the
+// HandleGroupCommitTimer, which fires once the schedd has handled the
+// other requests that were ready, syncs the log once for every commit
+// since the last sync and then replies to each client.  Since the log is
+// only appended to, a sync makes every earlier commit durable, so no
+// client hears that its commit succeeded before it is on disk.
+//
+// The commit is applied to the job queue before the sync, so any handler
+// other than the qmgmt ones could act on a job that is not yet durable,
+// by starting it, answering a query or forwarding it.  The pre-handler
+// hook does the sync and the replies before such a handler runs.
+
+static void
+ScheduleGroupCommit()
+{
+	if (group_commit_timer_id == -1) {
+		group_commit_timer_id = daemonCore->Register_Timer(0,
+			HandleGroupCommitTimer, "HandleGroupCommitTimer");
+	}
+}
+
+// Handle requests on the connection in Q_SOCK until the client closes it,
+// or a commit leaves it waiting for the group commit.
+int
+ServiceQmgmtConnection(bool sock_registered)
+{
+	if ( ! Q_SOCK->getCommitSyncSeq()) {
+		int rval = 0;
+		do {
+			rval = do_Q_request(*Q_SOCK);
+		} while(rval >= 0 && ! Q_SOCK->getCommitSyncSeq());
+		if (rval < 0) {
+			unsetQSock();
+			dprintf(D_FULLDEBUG, "QMGR Connection closed\n");
+			AbortTransactionAndRecomputeClusters();
+			return FALSE;
+		}
+	}
+
+	QmgmtPeer * peer = getQmgmtConnectionInfo();
+	peer->sock_registered = sock_registered;
+	group_commit_clients.push_back(peer);
+	ScheduleGroupCommit();
+	return KEEP_STREAM;
+}
+
+void
+HandleGroupCommitTimer(int /* tid */)
+{
+	group_commit_timer_id = -1;
+	std::vector<QmgmtPeer*> clients;
+	clients.swap(group_commit_clients);
+
+	JobQueue->SyncLog();
+	dprintf(D_FULLDEBUG, "Group commit synced the job queue log for %zu clients\n", clients.size());
+
+	for (QmgmtPeer * peer : clients) {
+		ASSERT(JobQueue->IsSynced(peer->commit_sync_seq));
+		peer->commit_sync_seq = 0;
+		ReliSock * sock = peer->getReliSock();
+		bool registered = peer->sock_registered;
+
+		if ( ! setQmgmtConnectionInfo(peer)) {
+			EXCEPT("HandleGroupCommitTimer: Unable to restore qmgmt connection");
+		}
+		int rval = SendCommitTransactionReply(*Q_SOCK, Q_SOCK->commit_rval, Q_SOCK->commit_errno);
+		peer = getQmgmtConnectionInfo();
+
+		if (rval >= 0 && ! registered) {
+			// handle the client's next request (or its closing the connection)
+			// when it arrives, with the connection state saved in peer
+			rval = daemonCore->Register_Socket(sock, "QMGMT connection",
+				[peer](Stream *) -> int {
+					if (peer->commit_sync_seq) {
+						return KEEP_STREAM; // still waiting for the group commit
+					}
+					if ( ! setQmgmtConnectionInfo(peer)) {
+						EXCEPT("QMGMT connection: Unable to restore qmgmt connection");
+					}
+					return ServiceQmgmtConnection(true);
+				},
+				"ServiceQmgmtConnection");
+			registered = rval >= 0;
+		}
+		if (rval < 0) {
+			dprintf(D_FULLDEBUG, "QMGR Connection closed\n");
+			delete peer;
+			if (registered) { daemonCore->Cancel_Socket(sock); }
+			delete sock;
+		}
+	}
+}
+
+static void
+GroupCommitPreHandlerHook(const char * handler_descrip)
+{
+	// nothing to sync, or called from within a qmgmt request or a transaction
+	if (group_commit_clients.empty() || Q_SOCK || ! JobQueue || JobQueue->InTransaction()) {
+		return;
+	}
+	static const char * const qmgmt_handlers[] = {
+		"handle_q", "ServiceQmgmtConnection", "HandleGroupCommitTimer",
+	};
+	for (const char * name : qmgmt_handlers) {
+		if (MATCH == strcmp(handler_descrip, name)) {
+			return;
+		}
+	}
+	if (group_commit_timer_id != -1) {
+		daemonCore->Cancel_Timer(group_commit_timer_id);
+	}
+	HandleGroupCommitTimer(-1);
+}
+
 int
 handle_q(int cmd, Stream *sock)
 {
@@ -3747,7 +4081,11 @@ handle_q(int cmd, Stream *sock)
 		do {
 			/* Probably should wrap a timer around this */
 			rval = do_Q_request(*Q_SOCK);
-		} while(rval >= 0);
+		} while(rval >= 0 && ! Q_SOCK->getCommitSyncSeq());
+		if (rval >= 0) {
+			ASSERT(fork_status != FORK_CHILD);
+			return ServiceQmgmtConnection(false);
+		}
 	}
 
 	unsetQSock();
@@ -4357,6 +4695,7 @@ int DestroyProc(int cluster_id, int proc_id)
 
 		// remove jobid from any indexes
 	scheduler.removeJobFromIndexes(key, job_prio);
+	scheduler.PeriodicExprTracking.jobRemoved(key);
 
 	JobQueueDirty = true;
 
@@ -5810,6 +6149,10 @@ SetAttribute(const JOB_ID_KEY & jid, const char *attr_name,
 	}
 
 	JobQueue->SetAttribute(key, attr_name, attr_value, flags & SetAttribute_SetDirty);
+	scheduler.PeriodicExprTracking.attributeChanged(key, attr_name);
+	if ( ! JobQueue->InTransaction() && JobQueueIndexHasAttr(attr_name)) {
+		ReindexJobQueueKey(key);
+	}
 	if( (flags & SHOULDLOG) && job ) {
 		const char* old_val = nullptr;
 		ExprTree *tree = job->LookupExpr(attr_name);
@@ -7286,7 +7629,7 @@ AddSessionAttributes(const std::vector<JobQueueKey> &new_keys, CondorError *errs
 	return 0;
 }
 
-int CommitTransactionInternal( bool durable, CondorError * errorStack );
+int CommitTransactionInternal( bool durable, CondorError * errorStack, unsigned long * sync_seq = nullptr );
 
 void
 CommitTransactionOrDieTrying() {
@@ -7330,7 +7673,20 @@ CommitTransactionAndLive( SetAttributeFlags_t flags,
 	return CommitTransactionInternal( durable, errorStack );
 }
 
-int CommitTransactionInternal( bool durable, CondorError * errorStack ) {
+int
+CommitTransactionForClient( SetAttributeFlags_t flags,
+                            CondorError * errorStack,
+                            unsigned long & sync_seq )
+{
+	sync_seq = 0;
+	bool durable = !(flags & NONDURABLE);
+	if ( ! durable || ! group_commit) {
+		return CommitTransactionAndLive( flags, errorStack );
+	}
+	return CommitTransactionInternal( durable, errorStack, &sync_seq );
+}
+
+int CommitTransactionInternal( bool durable, CondorError * errorStack, unsigned long * sync_seq ) {
 
 	std::string owner;
 	int has_new_idle_jobs = 0;
@@ -7400,6 +7756,18 @@ int CommitTransactionInternal( bool durable, CondorError * errorStack ) {
 		}
 	}
 
+	// remember the ads that had indexed attributes changed, so we can reindex them once
+	// the transaction is committed. new jobs are indexed when they are chained to their cluster
+	std::vector<JobQueueKey> reindex_keys;
+	if (JobQueueIndexEnabled()) {
+		for (const auto & key : exist_keys) {
+			classad::References attrs;
+			if (JobQueue->AddAttrNamesFromTransaction(key, attrs) && JobQueueIndexHasAnyAttr(attrs)) {
+				reindex_keys.push_back(key);
+			}
+		}
+	}
+
 	// if job queue timestamps are enabled, build a commit comment
 	// consisting of the time and an optional NONDURABLE flag
 	// comment buffer sized to hold a timestamp and the word NONDURABLE and some whitespace
@@ -7422,10 +7790,18 @@ int CommitTransactionInternal( bool durable, CondorError * errorStack ) {
 		JobQueue->CommitNondurableTransaction(commit_comment);
 		ScheduleJobQueueLogFlush();
 	}
+	else if (sync_seq) {
+		// the caller holds the reply to the client until this is synced
+		*sync_seq = JobQueue->CommitGroupedTransaction(commit_comment);
+	}
 	else {
 		JobQueue->CommitTransaction(commit_comment);
 	}
 
+	if (JobQueueIndexEnabled()) {
+		UpdateJobQueueIndexes(exist_keys, reindex_keys);
+	}
+
 	//----------------------------------------
 	// Transaction Post-processing starts here
 	//----------------------------------------
@@ -7698,6 +8074,8 @@ int CommitTransactionInternal( bool durable, CondorError * errorStack ) {
 
 					// Add the job to various runtime indexes for quick lookups
 				scheduler.indexAJob(procad, false);
+				scheduler.PeriodicExprTracking.jobChanged(job_id);
+				JobQueueIndexJob(procad);
 
 				PostCommitJobFactoryProc(clusterad, procad);
 
@@ -8064,6 +8442,10 @@ DeleteAttribute(const JOB_ID_KEY & key, const char *attr_name)
 	}
 
 	JobQueue->DeleteAttribute(key, attr_name);
+	scheduler.PeriodicExprTracking.attributeChanged(key, attr_name);
+	if ( ! JobQueue->InTransaction() && JobQueueIndexHasAttr(attr_name)) {
+		ReindexJobQueueKey(key);
+	}
 
 	JobQueueDirty = true;
 
@@ -9148,11 +9530,34 @@ GetNextJob(int initScan)
 JobQueueJob *
 GetNextJobByConstraint(const char *constraint, int initScan)
 {
+	// when the job queue indexes can narrow the constraint down,
+	// we look at the jobs they give us instead of the whole queue
+	static JobQueueIndexScan scan;
+	static bool use_index = false;
+
 	JobQueuePayload ad = nullptr;
 	JobQueueKey key;
 
 	if (initScan) {
-		JobQueue->StartIterateAllClassAds();
+		std::unique_ptr<classad::ExprTree> tree;
+		classad::ExprTree * expr = nullptr;
+		if (constraint && constraint[0] && 0 == ParseClassAdRvalExpr(constraint, expr)) {
+			tree.reset(expr);
+		}
+		use_index = scan.plan(tree.get());
+		if ( ! use_index) {
+			JobQueue->StartIterateAllClassAds();
+		}
+	}
+
+	if (use_index) {
+		JobQueueJob * job = nullptr;
+		while ((job = scan.nextCandidate())) {
+			if (EvalConstraint(job, constraint)) {
+				return job;
+			}
+		}
+		return nullptr;
 	}
 
 	while(JobQueue->Iterate(key,ad)) {
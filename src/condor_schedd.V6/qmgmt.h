@@ -55,6 +55,8 @@ class QmgmtPeer {
 	friend QmgmtPeer* getQmgmtConnectionInfo();
 	friend bool setQmgmtConnectionInfo(QmgmtPeer*);
 	friend void unsetQmgmtConnection();
+	friend void HandleGroupCommitTimer(int);
+	friend int ServiceQmgmtConnection(bool);
 
 	public:
 		QmgmtPeer();
@@ -92,6 +94,13 @@ class QmgmtPeer {
 
 		CondorError& getErrStack() { return errstack; }
 
+		// hold the reply to a CommitTransaction request until the commit
+		// has been synced to disk, see SCHEDD_JOB_QUEUE_LOG_GROUP_COMMIT
+		void deferCommitReply(unsigned long seq, int rval, int terrno) {
+			commit_sync_seq = seq; commit_rval = rval; commit_errno = terrno;
+		}
+		unsigned long getCommitSyncSeq() const { return commit_sync_seq; }
+
 	protected:
 
 		char *owner;  
@@ -105,6 +114,9 @@ class QmgmtPeer {
 		Transaction *transaction;
 		int next_proc_num{}, active_cluster_num{};
 		time_t xact_start_time{};
+		unsigned long commit_sync_seq{0};	// commit the held reply waits for
+		int commit_rval{0}, commit_errno{0};
+		bool sock_registered{false};		// sock has a DaemonCore handler
 
 		bool readonly{false};
 		bool write_ok = false;
@@ -721,6 +733,9 @@ int QmgmtHandleSendJobsetAd(int cluster_id, ClassAd & ad, int flags, int & terrn
 
 void SetMaxHistoricalLogs(int max_historical_logs);
 time_t GetOriginalJobQueueBirthdate();
+void PublishJobQueueLoadStats(ClassAd & ad);
+void PublishJobQueueSyncStats(ClassAd & ad);
+void PublishJobQueueCompactionStats(ClassAd & ad);
 void DestroyJobQueue( void );
 int handle_q(int, Stream *sock);
 void dirtyJobQueue( void );
@@ -967,6 +982,10 @@ bool Reschedule();
 bool UniverseUsesVanillaStartExpr(int universe);
 
 QmgmtPeer* getQmgmtConnectionInfo();
+// like CommitTransactionAndLive(), but with group commit enabled a durable commit
+// is not synced before returning; sync_seq is set to what the reply must wait for
+int CommitTransactionForClient(SetAttributeFlags_t flags, CondorError * errorStack, unsigned long & sync_seq);
+int SendCommitTransactionReply(QmgmtPeer &Q_PEER, int rval, int terrno);
 
 // JobSet qmgmt support functions
 bool JobSetDestroy(int setid);
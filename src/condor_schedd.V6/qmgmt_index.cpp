@@ -0,0 +1,347 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2024, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+#include "condor_common.h"
+#include "condor_debug.h"
+#include "condor_config.h"
+#include "condor_attributes.h"
+#include "compat_classad_util.h"
+#include "classad_helpers.h"
+#include "stl_string_utils.h"
+#include "stopwatch.h"
+#include "qmgmt.h"
+#include "qmgmt_index.h"
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <set>
+
+namespace {
+
+struct AttrIndex {
+	typedef std::map<std::string, std::set<JOB_ID_KEY>> ValueMap;
+
+	std::string attr;
+	ValueMap jobs;                                    // jobs by the normalized value of attr
+	std::map<JOB_ID_KEY, ValueMap::iterator> where;   // the entry of jobs that each indexed job is in
+	std::set<JOB_ID_KEY> unindexed;                   // jobs where attr is an expression
+
+	void remove(const JOB_ID_KEY & key) {
+		unindexed.erase(key);
+		auto it = where.find(key);
+		if (it != where.end()) {
+			it->second->second.erase(key);
+			if (it->second->second.empty()) { jobs.erase(it->second); }
+			where.erase(it);
+		}
+	}
+};
+
+bool index_enabled = false;
+std::vector<AttrIndex> indexes;
+
+long long query_count = 0;
+long long indexed_query_count = 0;
+
+// Turn a literal into the key it is indexed under.  Values that == considers
+// equal must get the same key, so strings are lower cased and all numbers are
+// compared as reals.  Returns false for values that can't compare equal to
+// anything (undefined, error, lists and ads).
+bool IndexKey(const classad::Value & val, std::string & key)
+{
+	std::string str;
+	bool bval = false;
+	double dval = 0;
+	if (val.IsStringValue(str)) {
+		lower_case(str);
+		key = "s:" + str;
+	} else if (val.IsBooleanValue(bval)) {
+		key = bval ? "n:1" : "n:0";
+	} else if (val.IsNumber(dval)) {
+		formatstr(key, "n:%.17g", dval + 0.0); // adding 0 turns -0 into 0
+	} else {
+		return false;
+	}
+	return true;
+}
+
+AttrIndex * FindIndex(const std::string & attr)
+{
+	for (auto & index : indexes) {
+		if (MATCH == strcasecmp(index.attr.c_str(), attr.c_str())) { return &index; }
+	}
+	return nullptr;
+}
+
+// add the jobs that index maps to value to keys, returns false if the value can't be looked up.
+bool LookupIndex(const AttrIndex & index, const classad::Value & value, std::vector<JOB_ID_KEY> & keys)
+{
+	std::string key;
+	if ( ! IndexKey(value, key)) {
+		return false;
+	}
+	auto it = index.jobs.find(key);
+	if (it != index.jobs.end()) {
+		keys.insert(keys.end(), it->second.begin(), it->second.end());
+	}
+	keys.insert(keys.end(), index.unindexed.begin(), index.unindexed.end());
+	std::sort(keys.begin(), keys.end());
+	keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+	return true;
+}
+
+// the jobs of the cluster in constraints like ClusterId == 100
+bool LookupCluster(const classad::Value & value, std::vector<JOB_ID_KEY> & keys)
+{
+	int cluster = 0;
+	if ( ! value.IsIntegerValue(cluster)) {
+		return false;
+	}
+	JobQueueCluster * cad = GetClusterAd(cluster);
+	if (cad) {
+		for (JobQueueJob * job = cad->FirstJob(); job != nullptr; job = cad->NextJob(job)) {
+			keys.push_back(job->jid);
+		}
+		std::sort(keys.begin(), keys.end());
+	}
+	return true;
+}
+
+// Set keys to the sorted ids of the jobs that may match the expression,
+// returns false if the indexes can't tell which jobs those are.
+bool PlanQuery(const classad::ExprTree * tree, std::vector<JOB_ID_KEY> & keys, int depth)
+{
+	keys.clear();
+	tree = SkipExprParens(tree);
+	if ( ! tree || depth > 50 || tree->GetKind() != classad::ExprTree::OP_NODE) {
+		return false;
+	}
+
+	classad::Operation::OpKind op;
+	classad::ExprTree *t1 = nullptr, *t2 = nullptr, *t3 = nullptr;
+	dynamic_cast<const classad::Operation*>(tree)->GetComponents(op, t1, t2, t3);
+
+	if (op == classad::Operation::LOGICAL_AND_OP) {
+		// only jobs that match both sides match, so either side will do
+		std::vector<JOB_ID_KEY> right;
+		bool left_ok = PlanQuery(t1, keys, depth + 1);
+		bool right_ok = PlanQuery(t2, right, depth + 1);
+		if (left_ok && right_ok) {
+			std::vector<JOB_ID_KEY> both;
+			std::set_intersection(keys.begin(), keys.end(), right.begin(), right.end(), std::back_inserter(both));
+			keys.swap(both);
+		} else if (right_ok) {
+			keys.swap(right);
+		}
+		return left_ok || right_ok;
+	}
+
+	if (op == classad::Operation::LOGICAL_OR_OP) {
+		// jobs that match either side match, so we need both
+		std::vector<JOB_ID_KEY> left, right;
+		if ( ! PlanQuery(t1, left, depth + 1) || ! PlanQuery(t2, right, depth + 1)) {
+			return false;
+		}
+		std::set_union(left.begin(), left.end(), right.begin(), right.end(), std::back_inserter(keys));
+		return true;
+	}
+
+	// attr == literal, or attr =?= literal, which matches a subset of what == does
+	if (op != classad::Operation::EQUAL_OP && op != classad::Operation::META_EQUAL_OP) {
+		return false;
+	}
+	std::string attr;
+	classad::Value value;
+	if ( ! ExprTreeIsAttrCmpLiteral(const_cast<classad::ExprTree*>(tree), op, attr, value)) {
+		return false;
+	}
+	if (MATCH == strcasecmp(attr.c_str(), ATTR_CLUSTER_ID)) {
+		return LookupCluster(value, keys);
+	}
+	AttrIndex * index = FindIndex(attr);
+	return index && LookupIndex(*index, value, keys);
+}
+
+} // namespace
+
+bool
+JobQueueIndexConfig()
+{
+	bool enable = param_boolean("SCHEDD_USE_JOB_QUEUE_INDEXES", true);
+
+	classad::References attrs;
+	if (enable) {
+		attrs.insert(ATTR_OWNER);
+		attrs.insert(ATTR_JOB_STATUS);
+		param_and_insert_attrs("SCHEDD_JOB_QUEUE_INDEX_ATTRS", attrs);
+		attrs.erase(ATTR_CLUSTER_ID);
+	}
+
+	bool changed = (enable != index_enabled) || (attrs.size() != indexes.size());
+	for (const auto & attr : attrs) {
+		if ( ! FindIndex(attr)) { changed = true; }
+	}
+	if ( ! changed) {
+		return false;
+	}
+
+	index_enabled = enable;
+	indexes.clear();
+	for (const auto & attr : attrs) {
+		indexes.emplace_back();
+		indexes.back().attr = attr;
+	}
+	if (enable) {
+		std::string list;
+		print_attrs(list, false, attrs, ", ");
+		dprintf(D_ALWAYS, "Indexing the job queue by ClusterId, %s\n", list.c_str());
+	}
+	return enable;
+}
+
+bool
+JobQueueIndexEnabled()
+{
+	return index_enabled;
+}
+
+bool
+JobQueueIndexHasAttr(const char * attr)
+{
+	for (const auto & index : indexes) {
+		if (MATCH == strcasecmp(index.attr.c_str(), attr)) { return true; }
+	}
+	return false;
+}
+
+bool
+JobQueueIndexHasAnyAttr(const classad::References & attrs)
+{
+	for (const auto & index : indexes) {
+		if (attrs.count(index.attr)) { return true; }
+	}
+	return false;
+}
+
+void
+JobQueueIndexJob(JobQueueJob * job)
+{
+	if ( ! job || ! job->IsJob()) {
+		return;
+	}
+	const JOB_ID_KEY & key = job->jid;
+	std::string value_key;
+	classad::Value value;
+	for (auto & index : indexes) {
+		classad::ExprTree * expr = job->LookupExpr(index.attr);
+		if (expr && ! ExprTreeIsLiteral(expr, value)) {
+			if ( ! index.unindexed.count(key)) {
+				index.remove(key);
+				index.unindexed.insert(key);
+			}
+			continue;
+		}
+		if ( ! expr || ! IndexKey(value, value_key)) {
+			index.remove(key);
+			continue;
+		}
+		auto it = index.where.find(key);
+		if (it != index.where.end() && it->second->first == value_key) {
+			continue; // no change
+		}
+		index.remove(key);
+		auto jt = index.jobs.emplace(value_key, std::set<JOB_ID_KEY>()).first;
+		jt->second.insert(key);
+		index.where[key] = jt;
+	}
+}
+
+void
+JobQueueIndexRemove(const JOB_ID_KEY & key)
+{
+	for (auto & index : indexes) {
+		index.remove(key);
+	}
+}
+
+void
+JobQueueIndexClear()
+{
+	for (auto & index : indexes) {
+		index.jobs.clear();
+		index.where.clear();
+		index.unindexed.clear();
+	}
+}
+
+bool
+JobQueueIndexCandidates(const classad::ExprTree * constraint, std::vector<JOB_ID_KEY> & candidates)
+{
+	++query_count;
+	if ( ! index_enabled || ! constraint || ! PlanQuery(constraint, candidates, 0)) {
+		candidates.clear();
+		return false;
+	}
+	++indexed_query_count;
+	return true;
+}
+
+JobQueueJob *
+JobQueueIndexScan::nextCandidate()
+{
+	while (m_next < m_keys.size()) {
+		JobQueueJob * job = GetJobAd(m_keys[m_next++]);
+		if (job) { return job; }
+	}
+	return nullptr;
+}
+
+JobQueueJob *
+JobQueueIndexScan::next(const classad::ExprTree * constraint, int timeslice_ms)
+{
+	int miss_count = 0;
+	Stopwatch sw;
+	JobQueueJob * job = nullptr;
+	while ((job = nextCandidate())) {
+		classad::Value result;
+		bool match = false;
+		if ( ! constraint) {
+			return job;
+		}
+		// evaluate the same way as the filter_iterator of the job queue does
+		if (classad::ClassAd::EvaluateExpr(job, constraint, result, classad::Value::ValueType::NUMBER_VALUES) &&
+			result.IsBooleanValueEquiv(match) && match) {
+			return job;
+		}
+		if ( ! miss_count) { sw.start(); }
+		++miss_count;
+		if (timeslice_ms > 0 && (miss_count & 0x1FF) == 0 && sw.get_ms() > timeslice_ms) {
+			break;
+		}
+	}
+	return nullptr;
+}
+
+void
+PublishJobQueueIndexStats(ClassAd & ad)
+{
+	ad.Assign(ATTR_JOB_QUEUE_QUERIES, query_count);
+	ad.Assign(ATTR_JOB_QUEUE_INDEXED_QUERIES, indexed_query_count);
+	ad.Assign(ATTR_JOB_QUEUE_INDEXED_QUERY_FRACTION, query_count ? (double)indexed_query_count / query_count : 0.0);
+}
@@ -0,0 +1,87 @@
+/***************************************************************
+ *
+ * Copyright (C) 1990-2024, Condor Team, Computer Sciences Department,
+ * University of Wisconsin-Madison, WI.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you
+ * may not use this file except in compliance with the License.  You may
+ * obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ***************************************************************/
+
+#ifndef QMGMT_INDEX_H
+#define QMGMT_INDEX_H
+
+#include "condor_common.h"
+#include "condor_classad.h"
+#include "proc.h"
+#include <vector>
+
+// Secondary indexes on the job queue, so that queries with constraints like
+// Owner == "bob", JobStatus == 2 or ClusterId == 100 can look at the matching
+// jobs instead of evaluating the constraint against every ad in the queue.
+//
+// Owner and JobStatus are always indexed, SCHEDD_JOB_QUEUE_INDEX_ATTRS adds
+// more attributes.  An index maps the literal value of the attribute in each
+// job (as seen through the cluster ad) to the jobs with that value.  Jobs where
+// the attribute is an expression can't be indexed by value, so they are
+// returned for every lookup.  ClusterId lookups use the cluster's job list.
+//
+// The candidates a lookup returns are a superset of the jobs that match,
+// the caller must still evaluate the constraint against each of them.
+
+class JobQueueJob;
+
+// Read the config, returns true if the set of indexed attributes changed,
+// in which case the indexes are empty and all jobs must be indexed again.
+bool JobQueueIndexConfig();
+bool JobQueueIndexEnabled();
+
+// true if the attribute is indexed (ClusterId is not, it is never indexed by value)
+bool JobQueueIndexHasAttr(const char * attr);
+bool JobQueueIndexHasAnyAttr(const classad::References & attrs);
+
+// add or update a job in the indexes, call this after the job is chained to its cluster ad
+void JobQueueIndexJob(JobQueueJob * job);
+// forget about a job that has left the queue
+void JobQueueIndexRemove(const JOB_ID_KEY & key);
+void JobQueueIndexClear();
+
+// Plan a job query.  Returns true and sets candidates to the (sorted) ids of
+// the jobs that may match the constraint, or false if the indexes can't narrow
+// the query down and the whole queue has to be scanned.  A null constraint
+// counts as a query that can't use an index.
+bool JobQueueIndexCandidates(const classad::ExprTree * constraint, std::vector<JOB_ID_KEY> & candidates);
+
+// Walks the candidates of a planned query, returning the ones that match
+class JobQueueIndexScan
+{
+public:
+	// returns false if the query can't use an index
+	bool plan(const classad::ExprTree * constraint) { m_next = 0; return JobQueueIndexCandidates(constraint, m_keys); }
+	bool done() const { return m_next >= m_keys.size(); }
+	void stop() { m_next = m_keys.size(); }
+
+	// returns the next candidate that is still in the queue, or nullptr when there are no more
+	JobQueueJob * nextCandidate();
+
+	// Returns the next job that matches, or nullptr when there are no more
+	// or when timeslice_ms has passed without finding one.
+	JobQueueJob * next(const classad::ExprTree * constraint, int timeslice_ms = 0);
+
+private:
+	std::vector<JOB_ID_KEY> m_keys;
+	size_t m_next{0};
+};
+
+void PublishJobQueueIndexStats(ClassAd & ad);
+
+#endif // QMGMT_INDEX_H
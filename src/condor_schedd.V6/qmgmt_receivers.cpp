@@ -43,6 +43,51 @@ static bool QmgmtMayAccessAttribute( char const *attr_name ) {
 	return !ClassAdAttributeIsPrivateAny( attr_name );
 }
 
+// send the reply to a CommitTransaction request
+int
+SendCommitTransactionReply(QmgmtPeer &Q_PEER, int rval, int terrno)
+{
+	CondorError& xact_errstack = Q_PEER.getErrStack();
+	ReliSock *syscall_sock = Q_PEER.getReliSock();
+
+	syscall_sock->encode();
+	neg_on_error( syscall_sock->code(rval) );
+	const CondorVersionInfo *vers = syscall_sock->get_peer_version();
+	bool send_classad = vers && vers->built_since_version(8, 3, 4);
+	bool always_send_classad = vers && vers->built_since_version(8, 7, 4);
+	if( rval < 0 ) {
+		neg_on_error( syscall_sock->code(terrno) );
+	}
+	if( rval < 0 && send_classad ) {
+		// Send a classad, for less backwards-incompatibility.
+		int code = 1;
+		const char * reason = "QMGMT rejected job submission.";
+		if(! xact_errstack.empty()) {
+			code = 2;
+			reason = xact_errstack.message();
+		}
+
+		ClassAd reply;
+		reply.Assign( "ErrorCode", code );
+		reply.Assign( "ErrorReason", reason );
+		neg_on_error( putClassAd( syscall_sock, reply ) );
+	} else if( always_send_classad ) {
+		ClassAd reply;
+
+		std::string reason;
+		if(! xact_errstack.empty()) {
+			reason = xact_errstack.getFullText();
+			reply.Assign( "WarningReason", reason );
+		}
+
+		neg_on_error( putClassAd( syscall_sock, reply ) );
+	}
+
+	neg_on_error( syscall_sock->end_of_message() );;
+	xact_errstack.clear();
+	return 0;
+}
+
 int
 do_Q_request(QmgmtPeer &Q_PEER)
 {
@@ -636,6 +681,7 @@ do_Q_request(QmgmtPeer &Q_PEER)
 	  {
 		int terrno = 0;
 		int flags = 0;
+		unsigned long sync_seq = 0;
 
 		if( request_num == CONDOR_CommitTransaction ) {
 			neg_on_error( syscall_sock->code(flags) );
@@ -652,47 +698,17 @@ do_Q_request(QmgmtPeer &Q_PEER)
 			else if (terrno > 0) terrno = -terrno;
 		} else {
 			errno = 0;
-			rval = CommitTransactionAndLive( flags, &xact_errstack );
+			rval = CommitTransactionForClient( flags, &xact_errstack, sync_seq );
 			terrno = errno;
 		}
 		dprintf( D_SYSCALLS, "\tflags = %d, rval = %d, errno = %d\n", flags, rval, terrno );
 
-		syscall_sock->encode();
-		neg_on_error( syscall_sock->code(rval) );
-		const CondorVersionInfo *vers = syscall_sock->get_peer_version();
-		bool send_classad = vers && vers->built_since_version(8, 3, 4);
-		bool always_send_classad = vers && vers->built_since_version(8, 7, 4);
-		if( rval < 0 ) {
-			neg_on_error( syscall_sock->code(terrno) );
-		}
-		if( rval < 0 && send_classad ) {
-			// Send a classad, for less backwards-incompatibility.
-			int code = 1;
-			const char * reason = "QMGMT rejected job submission.";
-			if(! xact_errstack.empty()) {
-				code = 2;
-				reason = xact_errstack.message();
-			}
-
-			ClassAd reply;
-			reply.Assign( "ErrorCode", code );
-			reply.Assign( "ErrorReason", reason );
-			neg_on_error( putClassAd( syscall_sock, reply ) );
-		} else if( always_send_classad ) {
-			ClassAd reply;
-
-			std::string reason;
-			if(! xact_errstack.empty()) {
-				reason = xact_errstack.getFullText();
-				reply.Assign( "WarningReason", reason );
-			}
-
-			neg_on_error( putClassAd( syscall_sock, reply ) );
+		if (sync_seq) {
+			// reply once the commit has been synced to disk, see handle_q()
+			Q_PEER.deferCommitReply(sync_seq, rval, terrno);
+			return 0;
 		}
-
-		neg_on_error( syscall_sock->end_of_message() );;
-		xact_errstack.clear();
-		return 0;
+		return SendCommitTransactionReply(Q_PEER, rval, terrno);
 	}
 
 	case CONDOR_GetAttributeFloat:
@@ -122,6 +122,7 @@ extern GridUniverseLogic* _gridlogic;
 
 #include "qmgmt.h"
 #include "qmgmt_startup_limits.h"
+#include "qmgmt_index.h"
 #include "condor_qmgr.h"
 #include "condor_vm_universe_types.h"
 #include "enum_utils.h"
@@ -1878,6 +1879,10 @@ Scheduler::count_jobs()
 	time_t job_queue_birthdate = GetOriginalJobQueueBirthdate();
 	cad->Assign(ATTR_JOB_QUEUE_BIRTHDATE, job_queue_birthdate);
 	m_adBase->Assign(ATTR_JOB_QUEUE_BIRTHDATE, job_queue_birthdate);
+	PublishJobQueueLoadStats(*cad);
+	PublishJobQueueSyncStats(*cad);
+	PublishJobQueueCompactionStats(*cad);
+	PublishJobQueueIndexStats(*cad);
 
 	daemonCore->UpdateLocalAd(cad);
 
@@ -3252,13 +3257,16 @@ struct QueryJobAdsContinuation : Service {
 	std::string my_name;
 	ClassAd analysisAd;
 	JobQueueLogType::filter_iterator it;
+	JobQueueIndexScan scan; // the candidates from the job queue indexes, when use_index is true
 	int match_limit;
+	int index_timeslice_ms;
 	int match_count;
 	bool summary_only;
 	bool unfinished_eom;
 	bool registered_socket;
 	bool send_server_time;
 	bool for_analysis{false};
+	bool use_index{false};
 
 	QueryJobAdsContinuation(classad_shared_ptr<classad::ExprTree> requirements_, int limit, int timeslice_ms=0, int iter_opts=0, bool server_time=true, bool for_anal=false);
 	int finish(Stream *);
@@ -3270,6 +3278,7 @@ QueryJobAdsContinuation::QueryJobAdsContinuation(classad_shared_ptr<classad::Exp
 	: requirements(requirements_),
 	  it(GetJobQueueIterator(*requirements, timeslice_ms)),
 	  match_limit(limit),
+	  index_timeslice_ms(timeslice_ms),
 	  match_count(0),
 	  summary_only(false),
 	  unfinished_eom(false),
@@ -3279,6 +3288,9 @@ QueryJobAdsContinuation::QueryJobAdsContinuation(classad_shared_ptr<classad::Exp
 {
 	it.set_options(iter_opts);
 	my_job_counts.clear_counters();
+	// the indexes only know about job ads
+	bool jobs_only = ! (iter_opts & (JOB_QUEUE_ITERATOR_OPT_INCLUDE_CLUSTERS | JOB_QUEUE_ITERATOR_OPT_INCLUDE_JOBSETS | JOB_QUEUE_ITERATOR_OPT_NO_PROC_ADS));
+	use_index = scan.plan(jobs_only ? requirements.get() : nullptr);
 }
 
 int
@@ -3287,6 +3299,7 @@ QueryJobAdsContinuation::finish(Stream *stream) {
 	JobQueueLogType::filter_iterator end = GetJobQueueIteratorEnd();
 	if (match_limit >= 0 && (match_count >= match_limit)) {
 		it = end;
+		scan.stop();
 	}
 	bool has_backlog = false;
 	int put_flags = PUT_CLASSAD_NON_BLOCKING | PUT_CLASSAD_NO_PRIVATE;
@@ -3305,8 +3318,12 @@ QueryJobAdsContinuation::finish(Stream *stream) {
 			return sendJobErrorAd(sock, 5, "Failed to write EOM to wire");
 		}
 	}
-	while ((it != end) && !has_backlog) {
-		JobQueuePayload ad = *it++;
+	while ((use_index ? ! scan.done() : (it != end)) && !has_backlog) {
+		JobQueuePayload ad = use_index ? scan.next(requirements.get(), index_timeslice_ms) : *it++;
+		if (!ad && use_index && scan.done()) {
+			// none of the remaining candidates matched
+			break;
+		}
 		if (!ad) {
 			// Return to DC in case if our time ran out.
 			has_backlog = true;
@@ -3360,6 +3377,7 @@ QueryJobAdsContinuation::finish(Stream *stream) {
 		}
 		if (match_limit >= 0 && (match_count >= match_limit)) {
 			it = end;
+			scan.stop();
 		}
 	}
 	if (has_backlog && !registered_socket) {
@@ -5379,11 +5397,46 @@ For a given job, evaluate any periodic expressions
 and abort, hold, or release the job as necessary.
 */
 
+/*
+Tell the tracker what the outcome of evaluating the periodic expressions
+of a job depends on, so that we evaluate it again only when that changes.
+*/
+
+static void
+TrackPeriodicExprs(JobQueueJob *jobad, bool responsible, int status, UserPolicy & policy)
+{
+	classad::References refs;
+	time_t recheck = 0;
+
+	// the attributes that ResponsibleForPeriodicExprs() looks at
+	refs.insert(ATTR_JOB_STATUS);
+	refs.insert(ATTR_JOB_UNIVERSE);
+	refs.insert(ATTR_JOB_MANAGED);
+	refs.insert(ATTR_HOLD_REASON_CODE);
+	refs.insert(ATTR_GRID_JOB_ID);
+
+	if (responsible) {
+		recheck = policy.PeriodicPolicyReferences(*jobad, status, refs);
+	} else if ((status == HELD || status == COMPLETED || status == REMOVED) &&
+	           scheduler.FindSrecByProcID(jobad->jid)) {
+		// we become responsible when the shadow exits, which need not change the job ad
+		recheck = time(nullptr);
+	}
+
+	scheduler.PeriodicExprTracking.jobEvaluated(jobad->jid, refs, recheck);
+}
+
 static int
 PeriodicExprEval(JobQueueJob *jobad, const JOB_ID_KEY & /*jid*/, void * pvUser)
 {
+	UserPolicy & policy = *(UserPolicy*)pvUser;
+
 	int status=-1;
-	if(!ResponsibleForPeriodicExprs(jobad, status)) return 1;
+	bool responsible = ResponsibleForPeriodicExprs(jobad, status);
+	if (scheduler.PeriodicExprTracking.enabled() && jobad->IsJob()) {
+		TrackPeriodicExprs(jobad, responsible, status, policy);
+	}
+	if(!responsible) return 1;
 
 	int cluster = jobad->jid.cluster;
 	int proc = jobad->jid.proc;
@@ -5395,8 +5448,6 @@ PeriodicExprEval(JobQueueJob *jobad, const JOB_ID_KEY & /*jid*/, void * pvUser)
 		if(status<0) return 1;
 	}
 
-	UserPolicy & policy = *(UserPolicy*)pvUser;
-
 	policy.ResetTriggers();
 	int action = policy.AnalyzePolicy(*jobad, PERIODIC_ONLY, status);
 
@@ -5454,7 +5505,9 @@ PeriodicExprEval(JobQueueJob *jobad, const JOB_ID_KEY & /*jid*/, void * pvUser)
 
 /*
 For all of the jobs in the queue, evaluate the 
-periodic user policy expressions.
+periodic user policy expressions.  When PERIODIC_EXPR_INCREMENTAL
+is enabled, only the jobs that the tracker says may have a different
+outcome than the last time are evaluated, except on a full pass.
 */
 
 void
@@ -5464,7 +5517,34 @@ Scheduler::PeriodicExprHandler( int /* timerID */ )
 
 	UserPolicy policy;
 	policy.Init();
-	WalkJobQueue2(PeriodicExprEval, &policy);
+
+	std::vector<JOB_ID_KEY> due;
+	if (PeriodicExprTracking.startPass(time(nullptr), due)) {
+		WalkJobQueue2(PeriodicExprEval, &policy);
+		if (PeriodicExprTracking.enabled()) {
+			dprintf(D_FULLDEBUG, "Periodic expressions depend on %zu attributes, %zu jobs on the time\n",
+					PeriodicExprTracking.numWatchedAttrs(), PeriodicExprTracking.numTimedJobs());
+		}
+	} else {
+		// a changed cluster ad changes all of its jobs
+		std::set<JOB_ID_KEY> jobs;
+		for (const auto & key : due) {
+			if (key.proc >= 0) {
+				jobs.insert(key);
+			} else if (JobQueueCluster * cad = GetClusterAd(key.cluster)) {
+				for (JobQueueJob * job = cad->FirstJob(); job; job = cad->NextJob(job)) {
+					jobs.insert(job->jid);
+				}
+			}
+		}
+		for (const auto & jid : jobs) {
+			JobQueueJob * job = GetJobAd(jid.cluster, jid.proc);
+			if (job) {
+				PeriodicExprEval(job, jid, &policy);
+			}
+		}
+		dprintf(D_FULLDEBUG, "Evaluated periodic expressions of %zu changed or due jobs\n", jobs.size());
+	}
 
 	PeriodicExprInterval.setFinishTimeNow();
 
@@ -16535,6 +16615,12 @@ Scheduler::Init()
 
 	PeriodicExprInterval.setTimeslice( param_double("PERIODIC_EXPR_TIMESLICE", 0.01,0,1) );
 
+	PeriodicExprTracking.setEnabled( param_boolean("PERIODIC_EXPR_INCREMENTAL", false) &&
+	                                 PeriodicExprInterval.getMinInterval() > 0 );
+	PeriodicExprTracking.setFullPassInterval( param_integer("PERIODIC_EXPR_FULL_INTERVAL", 3600, 0) );
+	// the system periodic expressions may have changed
+	PeriodicExprTracking.requestFullPass();
+
 	RequestClaimTimeout = param_integer("REQUEST_CLAIM_TIMEOUT",60*30);
 
 	int int_val = param_integer( "JOB_IS_FINISHED_INTERVAL", 0, 0 );
@@ -59,6 +59,7 @@
 #include "job_transforms.h"
 #include "history_queue.h"
 #include "live_job_counters.h"
+#include "periodic_expr_tracker.h"
 
 #include <utility>
 #include <string>
@@ -864,6 +865,9 @@ class Scheduler : public Service
 	// Class to manage sets of Job
 	JobSets *jobSets;
 
+	// Which jobs the next PeriodicExprHandler() pass needs to evaluate
+	PeriodicExprTracker PeriodicExprTracking;
+
 	std::map<GridUserIdentity, GridJobCounts> GridJobOwners;
 
 	bool ExportJobs(ClassAd & result, std::set<int> & clusters, const char *output_dir, const OwnerInfo *user, const char * new_spool_dir="##");
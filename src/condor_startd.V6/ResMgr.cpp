@@ -1551,6 +1551,22 @@ void ResMgr::send_updates_and_clear_dirty(int /*timerID = -1*/)
 		}
 	}
 
+	// send only what changed in slot ads if all of the collectors will take delta updates,
+	// which 25.15.0 is the first release to do.  the first updates tell us the collector versions.
+	bool send_deltas = send_delta_updates && enable_single_startd_daemon_ad == 1;
+	if (send_deltas) {
+		CollectorList * clist = daemonCore->getCollectorList();
+		if (clist) {
+			for (auto dcc : clist->getList()) {
+				if ( ! dcc || ! dcc->checkCachedVersion(25,15,0, false)) {
+					send_deltas = false;
+					break;
+				}
+			}
+		}
+	}
+
+	ClassAd delta_ad;
 	for(Resource* rip : slots) {
 		if ( ! rip) continue;
 		bool is_backfill_pslot = rip->is_partitionable_slot() && rip->r_backfill_slot;
@@ -1565,13 +1581,29 @@ void ResMgr::send_updates_and_clear_dirty(int /*timerID = -1*/)
 		if (rip->update_is_needed() || (send_backfill_slots && is_backfill_pslot)) {
 			public_ad.Clear(); private_ad.Clear();
 			rip->get_update_ads(public_ad, private_ad); // this clears update_is_needed
-			send_update(UPDATE_STARTD_AD, &public_ad, &private_ad, true);
+			if ( ! send_deltas) {
+				rip->want_full_update();
+				send_update(UPDATE_STARTD_AD, &public_ad, &private_ad, true);
+			} else if (rip->make_delta_update_ad(public_ad, delta_ad)) {
+				send_update(UPDATE_STARTD_AD_DELTA, &delta_ad, &private_ad, true);
+			} else {
+				send_update(UPDATE_STARTD_AD, &public_ad, &private_ad, true);
+			}
 		}
 	}
 
 	stats.EndRuntime(stats.SendUpdates, currenttime);
 }
 
+void ResMgr::send_full_updates()
+{
+	for (Resource * rip : slots) {
+		if ( ! rip) continue;
+		rip->want_full_update();
+		rip->update_needed(Resource::WhyFor::wf_doUpdate);
+	}
+}
+
 // called when Resource::update_needed is called
 time_t ResMgr::rip_update_needed(unsigned int whyfor_bits)
 {
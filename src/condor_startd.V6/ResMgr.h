@@ -245,6 +245,9 @@ public:
 		// Evaluate and send updates for dirty resources, and clear update dirty bits
 	void	send_updates_and_clear_dirty( int timerID = -1 );
 
+		// Send whole slot ads in the next update, rather than deltas
+	void	send_full_updates();
+
 	void vacate_all(bool fast, const std::string& reason, int code, int subcode) {
 		if (fast) { walk( [&](Resource* rip) { rip->kill_claim(reason, code, subcode); } ); }
 		else { walk( [&](Resource* rip) { rip->retire_claim(false, reason, code, subcode); } ); }
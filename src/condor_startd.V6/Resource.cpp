@@ -1797,6 +1797,43 @@ Resource::get_update_ads(ClassAd & public_ad, ClassAd & private_ad)
 	r_update_is_for = 0;
 }
 
+bool
+Resource::make_delta_update_ad(const ClassAd & public_ad, ClassAd & delta_ad)
+{
+	time_t now = time(nullptr);
+	bool send_whole_ad = r_last_full_update == 0 ||
+		(full_update_interval > 0 && now - r_last_full_update >= full_update_interval);
+
+	if ( ! send_whole_ad) {
+		delta_ad.Clear();
+			// the collector needs these to find the ad the delta applies to
+		for (const char * attr : {ATTR_NAME, ATTR_MY_TYPE, ATTR_MACHINE, ATTR_MY_ADDRESS, ATTR_STARTD_IP_ADDR}) {
+			CopyAttribute(attr, delta_ad, public_ad);
+		}
+		for (const auto & [attr, tree] : public_ad) {
+			ExprTree * last = r_last_update_ad.Lookup(attr);
+			if ( ! last || ! last->SameAs(tree)) {
+				delta_ad.Insert(attr, tree->Copy());
+			}
+		}
+		std::string removed;
+		for (const auto & [attr, tree] : r_last_update_ad) {
+			if ( ! public_ad.Lookup(attr)) {
+				if ( ! removed.empty()) { removed += ","; }
+				removed += attr;
+			}
+		}
+		if ( ! removed.empty()) {
+			delta_ad.Assign(ATTR_UPDATE_DELTA_REMOVED_ATTRS, removed);
+		}
+	} else {
+		r_last_full_update = now;
+	}
+
+	r_last_update_ad = public_ad;
+	return ! send_whole_ad;
+}
+
 // build a slot ad from whole cloth, used for updating the collector, etc
 // it is an ERROR to pass r_classad as input ad here!!
 void Resource::publish_single_slot_ad(ClassAd & ad, time_t last_heard_from, Purpose purpose)
@@ -1919,6 +1956,8 @@ Resource::update_with_ack( void )
 
 	publish_private(&private_ad);
 
+		// the collector will have this ad rather than the last one we sent
+	want_full_update();
 
     if ( !putClassAd ( socket, public_ad ) ) {
 
@@ -355,6 +355,11 @@ public:
 	void	update_walk_for_timer() { update_needed(wf_doUpdate); } // for use with Walk where arguments are not permitted
 	void	get_update_ads(ClassAd & public_ad, ClassAd & private_ad);
 	unsigned int update_is_needed() { return r_update_is_for; }
+		// For STARTD_SEND_DELTA_UPDATES. Returns true and fills delta_ad with the attributes of
+		// public_ad that changed since the last update, or returns false if the whole ad should
+		// be sent.  Either way, public_ad is remembered as the last update.
+	bool	make_delta_update_ad(const ClassAd & public_ad, ClassAd & delta_ad);
+	void	want_full_update() { r_last_full_update = 0; r_last_update_ad.Clear(); }
 	void    process_update_ad(ClassAd & ad, int snapshot=0); // change the update ad before we send it 
     int     update_with_ack( void );    // Actually update the CM and wait for an ACK, used when hibernating.
 	void	final_update( void );		// Send a final update to the CM
@@ -549,6 +554,8 @@ private:
 	// along with a bitmask of the reason for the update
 	time_t r_update_is_due = 0;		// 0 for update is not due, otherwise the oldest time it was requested
 	unsigned int r_update_is_for = 0; // mask of WhyFor bits giving reason for update
+	ClassAd r_last_update_ad;		// the slot ad as of the last update, when sending delta updates
+	time_t r_last_full_update = 0;	// when the whole slot ad was last sent, 0 to send it next time
 
 #ifdef USE_STARTD_LATCHES  // more generic mechanism for CpuBusy
 #else
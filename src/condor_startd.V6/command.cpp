@@ -3116,3 +3116,23 @@ command_data_slot(int, Stream * stream ) {
 	// dprintf( D_ALWAYS, "command_data_slot(): end\n" );
 	return TRUE;
 }
+
+int
+command_send_full_update(int /*dc_cmd*/, Stream* s)
+{
+	ClassAd ad;
+
+	s->decode();
+	if( !getClassAd(s, ad) || !s->end_of_message() ) {
+		dprintf(D_ALWAYS, "command_send_full_update: failed to read request from %s\n", s->peer_description());
+		return FALSE;
+	}
+
+	std::string name;
+	ad.LookupString(ATTR_NAME, name);
+	dprintf(D_FULLDEBUG, "Collector %s could not apply delta update of %s, will send whole slot ads\n",
+		s->peer_description(), name.c_str());
+
+	resmgr->send_full_updates();
+	return TRUE;
+}
@@ -126,6 +126,9 @@ int command_cancel_drain_jobs(int dc_cmd, Stream* s );
 // Rehome: kill all claims and prepare for new work
 int command_rehome(int dc_cmd, Stream* s );
 
+// A collector could not apply a delta update, send it whole slot ads
+int command_send_full_update(int dc_cmd, Stream* s );
+
 // ...
 int command_coalesce_slots(int, Stream * stream );
 
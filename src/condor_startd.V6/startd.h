@@ -102,6 +102,8 @@ extern	int		polling_interval;	// Interval for polling when
 									// running a job
 extern	int		update_interval;	// Interval to update CM
 extern  int		enable_single_startd_daemon_ad; // whther to send "Machine" ads  or "Slot" and "StartDaemon" ads
+extern  bool	send_delta_updates;	// send only the changed attributes of slot ads
+extern  int		full_update_interval;	// how often to send whole slot ads anyway, when sending deltas
 extern  BuildSlotFailureMode slot_config_failmode;
 extern  bool	continue_to_advertise_broken_dslots;
 extern  bool	enable_claimable_partitionable_slots;
@@ -62,6 +62,10 @@ int	update_interval = 0;	// Interval to update CM
 //      and advertise STARTD_OLD_ADTYPE to older collectors
 int enable_single_startd_daemon_ad = 0;
 
+// set by STARTD_SEND_DELTA_UPDATES and STARTD_FULL_UPDATE_INTERVAL
+bool send_delta_updates = false;
+int full_update_interval = 0;
+
 BuildSlotFailureMode slot_config_failmode = BuildSlotFailureMode::Except;
 
 // set by CONTINUE_TO_ADVERTISE_BROKEN_DSLOTS on startup
@@ -466,6 +470,10 @@ main_init( int, char* argv[] )
 								  "CANCEL_DRAIN_JOBS",
 								  command_cancel_drain_jobs,
 								  "command_cancel_drain_jobs", ADMINISTRATOR);
+	daemonCore->Register_CommandWithPayload( SEND_FULL_STARTD_UPDATE,
+								  "SEND_FULL_STARTD_UPDATE",
+								  command_send_full_update,
+								  "command_send_full_update", DAEMON);
 
 		//////////////////////////////////////////////////
 		// Reapers 
@@ -584,6 +592,9 @@ init_params( int first_time)
 	dprintf(D_STATUS, "ENABLE_STARTD_DAEMON_AD=%d (%s)\n", enable_single_startd_daemon_ad,
 		send_daemon_ad.ptr() ? send_daemon_ad.ptr() : "");
 
+	send_delta_updates = param_boolean("STARTD_SEND_DELTA_UPDATES", false);
+	full_update_interval = param_integer("STARTD_FULL_UPDATE_INTERVAL", 3600, 0);
+
 	if (first_time) {
 		// Init the failure mode for setup, if we have no daemon ad there isn't any way to
 		// report most failures, so we should default to Except in that case.
@@ -0,0 +1,106 @@
+#!/usr/bin/env pytest
+
+# Test that job queries the schedd answers from its job queue indexes give
+# the same jobs as evaluating the constraint against every job would, and
+# that the indexes keep up with edits and removals.
+
+import time
+
+import pytest
+
+from ornithology import *
+import htcondor2 as htcondor
+
+# The Color of each job, as it appears in the submit file.  Strings that
+# differ only in case, an expression and numbers of both kinds.
+COLORS = ['"red"', '"RED"', '"blue"', 'toLower("BLUE")', '2', '2.0']
+
+@standup
+def condor(test_dir):
+    with Condor(
+        local_dir=test_dir / "condor",
+        config={
+            "DAEMON_LIST": "MASTER COLLECTOR SCHEDD",
+            "USE_SHARED_PORT": False,
+            "SCHEDD_JOB_QUEUE_INDEX_ATTRS": "Color",
+        }
+    ) as condor:
+        yield condor
+
+# Submit one held job of each Color, and return their cluster ids
+@action
+def clusters(condor, path_to_sleep):
+    clusters = []
+    for color in COLORS:
+        handle = condor.submit(
+            description={
+                "executable": path_to_sleep,
+                "arguments": "3600",
+                "universe": "vanilla",
+                "hold": "true",
+                "My.Color": color,
+            },
+            count=1,
+        )
+        clusters.append(handle.clusterid)
+    return clusters
+
+def matching(condor, clusters, constraint):
+    ads = condor.query(constraint=constraint, projection=["ClusterId"])
+    return sorted(clusters.index(ad["ClusterId"]) for ad in ads)
+
+def indexed_queries(condor):
+    ad = condor.direct_status(htcondor.DaemonType.Schedd, htcondor.AdType.Schedd,
+                              projection=["JobQueueIndexedQueries"])[0]
+    return ad["JobQueueIndexedQueries"]
+
+# the constraints, and which of the jobs match them
+QUERIES = {
+    'Color == "red"': [0, 1],
+    'Color =?= "red"': [0],
+    'Color == "blue"': [2, 3],
+    'Color == 2': [4, 5],
+    'Color == "red" || Color == 2': [0, 1, 4, 5],
+    '(Color == "blue") && JobStatus == 5': [2, 3],
+    'Color == "green"': [],
+    'JobStatus == 5 && Color =!= "red"': [1, 2, 3, 4, 5],
+}
+
+class TestJobQueueIndexes:
+
+    @pytest.mark.parametrize("constraint", QUERIES.keys())
+    def test_query(self, condor, clusters, constraint):
+        assert matching(condor, clusters, constraint) == QUERIES[constraint]
+
+    def test_queries_use_index(self, condor, clusters):
+        before = indexed_queries(condor)
+        matching(condor, clusters, 'Color == "red"')
+        assert indexed_queries(condor) >= before + 1
+
+    def test_cluster_query(self, condor, clusters):
+        constraint = f'ClusterId == {clusters[4]} || Color =?= "RED"'
+        assert matching(condor, clusters, constraint) == [1, 4]
+
+    def test_index_follows_edits(self, condor, clusters):
+        # a literal changes value, and an expression becomes a literal
+        condor.edit("Color", '"blue"', f"ClusterId == {clusters[0]}")
+        condor.edit("Color", '"green"', f"ClusterId == {clusters[3]}")
+        assert matching(condor, clusters, 'Color == "red"') == [1]
+        assert matching(condor, clusters, 'Color == "blue"') == [0, 2]
+        assert matching(condor, clusters, 'Color == "green"') == [3]
+
+        # and back again
+        condor.edit("Color", '"red"', f"ClusterId == {clusters[0]}")
+        condor.edit("Color", 'toLower("BLUE")', f"ClusterId == {clusters[3]}")
+        assert matching(condor, clusters, 'Color == "red"') == [0, 1]
+        assert matching(condor, clusters, 'Color == "blue"') == [2, 3]
+        assert matching(condor, clusters, 'Color == "green"') == []
+
+    def test_index_follows_removal(self, condor, clusters):
+        condor.act(htcondor.JobAction.Remove, f"ClusterId == {clusters[1]} || ClusterId == {clusters[5]}")
+        for _ in range(60):
+            if not condor.query(constraint=f"ClusterId == {clusters[1]} || ClusterId == {clusters[5]}", projection=["ClusterId"]):
+                break
+            time.sleep(1)
+        assert matching(condor, clusters, 'Color == "red"') == [0]
+        assert matching(condor, clusters, 'Color == 2') == [4]
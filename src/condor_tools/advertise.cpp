@@ -30,8 +30,11 @@
 #include "daemon_list.h"
 #include "dc_collector.h"
 #include "ipv6_hostname.h"
+#include "utc_time.h"
 
 #include <algorithm>
+#include <chrono>
+#include <thread>
 #include <vector>
 
 void
@@ -46,6 +49,8 @@ usage( const char *cmd , const char * opt)
 	fprintf(stderr,"    -tcp              Ship classad via TCP (default)\n");
 	fprintf(stderr,"    -udp              Ship classad via UDP\n");
 	fprintf(stderr,"    -multiple         Publish multiple ads, separated by blank lines\n");
+	fprintf(stderr,"    -repeat <n>       Send the ads n times, to load test a collector\n");
+	fprintf(stderr,"    -rate <n>         Send no more than n ads per second\n");
 
 	if (opt && ( !strcmp(opt,"all") || !strcmp(opt,"cmd"))) {
 		fprintf(stderr,"\nAnd <update-command> is one of:\n");
@@ -136,6 +141,8 @@ int main( int argc, char *argv[] )
 	bool fake_private_ad = false;
 	bool allow_multiple = false;
 	bool many_connections = false;
+	int repeat = 1;
+	double rate = 0;
 	time_t start_time = time(nullptr);
 	int claim_sequence = 0;
 	std::string claimid; // in case we need to fake a private ad
@@ -171,6 +178,20 @@ int main( int argc, char *argv[] )
 		} else if(!strcmp(argv[i],"-version")) {
 			version();
 			exit(0);
+		} else if(!strcmp(argv[i],"-repeat") || !strcmp(argv[i],"-rate")) {
+			const char *opt = argv[i++];
+			char *endp = nullptr;
+			double val = argv[i] ? strtod(argv[i], &endp) : 0;
+			if(!argv[i] || *endp || val <= 0) {
+				fprintf(stderr,"%s requires a positive number.\n\n", opt);
+				usage(argv[0], NULL);
+				exit(1);
+			}
+			if(opt[2] == 'e') {
+				repeat = (int)val;
+			} else {
+				rate = val;
+			}
 		} else if(!strcmp(argv[i],"-debug")) {
 				// dprintf to console
 			dprintf_set_tool_debug("TOOL", 0);
@@ -311,7 +332,25 @@ int main( int argc, char *argv[] )
 
 		int success_count = 0;
 		int failure_count = 0;
-		for (auto &ad : ads) {
+		double begin = condor_gettimestamp_double();
+		size_t num_sends = ads.size() * repeat;
+		for (size_t n = 0; n < num_sends; ++n) {
+			auto &ad = ads[n % ads.size()];
+
+			if (n >= ads.size()) {
+					// A replayed ad must look like a new update, else the
+					// collector counts it as a duplicate.
+				int seq = 0;
+				if (ad->LookupInteger(ATTR_UPDATE_SEQUENCE_NUMBER, seq)) {
+					ad->Assign(ATTR_UPDATE_SEQUENCE_NUMBER, seq + 1);
+				}
+			}
+			if (rate > 0) {
+				double delay = begin + n / rate - condor_gettimestamp_double();
+				if (delay > 0) {
+					std::this_thread::sleep_for(std::chrono::duration<double>(delay));
+				}
+			}
 
 				// If there's no "MyAddress", generate one..
 			if( !ad->Lookup( ATTR_MY_ADDRESS ) ) {
@@ -406,6 +445,11 @@ int main( int argc, char *argv[] )
 			   success_count + failure_count,
 			   success_count+failure_count == 1 ? "" : "s",
 			   collector->name());
+		if (repeat > 1 || rate > 0) {
+			double elapsed = condor_gettimestamp_double() - begin;
+			printf("Sent for %.3f seconds, %.1f ads per second.\n",
+				   elapsed, elapsed > 0 ? success_count / elapsed : 0.0);
+		}
 	}
 
 	if (many_connections) {
@@ -27,6 +27,8 @@
 #include "function_test_driver.h"
 #include "emit.h"
 #include "unit_test_utils.h"
+#include "reli_sock.h"
+#include "condor_ver_info.h"
 
 #ifdef WIN32
 	#define strcasecmp _stricmp
@@ -57,6 +59,7 @@ static bool test_is_a_match_false_memory(void);
 static bool test_is_a_match_false_memory_reverse(void);
 static bool test_is_a_match_false_owner(void);
 static bool test_is_a_match_false_owner_reverse(void);
+static bool test_parallel_is_a_match(void);
 static bool test_expr_tree_to_string_short(void);
 static bool test_expr_tree_to_string_long(void);
 static bool test_expr_tree_to_string_long2(void);
@@ -309,6 +312,9 @@ static bool test_countMatches_undefined_list(void);
 static bool test_evalInEach_normal(void);
 static bool test_evalInEach_undefined_list_member(void);
 static bool test_evalInEach_undefined_list(void);
+static bool test_put_projection_binary(void);
+static bool test_put_projection_text(void);
+static bool test_put_pod_classad(void);
 
 
 bool OTEST_Old_Classads(void) {
@@ -340,6 +346,7 @@ bool OTEST_Old_Classads(void) {
 	driver.register_function(test_is_a_match_false_memory_reverse);
 	driver.register_function(test_is_a_match_false_owner);
 	driver.register_function(test_is_a_match_false_owner_reverse);
+	driver.register_function(test_parallel_is_a_match);
 	driver.register_function(test_expr_tree_to_string_short);
 	driver.register_function(test_expr_tree_to_string_long);
 	driver.register_function(test_expr_tree_to_string_long2);
@@ -592,6 +599,9 @@ bool OTEST_Old_Classads(void) {
 	driver.register_function(test_evalInEach_undefined_list_member);
 	driver.register_function(test_evalInEach_undefined_list);
 	driver.register_function(test_nested_ads);
+	driver.register_function(test_put_projection_binary);
+	driver.register_function(test_put_projection_text);
+	driver.register_function(test_put_pod_classad);
 
 	return driver.do_all_functions();
 }
@@ -1254,6 +1264,62 @@ static bool test_is_a_match_false_owner_reverse() {
 	PASS;
 }
 
+static bool test_parallel_is_a_match() {
+	emit_test("Test that ParallelIsAMatch() returns the same result as "
+		"IsAMatch() for each candidate, and skips NULL candidates.");
+    const char* job_string = "\tMyType=\"Job\"\n\t\tTargetType=\"Machine\"\n\t\t"
+		"Owner = \"alain\"\n\t\tRequestMemory = 40\n\t\t"
+		"Requirements = (TARGET.Memory > RequestMemory) && (TARGET.Arch == \"X86_64\")";
+	ClassAd job;
+	initAdFromString(job_string, job);
+
+	const int num_slots = 1000;
+	std::vector<ClassAd*> slots;
+	for (int ix = 0; ix < num_slots; ++ix) {
+		ClassAd *slot = new ClassAd();
+		slot->Assign("Memory", ix % 100);
+		slot->Assign("Arch", (ix % 3) ? "X86_64" : "ppc64le");
+		slot->AssignExpr("Requirements", (ix % 7) ? "TARGET.Owner == \"alain\"" : "false");
+		slots.push_back(slot);
+	}
+	std::vector<ClassAd*> candidates(slots);
+	for (int ix = 0; ix < num_slots; ix += 11) {
+		candidates[ix] = NULL;
+	}
+
+	size_t expect = 0;
+	std::vector<bool> expected(num_slots, false);
+	for (int ix = 0; ix < num_slots; ++ix) {
+		if (candidates[ix] && IsAMatch(&job, candidates[ix])) {
+			expected[ix] = true;
+			++expect;
+		}
+	}
+
+	bool same = true;
+	size_t result = 0;
+	for (int threads = 1; threads <= 8; threads *= 2) {
+		std::vector<bool> matched;
+		result = ParallelIsAMatch(&job, candidates, matched, threads);
+		if (result != expect || matched != expected) {
+			same = false;
+		}
+	}
+	for (ClassAd *slot : slots) { delete slot; }
+
+	emit_input_header();
+	emit_param("Job", job_string);
+	emit_param("Slots", "%d", num_slots);
+	emit_output_expected_header();
+	emit_retval("%zu", expect);
+	emit_output_actual_header();
+	emit_retval("%zu", result);
+	if(result != expect || ! same) {
+		FAIL;
+	}
+	PASS;
+}
+
 static bool test_expr_tree_to_string_short() {
 	emit_test("Test that ExprTreeToString() returns the correct string "
 		"representation of the ExprTree of the attribute in the classad when "
@@ -8152,3 +8218,143 @@ static bool test_evalInEach_undefined_list() {
 	PASS;
 }
 
+// Send two copies of the projection of ad over a loopback ReliSock to a peer
+// of the given version.  The int that starts the first copy is returned in
+// count, it is the number of attributes for the text encoding and a negative
+// marker for the binary one.  The second copy is read with getClassAd.
+static bool put_get_projection(const CondorVersionInfo &peer, const ClassAd &ad,
+	const classad::References &whitelist, int &count, ClassAd &received)
+{
+	ReliSock listener, client;
+	if ( ! listener.bind(CP_IPV4, false, 0, true) || ! listener.listen() ||
+		 ! client.connect("127.0.0.1", listener.get_port())) {
+		return false;
+	}
+	ReliSock *server = listener.accept();
+	if ( ! server) {
+		return false;
+	}
+	client.set_peer_version(&peer);
+	client.encode();
+	bool ok = putClassAd(&client, ad, 0, &whitelist) && client.end_of_message() &&
+		putClassAd(&client, ad, 0, &whitelist) && client.end_of_message();
+	if (ok) {
+		server->decode();
+		ok = server->code(count);
+		server->end_of_message(); // the rest of the first copy is not read
+		ok = ok && getClassAd(server, received) && server->end_of_message();
+	}
+	delete server;
+	return ok;
+}
+
+static const char* projection_ad_string =
+	"A = 1\n"
+	"B = \"not sent\"\n"
+	"C = \"string\"\n"
+	"D = A + 2 * C\n"
+	"E = { 1, \"two\", [ F = 3 ] }\n";
+
+static bool test_put_projection(const CondorVersionInfo &peer, bool expect_binary)
+{
+	ClassAd ad, expected, received;
+	initAdFromString(projection_ad_string, ad);
+	classad::References whitelist = { "A", "C", "D", "E", "Missing" };
+	for (const auto & attr : whitelist) {
+		ExprTree *expr = ad.Lookup(attr);
+		if (expr) { expected.Insert(attr, expr->Copy()); }
+	}
+	std::string expected_str, received_str;
+	sPrintAd(expected_str, expected);
+
+	int count = 0;
+	bool sent = put_get_projection(peer, ad, whitelist, count, received);
+	sPrintAd(received_str, received);
+
+	emit_input_header();
+	emit_param("ClassAd", projection_ad_string);
+	emit_param("Projection", "A, C, D, E, Missing");
+	emit_param("Peer Version", "%d.%d.%d", peer.getMajorVer(), peer.getMinorVer(), peer.getSubMinorVer());
+	emit_output_expected_header();
+	emit_retval("%s", expect_binary ? "binary marker" : "4");
+	emit_param("ClassAd", expected_str.c_str());
+	emit_output_actual_header();
+	emit_retval("%d", count);
+	emit_param("ClassAd", received_str.c_str());
+	if ( ! sent || (expect_binary ? count >= 0 : count != 4) || ! expected.SameAs(&received)) {
+		FAIL;
+	}
+	PASS;
+}
+
+static bool test_put_projection_binary()
+{
+	emit_test("Test that a projection of a ClassAd sent to a peer that reads the "
+		"binary encoding is sent in that encoding and read back the same.");
+	return test_put_projection(CondorVersionInfo(25, 15, 0), true);
+}
+
+static bool test_put_projection_text()
+{
+	emit_test("Test that a projection of a ClassAd sent to a peer that can't read the "
+		"binary encoding is sent as text and read back the same.");
+	return test_put_projection(CondorVersionInfo(25, 14, 0), false);
+}
+
+static const char* pod_ad_string =
+	"A = 1\n"
+	"B = \"two\"\n"
+	"C = 3.5\n"
+	"D = true\n";
+
+// The ads of the security handshake are read with getPODClassAd, which only
+// takes the text encoding, even from a peer that can read the binary one.
+static bool test_put_pod_classad()
+{
+	emit_test("Test that a ClassAd sent with PUT_CLASSAD_NO_BINARY to a peer that "
+		"reads the binary encoding can be read with getPODClassAd, whole and projected.");
+	ClassAd ad, received, received_proj, expected_proj;
+	initAdFromString(pod_ad_string, ad);
+	classad::References whitelist = { "A", "D" };
+	expected_proj.Assign("A", 1);
+	expected_proj.Assign("D", true);
+
+	CondorVersionInfo peer(25, 15, 0);
+	bool ok = false;
+	ReliSock listener, client;
+	if (listener.bind(CP_IPV4, false, 0, true) && listener.listen() &&
+		client.connect("127.0.0.1", listener.get_port())) {
+		ReliSock *server = listener.accept();
+		if (server) {
+			client.set_peer_version(&peer);
+			client.encode();
+			ok = putClassAd(&client, ad, PUT_CLASSAD_NO_BINARY) && client.end_of_message() &&
+				putClassAd(&client, ad, PUT_CLASSAD_NO_BINARY, &whitelist) && client.end_of_message();
+			server->set_peer_version(&peer);
+			server->decode();
+			ok = ok && getPODClassAd(server, received) && server->end_of_message() &&
+				getPODClassAd(server, received_proj) && server->end_of_message();
+			delete server;
+		}
+	}
+	std::string received_str, received_proj_str;
+	sPrintAd(received_str, received);
+	sPrintAd(received_proj_str, received_proj);
+
+	emit_input_header();
+	emit_param("ClassAd", pod_ad_string);
+	emit_param("Projection", "A, D");
+	emit_param("Peer Version", "25.15.0");
+	emit_output_expected_header();
+	emit_retval("%s", "true");
+	emit_param("ClassAd", pod_ad_string);
+	emit_param("Projected ClassAd", "A = 1\nD = true\n");
+	emit_output_actual_header();
+	emit_retval("%s", tfstr(ok));
+	emit_param("ClassAd", received_str.c_str());
+	emit_param("Projected ClassAd", received_proj_str.c_str());
+	if ( ! ok || ! ad.SameAs(&received) || ! expected_proj.SameAs(&received_proj)) {
+		FAIL;
+	}
+	PASS;
+}
@@ -148,6 +148,12 @@ static bool test_hold_multi_macro_firing_custom_reason(void);
 
 static bool test_cron_minute(void);
 
+static bool test_policy_references_and(void);
+static bool test_policy_references_or(void);
+static bool test_policy_references_ternary(void);
+static bool test_policy_references_elapsed_time(void);
+static bool test_policy_references_duration(void);
+
 
 //global variables
 static ClassAdParser parser;
@@ -310,6 +316,11 @@ bool OTEST_UserPolicy(void) {
 	driver.register_function(test_hold_multi_macro_firing_custom_reason);
 	driver.register_function(test_cron_minute);
 	driver.register_function(test_invalid_cron);
+	driver.register_function(test_policy_references_and);
+	driver.register_function(test_policy_references_or);
+	driver.register_function(test_policy_references_ternary);
+	driver.register_function(test_policy_references_elapsed_time);
+	driver.register_function(test_policy_references_duration);
 
 	return driver.do_all_functions();
 }
@@ -3113,3 +3124,135 @@ static bool test_invalid_cron(void) {
 
 	FAIL;
 }
+
+// Call PeriodicPolicyReferences() for a job with the given attributes, and
+// check which of the attributes A, B, C and QDate it says the policy depends
+// on, and when it says the policy may change.  A want_when of -1 is now.
+static bool check_policy_references(const char * attrs, const char * want, time_t want_when) {
+	ClassAd job;
+	initAdFromString(attrs, job);
+	unparser.Unparse(classad_string, &job);
+	emit_input_header();
+	emit_param("ClassAd", "%s", classad_string.c_str());
+	emit_output_expected_header();
+	emit_param("References", "%s", want);
+	emit_param("When", "%lld", (long long)want_when);
+
+	UserPolicy policy;
+	policy.Init();
+	classad::References refs;
+	time_t when = policy.PeriodicPolicyReferences(job, -1, refs);
+	std::string got;
+	for (const char * attr : { "A", "B", "C", "QDate" }) {
+		if (refs.count(attr)) {
+			if ( ! got.empty()) got += ",";
+			got += attr;
+		}
+	}
+	emit_output_actual_header();
+	emit_param("References", "%s", got.c_str());
+	emit_param("When", "%lld", (long long)when);
+	classad_string.clear();
+	if (want_when < 0) {
+		return got == want && when > 0 && when <= time(nullptr);
+	}
+	return got == want && when == want_when;
+}
+
+static bool test_policy_references_and() {
+	emit_test("Test that PeriodicPolicyReferences() leaves out the right operand "
+		"of && when the left one is false, and only then.");
+	if ( ! check_policy_references("\tPeriodicHold = A && B\n\t\tA = false\n\t\tB = true\n\t\tJobStatus = 1", "A", 0)) {
+		FAIL;
+	}
+	if ( ! check_policy_references("\tPeriodicHold = A && B\n\t\tA = true\n\t\tB = true\n\t\tJobStatus = 1", "A,B", 0)) {
+		FAIL;
+	}
+	PASS;
+}
+
+static bool test_policy_references_or() {
+	emit_test("Test that PeriodicPolicyReferences() leaves out the right operand "
+		"of || when the left one is true, and only then.");
+	if ( ! check_policy_references("\tPeriodicRemove = A || B\n\t\tA = true\n\t\tB = false\n\t\tJobStatus = 1", "A", 0)) {
+		FAIL;
+	}
+	if ( ! check_policy_references("\tPeriodicRemove = A || B\n\t\tA = false\n\t\tB = false\n\t\tJobStatus = 1", "A,B", 0)) {
+		FAIL;
+	}
+	PASS;
+}
+
+static bool test_policy_references_ternary() {
+	emit_test("Test that PeriodicPolicyReferences() leaves out the operand "
+		"of ?: that the condition does not choose.");
+	if ( ! check_policy_references("\tPeriodicHold = A ? B : C\n\t\tA = true\n\t\tB = false\n\t\tC = true\n\t\tJobStatus = 1", "A,B", 0)) {
+		FAIL;
+	}
+	if ( ! check_policy_references("\tPeriodicHold = A ? B : C\n\t\tA = false\n\t\tB = false\n\t\tC = true\n\t\tJobStatus = 1", "A,C", 0)) {
+		FAIL;
+	}
+	// an undefined condition makes the result undefined whatever the operands are
+	if ( ! check_policy_references("\tPeriodicHold = A ? B : C\n\t\tB = false\n\t\tC = true\n\t\tJobStatus = 1", "A,B,C", 0)) {
+		FAIL;
+	}
+	PASS;
+}
+
+static bool test_policy_references_elapsed_time() {
+	emit_test("Test that PeriodicPolicyReferences() returns the time at which "
+		"a comparison of the time since an attribute of the job changes.");
+	time_t now = time(nullptr);
+	std::string attrs;
+	// true 3600 seconds after QDate
+	formatstr(attrs, "\tPeriodicHold = time() - QDate > 3600\n\t\tQDate = %lld\n\t\tJobStatus = 1", (long long)now - 100);
+	if ( ! check_policy_references(attrs.c_str(), "QDate", now - 100 + 3601)) {
+		FAIL;
+	}
+	formatstr(attrs, "\tPeriodicRemove = 3600 <= (CurrentTime - QDate)\n\t\tQDate = %lld\n\t\tJobStatus = 1", (long long)now - 100);
+	if ( ! check_policy_references(attrs.c_str(), "QDate", now - 100 + 3600)) {
+		FAIL;
+	}
+	// the limit can come from the job too
+	formatstr(attrs, "\tPeriodicHold = time() - QDate > A\n\t\tA = 60\n\t\tQDate = %lld\n\t\tJobStatus = 1", (long long)now);
+	if ( ! check_policy_references(attrs.c_str(), "A,QDate", now + 61)) {
+		FAIL;
+	}
+	// once it is true it stays true
+	formatstr(attrs, "\tPeriodicHold = time() - QDate > 3600\n\t\tQDate = %lld\n\t\tJobStatus = 1", (long long)now - 7200);
+	if ( ! check_policy_references(attrs.c_str(), "QDate", 0)) {
+		FAIL;
+	}
+	// and it doesn't matter while the other operand of && is false
+	formatstr(attrs, "\tPeriodicHold = A && time() - QDate > 3600\n\t\tA = false\n\t\tQDate = %lld\n\t\tJobStatus = 1", (long long)now);
+	if ( ! check_policy_references(attrs.c_str(), "A", 0)) {
+		FAIL;
+	}
+	// time() used any other way changes all the time
+	if ( ! check_policy_references("\tPeriodicHold = (time() % 60) == 0\n\t\tJobStatus = 1", "", -1)) {
+		FAIL;
+	}
+	PASS;
+}
+
+static bool test_policy_references_duration() {
+	emit_test("Test that PeriodicPolicyReferences() returns the time at which "
+		"a running job reaches its allowed job duration.");
+	time_t now = time(nullptr);
+	std::string attrs;
+	formatstr(attrs, "\tAllowedJobDuration = 600\n\t\tShadowBday = %lld\n\t\tJobStatus = 2", (long long)now - 100);
+	if ( ! check_policy_references(attrs.c_str(), "", now - 100 + 600)) {
+		FAIL;
+	}
+	formatstr(attrs, "\tAllowedExecuteDuration = 600\n\t\tShadowBday = %lld\n\t\tJobCurrentStartExecutingDate = %lld\n\t\tJobStatus = 2",
+		(long long)now - 100, (long long)now - 50);
+	if ( ! check_policy_references(attrs.c_str(), "", now - 50 + 601)) {
+		FAIL;
+	}
+	// without limits a running job never needs to be checked again
+	formatstr(attrs, "\tShadowBday = %lld\n\t\tJobStatus = 2", (long long)now - 100);
+	if ( ! check_policy_references(attrs.c_str(), "", 0)) {
+		FAIL;
+	}
+	PASS;
+}
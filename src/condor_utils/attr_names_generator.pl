@@ -0,0 +1,50 @@
+#! /usr/bin/env perl
+
+##**************************************************************
+##
+## Copyright (C) 1990-2024, Condor Team, Computer Sciences Department,
+## University of Wisconsin-Madison, WI.
+## 
+## Licensed under the Apache License, Version 2.0 (the "License"); you
+## may not use this file except in compliance with the License.  You may
+## obtain a copy of the License at
+## 
+##    http://www.apache.org/licenses/LICENSE-2.0
+## 
+## Unless required by applicable law or agreed to in writing, software
+## distributed under the License is distributed on an "AS IS" BASIS,
+## WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+## See the License for the specific language governing permissions and
+## limitations under the License.
+##
+##**************************************************************
+
+# Write the names of the ATTR_ defines of condor_attributes.h, in the order
+# they are there, as an initializer list of string literals, so that
+# condor_attributes.cpp can intern them without a copy of the list to keep
+# in sync with the header.
+#
+# usage: attr_names_generator.pl -i condor_attributes.h -o condor_attr_names.h
+
+use strict;
+use warnings;
+use Getopt::Std;
+
+my %options;
+getopts('i:o:', \%options);
+die "usage: $0 -i condor_attributes.h -o output.h\n" unless $options{i} && $options{o};
+
+open(my $in, '<', $options{i}) or die "Can't read $options{i}: $!\n";
+my @names;
+while (my $line = <$in>) {
+	push @names, $1 if $line =~ /^\s*#\s*define\s+ATTR_\w+\s+"([^"\\]*)"/;
+}
+close($in);
+die "No ATTR_ defines found in $options{i}\n" unless @names;
+
+my $tmp = "$options{o}.tmp";
+open(my $out, '>', $tmp) or die "Can't write $tmp: $!\n";
+print $out "// Generated from condor_attributes.h by attr_names_generator.pl, do not edit.\n";
+print $out "\t\"$_\",\n" for @names;
+close($out) or die "Can't write $tmp: $!\n";
+rename($tmp, $options{o}) or die "Can't rename $tmp to $options{o}: $!\n";
@@ -108,6 +108,11 @@ public:
   */
   void CommitNondurableTransaction(const char * comment=NULL) { ClassAdLog<K,AD>::CommitNondurableTransaction(comment); }
 
+  /** Commit a transaction without waiting for it to reach the disk
+    @return the commit's sequence number, durable once IsSynced() is true for it
+  */
+  unsigned long CommitGroupedTransaction(const char * comment=NULL) { return ClassAdLog<K,AD>::CommitGroupedTransaction(comment); }
+
   /** Abort a transaction
     @return true if a transaction aborted, false if no transaction active
   */
@@ -154,6 +159,11 @@ public:
 		// This means doing both a flush and fsync.
   void ForceLog() { ClassAdLog<K,AD>::ForceLog(); }
 
+		// Force the log to disk if grouped commits are not durable yet.
+  void SyncLog() { ClassAdLog<K,AD>::SyncLog(); }
+  bool IsSynced(unsigned long seq) const { return ClassAdLog<K,AD>::IsSynced(seq); }
+  const ClassAdLogSyncStats & GetSyncStats() const { return ClassAdLog<K,AD>::GetSyncStats(); }
+
   ///
   Transaction* getActiveTransaction() { return ClassAdLog<K,AD>::getActiveTransaction(); }
   ///
@@ -174,6 +184,12 @@ public:
   */
   bool TruncLog() { return ClassAdLog<K,AD>::TruncLog(); }
 
+  // compact the log in the background, see ClassAdLog::BeginTruncLog()
+  bool BeginTruncLog() { return ClassAdLog<K,AD>::BeginTruncLog(); }
+  bool WriteTruncLog() { return ClassAdLog<K,AD>::WriteTruncLog(); }
+  bool EndTruncLog(bool written) { return ClassAdLog<K,AD>::EndTruncLog(written); }
+  bool TruncLogInProgress() const { return ClassAdLog<K,AD>::TruncLogInProgress(); }
+
   /** Close the log file, discarding any changes that have not yet been written.
       On return from this function, the transaction log will be closed and
       changes to the ad collection will no longer be allowed
@@ -185,6 +201,9 @@ public:
 
   time_t GetOrigLogBirthdate() { return ClassAdLog<K,AD>::GetOrigLogBirthdate(); }
 
+  void SetLoadThreads(int threads) { ClassAdLog<K,AD>::SetLoadThreads(threads); }
+  const ClassAdLogLoadStats & GetLoadStats() const { return ClassAdLog<K,AD>::GetLoadStats(); }
+
   //@}
   //------------------------------------------------------------------------
   /**@name Method to control the class-ads in the repository
@@ -29,6 +29,14 @@
 
 #if defined(UNIX)
 #include "ClassAdLogPlugin.h"
+#include <sys/mman.h>
+#endif
+#include <atomic>
+#include <thread>
+#include <memory>
+#include <functional>
+#ifdef _OPENMP
+#include <omp.h>
 #endif
 
 /***** Prevent calling free multiple times in this code *****/
@@ -60,6 +68,225 @@ const ConstructClassAdLogTableEntry<ClassAd*> DefaultMakeClassAdLogTableEntry;
 #endif
 
 
+// While a log is loaded by several threads, CLASSAD_LOG_STRICT_PARSING is
+// looked up once beforehand, rather than by each thread that needs it.
+static int log_load_strict_parsing = -1;
+
+// Size of the parts a log is cut into to be parsed by several threads.
+static size_t log_load_part_size = 1024*1024;
+
+void SetClassAdLogLoadPartSize(size_t bytes)
+{
+	log_load_part_size = std::max<size_t>(bytes, 1);
+}
+
+#if defined(UNIX)
+
+// A part of a log being loaded by several threads.  Each part begins at
+// the beginning of a line.  The records that begin in it are parsed by
+// one thread, then played by the loading thread in log order.
+struct LogLoadPart {
+	const char * begin{nullptr};
+	size_t size{0};
+	std::vector<LogRecord*> records;
+	size_t end{0};      // offset from begin of the end of the last record parsed
+	bool bad{false};    // parsing stopped at a record that did not parse
+	std::atomic<bool> done{false};
+};
+
+// Like InstantiateLogEntry(), but leaves a record that does not parse to
+// the serial reader to recover from, rather than recovering from it.
+static LogRecord *
+ParseLogEntry(FILE *fp, unsigned long /*recnum*/, int type, const ConstructLogEntry & ctor)
+{
+	LogRecord * log_rec = ctor.NewLogRec(type);
+	if (log_rec && (log_rec->ReadBody(fp) < 0 || log_rec->get_op_type() == CondorLogOp_Error)) {
+		delete log_rec;
+		log_rec = nullptr;
+	}
+	return log_rec;
+}
+
+// Parse the records that begin in a part of the log.  They are read from
+// a stream of the rest of the log, so a record that runs past the end of
+// the part is read just as the serial reader would read it.
+static void
+ParseLogLoadPart(LogLoadPart & part, const char * log_end, const ConstructLogEntry & maker)
+{
+	FILE * fp = fmemopen(const_cast<char*>(part.begin), log_end - part.begin, "r");
+	if ( ! fp) {
+		part.bad = true;
+		return;
+	}
+	for (;;) {
+		long pos = ftell(fp);
+		if (pos < 0) {
+			part.bad = true;
+			break;
+		}
+		if ((size_t)pos >= part.size) {
+			break;
+		}
+		LogRecord * log_rec = ReadLogEntry(fp, 0, ParseLogEntry, maker);
+		if ( ! log_rec) {
+			part.bad = true;
+			break;
+		}
+		part.records.push_back(log_rec);
+		part.end = ftell(fp);
+	}
+	fclose(fp);
+}
+
+// Read the log from offset pos on with several threads parsing parts of
+// it, and hand the records to play in log order.  The loading thread plays
+// each part once it is parsed, while the other threads parse the parts
+// after it.  Returns the offset of the first record not played.  That is
+// the end of the log unless a record did not parse or the last line is
+// incomplete, and the serial reader takes over from there.
+static long long
+LoadClassAdLogParallel(
+	int fd,
+	long long pos,
+	int threads,
+	const ConstructLogEntry & maker,
+	const std::function<void(LogRecord*)> & play,
+	ClassAdLogLoadStats & stats)
+{
+	struct stat si;
+	if (fstat(fd, &si) < 0 || si.st_size <= pos) {
+		return pos;
+	}
+	size_t log_size = si.st_size;
+	void * map = mmap(nullptr, log_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (map == MAP_FAILED) {
+		dprintf(D_ALWAYS, "Failed to map log for parallel loading (errno %d), reading it serially\n", errno);
+		return pos;
+	}
+	madvise(map, log_size, MADV_SEQUENTIAL);
+	const char * data = (const char *)map;
+	const char * log_end = data + log_size;
+
+	// only whole lines are cut into parts
+	const char * lines_end = log_end;
+	while (lines_end > data + pos && lines_end[-1] != '\n') {
+		--lines_end;
+	}
+	std::vector<std::unique_ptr<LogLoadPart>> parts;
+	for (const char * begin = data + pos; begin < lines_end; ) {
+		const char * cut = lines_end;
+		if ((size_t)(lines_end - begin) > log_load_part_size) {
+			cut = (const char *)memchr(begin + log_load_part_size - 1, '\n', lines_end - (begin + log_load_part_size - 1)) + 1;
+		}
+		parts.emplace_back(new LogLoadPart);
+		parts.back()->begin = begin;
+		parts.back()->size = cut - begin;
+		begin = cut;
+	}
+
+	// parts are claimed for parsing in order, and no further ahead of
+	// the loading thread than this, so parsed records don't pile up
+	const size_t max_ahead = (size_t)threads * 4;
+	std::atomic<size_t> next_part{0};
+	std::atomic<size_t> played{0};
+	std::atomic<bool> stop{false};
+	const char * resume = lines_end;
+	int team_size = 1;
+	double parse_time = 0, play_time = 0;
+
+	auto parse_next = [&]() -> bool {
+		size_t ix = next_part.load();
+		if (ix >= parts.size() || ix >= played.load() + max_ahead) {
+			return false;
+		}
+		if (next_part.compare_exchange_strong(ix, ix + 1)) {
+			ParseLogLoadPart(*parts[ix], log_end, maker);
+			parts[ix]->done.store(true, std::memory_order_release);
+		}
+		return true;
+	};
+
+	double begin_time = _condor_debug_get_time_double();
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(threads)
+#endif
+	{
+#ifdef _OPENMP
+		int tid = omp_get_thread_num();
+		if (tid == 0) { team_size = omp_get_num_threads(); }
+#else
+		int tid = 0;
+#endif
+		double busy = 0;
+		if (tid == 0) {
+			for (size_t ix = 0; ix < parts.size(); ++ix) {
+				LogLoadPart & part = *parts[ix];
+				// help parse while the part we need next is not ready
+				while ( ! part.done.load(std::memory_order_acquire)) {
+					double start = _condor_debug_get_time_double();
+					if (parse_next()) {
+						busy += _condor_debug_get_time_double() - start;
+					} else {
+						std::this_thread::yield();
+					}
+				}
+
+				double start = _condor_debug_get_time_double();
+				for (LogRecord * log_rec : part.records) {
+					play(log_rec);
+				}
+				part.records.clear();
+				play_time += _condor_debug_get_time_double() - start;
+
+				// stop at a record that did not parse, and at a record that
+				// ran into the next part, since that part was parsed from
+				// the middle of the record
+				const char * part_end = part.begin + part.end;
+				if (part.bad || (ix + 1 < parts.size() && part_end != parts[ix + 1]->begin)) {
+					resume = part_end;
+					played = ix + 1;
+					break;
+				}
+				played = ix + 1;
+			}
+			stop = true;
+		} else {
+			while ( ! stop && next_part.load() < parts.size()) {
+				double start = _condor_debug_get_time_double();
+				if (parse_next()) {
+					busy += _condor_debug_get_time_double() - start;
+				} else {
+					std::this_thread::yield();
+				}
+			}
+		}
+#ifdef _OPENMP
+#pragma omp atomic
+#endif
+		parse_time += busy;
+	}
+
+	// records parsed after the loading thread stopped are read again serially
+	for (size_t ix = played; ix < parts.size(); ++ix) {
+		for (LogRecord * log_rec : parts[ix]->records) {
+			delete log_rec;
+		}
+	}
+
+	long long resume_pos = resume - data;
+	munmap(map, log_size);
+
+	stats.threads = team_size;
+	stats.parse_time += parse_time;
+	stats.play_time += play_time;
+	dprintf(D_FULLDEBUG, "Loaded %lld bytes of log in %zu parts with %d threads in %.3f seconds (parsing %.3f, playing %.3f)\n",
+		resume_pos - pos, parts.size(), team_size, _condor_debug_get_time_double() - begin_time, parse_time, play_time);
+	return resume_pos;
+}
+
+#endif
+
 // non-templatized worker function that implements the log loading functionality of ClassAdLog
 //
 FILE* LoadClassAdLog(
@@ -70,10 +297,14 @@ FILE* LoadClassAdLog(
 	time_t & m_original_log_birthdate,
 	bool & is_clean,
 	bool & requires_successful_cleaning,
-	std::string & errmsg)
+	std::string & errmsg,
+	int threads,
+	ClassAdLogLoadStats * stats)
 {
 	FILE* log_fp = NULL;
 	Transaction * active_transaction = NULL;
+	ClassAdLogLoadStats load_stats;
+	double begin_time = _condor_debug_get_time_double();
 
 	historical_sequence_number = 1;
 	m_original_log_birthdate = time(NULL);
@@ -95,23 +326,13 @@ FILE* LoadClassAdLog(
 	requires_successful_cleaning = false;
 
 	// Read all of the log records
-	LogRecord		*log_rec;
 	unsigned long count = 0;
 	long long next_log_entry_pos = 0;
     long long curr_log_entry_pos = 0;
-	while ((log_rec = ReadLogEntry(log_fp, 1+count, InstantiateLogEntry, maker)) != 0) {
-        curr_log_entry_pos = next_log_entry_pos;
-		next_log_entry_pos = ftell(log_fp);
-		count++;
-		switch (log_rec->get_op_type()) {
-		case CondorLogOp_Error:
-			// this is defensive, ought to be caught in InstantiateLogEntry()
-			formatstr(errmsg, "ERROR: in log %s transaction record %lu was bad (byte offset %lld)\n", filename, count, curr_log_entry_pos);
-			fclose(log_fp); log_fp = NULL;
 
-			delete active_transaction;
-			return NULL;
-			break;
+	// Play a good record, count is its record number
+	auto play = [&](LogRecord * log_rec) {
+		switch (log_rec->get_op_type()) {
 		case CondorLogOp_BeginTransaction:
 			// this file contains transactions, so it must not
 			// have been cleanly shut down
@@ -149,7 +370,44 @@ FILE* LoadClassAdLog(
 				delete log_rec;
 			}
 		}
+	};
+
+#if defined(UNIX)
+	if (threads > 1) {
+		// the function table of the ClassAd parser is set up on first use
+		classad::ExprTree * warmup = nullptr;
+		ParseClassAdRvalExpr("isUndefined(x)", warmup);
+		delete warmup;
+
+		log_load_strict_parsing = param_boolean("CLASSAD_LOG_STRICT_PARSING", true);
+		next_log_entry_pos = LoadClassAdLogParallel(log_fd, 0, threads, maker,
+			[&](LogRecord * log_rec) { count++; play(log_rec); }, load_stats);
+		log_load_strict_parsing = -1;
+		fseek(log_fp, next_log_entry_pos, SEEK_SET);
+	}
+#endif
+
+	LogRecord		*log_rec;
+	double read_begin = _condor_debug_get_time_double();
+	while ((log_rec = ReadLogEntry(log_fp, 1+count, InstantiateLogEntry, maker)) != 0) {
+        curr_log_entry_pos = next_log_entry_pos;
+		next_log_entry_pos = ftell(log_fp);
+		count++;
+		if (log_rec->get_op_type() == CondorLogOp_Error) {
+			// this is defensive, ought to be caught in InstantiateLogEntry()
+			formatstr(errmsg, "ERROR: in log %s transaction record %lu was bad (byte offset %lld)\n", filename, count, curr_log_entry_pos);
+			fclose(log_fp); log_fp = NULL;
+
+			delete active_transaction;
+			return NULL;
+		}
+		double play_begin = _condor_debug_get_time_double();
+		load_stats.parse_time += play_begin - read_begin;
+		play(log_rec);
+		read_begin = _condor_debug_get_time_double();
+		load_stats.play_time += read_begin - play_begin;
 	}
+
 	long long final_log_entry_pos = ftell(log_fp);
 	if( next_log_entry_pos != final_log_entry_pos ) {
 		// The log file has a broken line at the end so we _must_
@@ -182,6 +440,11 @@ FILE* LoadClassAdLog(
 		delete log_rec;
 	}
 
+	if (stats) {
+		load_stats.records = count;
+		load_stats.load_time = _condor_debug_get_time_double() - begin_time;
+		*stats = load_stats;
+	}
 	return log_fp;
 }
 
@@ -247,6 +510,68 @@ bool SaveHistoricalClassAdLogs(
 }
 
 
+// Replace the log with the file tmp_log_filename, and reopen it for appending.
+// log_fp must be closed.  If the file can't be replaced, the old log is reopened.
+static bool ReplaceClassAdLog(
+	const char * filename,          // in
+	const char * tmp_log_filename,  // in
+	FILE* &log_fp,                  // out
+	std::string & errmsg)           // out
+{
+	if (rotate_file(tmp_log_filename, filename) < 0) {
+		formatstr(errmsg, "failed to rotate job queue log!\n");
+
+		unlink(tmp_log_filename);
+
+		int log_fd = safe_open_wrapper_follow(filename, O_RDWR | O_APPEND | O_LARGEFILE | _O_NOINHERIT, 0600);
+		if (log_fd < 0) {
+			formatstr(errmsg, "failed to reopen log %s, errno = %d after failing to rotate log.",filename,errno);
+		} else {
+			log_fp = fdopen(log_fd, "a+");
+			if (log_fp == NULL) {
+				formatstr(errmsg, "failed to refdopen log %s, errno = %d after failing to rotate log.",filename,errno);
+				close(log_fd);
+			}
+		}
+
+		return false;
+	}
+
+#ifndef WIN32
+	// POSIX does not provide any durability guarantees for rename().  Instead, we must
+	// open the parent directory and invoke fsync there.
+	std::string parent_dir = condor_dirname(filename);
+	int parent_fd = safe_open_wrapper_follow(parent_dir.c_str(), O_RDONLY);
+	if (parent_fd >= 0)
+	{
+		if (condor_fsync(parent_fd) == -1)
+		{
+			formatstr(errmsg, "Failed to fsync directory %s after rename. (errno=%d, msg=%s)", parent_dir.c_str(), errno, strerror(errno));
+		}
+		close(parent_fd);
+	}
+	else
+	{
+		formatstr(errmsg, "Failed to open parent directory %s for fsync after rename. (errno=%d, msg=%s)", parent_dir.c_str(), errno, strerror(errno));
+	}
+#endif
+
+	int log_fd = safe_open_wrapper_follow(filename, O_RDWR | O_APPEND | O_LARGEFILE | _O_NOINHERIT, 0600);
+	if (log_fd < 0) {
+		formatstr(errmsg, "failed to open log in append mode: "
+			"safe_open_wrapper(%s) returns %d", filename, log_fd);
+	} else {
+		log_fp = fdopen(log_fd, "a+");
+		if (log_fp == NULL) {
+			close(log_fd);
+			formatstr(errmsg, "failed to fdopen log in append mode: "
+				"fdopen(%s) returns %d", filename, log_fd);
+		}
+	}
+
+	return true;
+}
+
 bool TruncateClassAdLog(
 	const char * filename,	        // in
 	LoggableClassAdTable & la,      // in
@@ -301,60 +626,12 @@ bool TruncateClassAdLog(
 	}
 
 	fclose(new_log_fp);	// avoid sharing violation on move
-	if (rotate_file(tmp_log_filename.c_str(), filename) < 0) {
-		formatstr(errmsg, "failed to rotate job queue log!\n");
-
-		unlink(tmp_log_filename.c_str());
-
-		int log_fd = safe_open_wrapper_follow(filename, O_RDWR | O_APPEND | O_LARGEFILE | _O_NOINHERIT, 0600);
-		if (log_fd < 0) {
-			formatstr(errmsg, "failed to reopen log %s, errno = %d after failing to rotate log.",filename,errno);
-		} else {
-			log_fp = fdopen(log_fd, "a+");
-			if (log_fp == NULL) {
-				formatstr(errmsg, "failed to refdopen log %s, errno = %d after failing to rotate log.",filename,errno);
-				close(log_fd);
-			}
-		}
-
+	if ( ! ReplaceClassAdLog(filename, tmp_log_filename.c_str(), log_fp, errmsg)) {
 		return false;
 	}
 
 	// we successfully wrote and rotated, so we can update our sequence number
 	historical_sequence_number = future_sequence_number;
-
-#ifndef WIN32
-	// POSIX does not provide any durability guarantees for rename().  Instead, we must
-	// open the parent directory and invoke fsync there.
-	std::string parent_dir = condor_dirname(filename);
-	int parent_fd = safe_open_wrapper_follow(parent_dir.c_str(), O_RDONLY);
-	if (parent_fd >= 0)
-	{
-		if (condor_fsync(parent_fd) == -1)
-		{
-			formatstr(errmsg, "Failed to fsync directory %s after rename. (errno=%d, msg=%s)", parent_dir.c_str(), errno, strerror(errno));
-		}
-		close(parent_fd);
-	}
-	else
-	{
-		formatstr(errmsg, "Failed to open parent directory %s for fsync after rename. (errno=%d, msg=%s)", parent_dir.c_str(), errno, strerror(errno));
-	}
-#endif
-
-	int log_fd = safe_open_wrapper_follow(filename, O_RDWR | O_APPEND | O_LARGEFILE | _O_NOINHERIT, 0600);
-	if (log_fd < 0) {
-		formatstr(errmsg, "failed to open log in append mode: "
-			"safe_open_wrapper(%s) returns %d", filename, log_fd);
-	} else {
-		log_fp = fdopen(log_fd, "a+");
-		if (log_fp == NULL) {
-			close(log_fd);
-			formatstr(errmsg, "failed to fdopen log in append mode: "
-				"fdopen(%s) returns %d", filename, log_fd);
-		}
-	}
-
 	return true;
 }
 
@@ -522,6 +799,92 @@ bool AddAttrsFromLogTransaction(
 }
 
 
+bool WriteClassAdLogSnapshot(
+	const char * snapshot_filename,
+	LoggableClassAdTable & la,
+	const ConstructLogEntry& maker,
+	unsigned long sequence_number,
+	time_t original_log_birthdate,
+	std::string & errmsg)
+{
+	int fd = safe_create_replace_if_exists(snapshot_filename, O_RDWR | O_CREAT | O_LARGEFILE | _O_NOINHERIT, 0600);
+	if (fd < 0) {
+		formatstr(errmsg, "failed to compact log: safe_create_replace_if_exists(%s) failed with errno %d (%s)\n",
+			snapshot_filename, errno, strerror(errno));
+		return false;
+	}
+	FILE * fp = fdopen(fd, "r+");
+	if ( ! fp) {
+		formatstr(errmsg, "failed to compact log: fdopen(%s) returns NULL\n", snapshot_filename);
+		close(fd);
+		return false;
+	}
+	bool success = WriteClassAdLogState(fp, snapshot_filename, sequence_number, original_log_birthdate, la, maker, errmsg);
+	if (fclose(fp) != 0 && success) {
+		formatstr(errmsg, "failed to compact log: fclose(%s) failed with errno %d (%s)\n", snapshot_filename, errno, strerror(errno));
+		success = false;
+	}
+	return success;
+}
+
+bool SwapClassAdLogSnapshot(
+	const char * filename,
+	const char * snapshot_filename,
+	off_t offset,
+	FILE* &log_fp,
+	unsigned long & historical_sequence_number,
+	std::string & errmsg)
+{
+	if (fflush(log_fp) != 0) {
+		formatstr(errmsg, "failed to compact log: fflush of %s failed, errno = %d\n", filename, errno);
+		return false;
+	}
+
+	int snap_fd = safe_open_wrapper_follow(snapshot_filename, O_WRONLY | O_APPEND | O_LARGEFILE | _O_NOINHERIT, 0600);
+	if (snap_fd < 0) {
+		formatstr(errmsg, "failed to compact log: open of %s failed with errno %d (%s)\n", snapshot_filename, errno, strerror(errno));
+		return false;
+	}
+	int log_fd = safe_open_wrapper_follow(filename, O_RDONLY | O_LARGEFILE | _O_NOINHERIT, 0600);
+	if (log_fd < 0 || lseek(log_fd, offset, SEEK_SET) != offset) {
+		formatstr(errmsg, "failed to compact log: could not read %s from offset %lld, errno %d (%s)\n",
+			filename, (long long)offset, errno, strerror(errno));
+		if (log_fd >= 0) close(log_fd);
+		close(snap_fd);
+		return false;
+	}
+
+	// the records committed since the snapshot was taken.  Records are
+	// only written whole, so the log ends on a record boundary here.
+	char buf[64*1024];
+	ssize_t cb = 0;
+	long long tail = 0;
+	while ((cb = full_read(log_fd, buf, sizeof(buf))) > 0) {
+		if (full_write(snap_fd, buf, cb) != cb) {
+			cb = -1;
+			break;
+		}
+		tail += cb;
+	}
+	close(log_fd);
+	if (cb < 0 || condor_fdatasync(snap_fd) < 0) {
+		formatstr(errmsg, "failed to compact log: copying %s to %s failed, errno %d (%s)\n",
+			filename, snapshot_filename, errno, strerror(errno));
+		close(snap_fd);
+		return false;
+	}
+	close(snap_fd);
+	dprintf(D_FULLDEBUG, "Appended %lld bytes committed during compaction of %s\n", tail, filename);
+
+	fclose(log_fp);
+	log_fp = NULL;
+	if ( ! ReplaceClassAdLog(filename, snapshot_filename, log_fp, errmsg)) {
+		return false;
+	}
+	historical_sequence_number += 1;
+	return true;
+}
+
 bool WriteClassAdLogState(
 	FILE *fp, // in
 	const char * filename,
@@ -823,12 +1186,22 @@ LogSetAttribute::Play(void *data_structure)
 	if ( ! table->lookup(key, ad))
 		return -1;
 
+	if (not_strict) {
+		dprintf(D_ALWAYS, "WARNING: strict classad parsing failed for expression: %s\n", value);
+	}
+
 	std::string attr(name);
-	if (ad->InsertViaCache(attr, value)) {
-		rval = TRUE;
+	bool inserted = false;
+	if (value_expr) {
+		// use the tree ReadBody() or the constructor parsed, rather than parsing
+		// the value again.  The ad takes the tree, so get_expr() returns NULL after.
+		ExprTree * tree = value_expr;
+		value_expr = NULL;
+		inserted = ad->InsertViaCache(attr, value, tree);
 	} else {
-		rval = FALSE;
+		inserted = ad->InsertViaCache(attr, value);
 	}
+	rval = inserted ? TRUE : FALSE;
 	if (is_dirty) {
 		ad->MarkAttributeDirty(name);
 	} else {
@@ -908,14 +1281,18 @@ LogSetAttribute::ReadBody(FILE* fp)
 
 	if (value_expr) delete value_expr;
 	value_expr = NULL;
+	not_strict = false;
 	if (ParseClassAdRvalExpr(value, value_expr)) {
 		if (value_expr) delete value_expr;
 		value_expr = NULL;
-		if (param_boolean("CLASSAD_LOG_STRICT_PARSING", true)) {
+		bool strict = (log_load_strict_parsing >= 0) ? (log_load_strict_parsing != 0) : param_boolean("CLASSAD_LOG_STRICT_PARSING", true);
+		if (strict) {
 			return -1;
-		} else {
-			dprintf(D_ALWAYS, "WARNING: strict classad parsing failed for expression: %s\n", value);
 		}
+		// warn when the record is played rather than here, since this may be
+		// one of the threads parsing the log in parallel, and dprintf is not
+		// thread safe unless the daemon made it so.
+		not_strict = true;
 	}
 	return rval + rval1;
 }
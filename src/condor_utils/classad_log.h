@@ -83,6 +83,24 @@ const ConstructClassAdLogTableEntry<ClassAd*> DefaultMakeClassAdLogTableEntry;
 extern const ConstructClassAdLogTableEntry<ClassAd*> DefaultMakeClassAdLogTableEntry;
 #endif
 
+// How long loading a log took, and where the time went.
+struct ClassAdLogLoadStats {
+	int threads{1};             // threads that parsed records
+	unsigned long records{0};   // records read
+	double load_time{0};        // seconds to load the whole log
+	double parse_time{0};       // thread seconds spent reading and parsing records
+	double play_time{0};        // seconds spent applying records to the table
+};
+
+// Durable commits to a log, and the fsyncs that made them durable.
+struct ClassAdLogSyncStats {
+	unsigned long commits{0};   // durable and grouped commits
+	unsigned long syncs{0};     // fsyncs of the log
+	unsigned long max_batch{0}; // most commits made durable by one fsync
+	double sync_time{0};        // seconds spent in fsync
+	double max_sync_time{0};    // longest fsync
+};
+
 template <typename K, typename AD>
 class ClassAdLog {
 public:
@@ -144,6 +162,18 @@ public:
 	void AppendLog(LogRecord *log);	// perform a log operation
 	bool TruncLog();				// clean log file on disk
 
+	// Compact the log without holding up the caller while the table is
+	// written.  BeginTruncLog() notes where the log ends.  WriteTruncLog()
+	// is then called with a copy of the table as it was at that point,
+	// usually in a forked child, and writes it to a new log.  Meanwhile
+	// transactions go on being written to the log.  EndTruncLog() appends
+	// them to the new log and replaces the log with it.  A TruncLog() in
+	// between cancels the compaction.
+	bool BeginTruncLog();
+	bool WriteTruncLog();
+	bool EndTruncLog(bool written);
+	bool TruncLogInProgress() const { return trunc_offset >= 0; }
+
 	// close the log file and discard any unwritten transactions, disable future changes
 	void StopLog();
 
@@ -151,6 +181,12 @@ public:
 	bool AbortTransaction();
 	void CommitTransaction(const char * comment = NULL);
 	void CommitNondurableTransaction(const char * comment = NULL);
+		// Commit without waiting for the log to reach the disk, so that
+		// the commits made until the next SyncLog() share one fsync.
+		// Returns the commit's sequence number, or 0 if there is nothing
+		// to wait for.  The commit is durable once IsSynced() returns true
+		// for that number.
+	unsigned long CommitGroupedTransaction(const char * comment = NULL);
 	bool InTransaction() { return active_transaction != NULL; }
 	int SetTransactionTriggers(int mask);
 	int GetTransactionTriggers();
@@ -190,6 +226,12 @@ public:
 		// This means doing both a flush and fsync.
 	void ForceLog();
 
+		// Force the log to disk if there are grouped commits that are not
+		// durable yet.
+	void SyncLog();
+	bool IsSynced(unsigned long seq) const { return seq <= synced_seq; }
+	const ClassAdLogSyncStats & GetSyncStats() const { return sync_stats; }
+
 	bool AdExistsInTableOrTransaction(const K& key);
 
 	// returns 1 and sets val if corresponding SetAttribute found
@@ -223,6 +265,11 @@ public:
 
 	time_t GetOrigLogBirthdate() {return m_original_log_birthdate;}
 
+	// When more than one, InitLogFile() parses the records of the log with
+	// this many threads, and plays them into the table in order as it goes.
+	void SetLoadThreads(int threads) { this->load_threads = threads; }
+	const ClassAdLogLoadStats & GetLoadStats() const { return load_stats; }
+
 protected:
 	/** Returns handle to active transaction.  Upon return of this
 		method, any active transaction is forgotten.  It is the caller's
@@ -258,6 +305,14 @@ private:
 	unsigned long historical_sequence_number;
 	time_t m_original_log_birthdate;
 	int m_nondurable_level;
+	int load_threads;
+	ClassAdLogLoadStats load_stats;
+	unsigned long commit_seq;	// durable and grouped commits written to the log
+	unsigned long synced_seq;	// commits the last fsync made durable
+	ClassAdLogSyncStats sync_stats;
+	off_t trunc_offset;			// where the log ended when BeginTruncLog() was called, or -1
+
+	std::string TruncLogSnapshotFilename() const { return log_filename_buf + ".compact"; }
 
 	bool SaveHistoricalLogs();
 };
@@ -393,6 +448,7 @@ private:
 	char *value;
 	bool is_dirty;
     ExprTree* value_expr;    
+	bool not_strict{false};	// value did not parse strictly, warn when played
 };
 
 class LogDeleteAttribute : public LogRecord {
@@ -461,6 +517,24 @@ bool TruncateClassAdLog(
 	time_t & m_original_log_birthdate, // in,out
 	std::string & errmsg);          // out
 
+// write the state of the table to a new file, as the start of a compacted log
+bool WriteClassAdLogSnapshot(
+	const char * snapshot_filename, // in
+	LoggableClassAdTable & la,      // in
+	const ConstructLogEntry& maker, // in
+	unsigned long sequence_number,  // in
+	time_t original_log_birthdate,  // in
+	std::string & errmsg);          // out
+
+// append what was written to the log after offset to the snapshot, and replace the log with it
+bool SwapClassAdLogSnapshot(
+	const char * filename,          // in
+	const char * snapshot_filename, // in
+	off_t offset,                   // in
+	FILE* &log_fp,                  // in,out
+	unsigned long & historical_sequence_number, // in,out
+	std::string & errmsg);          // out
+
 bool WriteClassAdLogState(
 	FILE *fp,                       // in
 	const char * filename,          // in: used for error messages
@@ -478,7 +552,13 @@ FILE* LoadClassAdLog(
 	time_t & m_original_log_birthdate, // in,out
 	bool & is_clean,  // out: true if log was shutdown cleanly
 	bool & requires_successful_cleaning, // out: true if log must be cleaned (i.e rotated) before it can be written to again.
-	std::string & errmsg);          // out, contains error or warning messages
+	std::string & errmsg,           // out, contains error or warning messages
+	int threads = 1,                // in: threads to parse records with
+	ClassAdLogLoadStats * stats = nullptr); // out, optional
+
+// Set the size of the parts a log is cut into when it is loaded by several
+// threads, the default is 1 MB.  Tests make it small to cut a small log up.
+void SetClassAdLogLoadPartSize(size_t bytes);
 
 int FlushClassAdLog(FILE* fp, bool force);
 
@@ -534,7 +614,8 @@ ClassAdLog<K,AD>::InitLogFile(const char *filename,int max_historical_logs_arg)
 	log_fp = LoadClassAdLog(filename,
 		la, this->GetTableEntryMaker(),
 		historical_sequence_number, m_original_log_birthdate,
-		is_clean, requires_successful_cleaning, errmsg);
+		is_clean, requires_successful_cleaning, errmsg,
+		load_threads, &load_stats);
 
 	if ( ! log_fp) {
 		dprintf(D_ALWAYS, "%s", errmsg.c_str());
@@ -567,6 +648,10 @@ ClassAdLog<K,AD>::ClassAdLog(const ConstructLogEntry* maker)
 	, historical_sequence_number(0)
 	, m_original_log_birthdate(0)
 	, m_nondurable_level(0)
+	, load_threads(1)
+	, commit_seq(0)
+	, synced_seq(0)
+	, trunc_offset(-1)
 {
 }
 
@@ -611,6 +696,7 @@ ClassAdLog<K,AD>::AppendLog(LogRecord *log)
 				EXCEPT("write to %s failed, errno = %d", logFilename(), errno);
 			}
 			if( m_nondurable_level == 0 ) {
+				++commit_seq;
 				ForceLog();  // flush and fsync
 			}
 		}
@@ -636,10 +722,34 @@ ClassAdLog<K,AD>::ForceLog()
 {
 	// Force log changes to disk.  This involves first flushing
 	// the log from memory buffers, then fsyncing to disk.
+	double begin = _condor_debug_get_time_double();
 	int err = FlushClassAdLog(log_fp, true);
 	if (err) {
 		EXCEPT("fsync of %s failed, errno = %d", logFilename(), err);
 	}
+	if ( ! log_fp) {
+		return;
+	}
+	double elapsed = _condor_debug_get_time_double() - begin;
+	unsigned long batch = commit_seq - synced_seq;
+	synced_seq = commit_seq;
+	sync_stats.commits += batch;
+	sync_stats.syncs += 1;
+	sync_stats.max_batch = std::max(sync_stats.max_batch, batch);
+	sync_stats.sync_time += elapsed;
+	sync_stats.max_sync_time = std::max(sync_stats.max_sync_time, elapsed);
+	if (elapsed > 5) {
+		dprintf(D_FULLDEBUG, "fsync of %s for %lu commits took %.3f seconds\n", logFilename(), batch, elapsed);
+	}
+}
+
+template <typename K, typename AD>
+void
+ClassAdLog<K,AD>::SyncLog()
+{
+	if (commit_seq != synced_seq) {
+		ForceLog();
+	}
 }
 
 template <typename K, typename AD>
@@ -655,6 +765,11 @@ ClassAdLog<K,AD>::TruncLog()
 {
 	dprintf(D_ALWAYS,"About to rotate ClassAd log %s\n",logFilename());
 
+	if (TruncLogInProgress()) {
+		dprintf(D_ALWAYS, "Cancelling the background compaction of %s\n", logFilename());
+		trunc_offset = -1;
+	}
+
 	if(!SaveHistoricalLogs()) {
 		dprintf(D_ALWAYS,"Skipping log rotation, because saving of historical log failed for %s.\n",logFilename());
 		return false;
@@ -673,7 +788,84 @@ ClassAdLog<K,AD>::TruncLog()
 	if ( ! errmsg.empty()) {
 		dprintf(D_ALWAYS, "%s", errmsg.c_str());
 	}
+	if (rotated) {
+		// the new log was synced, and holds the state of every commit so far
+		synced_seq = commit_seq;
+	}
+
+	return rotated;
+}
+
+template <typename K, typename AD>
+bool
+ClassAdLog<K,AD>::BeginTruncLog()
+{
+	if (TruncLogInProgress() || ! log_fp) {
+		return false;
+	}
+	// flush, so that the offset is right, and so that the child that writes
+	// the new log does not inherit records that we have yet to write.
+	FlushLog();
+	off_t offset = lseek(fileno(log_fp), 0, SEEK_END);
+	if (offset < 0) {
+		dprintf(D_ALWAYS, "Cannot compact ClassAd log %s, lseek failed, errno = %d\n", logFilename(), errno);
+		return false;
+	}
+	dprintf(D_ALWAYS, "About to compact ClassAd log %s in the background\n", logFilename());
+	trunc_offset = offset;
+	return true;
+}
+
+template <typename K, typename AD>
+bool
+ClassAdLog<K,AD>::WriteTruncLog()
+{
+	std::string errmsg;
+	ClassAdLogTable<K,AD> la(table);
+	bool success = WriteClassAdLogSnapshot(TruncLogSnapshotFilename().c_str(),
+		la, this->GetTableEntryMaker(),
+		historical_sequence_number + 1, m_original_log_birthdate,
+		errmsg);
+	if ( ! success) {
+		dprintf(D_ALWAYS, "%s", errmsg.c_str());
+	}
+	return success;
+}
+
+template <typename K, typename AD>
+bool
+ClassAdLog<K,AD>::EndTruncLog(bool written)
+{
+	std::string snapshot = TruncLogSnapshotFilename();
+	off_t offset = trunc_offset;
+	trunc_offset = -1;
 
+	if (offset < 0 || ! written || ! log_fp) {
+		unlink(snapshot.c_str());
+		return false;
+	}
+	if ( ! SaveHistoricalLogs()) {
+		dprintf(D_ALWAYS,"Skipping log compaction, because saving of historical log failed for %s.\n",logFilename());
+		unlink(snapshot.c_str());
+		return false;
+	}
+
+	std::string errmsg;
+	bool rotated = SwapClassAdLogSnapshot(logFilename(), snapshot.c_str(), offset,
+		log_fp, historical_sequence_number, errmsg);
+	if ( ! log_fp) {
+		// as in TruncLog(), the failure is fatal if the log is no longer open
+		EXCEPT("%s", errmsg.c_str());
+	}
+	if ( ! errmsg.empty()) {
+		dprintf(D_ALWAYS, "%s", errmsg.c_str());
+	}
+	if (rotated) {
+		// the new log was synced, and holds the state of every commit so far
+		synced_seq = commit_seq;
+	} else {
+		unlink(snapshot.c_str());
+	}
 	return rotated;
 }
 
@@ -756,7 +948,11 @@ ClassAdLog<K,AD>::CommitTransaction(const char * comment /*=NULL*/)
 		active_transaction->AppendLog(log);
 		bool nondurable = m_nondurable_level > 0;
 		ClassAdLogTable<K,AD> la(table);
-		active_transaction->Commit(log_fp, logFilename(), &la, nondurable );
+		active_transaction->Commit(log_fp, logFilename(), &la, true );
+		if ( ! nondurable && log_fp) {
+			++commit_seq;
+			ForceLog();
+		}
 	}
 	delete active_transaction;
 	active_transaction = NULL;
@@ -771,6 +967,25 @@ ClassAdLog<K,AD>::CommitNondurableTransaction(const char * comment /*=NULL*/)
 	DecNondurableCommitLevel( old_level );
 }
 
+template <typename K, typename AD>
+unsigned long
+ClassAdLog<K,AD>::CommitGroupedTransaction(const char * comment /*=NULL*/)
+{
+	if (!active_transaction) return 0;
+	unsigned long seq = 0;
+	if (!active_transaction->EmptyTransaction()) {
+		LogEndTransaction *log = new LogEndTransaction;
+		log->set_comment(comment);
+		active_transaction->AppendLog(log);
+		ClassAdLogTable<K,AD> la(table);
+		active_transaction->Commit(log_fp, logFilename(), &la, true );
+		if (log_fp) { seq = ++commit_seq; }
+	}
+	delete active_transaction;
+	active_transaction = NULL;
+	return seq;
+}
+
 template <typename K, typename AD>
 bool
 ClassAdLog<K,AD>::AdExistsInTableOrTransaction(const K& key)
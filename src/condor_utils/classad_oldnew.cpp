@@ -38,6 +38,70 @@ int _putClassAd(Stream *sock, const classad::ClassAd& ad, int options,
 
 static const char *SECRET_MARKER = "ZKM"; // "it's a Zecret Klassad, Mon!"
 
+// An ad is sent as the number of attributes followed by an "attr = expr"
+// string for each.  Instead of the number, a peer that can read it may be
+// sent this marker followed by the whole ad in the binary encoding of
+// classad::ClassAdBinaryUnParser, as a length and that many bytes.  Older
+// peers reject a negative number of attributes rather than misreading it.
+static const int BINARY_CLASSAD_MARKER = -2;
+
+static bool send_binary_classads = true;
+
+void setBinaryClassAdEncoding(bool enable)
+{
+	send_binary_classads = enable;
+}
+
+// Returns the socket to send an ad on in the binary encoding, or NULL if
+// the text encoding must be used.  Names are sent once per message, so
+// the dictionary lives in the ReliSock, which clears it at end of message.
+// 25.15.0 is the first release that can read the binary encoding, but
+// getPODClassAd() never does, so ads it reads are sent with PUT_CLASSAD_NO_BINARY.
+static ReliSock *binaryClassAdSock(Stream *sock, int options)
+{
+	if ( ! send_binary_classads || (options & PUT_CLASSAD_NO_BINARY) || sock->type() != Stream::reli_sock) {
+		return nullptr;
+	}
+	auto *verinfo = sock->get_peer_version();
+	if ( ! verinfo || ! verinfo->built_since_version(25, 15, 0)) {
+		return nullptr;
+	}
+	return static_cast<ReliSock *>(sock);
+}
+
+// Read the rest of an ad that began with BINARY_CLASSAD_MARKER.
+// Expressions arrive as trees; if use_cache is set, they are shared
+// through the expression cache keyed on their encoded bytes, so they
+// are never unparsed to text.
+static bool getBinaryClassAd(Stream *sock, classad::ClassAd &ad, const char *who, bool use_cache)
+{
+	if (sock->type() != Stream::reli_sock) {
+		dprintf(D_ALWAYS, "%s: binary ClassAd on a non-TCP socket\n", who);
+		return false;
+	}
+	ReliSock *rsock = static_cast<ReliSock *>(sock);
+
+	int len = 0;
+	if ( ! sock->code(len) || len < 0) {
+		dprintf(D_FULLDEBUG, "%s: FAILED to get binary ClassAd length.\n", who);
+		return false;
+	}
+	std::string buf(len, '\0');
+	if (len > 0 && sock->get_bytes(buf.data(), len) != len) {
+		dprintf(D_FULLDEBUG, "%s: FAILED to get %d bytes of binary ClassAd.\n", who, len);
+		return false;
+	}
+
+	const char *pos = buf.data();
+	const char *end = pos + buf.size();
+	classad::ClassAdBinaryParser parser(&rsock->getBinaryAdNames());
+	if ( ! parser.ParseClassAd(pos, end, ad, use_cache) || pos != end) {
+		dprintf(D_ALWAYS, "%s: FAILED to decode binary ClassAd of %d bytes.\n", who, len);
+		return false;
+	}
+	return true;
+}
+
 bool getClassAd( Stream *sock, classad::ClassAd& ad )
 {
 	int 					numExprs;
@@ -50,6 +114,12 @@ bool getClassAd( Stream *sock, classad::ClassAd& ad )
 		dprintf(D_FULLDEBUG, "FAILED to get number of expressions.\n");
  		return false;
 	}
+	if (numExprs == BINARY_CLASSAD_MARKER) {
+		if ( ! getBinaryClassAd(sock, ad, "getClassAd", true)) {
+			return false;
+		}
+		numExprs = 0;
+	}
 	if (numExprs < 0 || numExprs > 1'000'000) {
 		dprintf(D_ALWAYS, "getClassAd: invalid numExprs %d\n", numExprs);
 		return false;
@@ -322,6 +392,12 @@ bool getClassAdEx( Stream *sock, classad::ClassAd& ad, int options)
 	if( !sock->code( numExprs ) ) {
 		return false;
 	}
+	if (numExprs == BINARY_CLASSAD_MARKER) {
+		if ( ! getBinaryClassAd(sock, ad, "getClassAdEx", use_cache)) {
+			return false;
+		}
+		numExprs = 0;
+	}
 	if (numExprs < 0 || numExprs > 1'000'000) {
 		dprintf(D_ALWAYS, "getClassAdEx: invalid numExprs %d\n", numExprs);
 		return false;
@@ -371,6 +447,8 @@ bool getClassAdEx( Stream *sock, classad::ClassAd& ad, int options)
 		// this is faster than letting the classad parser parse it (as of 8.7.0) and also
 		// uses less memory than letting the classad cache see it since literal nodes are the same
 		// size as envelope nodes.
+		// Like the parser, the Literal factories allocate from the caller's ExprArena
+		// if it has an ExprArenaScope open.
 		//
 		bool inserted = false;
 		IF_PROFILE_GETCLASSAD(int subtype = 0);
@@ -496,6 +574,9 @@ getClassAdNoTypes( Stream *sock, classad::ClassAd& ad )
 	if( !sock->code( numExprs ) ) {
  		return false;
 	}
+	if (numExprs == BINARY_CLASSAD_MARKER) {
+		return getBinaryClassAd(sock, ad, "getClassAdNoTypes", false);
+	}
 	if (numExprs < 0 || numExprs > 1'000'000) {
 		dprintf(D_ALWAYS, "getClassAdNoTypes: invalid numExprs %d\n", numExprs);
 		return false;
@@ -669,6 +750,24 @@ static int _putClassAdTrailingInfo(Stream *sock, const classad::ClassAd& /* ad *
 	return true;
 }
 
+// helper function for _putClassAd, finishes and sends an ad whose
+// attributes have been encoded into buf by unp.
+static int _putBinaryClassAd(ReliSock *sock, const classad::ClassAd& ad, classad::ClassAdBinaryUnParser &unp,
+	std::string &buf, bool send_server_time, bool excludeTypes)
+{
+	if (send_server_time) {
+		std::unique_ptr<classad::ExprTree> now(classad::Literal::MakeInteger(time(nullptr)));
+		unp.UnparseAttr(buf, ATTR_SERVER_TIME, now.get());
+	}
+
+	int marker = BINARY_CLASSAD_MARKER;
+	int len = (int)buf.size();
+	if ( ! sock->code(marker) || ! sock->code(len) || sock->put_bytes(buf.data(), len) != len) {
+		return false;
+	}
+	return _putClassAdTrailingInfo(sock, ad, false, excludeTypes);
+}
+
 int _putClassAd( Stream *sock, const classad::ClassAd& ad, int options,
 	const classad::References *encrypted_attrs)
 {
@@ -752,8 +851,19 @@ int _putClassAd( Stream *sock, const classad::ClassAd& ad, int options,
 		send_server_time = true;
 	}
 
+	// Private attributes that have to be encrypted one at a time
+	// can only be sent in the text encoding.
+	ReliSock *binary_sock = binaryClassAdSock(sock, options);
+	if (binary_sock && ! crypto_is_noop && private_count > 0) {
+		binary_sock = nullptr;
+	}
+	std::unique_ptr<classad::ClassAdBinaryUnParser> binary_unp;
+
 	sock->encode( );
-	if( !sock->code( numExprs ) ) {
+	if (binary_sock) {
+		binary_unp.reset(new classad::ClassAdBinaryUnParser(&binary_sock->getBinaryAdNames()));
+		classad::ClassAdBinaryUnParser::UnparseCount(buf, numExprs);
+	} else if( !sock->code( numExprs ) ) {
 		return false;
 	}
 
@@ -806,6 +916,11 @@ int _putClassAd( Stream *sock, const classad::ClassAd& ad, int options,
 				}
 			}
 
+			if (binary_unp) {
+				binary_unp->UnparseAttr( buf, attr, expr );
+				continue;
+			}
+
 			buf = attr;
 			buf += " = ";
 			unp.Unparse( buf, expr );
@@ -821,6 +936,9 @@ int _putClassAd( Stream *sock, const classad::ClassAd& ad, int options,
 		}
 	}
 
+	if (binary_unp) {
+		return _putBinaryClassAd(binary_sock, ad, *binary_unp, buf, send_server_time, excludeTypes);
+	}
 	return _putClassAdTrailingInfo(sock, ad, send_server_time, excludeTypes);
 }
 
@@ -864,19 +982,43 @@ int _putClassAd( Stream *sock, const classad::ClassAd& ad, int options, const cl
 	}
 
 
+	bool crypto_is_noop =  sock->prepare_crypto_for_secret_is_noop();
+
+	// Private attributes that have to be encrypted one at a time
+	// can only be sent in the text encoding.
+	ReliSock *binary_sock = binaryClassAdSock(sock, options);
+	if (binary_sock && ! crypto_is_noop) {
+		for (classad::References::const_iterator attr = whitelist.begin(); attr != whitelist.end(); ++attr) {
+			if (blacklist.find(*attr) == blacklist.end() &&
+				(ClassAdAttributeIsPrivateAny(*attr) ||
+				(encrypted_attrs && (encrypted_attrs->find(*attr) != encrypted_attrs->end())))
+			) {
+				binary_sock = nullptr;
+				break;
+			}
+		}
+	}
+	std::unique_ptr<classad::ClassAdBinaryUnParser> binary_unp;
+
+	std::string buf;
 	sock->encode( );
-	if( !sock->code( numExprs ) ) {
+	if (binary_sock) {
+		binary_unp.reset(new classad::ClassAdBinaryUnParser(&binary_sock->getBinaryAdNames()));
+		classad::ClassAdBinaryUnParser::UnparseCount(buf, numExprs);
+	} else if( !sock->code( numExprs ) ) {
 		return false;
 	}
 
-	std::string buf;
-	bool crypto_is_noop =  sock->prepare_crypto_for_secret_is_noop();
 	for (classad::References::const_iterator attr = whitelist.begin(); attr != whitelist.end(); ++attr) {
 
 		if (blacklist.find(*attr) != blacklist.end())
 			continue;
 
 		classad::ExprTree const *expr = ad.Lookup(*attr);
+		if (binary_unp) {
+			binary_unp->UnparseAttr( buf, *attr, expr );
+			continue;
+		}
 		buf = *attr;
 		buf += " = ";
 		unp.Unparse( buf, expr );
@@ -897,5 +1039,8 @@ int _putClassAd( Stream *sock, const classad::ClassAd& ad, int options, const cl
 		}
 	}
 
+	if (binary_unp) {
+		return _putBinaryClassAd(binary_sock, ad, *binary_unp, buf, send_server_time, excludeTypes);
+	}
 	return _putClassAdTrailingInfo(sock, ad, send_server_time, excludeTypes);
 }
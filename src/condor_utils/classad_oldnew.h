@@ -78,6 +78,13 @@ int putClassAd (Stream *sock, const classad::ClassAd& ad, int options,
 #define PUT_CLASSAD_NON_BLOCKING        0x04 // use non-blocking sematics. returns 2 of this would have blocked.
 #define PUT_CLASSAD_NO_EXPAND_WHITELIST 0x08 // use the whitelist argument as-is, (default is to expand internal references before using it)
 #define PUT_CLASSAD_SERVER_TIME         0x10 // add ServerTime attribute with current time value
+#define PUT_CLASSAD_NO_BINARY           0x20 // always use the text encoding, for peers that read with getPODClassAd()
+
+/** Whether putClassAd() may send ads in the binary encoding to peers that
+ *  can read it.  getClassAd() reads either encoding regardless.
+ *  Set from ENABLE_BINARY_CLASSAD_ENCODING by ClassAdReconfig().
+ */
+void setBinaryClassAdEncoding(bool enable);
 
 // fetch the given attribute from the queryAd and convert it into a set of attributes
 //   the attribute should be a string value containing a comma and/or space separated list of attributes (like StringList)
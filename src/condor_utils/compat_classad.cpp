@@ -63,6 +63,12 @@ static bool ClassAd_strictEvaluation = false;
 
 void ClassAdReconfig()
 {
+	static bool interned_attr_names = false;
+	if ( ! interned_attr_names) {
+		InternCondorAttrNames();
+		interned_attr_names = true;
+	}
+
 	// The set of private attributes in the form of a classad.
 	// Iterating over these attribute names is guaranteed to be in
 	// the same relative order as any other classad.
@@ -74,6 +80,9 @@ void ClassAdReconfig()
 	classad::SetOldClassAdSemantics( !ClassAd_strictEvaluation );
 
 	classad::ClassAdSetExpressionCaching( param_boolean( "ENABLE_CLASSAD_CACHING", false ) );
+	classad::ClassAdSetCompiledEvaluation( param_boolean( "CLASSAD_COMPILED_EVALUATION", true ) );
+	classad::ClassAdSetRegexCacheSize( param_integer( "CLASSAD_REGEX_CACHE_SIZE", 256, 0 ) );
+	setBinaryClassAdEncoding( param_boolean( "ENABLE_BINARY_CLASSAD_ENCODING", true ) );
 
 	char *new_libs = param( "CLASSAD_USER_LIBS" );
 	if ( new_libs ) {
@@ -266,6 +266,10 @@ int EvalBool  (const char *name, classad::ClassAd *my, classad::ClassAd *target,
 // registering additional ClassAd functions
 void ClassAdReconfig();
 
+// Intern the attribute names from condor_attributes.h (see classad/attrName.h).
+// ClassAdReconfig() does this the first time it is called.
+void InternCondorAttrNames();
+
 class ClassAdFileParseHelper
 {
  public:
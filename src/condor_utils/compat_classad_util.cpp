@@ -25,6 +25,8 @@
 #include "classad/classadCache.h" // for CachedExprEnvelope
 
 #include "compat_classad_list.h"
+#include <atomic>
+#include <memory>
 #ifdef _OPENMP
 #include <omp.h>
 #endif
@@ -929,109 +931,178 @@ bool IsAMatch( ClassAd *ad1, ClassAd *ad2 )
 	return result;
 }
 
-static classad::MatchClassAd *match_pool = NULL;
-static ClassAd *target_pool = NULL;
-static std::vector<ClassAd*> *matched_ads = NULL;
+// Per-thread state for the parallel matching functions.  These live for
+// the life of the process, so each call only has to point them at the new
+// request.  The left ad of each match ad is an empty ad chained to the
+// request, so the request is never copied.
+struct ParallelMatchContext {
+	classad::MatchClassAd mad;
+	ClassAd left;
+	// candidates [next, end) of this thread's share have not been
+	// claimed yet.  Threads that run out of work claim (steal) chunks
+	// from the shares of other threads.
+	alignas(64) std::atomic<size_t> next{0};
+	size_t end{0};
+	double busy{0};
+};
 
-bool ParallelIsAMatch(ClassAd *ad1, std::vector<ClassAd*> &candidates, std::vector<ClassAd*> &matches, int threads, bool halfMatch)
+static std::vector<std::unique_ptr<ParallelMatchContext>> par_contexts;
+
+static size_t ParallelMatchThreads(int threads, size_t adCount)
 {
-	int adCount = candidates.size();
-	static size_t cpu_count = 0;
-	size_t current_cpu_count = threads;
-	int iterations = 0;
-	size_t matched = 0;
+	size_t num_threads = (threads > 1) ? (size_t)threads : 1;
+	if (num_threads > adCount) { num_threads = adCount; }
+	return num_threads;
+}
 
-	if(cpu_count != current_cpu_count)
-	{
-		cpu_count = current_cpu_count;
-		if(match_pool)
-		{
-			delete[] match_pool;
-			match_pool = NULL;
-		}
-		if(target_pool)
-		{
-			delete[] target_pool;
-			target_pool = NULL;
-		}
-		if(matched_ads)
-		{
-			delete[] matched_ads;
-			matched_ads = NULL;
-		}
+// Call fn(tid, mad, i) for each non-NULL candidate i, from up to
+// ParallelMatchThreads() threads.  tid is the index of the calling thread
+// and mad has ad1 on the left and candidates[i] on the right.
+template <class Func>
+static void ParallelForEachCandidate(ClassAd *ad1, const std::vector<ClassAd*> &candidates,
+	int threads, ParallelMatchStats *stats, Func fn)
+{
+	const size_t adCount = candidates.size();
+	if (stats) {
+		stats->wall_time = stats->busy_time = 0;
+		stats->threads = 0;
+	}
+	if ( ! adCount) {
+		return;
 	}
 
-	if(!match_pool)
-		match_pool = new classad::MatchClassAd[cpu_count];
-	if(!target_pool)
-		target_pool = new ClassAd[cpu_count];
-	if(!matched_ads)
-		matched_ads = new std::vector<ClassAd*>[cpu_count];
-
-	if(!candidates.size())
-		return false;
+	size_t num_threads = ParallelMatchThreads(threads, adCount);
+	while (par_contexts.size() < num_threads) {
+		par_contexts.emplace_back(new ParallelMatchContext());
+	}
 
-	for(size_t index = 0; index < cpu_count; index++)
-	{
-		target_pool[index].CopyFrom(*ad1);
-		match_pool[index].ReplaceLeftAd(&(target_pool[index]));
-		matched_ads[index].clear();
+	// Small chunks balance better, big chunks contend less for the cursors.
+	size_t chunk = adCount / (num_threads * 16);
+	if (chunk < 8) { chunk = 8; }
+	if (chunk > 256) { chunk = 256; }
+
+	for (size_t ix = 0; ix < num_threads; ++ix) {
+		ParallelMatchContext &ctx = *par_contexts[ix];
+		ctx.left.ChainToAd(ad1);
+		ctx.mad.ReplaceLeftAd(&ctx.left);
+		ctx.next = adCount * ix / num_threads;
+		ctx.end = adCount * (ix + 1) / num_threads;
+		ctx.busy = 0;
 	}
 
-	iterations = ((candidates.size() - 1) / cpu_count) + 1;
+	int team_size = 1;
+	double begin = _condor_debug_get_time_double();
 
 #ifdef _OPENMP
-	omp_set_num_threads(cpu_count);
+#pragma omp parallel num_threads(num_threads)
 #endif
-
-#pragma omp parallel
 	{
-
 #ifdef _OPENMP
-		int omp_id = omp_get_thread_num();
+		size_t tid = omp_get_thread_num();
+		if (tid == 0) { team_size = omp_get_num_threads(); }
 #else
-		int omp_id = 0;
+		size_t tid = 0;
 #endif
-		for(int index = 0; index < iterations; index++)
-		{
-			bool result = false;
-			int offset = omp_id + index * cpu_count;
-			if(offset >= adCount)
-				break;
-			ClassAd *ad2 = candidates[offset];
-
-			match_pool[omp_id].ReplaceRightAd(ad2);
-		
-			if(halfMatch)
-				result = match_pool[omp_id].rightMatchesLeft();
-			else
-				result = match_pool[omp_id].symmetricMatch();
-
-			match_pool[omp_id].RemoveRightAd();
-
-			if(result)
-			{
-				matched_ads[omp_id].push_back(ad2);
+		double start = _condor_debug_get_time_double();
+		ParallelMatchContext &ctx = *par_contexts[tid];
+
+		// work through our own share first, then steal from the others
+		for (size_t victim = 0; victim < num_threads; ++victim) {
+			ParallelMatchContext &owner = *par_contexts[(tid + victim) % num_threads];
+			for (;;) {
+				size_t first = owner.next.fetch_add(chunk, std::memory_order_relaxed);
+				if (first >= owner.end) {
+					break;
+				}
+				size_t last = std::min(first + chunk, owner.end);
+				for (size_t offset = first; offset < last; ++offset) {
+					ClassAd *ad2 = candidates[offset];
+					if ( ! ad2) {
+						continue;
+					}
+
+					ctx.mad.ReplaceRightAd(ad2);
+					fn(tid, ctx.mad, offset);
+					ctx.mad.RemoveRightAd();
+				}
 			}
 		}
+		ctx.busy = _condor_debug_get_time_double() - start;
 	}
 
-	for(size_t index = 0; index < cpu_count; index++)
-	{
-		match_pool[index].RemoveLeftAd();
-		matched += matched_ads[index].size();
+	double wall = _condor_debug_get_time_double() - begin;
+
+	for (size_t ix = 0; ix < num_threads; ++ix) {
+		ParallelMatchContext &ctx = *par_contexts[ix];
+		ctx.mad.RemoveLeftAd();
+		ctx.left.Unchain();
+		if (stats) { stats->busy_time += ctx.busy; }
 	}
 
-	if(matches.capacity() < matched)
-		matches.reserve(matched);
+	if (stats) {
+		stats->wall_time = wall;
+		stats->threads = team_size;
+	}
+}
 
-	for(size_t index = 0; index < cpu_count; index++)
-	{
-		if(matched_ads[index].size())
-			matches.insert(matches.end(), matched_ads[index].begin(), matched_ads[index].end());
+size_t ParallelIsAMatch(ClassAd *ad1, const std::vector<ClassAd*> &candidates, std::vector<bool> &matched,
+	int threads, bool halfMatch, ParallelMatchStats *stats)
+{
+	const size_t adCount = candidates.size();
+	matched.assign(adCount, false);
+
+	// bit i of bits[t] is set if thread t found that candidate i matches
+	const size_t words = (adCount + 63) / 64;
+	std::vector<std::vector<uint64_t>> bits(ParallelMatchThreads(threads, adCount));
+	for (auto &thread_bits : bits) {
+		thread_bits.assign(words, 0);
 	}
 
-	return matches.size() > 0;
+	ParallelForEachCandidate(ad1, candidates, threads, stats,
+		[&bits, halfMatch](size_t tid, classad::MatchClassAd &mad, size_t offset) {
+			bool result = halfMatch ? mad.rightMatchesLeft() : mad.symmetricMatch();
+			if (result) {
+				bits[tid][offset / 64] |= (uint64_t)1 << (offset % 64);
+			}
+		});
+
+	size_t num_matched = 0;
+	for (size_t word = 0; word < words; ++word) {
+		uint64_t word_bits = 0;
+		for (const auto &thread_bits : bits) {
+			word_bits |= thread_bits[word];
+		}
+		for (size_t offset = word * 64; word_bits; ++offset, word_bits >>= 1) {
+			if (word_bits & 1) {
+				matched[offset] = true;
+				++num_matched;
+			}
+		}
+	}
+	return num_matched;
+}
+
+void ParallelForEachMatchAd(ClassAd *ad1, const std::vector<ClassAd*> &candidates, int threads,
+	const std::function<void(classad::MatchClassAd &mad, size_t index)> &fn, ParallelMatchStats *stats)
+{
+	ParallelForEachCandidate(ad1, candidates, threads, stats,
+		[&fn](size_t /*tid*/, classad::MatchClassAd &mad, size_t offset) {
+			fn(mad, offset);
+		});
+}
+
+bool ParallelIsAMatch(ClassAd *ad1, std::vector<ClassAd*> &candidates, std::vector<ClassAd*> &matches, int threads, bool halfMatch)
+{
+	std::vector<bool> matched;
+	size_t num_matched = ParallelIsAMatch(ad1, candidates, matched, threads, halfMatch, NULL);
+
+	matches.reserve(matches.size() + num_matched);
+	for (size_t ix = 0; ix < candidates.size(); ++ix) {
+		if (matched[ix]) {
+			matches.push_back(candidates[ix]);
+		}
+	}
+	return num_matched > 0;
 }
 
 bool IsAConstraintMatch( ClassAd *query, ClassAd *target )
@@ -21,6 +21,7 @@
 #define COMPAT_CLASSAD_UTIL_H
 
 #include "compat_classad.h"
+#include <functional>
 
 // parse str into attr=expression, returning the attr and the expression and true on success
 bool ParseLongFormAttrValue(const char*str, std::string &attr, classad::ExprTree*& tree);
@@ -170,6 +171,29 @@ bool IsAConstraintMatch( ClassAd *query, ClassAd *target );
 
 bool ParallelIsAMatch(ClassAd *ad1, std::vector<ClassAd*> &candidates, std::vector<ClassAd*> &matches, int threads, bool halfMatch = false);
 
+struct ParallelMatchStats {
+	double wall_time;	// seconds from start to finish
+	double busy_time;	// seconds spent matching, summed over threads
+	int threads;		// number of threads that took part
+};
+
+// Match ad1 against each of the candidates using up to threads threads.
+// On return matched[i] is true iff candidates[i] matches ad1; NULL
+// candidates are skipped and never match.  The candidates are split evenly
+// between the threads, and threads that finish their share early take
+// over chunks of the remaining shares.  Returns the number of matches.
+size_t ParallelIsAMatch(ClassAd *ad1, const std::vector<ClassAd*> &candidates, std::vector<bool> &matched,
+	int threads, bool halfMatch = false, ParallelMatchStats *stats = NULL);
+
+// Call fn(mad, i) for each non-NULL candidate i, using up to threads
+// threads, with the candidates shared out as for ParallelIsAMatch().
+// mad is a match ad with ad1 on the left and candidates[i] on the right,
+// so expressions evaluated in either ad see the other one as TARGET; the
+// left ad is chained to ad1 rather than being ad1 itself.  fn is called
+// concurrently and must not write to anything but its result for i.
+void ParallelForEachMatchAd(ClassAd *ad1, const std::vector<ClassAd*> &candidates, int threads,
+	const std::function<void(classad::MatchClassAd &mad, size_t index)> &fn, ParallelMatchStats *stats = NULL);
+
 void AddClassAdXMLFileHeader(std::string &buffer);
 void AddClassAdXMLFileFooter(std::string &buffer);
 
@@ -22,6 +22,7 @@
 //#include "condor_distribution.h"
 #define _CONDOR_ATTR_MAIN
 #include "condor_attributes.h"
+#include "compat_classad.h"
 
 #if 0
 // Initialize our logic
@@ -94,3 +95,19 @@ AttrGetName( CONDOR_ATTR which )
 #define ATTR_VERSION					AttrGetName( ATTRE_VERSION )
 
 #endif
+
+// The attribute names from condor_attributes.h, in the order they are there,
+// generated from the header at build time.  Daemons and tools intern these
+// when they first read their configuration, before they have seen most other
+// names, so that these names get the same keys in every process; see
+// classad/attrName.h.  Names that are not in this list work just as well.
+static const char * const CondorAttrNames[] =
+{
+#include "condor_attr_names.h"
+};
+
+void
+InternCondorAttrNames()
+{
+	classad::ClassAdInternAttrNames(CondorAttrNames, COUNTOF(CondorAttrNames));
+}
@@ -2,6 +2,7 @@
 #include "condor_sockfunc.h"
 #include "ipv6_hostname.h"
 #include "condor_debug.h"
+#include <vector>
 
 int condor_connect(int sockfd, const condor_sockaddr& addr)
 {
@@ -91,6 +92,48 @@ int condor_recvfrom(int sockfd, void* buf, size_t buf_size, int flags,
 	return ret;
 }
 
+int condor_recvfrom_batch(int sockfd, char* bufs, size_t buf_size, int count,
+		int* lengths, condor_sockaddr* addrs)
+{
+	if (count <= 0) {
+		return 0;
+	}
+#if defined(LINUX)
+	if (count > 1) {
+		std::vector<mmsghdr> msgs(count);
+		std::vector<iovec> iovs(count);
+		std::vector<sockaddr_storage> froms(count);
+		for (int i = 0; i < count; ++i) {
+			iovs[i].iov_base = bufs + i*buf_size;
+			iovs[i].iov_len = buf_size;
+			memset(&msgs[i], 0, sizeof(msgs[i]));
+			msgs[i].msg_hdr.msg_iov = &iovs[i];
+			msgs[i].msg_hdr.msg_iovlen = 1;
+			msgs[i].msg_hdr.msg_name = &froms[i];
+			msgs[i].msg_hdr.msg_namelen = sizeof(froms[i]);
+		}
+		int ret = recvmmsg(sockfd, msgs.data(), count, MSG_WAITFORONE, nullptr);
+		if (ret > 0) {
+			for (int i = 0; i < ret; ++i) {
+				lengths[i] = (int)msgs[i].msg_len;
+				addrs[i] = condor_sockaddr((sockaddr*)&froms[i]);
+			}
+			return ret;
+		}
+		if (ret < 0 && errno != ENOSYS) {
+			return ret;
+		}
+		// recvmmsg() is missing, fall back to one datagram at a time
+	}
+#endif
+	int ret = condor_recvfrom(sockfd, bufs, buf_size, 0, addrs[0]);
+	if (ret < 0) {
+		return ret;
+	}
+	lengths[0] = ret;
+	return 1;
+}
+
 static double getnameinfo_slow_limit = 2.0;
 int condor_getnameinfo (const condor_sockaddr& addr,
 		                char * __host, socklen_t __hostlen,
@@ -30,7 +30,7 @@
 #include "proc.h"
 #include "classad_log.h"
 #include "classad_collection.h"
-//#include "condor_attributes.h"
+#include "condor_attributes.h"
 //#include "condor_holdcodes.h"
 #include <map>
 
@@ -788,6 +788,47 @@ bool load_classad_log(ClassAdLogTableWithStats & classad_log, bool verbose, cons
 	return true;
 }
 
+// load the log with LoadClassAdLog serially and with the given number of threads,
+// and check that both give the same ads
+bool compare_parallel_load(bool verbose, const char * filename, int threads)
+{
+	ClassAdLogTableWithStats tables[2];
+	ClassAdLogLoadStats stats[2];
+	int nthreads[2] = { 1, threads };
+	for (int ix = 0; ix < 2; ++ix) {
+		unsigned long hist_seq = 0;
+		time_t birthdate = 0;
+		bool is_clean = true, needs_clean = false;
+		std::string errmsg;
+		FILE * fp = LoadClassAdLog(filename, tables[ix], DefaultMakeClassAdLogTableEntry,
+			hist_seq, birthdate, is_clean, needs_clean, errmsg, nthreads[ix], &stats[ix]);
+		if ( ! fp) {
+			fprintf(stderr, "failed to load %s with %d threads: %s\n", filename, nthreads[ix], errmsg.c_str());
+			++fail_count;
+			return false;
+		}
+		fclose(fp);
+		if (verbose) {
+			fprintf(stdout, "%d threads: %lu records in %.3f seconds (parse %.3f, play %.3f)\n", stats[ix].threads,
+				stats[ix].records, stats[ix].load_time, stats[ix].parse_time, stats[ix].play_time);
+		}
+	}
+
+	bool ok = stats[0].records == stats[1].records && tables[0].ads().size() == tables[1].ads().size();
+	for (const auto & [key,ad] : tables[0].ads()) {
+		auto it = tables[1].ads().find(key);
+		if (it == tables[1].ads().end() || ! ad->SameAs(it->second)) {
+			fprintf(stderr, "ad %s differs when loaded with %d threads\n", key.c_str(), threads);
+			ok = false;
+			break;
+		}
+	}
+	if ( ! ok) {
+		fprintf(stderr, "FAILED: loading %s with %d threads gave a different result\n", filename, threads);
+		++fail_count;
+	}
+	return ok;
+}
 
 void testing_job_queue(ClassAdLogTableWithStats & /*job_queue*/, bool verbose)
 {
@@ -803,6 +844,170 @@ void testing_accountant(ClassAdLogTableWithStats & /*acct_log*/, bool verbose)
 	}
 }
 
+typedef ClassAdLog<std::string,ClassAd*> TestClassAdLog;
+
+#define REQUIRE(cond) \
+	if ( ! (cond)) { fprintf(stderr, "FAILED: %s at line %d\n", #cond, __LINE__); ++fail_count; }
+
+// make a new ad with an attribute, or change the attribute of an existing ad
+static void set_attr(TestClassAdLog & log, const char * key, const char * attr, const char * value, bool new_ad = false)
+{
+	if (new_ad) { log.AppendLog(new LogNewClassAd(key, "Job")); }
+	log.AppendLog(new LogSetAttribute(key, attr, value));
+}
+
+// true if the log file loads into the same ads as the table of the given log.
+// This reads the log with LoadClassAdLog(), InitLogFile() would rewrite it.
+static bool log_file_matches(TestClassAdLog & log, const char * filename)
+{
+	ClassAdLogTableWithStats loaded;
+	unsigned long hist_seq = 0;
+	time_t birthdate = 0;
+	bool is_clean = true, needs_clean = false;
+	std::string errmsg;
+	FILE * fp = LoadClassAdLog(filename, loaded, DefaultMakeClassAdLogTableEntry,
+		hist_seq, birthdate, is_clean, needs_clean, errmsg);
+	if ( ! fp) {
+		fprintf(stderr, "failed to load %s: %s\n", filename, errmsg.c_str());
+		return false;
+	}
+	fclose(fp);
+
+	bool same = loaded.ads().size() == (size_t)log.table.getNumElements();
+	for (const auto & [key,ad] : loaded.ads()) {
+		ClassAd * other = nullptr;
+		if (log.table.lookup(key, other) != 0 || ! other || ! other->SameAs(ad)) {
+			same = false;
+		}
+	}
+	return same;
+}
+
+void testing_group_commit(bool verbose)
+{
+	if (verbose) {
+		fprintf( stdout, "\n----- testing_group_commit ----\n\n");
+	}
+
+	const char * filename = "test_classad_log_group_commit.log";
+	unlink(filename);
+	{
+		TestClassAdLog log;
+		REQUIRE(log.InitLogFile(filename));
+		unsigned long syncs = log.GetSyncStats().syncs;
+
+		// grouped commits are applied at once, but not synced
+		log.BeginTransaction();
+		set_attr(log, "1.0", ATTR_JOB_STATUS, "1", true);
+		unsigned long seq1 = log.CommitGroupedTransaction();
+		ClassAd * ad = nullptr;
+		REQUIRE(seq1 != 0);
+		REQUIRE( ! log.IsSynced(seq1));
+		REQUIRE(log.table.lookup("1.0", ad) == 0);
+
+		log.BeginTransaction();
+		set_attr(log, "1.1", ATTR_JOB_STATUS, "1", true);
+		unsigned long seq2 = log.CommitGroupedTransaction();
+		REQUIRE(seq2 > seq1);
+		REQUIRE( ! log.IsSynced(seq1) && ! log.IsSynced(seq2));
+
+		// an empty transaction has nothing to wait for
+		log.BeginTransaction();
+		REQUIRE(log.CommitGroupedTransaction() == 0);
+
+		// one sync makes both durable
+		log.SyncLog();
+		REQUIRE(log.IsSynced(seq1) && log.IsSynced(seq2));
+		REQUIRE(log.GetSyncStats().syncs == syncs + 1);
+		REQUIRE(log.GetSyncStats().max_batch == 2);
+
+		// with nothing new, SyncLog does not sync again
+		log.SyncLog();
+		REQUIRE(log.GetSyncStats().syncs == syncs + 1);
+
+		// a durable commit syncs the grouped commits before it
+		log.BeginTransaction();
+		set_attr(log, "1.0", ATTR_JOB_STATUS, "2");
+		unsigned long seq3 = log.CommitGroupedTransaction();
+		REQUIRE( ! log.IsSynced(seq3));
+		log.BeginTransaction();
+		set_attr(log, "1.1", ATTR_JOB_STATUS, "2");
+		log.CommitTransaction();
+		REQUIRE(log.IsSynced(seq3));
+
+		REQUIRE(log_file_matches(log, filename));
+	}
+	unlink(filename);
+}
+
+void testing_trunc_log(bool verbose)
+{
+	if (verbose) {
+		fprintf( stdout, "\n----- testing_trunc_log ----\n\n");
+	}
+
+	const char * filename = "test_classad_log_trunc.log";
+	unlink(filename);
+	{
+		TestClassAdLog log;
+		REQUIRE(log.InitLogFile(filename));
+		for (int proc = 0; proc < 4; ++proc) {
+			std::string key;
+			formatstr(key, "1.%d", proc);
+			log.BeginTransaction();
+			set_attr(log, key.c_str(), ATTR_JOB_STATUS, "1", true);
+			log.CommitTransaction();
+		}
+
+		// the schedd writes the compacted log in a forked child, with the
+		// table as it was at BeginTruncLog(), which is the table here
+		REQUIRE(log.BeginTruncLog());
+		REQUIRE(log.TruncLogInProgress());
+		REQUIRE( ! log.BeginTruncLog());
+		REQUIRE(log.WriteTruncLog());
+
+		// commits while the compacted log is written, of every kind
+		log.BeginTransaction();
+		set_attr(log, "1.0", ATTR_JOB_STATUS, "2");
+		set_attr(log, "1.4", ATTR_JOB_STATUS, "1", true);
+		log.CommitTransaction();
+		log.BeginTransaction();
+		log.AppendLog(new LogDestroyClassAd("1.1"));
+		log.CommitNondurableTransaction();
+		log.BeginTransaction();
+		log.AppendLog(new LogDeleteAttribute("1.2", ATTR_JOB_STATUS));
+		unsigned long seq = log.CommitGroupedTransaction();
+		REQUIRE( ! log.IsSynced(seq));
+
+		REQUIRE(log.EndTruncLog(true));
+		REQUIRE( ! log.TruncLogInProgress());
+		REQUIRE(log.IsSynced(seq));
+		REQUIRE(log_file_matches(log, filename));
+
+		// and the log goes on after the swap
+		log.BeginTransaction();
+		set_attr(log, "1.3", ATTR_JOB_STATUS, "4");
+		log.CommitTransaction();
+		REQUIRE(log_file_matches(log, filename));
+
+		// a compaction that failed leaves the log as it was
+		REQUIRE(log.BeginTruncLog());
+		log.BeginTransaction();
+		set_attr(log, "1.0", ATTR_JOB_STATUS, "3");
+		log.CommitTransaction();
+		REQUIRE( ! log.EndTruncLog(false));
+		REQUIRE(log_file_matches(log, filename));
+
+		// and TruncLog() cancels one in progress
+		REQUIRE(log.BeginTruncLog());
+		REQUIRE(log.WriteTruncLog());
+		REQUIRE(log.TruncLog());
+		REQUIRE( ! log.EndTruncLog(true));
+		REQUIRE(log_file_matches(log, filename));
+	}
+	unlink(filename);
+}
+
 void Usage(const char * appname, FILE * out)
 {
 	const char * p = appname;
@@ -818,11 +1023,14 @@ void Usage(const char * appname, FILE * out)
 		"\n  <source> is a classad transaction log file that is read\n"
 		"    -job-queue <file>\tRead a job_queue.log file\n"
 		"    -accountant <file>\tRead an Accoutantnew.log file\n"
+		"    -threads <n>\t\tCheck that loading with <n> threads gives the same ads as loading serially\n"
+		"    -part-size <bytes>\tCut the log into parts of this size when loading with threads\n"
 		"\n  <queryopts> are queries run against the classad collection\n"
 		"    -long[:fmt]\t\tOutput results in the given format\n"
 		"    -raw\t\tOutput unmodified ads. Otherwise ads are chained and key attributes added.\n"
 		"    -constraint <expr>\tOutput only ads which match the expression.\n"
-		"\n  <tests> is one or more letters choosing specific subtests (future)\n"
+		"\n  <tests> is one or more letters choosing specific subtests\n"
+		"    c  commit and compaction tests, these write their own logs and need no <source>\n"
 		//"    j  job_queue tests\n"
 		//"    a  accounting tests\n"
 		"\n  This tool reads a classad transaction log and builds a collection of ads.\n"
@@ -837,6 +1045,7 @@ void Usage(const char * appname, FILE * out)
 // is one or more of 
 //   j   testing_job_queue
 //   a   testing_accountant
+//   c   testing_group_commit, testing_trunc_log
 //
 int main( int /*argc*/, const char ** argv) {
 
@@ -847,6 +1056,7 @@ int main( int /*argc*/, const char ** argv) {
 	bool dash_long = false;
 	bool dash_raw_ads = false;
 	const char * log_filename = nullptr;
+	int load_threads = 0;
 	ClassAdLogTableWithStats classad_log;
 	ClassAdFileParseType::ParseType dash_long_format = ClassAdFileParseType::Parse_auto;
 	ConstraintHolder constr;
@@ -870,10 +1080,11 @@ int main( int /*argc*/, const char ** argv) {
 					switch (*pcolon) {
 					case 'j': test_flags |= 0x0111; break; // job_queue
 					case 'a': test_flags |= 0x0222; break; // accountant
+					case 'c': test_flags |= 0x0444; break; // commits
 					}
 				}
 			} else {
-				test_flags = 3;
+				test_flags = 7;
 			}
 		} else if (is_dash_arg_prefix(arg, "job-queue", 3)) {
 			log_filename = argv[ii+1];
@@ -895,6 +1106,19 @@ int main( int /*argc*/, const char ** argv) {
 			}
 			other_arg = true;
 			classad_log.set_string_keys();
+		} else if (is_dash_arg_prefix(arg, "threads", 2)) {
+			if ( ! argv[ii+1] || atoi(argv[ii+1]) < 2) {
+				fprintf(stderr, "-threads requires a number of threads greater than 1\n");
+				return 1;
+			}
+			load_threads = atoi(argv[++ii]);
+			other_arg = true;
+		} else if (is_dash_arg_prefix(arg, "part-size", 4)) {
+			if ( ! argv[ii+1] || atoi(argv[ii+1]) < 1) {
+				fprintf(stderr, "-part-size requires a number of bytes\n");
+				return 1;
+			}
+			SetClassAdLogLoadPartSize(atoi(argv[++ii]));
 		} else if (is_dash_arg_colon_prefix(arg, "debug", &pcolon, 3)) {
 			// dprintf to console
 			dprintf_set_tool_debug("TOOL", (pcolon && pcolon[1]) ? pcolon+1 : nullptr);
@@ -929,13 +1153,22 @@ int main( int /*argc*/, const char ** argv) {
 			return 1;
 		}
 	}
+	ClassAdReconfig(); // register the compat classad functions. 
+
+	if (test_flags & 0x0004) testing_group_commit(dash_verbose);
+	if (test_flags & 0x0004) testing_trunc_log(dash_verbose);
+
 	// if no log file specified, just print usage and exit.
-	if ( ! log_filename) { Usage(argv[0], stdout); return 1; }
+	if ( ! log_filename) {
+		if (test_flags & 0x0004) { return fail_count > 0; }
+		Usage(argv[0], stdout); return 1;
+	}
 
 	if ( ! test_flags && ! other_arg) test_flags = -1;
 
-	ClassAdReconfig(); // register the compat classad functions. 
-
+	if (log_filename && load_threads) {
+		compare_parallel_load(dash_verbose, log_filename, load_threads);
+	}
 	if (log_filename) {
 		if (load_classad_log(classad_log, dash_verbose, log_filename)) {
 			// if no tests, just dump job queue stats
@@ -585,6 +585,321 @@ bool UserPolicy::AnalyzeSinglePeriodicPolicy(ClassAd & ad, const char * attrname
 	return false;
 }
 
+// The earlier of two times at which a value may change, where 0 is never.
+static time_t EarlierChange(time_t a, time_t b)
+{
+	if ( ! a) return b;
+	if ( ! b) return a;
+	return MIN(a, b);
+}
+
+// The time at which a value that changes once, at the given time, may
+// change, which is never if that time has passed.
+static time_t ChangeAfter(time_t t, time_t now)
+{
+	return (t > now) ? t : 0;
+}
+
+static bool IsCurrentTime(const classad::ExprTree * tree)
+{
+	tree = SkipExprParens(tree);
+	if ( ! tree) return false;
+	if (tree->GetKind() == classad::ExprTree::ATTRREF_NODE) {
+		classad::ExprTree * scope = nullptr;
+		std::string attr;
+		bool absolute = false;
+		((const classad::AttributeReference*)tree)->GetComponents(scope, attr, absolute);
+		return ! scope && YourStringNoCase(ATTR_CURRENT_TIME) == attr;
+	}
+	if (tree->GetKind() == classad::ExprTree::FN_CALL_NODE) {
+		std::string fnName;
+		std::vector<classad::ExprTree*> args;
+		((const classad::FunctionCall*)tree)->GetComponents(fnName, args);
+		return args.empty() && YourStringNoCase("time") == fnName;
+	}
+	return false;
+}
+
+static time_t AddPolicyReferences(ClassAd & ad, const classad::ExprTree * tree, classad::References & refs, bool prune, time_t now, int depth = 0);
+
+// Comparisons like time() - EnteredCurrentStatus > 3600 or
+// CurrentTime - QDate <= Limit change value once, when the current time
+// passes the sum of two values from the ad.  If tree is one of those,
+// add what the two values depend on to refs, set when to the time the
+// comparison changes, and return true.
+static bool ElapsedTimeComparison(ClassAd & ad, classad::Operation::OpKind op, classad::ExprTree * t1, classad::ExprTree * t2,
+	classad::References & refs, time_t now, int depth, time_t & when)
+{
+	if (op != classad::Operation::LESS_THAN_OP && op != classad::Operation::LESS_OR_EQUAL_OP &&
+		op != classad::Operation::GREATER_THAN_OP && op != classad::Operation::GREATER_OR_EQUAL_OP) {
+		return false;
+	}
+
+	// find the side that is the current time minus something, and make it the left side
+	classad::ExprTree * elapsed = nullptr;
+	classad::ExprTree * limit = nullptr;
+	for (int side = 0; side < 2 && ! elapsed; ++side) {
+		classad::ExprTree * tree = SkipExprParens(side ? t2 : t1);
+		if ( ! tree || tree->GetKind() != classad::ExprTree::OP_NODE) continue;
+		classad::Operation::OpKind sub_op;
+		classad::ExprTree *s1, *s2, *s3;
+		((const classad::Operation*)tree)->GetComponents(sub_op, s1, s2, s3);
+		if (sub_op == classad::Operation::SUBTRACTION_OP && IsCurrentTime(s1) && s2) {
+			elapsed = s2;
+			limit = side ? t1 : t2;
+			if (side) {
+				// C < time() - X is time() - X > C
+				switch (op) {
+				case classad::Operation::LESS_THAN_OP: op = classad::Operation::GREATER_THAN_OP; break;
+				case classad::Operation::LESS_OR_EQUAL_OP: op = classad::Operation::GREATER_OR_EQUAL_OP; break;
+				case classad::Operation::GREATER_THAN_OP: op = classad::Operation::LESS_THAN_OP; break;
+				default: op = classad::Operation::LESS_OR_EQUAL_OP; break;
+				}
+			}
+		}
+	}
+	if ( ! elapsed || ! limit) {
+		return false;
+	}
+
+	// both values must not depend on the time themselves
+	classad::References sub_refs;
+	if (AddPolicyReferences(ad, elapsed, sub_refs, false, now, depth + 1) ||
+		AddPolicyReferences(ad, limit, sub_refs, false, now, depth + 1)) {
+		return false;
+	}
+	refs.insert(sub_refs.begin(), sub_refs.end());
+
+	// if they aren't numbers the comparison doesn't change with the time
+	classad::Value val;
+	double start = 0, span = 0;
+	when = 0;
+	if ( ! ad.EvaluateExpr(elapsed, val) || ! val.IsNumber(start) ||
+		 ! ad.EvaluateExpr(limit, val) || ! val.IsNumber(span)) {
+		return true;
+	}
+
+	// time() - start op span is time() op start + span, which changes at
+	double threshold = start + span;
+	if (threshold < (double)now || threshold > 1e15) {
+		return true; // already has its final value, or never will change
+	}
+	time_t at = (time_t)floor(threshold);
+	if (op == classad::Operation::GREATER_THAN_OP || op == classad::Operation::LESS_OR_EQUAL_OP) {
+		at += 1;
+	} else if ((double)at < threshold) {
+		at += 1;
+	}
+	when = ChangeAfter(at, now);
+	return true;
+}
+
+// Add the attributes of the ad that the value of tree depends on to refs,
+// following references to other attributes of the ad.  When prune is true,
+// the operand of an && or || or ?: that the first operand keeps from mattering
+// is left out.  Returns the time at which the value may change when none of
+// those attributes do, which is no later than now if it depends on the current
+// time or the like in a way we can't tell, or 0 if it never will.
+static time_t AddPolicyReferences(ClassAd & ad, const classad::ExprTree * tree, classad::References & refs, bool prune, time_t now, int depth)
+{
+	if ( ! tree) return 0;
+	if (depth > 20) return now; // a reference loop, or too deep to keep track of
+
+	switch (tree->GetKind()) {
+		case classad::ExprTree::ATTRREF_NODE: {
+			classad::ExprTree * scope = nullptr;
+			std::string attr, scope_name;
+			bool absolute = false;
+			((const classad::AttributeReference*)tree)->GetComponents(scope, attr, absolute);
+			if (scope && ! (ExprTreeIsAttrRef(scope, scope_name) &&
+							(YourStringNoCase("MY") == scope_name || YourStringNoCase("TARGET") == scope_name))) {
+				// an attribute of a nested ad, which only changes when the nested ad does
+				return AddPolicyReferences(ad, scope, refs, false, now, depth + 1);
+			}
+			if (YourStringNoCase(ATTR_CURRENT_TIME) == attr) {
+				return now;
+			}
+			refs.insert(attr);
+			return AddPolicyReferences(ad, ad.Lookup(attr), refs, prune, now, depth + 1);
+		}
+
+		case classad::ExprTree::OP_NODE: {
+			classad::Operation::OpKind op;
+			classad::ExprTree *t1, *t2, *t3;
+			((const classad::Operation*)tree)->GetComponents(op, t1, t2, t3);
+			time_t when = 0;
+			if (ElapsedTimeComparison(ad, op, t1, t2, refs, now, depth, when)) {
+				return when;
+			}
+			when = AddPolicyReferences(ad, t1, refs, prune, now, depth);
+			if (prune && t1 &&
+				(op == classad::Operation::LOGICAL_AND_OP || op == classad::Operation::LOGICAL_OR_OP || op == classad::Operation::TERNARY_OP)) {
+				// the operand that doesn't matter now may matter once the first one changes,
+				// which is no earlier than when
+				classad::Value val;
+				bool b = false;
+				if (ad.EvaluateExpr(t1, val)) {
+					if (op == classad::Operation::TERNARY_OP) {
+						if (val.IsBooleanValue(b)) {
+							return EarlierChange(when, AddPolicyReferences(ad, b ? t2 : t3, refs, prune, now, depth));
+						}
+					} else if (val.IsErrorValue() || (val.IsBooleanValue(b) && b == (op == classad::Operation::LOGICAL_OR_OP))) {
+						return when;
+					}
+				}
+			}
+			when = EarlierChange(when, AddPolicyReferences(ad, t2, refs, prune, now, depth));
+			when = EarlierChange(when, AddPolicyReferences(ad, t3, refs, prune, now, depth));
+			return when;
+		}
+
+		case classad::ExprTree::FN_CALL_NODE: {
+			std::string fnName;
+			std::vector<classad::ExprTree*> args;
+			((const classad::FunctionCall*)tree)->GetComponents(fnName, args);
+			// time() and random() change by themselves, and we can't tell what eval() will look at
+			time_t when = 0;
+			if (YourStringNoCase("time") == fnName || YourStringNoCase("random") == fnName || YourStringNoCase("eval") == fnName) {
+				when = now;
+			}
+			for (auto * arg : args) {
+				// some functions evaluate their arguments in other ads, so don't prune them
+				when = EarlierChange(when, AddPolicyReferences(ad, arg, refs, false, now, depth));
+			}
+			return when;
+		}
+
+		case classad::ExprTree::CLASSAD_NODE: {
+			std::vector< std::pair<std::string, classad::ExprTree*> > attrs;
+			((const classad::ClassAd*)tree)->GetComponents(attrs);
+			time_t when = 0;
+			for (auto & it : attrs) {
+				when = EarlierChange(when, AddPolicyReferences(ad, it.second, refs, false, now, depth));
+			}
+			return when;
+		}
+
+		case classad::ExprTree::EXPR_LIST_NODE: {
+			std::vector<classad::ExprTree*> exprs;
+			((const classad::ExprList*)tree)->GetComponents(exprs);
+			time_t when = 0;
+			for (auto * expr : exprs) {
+				when = EarlierChange(when, AddPolicyReferences(ad, expr, refs, false, now, depth));
+			}
+			return when;
+		}
+
+		case classad::ExprTree::EXPR_ENVELOPE:
+			return AddPolicyReferences(ad, SkipExprEnvelope(const_cast<classad::ExprTree*>(tree)), refs, prune, now, depth);
+
+		default: // literals
+			return 0;
+	}
+}
+
+// The job duration limits, which AnalyzePolicy() checks against the current time
+static time_t DurationLimitReferences(ClassAd & ad, classad::References & refs, time_t now)
+{
+	time_t when = 0;
+	const char * attrs[] = { ATTR_JOB_ALLOWED_JOB_DURATION, ATTR_JOB_ALLOWED_EXECUTE_DURATION,
+		ATTR_SHADOW_BIRTHDATE, ATTR_JOB_CURRENT_START_EXECUTING_DATE, "TransferOutFinished" };
+	for (const char * attr : attrs) {
+		refs.insert(attr);
+		when = EarlierChange(when, AddPolicyReferences(ad, ad.Lookup(attr), refs, false, now));
+	}
+
+	time_t birthday = 0, allowed = 0, began = 0, finished = 0;
+	if ( ! ad.LookupInteger(ATTR_SHADOW_BIRTHDATE, birthday)) {
+		return when;
+	}
+	// held once time() - birthday >= allowed
+	if (ad.LookupInteger(ATTR_JOB_ALLOWED_JOB_DURATION, allowed)) {
+		when = EarlierChange(when, ChangeAfter(birthday + allowed, now));
+	}
+	// held once time() - began > allowed
+	if (ad.LookupInteger(ATTR_JOB_ALLOWED_EXECUTE_DURATION, allowed) &&
+		ad.LookupInteger(ATTR_JOB_CURRENT_START_EXECUTING_DATE, began) && began >= birthday) {
+		if (ad.LookupInteger("TransferOutFinished", finished) && finished > began) {
+			began = finished;
+		}
+		when = EarlierChange(when, ChangeAfter(began + allowed + 1, now));
+	}
+	return when;
+}
+
+time_t UserPolicy::PeriodicPolicyReferences(ClassAd & ad, int state, classad::References & refs)
+{
+	time_t now = time(nullptr);
+	time_t when = 0;
+
+	refs.insert(ATTR_JOB_STATUS);
+	if (state < 0 && ! ad.LookupInteger(ATTR_JOB_STATUS, state)) {
+		return 0;
+	}
+	if (state == REMOVED) {
+		return 0;
+	}
+	if (state == RUNNING || state == SUSPENDED) {
+		when = DurationLimitReferences(ad, refs, now);
+	}
+
+	refs.insert(ATTR_TIMER_REMOVE_CHECK);
+	ExprTree * expr = ad.Lookup(ATTR_TIMER_REMOVE_CHECK);
+	if (expr) {
+		when = EarlierChange(when, AddPolicyReferences(ad, expr, refs, true, now));
+		time_t timer_remove = -1;
+		if (ad.LookupInteger(ATTR_TIMER_REMOVE_CHECK, timer_remove) && timer_remove >= 0) {
+			// removed once timer_remove < time()
+			when = EarlierChange(when, ChangeAfter(timer_remove + 1, now));
+		}
+	}
+
+	std::vector<std::pair<const char *, SysPolicyId>> policies;
+	if (state == RUNNING || state == SUSPENDED) {
+		policies.emplace_back(ATTR_PERIODIC_VACATE_CHECK, POLICY_SYSTEM_PERIODIC_VACATE);
+	}
+	if (state != HELD && state != COMPLETED) {
+		policies.emplace_back(ATTR_PERIODIC_HOLD_CHECK, POLICY_SYSTEM_PERIODIC_HOLD);
+	}
+	if (state == HELD) {
+		refs.insert(ATTR_HOLD_REASON_CODE);
+		refs.insert(ATTR_NUM_HOLDS);
+		policies.emplace_back(ATTR_PERIODIC_RELEASE_CHECK, POLICY_SYSTEM_PERIODIC_RELEASE);
+	}
+	policies.emplace_back(ATTR_PERIODIC_REMOVE_CHECK, POLICY_SYSTEM_PERIODIC_REMOVE);
+
+	for (auto & [attr, sys_policy] : policies) {
+		refs.insert(attr);
+		when = EarlierChange(when, AddPolicyReferences(ad, ad.Lookup(attr), refs, true, now));
+
+	#ifdef ENABLE_JOB_POLICY_LISTS // multi policy
+		std::vector<JobPolicyExpr> * sys_exprs = nullptr;
+		switch (sys_policy) {
+		case POLICY_SYSTEM_PERIODIC_HOLD: sys_exprs = &m_sys_periodic_holds; break;
+		case POLICY_SYSTEM_PERIODIC_RELEASE: sys_exprs = &m_sys_periodic_releases; break;
+		case POLICY_SYSTEM_PERIODIC_REMOVE: sys_exprs = &m_sys_periodic_removes; break;
+		case POLICY_SYSTEM_PERIODIC_VACATE: sys_exprs = &m_sys_periodic_vacates; break;
+		default: break;
+		}
+		if (sys_exprs) {
+			for (auto & policy : *sys_exprs) {
+				when = EarlierChange(when, AddPolicyReferences(ad, policy.Expr(), refs, true, now));
+			}
+		}
+	#else
+		switch (sys_policy) {
+		case POLICY_SYSTEM_PERIODIC_HOLD: expr = m_sys_periodic_hold; break;
+		case POLICY_SYSTEM_PERIODIC_RELEASE: expr = m_sys_periodic_release; break;
+		case POLICY_SYSTEM_PERIODIC_REMOVE: expr = m_sys_periodic_remove; break;
+		default: expr = NULL; break;
+		}
+		when = EarlierChange(when, AddPolicyReferences(ad, expr, refs, true, now));
+	#endif
+	}
+
+	return when;
+}
+
 const char* UserPolicy::FiringExpression(void)
 {
 	return m_fire_expr;
@@ -283,6 +283,14 @@ class UserPolicy
 		   occurred, then false is returned. */
 		bool FiringReason(std::string & reason, int & reason_code, int & reason_subcode);
 
+		/* Add to refs the names of the attributes of the ad that the result of
+		   AnalyzePolicy(ad, PERIODIC_ONLY, state) depends on.  Returns the time
+		   at which the result may change even if none of those attributes do,
+		   or 0 if it never will.  That is when the job duration limits or
+		   comparisons like time() - QDate > 3600 are reached, or no later
+		   than now if the result depends on the current time in other ways. */
+		time_t PeriodicPolicyReferences(ClassAd &ad, int state, classad::References &refs);
+
 	private: /* functions */
 		/* This function inserts six of the seven (all but TimerRemove) user
 			job policy expressions with default values into the classad if they